@@ -39,6 +39,9 @@ struct VBlockDescriptor_t
 /// allocations of up to 128 bytes, and allocates buckets of increasing sizes using the OS's memory manager when
 /// more allocations of a specific size group are required. Larger allocations are simply passed to its base class,
 /// VMemoryManager_CRT, which uses OS memory management functions.
+///
+/// All allocations and deallocations are serialized by a single mutex. Applications that allocate heavily from
+/// several threads at the same time should use VThreadCachingMemoryManager (VisionEnginePlugin) instead.
 class VSmallBlockMemoryManager : public VMemoryManager_CRT
 {
 public:
@@ -34,6 +34,21 @@ public:
   /// \brief
   ///   Atomically decrements the passed value and returns the new value
   inline static int Decrement(int &i32);
+
+  /// \brief
+  ///   Atomically replaces the pointer at pDest with pExchange if it is equal to pComparand, and
+  ///   returns the previous value. Acts as a full memory barrier.
+  inline static void* CompareExchangePointer(void* volatile *pDest, void *pExchange, void *pComparand);
+
+  /// \brief
+  ///   Reads the pointer at pSrc. Memory accesses that follow the call are not moved before the read
+  ///   (acquire semantics).
+  inline static void* LoadPointerAcquire(void* const volatile *pSrc);
+
+  /// \brief
+  ///   Writes p to pDest. Memory accesses that precede the call are not moved after the write
+  ///   (release semantics).
+  inline static void StorePointerRelease(void* volatile *pDest, void *p);
 };
 
 #if defined(WIN32)
@@ -18,6 +18,33 @@ int VAtomic::Decrement(int &i32)
   return OSAtomicDecrement32(&i32);
 }
 
+void* VAtomic::CompareExchangePointer(void* volatile *pDest, void *pExchange, void *pComparand)
+{
+  // OSAtomicCompareAndSwapPtrBarrier only reports success, so retry until the comparison either
+  // fails on a freshly read value or the swap succeeds
+  for (;;)
+  {
+    void *pPrevious = *pDest;
+    if (pPrevious != pComparand)
+      return pPrevious;
+    if (OSAtomicCompareAndSwapPtrBarrier(pComparand, pExchange, pDest))
+      return pComparand;
+  }
+}
+
+void* VAtomic::LoadPointerAcquire(void* const volatile *pSrc)
+{
+  void *p = *pSrc;
+  OSMemoryBarrier();
+  return p;
+}
+
+void VAtomic::StorePointerRelease(void* volatile *pDest, void *p)
+{
+  OSMemoryBarrier();
+  *pDest = p;
+}
+
 /*
  * Havok SDK - Base file, BUILD(#20131021)
  * 
@@ -16,6 +16,32 @@ int VAtomic::Decrement(int &i32)
   return InterlockedDecrement((LONG*) &i32);
 }
 
+void* VAtomic::CompareExchangePointer(void* volatile *pDest, void *pExchange, void *pComparand)
+{
+  return InterlockedCompareExchangePointer((PVOID volatile*) pDest, pExchange, pComparand);
+}
+
+void* VAtomic::LoadPointerAcquire(void* const volatile *pSrc)
+{
+  void *p = *pSrc;
+#if defined(_M_ARM)
+  MemoryBarrier();
+#else
+  _ReadWriteBarrier(); // x86 and x64 loads are not reordered with later accesses
+#endif
+  return p;
+}
+
+void VAtomic::StorePointerRelease(void* volatile *pDest, void *p)
+{
+#if defined(_M_ARM)
+  MemoryBarrier();
+#else
+  _ReadWriteBarrier(); // x86 and x64 stores are not reordered with earlier accesses
+#endif
+  *pDest = p;
+}
+
 /*
  * Havok SDK - Base file, BUILD(#20131019)
  * 
@@ -17,6 +17,24 @@ int VAtomic::Decrement(int &i32)
   return __sync_sub_and_fetch(&i32, 1);
 }
 
+void* VAtomic::CompareExchangePointer(void* volatile *pDest, void *pExchange, void *pComparand)
+{
+  return __sync_val_compare_and_swap(pDest, pComparand, pExchange);
+}
+
+void* VAtomic::LoadPointerAcquire(void* const volatile *pSrc)
+{
+  void *p = *pSrc;
+  __sync_synchronize();
+  return p;
+}
+
+void VAtomic::StorePointerRelease(void* volatile *pDest, void *p)
+{
+  __sync_synchronize();
+  *pDest = p;
+}
+
 /*
  * Havok SDK - Base file, BUILD(#20131019)
  * 
@@ -36,15 +36,20 @@ VisCallback_cl IVisSceneManager_cl::OnReposition(VIS_PROFILE_REPOSITION_CUSTOMOB
     if (!pInst) continue;
     
 
-IVisSceneManager_cl::IVisSceneManager_cl()
+IVisSceneManager_cl::IVisSceneManager_cl() : m_SpatialIndexBoxes(0), m_SpatialIndexObjects(0, NULL)
 {
   m_pStreamingReferenceObject = NULL;
   m_pLastTestedZone = NULL;
   m_bHandleRepositioning = true;
+  m_iZoneIndexUpdateCount = m_iStaticGeometryIndexUpdateCount = INT_MIN;
+  m_iStaticGeometryTableHash = 0;
+
+  Vision::Callbacks.OnWorldDeInit += this;
 }
 
 IVisSceneManager_cl::~IVisSceneManager_cl() 
 {
+  Vision::Callbacks.OnWorldDeInit -= this;
 }
 
 VisVisibilityZone_cl *IVisSceneManager_cl::VisibilityZoneForUID(__int64 uid) const
@@ -70,6 +75,7 @@ void IVisSceneManager_cl::AddVisibilityZone(VisVisibilityZone_cl *pZone)
   pZone->SetIndex(iIndex);
   VASSERT(m_VisibilityZones.GetAt(iIndex)==pZone);
   pZone->OnAddedToSceneManager(this);
+  InvalidateSpatialIndex();
 }
 
 void IVisSceneManager_cl::RemoveVisibilityZone(VisVisibilityZone_cl *pZone)
@@ -84,6 +90,8 @@ void IVisSceneManager_cl::RemoveVisibilityZone(VisVisibilityZone_cl *pZone)
   // enumerate
   for (int i=0;i<m_VisibilityZones.Count();i++)
     m_VisibilityZones.GetAt(i)->SetIndex(i);
+
+  InvalidateSpatialIndex();
 }
 
 void IVisSceneManager_cl::RemoveAllVisibilityZones()
@@ -103,6 +111,7 @@ void IVisSceneManager_cl::RemoveAllVisibilityZones()
   }
 
   m_VisibilityZones.Clear();
+  InvalidateSpatialIndex();
 
 /*
   // also clear the resource caching queue
@@ -124,67 +133,256 @@ VisObject3D_cl* IVisSceneManager_cl::GetStreamingReferenceSafe() const
 
 
 
+// Removes the instances which are not assigned to any visibility zone (i.e. not part of the scene)
+// from the entries that have been appended to destList since iFirst.
+static void RemoveUnassignedGeometry(VisStaticGeometryInstanceCollection_cl &destList, int iFirst)
+{
+  VisStaticGeometryInstance_cl **pList = destList.GetDataPtr();
+  const int iCount = destList.GetNumEntries();
+  int iKept = iFirst;
+  for (int i=iFirst; i<iCount; i++)
+    if (pList[i]->GetVisibilityZoneAssignmentCount() > 0)
+      pList[iKept++] = pList[i];
+  destList.SetNumEntries(iKept);
+}
+
 void IVisSceneManager_cl::GatherStaticGeometryInBoundingBox(const hkvAlignedBBox &bbox, VisStaticGeometryInstanceCollection_cl &destList)
 {
-  VisVisibilityZone_cl *tempNodeList[256];
-  int iNumNodes = FindVisibilityZones(bbox, tempNodeList, 256);
-//  int iNumFoundGIs = 0;
-  VisStaticGeometryInstance_cl::ResetTags();
+  VisSpatialIndexPtr spIndex = GetStaticGeometryIndex();
+  const int iFirst = destList.GetNumEntries();
+  if (spIndex->FindInBoundingBox(bbox, destList) > 0)
+    RemoveUnassignedGeometry(destList, iFirst);
+}
 
-  for (int i=0; i<iNumNodes; i++) 
-  {
-    VisVisibilityZone_cl *pNode = tempNodeList[i];
-    hkvAlignedBBox nodeBox = pNode->GetBoundingBox();
-    if (!nodeBox.overlaps(bbox))
-      continue;
+void IVisSceneManager_cl::GatherStaticGeometryInSphere(const hkvBoundingSphere &sphere, VisStaticGeometryInstanceCollection_cl &destList)
+{
+  VisSpatialIndexPtr spIndex = GetStaticGeometryIndex();
+  const int iFirst = destList.GetNumEntries();
+  if (spIndex->FindInSphere(sphere, destList) > 0)
+    RemoveUnassignedGeometry(destList, iFirst);
+}
 
-    const VisStaticGeometryInstanceCollection_cl *pGIs = pNode->GetStaticGeometryInstances();
-    VisStaticGeometryInstance_cl **pGeoInstanceList = (VisStaticGeometryInstance_cl **)pGIs->GetDataPtr();
-    int iNumGIs = pGIs->GetNumEntries();
-    if (iNumGIs < 1)
-      continue;
-    for (int j=0; j<iNumGIs; j++, pGeoInstanceList++)
-    {
-      if ((*pGeoInstanceList)->IsTagged())
-        continue;
-      (*pGeoInstanceList)->Tag();
-      if (!(*pGeoInstanceList)->GetBoundingBox().overlaps(bbox))
-        continue;
-      destList.AppendEntry(*pGeoInstanceList);
-    }
-  }
+void IVisSceneManager_cl::GatherStaticGeometryAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisStaticGeometryInstanceCollection_cl &destList)
+{
+  VisSpatialIndexPtr spIndex = GetStaticGeometryIndex();
+  const int iFirst = destList.GetNumEntries();
+  if (spIndex->FindAlongLineSegment(vStart, vEnd, destList) > 0)
+    RemoveUnassignedGeometry(destList, iFirst);
 }
 
 
+// Returns whether the passed entity is assigned to one of the passed zones
+static bool IsInAnyZone(const VisObject3DVisData_cl *pVisData, VisVisibilityZone_cl * const *pZones, int iZoneCount)
+{
+  for (int i=0; i<iZoneCount; i++)
+    if (pVisData->ContainsVisibilityZone(pZones[i]))
+      return true;
+  return false;
+}
 
-void IVisSceneManager_cl::GatherEntitiesInBoundingBox(const hkvAlignedBBox &bbox, VisEntityCollection_cl &destList)
+// Appends the entities of the passed zones that overlap the passed box or sphere, in the order of the
+// zones. Entities which are assigned to several of the zones are only added by the first of them. This
+// does not use the entity tags, so it can run on multiple threads at the same time.
+static void GatherEntitiesInZones(const VisVisibilityZoneCollection_cl &zones, const hkvAlignedBBox *pBox, const hkvBoundingSphere *pSphere, VisEntityCollection_cl &destList)
 {
-  VisVisibilityZone_cl *tempNodeList[256];
-  int iNumNodes = FindVisibilityZones(bbox, tempNodeList, 256);
-  VisBaseEntity_cl::ResetTags();
+  const int iNumZones = zones.GetNumEntries();
+  VisVisibilityZone_cl *pVisitedBuffer[64];
+  VisVisibilityZone_cl **pVisitedZones = (iNumZones > (int)V_ARRAY_SIZE(pVisitedBuffer)) ? new VisVisibilityZone_cl *[iNumZones] : pVisitedBuffer;
+  int iVisitedZones = 0;
 
-  for (int i=0; i<iNumNodes; i++) 
+  for (int i=0; i<iNumZones; i++)
   {
-    VisVisibilityZone_cl *pNode = tempNodeList[i];
-    hkvAlignedBBox nodeBox = pNode->GetBoundingBox();
-    if (!nodeBox.overlaps(bbox))
+    VisVisibilityZone_cl *pNode = zones.GetEntry(i);
+    const hkvAlignedBBox &nodeBox = pNode->GetBoundingBox();
+    if (pBox ? !nodeBox.overlaps(*pBox) : !nodeBox.overlaps(*pSphere))
       continue;
 
     const VisEntityCollection_cl *pEntities = pNode->GetEntities();
     VisBaseEntity_cl **pEntityList = (VisBaseEntity_cl **)pEntities->GetDataPtr();
     const int iEntities = pEntities->GetNumEntries();
-    if (iEntities < 1)
-      continue;
     for (int j=0; j<iEntities; j++, pEntityList++)
     {
-      if ((*pEntityList)->IsTagged())
+      VisBaseEntity_cl *pEntity = *pEntityList;
+      const hkvAlignedBBox &entityBox = *pEntity->GetCurrentVisBoundingBoxPtr();
+      if (pBox ? !entityBox.overlaps(*pBox) : !entityBox.overlaps(*pSphere))
         continue;
-      (*pEntityList)->Tag();
-      if (!(*pEntityList)->GetCurrentVisBoundingBoxPtr()->overlaps(bbox))
+      // entities that span multiple zones have already been added by a previous zone
+      const VisObject3DVisData_cl *pVisData = pEntity->GetVisData();
+      if (iVisitedZones > 0 && pVisData->GetNumVisibilityZones() > 1 && IsInAnyZone(pVisData, pVisitedZones, iVisitedZones))
         continue;
-      destList.AppendEntry(*pEntityList);
+      destList.AppendEntry(pEntity);
     }
+    if (iEntities > 0)
+      pVisitedZones[iVisitedZones++] = pNode;
+  }
+
+  if (pVisitedZones != pVisitedBuffer)
+    V_SAFE_DELETE_ARRAY(pVisitedZones);
+}
+
+void IVisSceneManager_cl::GatherEntitiesInBoundingBox(const hkvAlignedBBox &bbox, VisEntityCollection_cl &destList)
+{
+  VisVisibilityZoneCollection_cl zones(64);
+  GatherVisibilityZonesInBoundingBox(bbox, zones);
+  GatherEntitiesInZones(zones, &bbox, NULL, destList);
+}
+
+void IVisSceneManager_cl::GatherEntitiesInSphere(const hkvBoundingSphere &sphere, VisEntityCollection_cl &destList)
+{
+  VisVisibilityZoneCollection_cl zones(64);
+  GatherVisibilityZonesInSphere(sphere, zones);
+  GatherEntitiesInZones(zones, NULL, &sphere, destList);
+}
+
+
+void IVisSceneManager_cl::GatherVisibilityZonesInBoundingBox(const hkvAlignedBBox &bbox, VisVisibilityZoneCollection_cl &destList)
+{
+  VisSpatialIndexPtr spIndex = GetVisibilityZoneIndex();
+  spIndex->FindInBoundingBox(bbox, destList);
+}
+
+void IVisSceneManager_cl::GatherVisibilityZonesInSphere(const hkvBoundingSphere &sphere, VisVisibilityZoneCollection_cl &destList)
+{
+  VisSpatialIndexPtr spIndex = GetVisibilityZoneIndex();
+  spIndex->FindInSphere(sphere, destList);
+}
+
+void IVisSceneManager_cl::GatherVisibilityZonesAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisVisibilityZoneCollection_cl &destList)
+{
+  VisSpatialIndexPtr spIndex = GetVisibilityZoneIndex();
+  spIndex->FindAlongLineSegment(vStart, vEnd, destList);
+}
+
+
+// Returns an index for the passed objects: pIndex itself if nothing has changed, otherwise a new
+// index. pIndex is never modified since other threads may still be querying it.
+static VisSpatialIndex_cl *UpdateSpatialIndex(VisSpatialIndex_cl *pIndex, int iCount, const hkvAlignedBBox *pBoxes, void * const *ppObjects)
+{
+  bool bSameObjects = (pIndex != NULL && pIndex->GetObjectCount() == iCount);
+  bool bSameBoxes = bSameObjects;
+  for (int i=0; i<iCount && bSameObjects; i++)
+  {
+    if (pIndex->GetObject(i) != ppObjects[i])
+      bSameObjects = false;
+    else if (bSameBoxes && !pIndex->GetObjectBoundingBox(i).isIdentical(pBoxes[i]))
+      bSameBoxes = false;
+  }
+  if (bSameObjects && bSameBoxes)
+    return pIndex;
+
+  VisSpatialIndex_cl *pNewIndex = new VisSpatialIndex_cl();
+  if (bSameObjects)
+  {
+    // moved objects, e.g. after repositioning: keep the tree structure
+    pNewIndex->CopyFrom(*pIndex);
+    if (pNewIndex->Refit(pBoxes))
+      return pNewIndex;
   }
+  pNewIndex->Build(iCount, pBoxes, ppObjects);
+  return pNewIndex;
+}
+
+// Returns true if the spatial indices have to be checked for changes
+static inline bool NeedsSpatialIndexCheck(int iLastUpdateCount)
+{
+#ifdef WIN32
+  // the scene is not ticked inside the editor, but objects are moved all the time
+  if (Vision::Editor.IsInEditor())
+    return true;
+#endif
+  return iLastUpdateCount != Vision::Game.GetUpdateSceneCount();
+}
+
+VisSpatialIndexPtr IVisSceneManager_cl::GetVisibilityZoneIndex()
+{
+  VMutexLocker lock(m_SpatialIndexMutex);
+  if (m_spZoneIndex != NULL && !NeedsSpatialIndexCheck(m_iZoneIndexUpdateCount))
+    return m_spZoneIndex;
+  m_iZoneIndexUpdateCount = Vision::Game.GetUpdateSceneCount();
+
+  // assignment boxes can be changed without notifying the scene manager, so compare them
+  const int iNumZones = m_VisibilityZones.Count();
+  m_SpatialIndexBoxes.EnsureSize(iNumZones);
+  m_SpatialIndexObjects.EnsureSize(iNumZones);
+  hkvAlignedBBox *pBoxes = m_SpatialIndexBoxes.GetDataPtr();
+  void **ppObjects = m_SpatialIndexObjects.GetDataPtr();
+  for (int i=0; i<iNumZones; i++)
+  {
+    VisVisibilityZone_cl *pZone = m_VisibilityZones.GetAt(i);
+    pBoxes[i] = pZone->GetAssignmentBoundingBox();
+    ppObjects[i] = pZone;
+  }
+
+  m_spZoneIndex = UpdateSpatialIndex(m_spZoneIndex, iNumZones, pBoxes, ppObjects);
+  return m_spZoneIndex;
+}
+
+// Weighted pointer sum over the element table of the static geometry instances. It changes when instances
+// are created or deleted and only reads the table, not the instances themselves.
+static UINT_PTR ComputeStaticGeometryTableHash()
+{
+  const int iCount = VisStaticGeometryInstance_cl::ElementManagerGetSize();
+  UINT_PTR iHash = (UINT_PTR)iCount;
+  for (int i=0; i<iCount; i++)
+    iHash += (UINT_PTR)VisStaticGeometryInstance_cl::ElementManagerGet(i) * (UINT_PTR)(i+1);
+  return iHash;
+}
+
+VisSpatialIndexPtr IVisSceneManager_cl::GetStaticGeometryIndex()
+{
+  VMutexLocker lock(m_SpatialIndexMutex);
+
+  // Instances can be created and deleted at any time during the tick. The index must not miss new
+  // instances or return deleted ones, so the element table is compared on every query.
+  const UINT_PTR iTableHash = ComputeStaticGeometryTableHash();
+  if (m_spStaticGeometryIndex != NULL && iTableHash == m_iStaticGeometryTableHash && !NeedsSpatialIndexCheck(m_iStaticGeometryIndexUpdateCount))
+    return m_spStaticGeometryIndex;
+  m_iStaticGeometryIndexUpdateCount = Vision::Game.GetUpdateSceneCount();
+  m_iStaticGeometryTableHash = iTableHash;
+
+  const int iSize = VisStaticGeometryInstance_cl::ElementManagerGetSize();
+  m_SpatialIndexBoxes.EnsureSize(iSize);
+  m_SpatialIndexObjects.EnsureSize(iSize);
+  hkvAlignedBBox *pBoxes = m_SpatialIndexBoxes.GetDataPtr();
+  void **ppObjects = m_SpatialIndexObjects.GetDataPtr();
+  int iNumInstances = 0;
+  FOR_ALL_GEOMETRY_INSTANCES
+    pBoxes[iNumInstances] = pInst->GetBoundingBox();
+    ppObjects[iNumInstances] = pInst;
+    iNumInstances++;
+  }
+
+  m_spStaticGeometryIndex = UpdateSpatialIndex(m_spStaticGeometryIndex, iNumInstances, pBoxes, ppObjects);
+  return m_spStaticGeometryIndex;
+}
+
+void IVisSceneManager_cl::InvalidateSpatialIndex()
+{
+  VMutexLocker lock(m_SpatialIndexMutex);
+  m_iZoneIndexUpdateCount = m_iStaticGeometryIndexUpdateCount = INT_MIN;
+}
+
+
+void IVisSceneManager_cl::AddSoftwareOccluder(VisSoftwareOccluder_cl *pOccluder)
+{
+  VASSERT(pOccluder != NULL);
+  m_SoftwareOccluders.AddUnique(pOccluder);
+}
+
+void IVisSceneManager_cl::RemoveSoftwareOccluder(VisSoftwareOccluder_cl *pOccluder)
+{
+  m_SoftwareOccluders.SafeRemove(pOccluder);
+}
+
+void IVisSceneManager_cl::RemoveAllSoftwareOccluders()
+{
+  m_SoftwareOccluders.Clear();
+}
+
+void IVisSceneManager_cl::OnHandleCallback(IVisCallbackDataObject_cl *pData)
+{
+  if (pData->m_pSender==&Vision::Callbacks.OnWorldDeInit)
+    RemoveAllSoftwareOccluders();
 }
 
 
@@ -205,6 +403,9 @@ void IVisSceneManager_cl::RepositionAllZones()
   // trigger callback for custom scene elements
   VisZoneRepositionDataObject_cl data(&OnReposition, m_RepositionInfo);
   data.Trigger();
+
+  // zones and geometry have moved
+  InvalidateSpatialIndex();
 }
 
 void IVisSceneManager_cl::SetGlobalPivot(const hkvVec3d& vPivot )
@@ -231,6 +432,13 @@ VisionSceneManager_cl::VisionSceneManager_cl() : m_ChangingZones(0, 0)
   m_bPreferUnload = false;
   m_iLastManagerIndex = 0;
 
+  m_vLastStreamingPos.setZero();
+  m_vStreamingVelocity.setZero();
+  m_bLastStreamingPosValid = false;
+  m_fStreamingPredictionTime = 2.f;
+  m_iMaxReadAheadTasks = 4;
+  m_iMaxReadAheadBytes = 32*1024*1024;
+
   m_SnapshotQueue.m_pCreator = &g_ResourceCreator;
   m_SnapshotQueue.m_pLoader = &Vision::File.GetMemoryStreamManager();
   m_SnapshotQueue.m_pFileManager = Vision::File.GetManager();
@@ -245,18 +453,10 @@ VisionSceneManager_cl::~VisionSceneManager_cl()
 
 unsigned int VisionSceneManager_cl::FindVisibilityZones(const hkvAlignedBBox &bbox, VisVisibilityZone_cl **pNodes, unsigned int iMaxNodes)
 {
-  int iNumRelevantZones = 0;
-
-  FOR_ALL_VISIBILITY_ZONES
-    if (bbox.overlaps(pZone->GetAssignmentBoundingBox()))
-    {
-      pNodes[iNumRelevantZones++] = pZone;
-      if (iNumRelevantZones >= iMaxNodes) {
-        Vision::Error.Warning("Entity overlapped more than %d visibility zones - bounding box may be incorrect or too large.", iMaxNodes);
-        break;
-      }
-    }
-  }
+  VisSpatialIndexPtr spIndex = GetVisibilityZoneIndex();
+  int iNumRelevantZones = spIndex->FindInBoundingBox(bbox, (void **)pNodes, (int)iMaxNodes);
+  if (iMaxNodes > 0 && iNumRelevantZones >= (int)iMaxNodes)
+    Vision::Error.Warning("Entity overlapped more than %d visibility zones - bounding box may be incorrect or too large.", iMaxNodes);
   return iNumRelevantZones;
 }
 
@@ -432,6 +632,9 @@ VisZoneResource_cl *VisionSceneManager_cl::CreateZoneResource(VisZoneResourceMan
 #define ACTION_CALL_SCHEDULELOADING 3
 #define ACTION_CALL_UNLOADINGTICK   4
 
+// number of points on the predicted path of the streaming reference object that are tested against the zone boxes
+#define STREAMING_PREDICTION_STEPS  4
+
 #define MARK_ZONE_AS_CHANGING \
   if (!bZoneAdded) {m_ChangingZones[iChangingZones++] = pZone;bZoneAdded=true;}
 
@@ -469,9 +672,15 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
   if (m_bHandleRepositioning && m_RepositionInfo.SupportsRepositioning())
   {
     if (m_RepositionInfo.HandleRepositioning(pCamera))
+    {
       RepositionAllZones();
+      m_bLastStreamingPosValid = false; // the camera jumps, which is not a movement
+    }
   }
 
+  UpdateStreamingVelocity(vCamPos, fTimeDelta);
+  const hkvVec3 vPredictedMotion = m_vStreamingVelocity * m_fStreamingPredictionTime;
+  const bool bPredictMotion = !vPredictedMotion.isZero(0.001f);
 
   const int iCount = zones.GetResourceCount();
   int iChangingZones = 0;
@@ -484,7 +693,15 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
     if (!pZone || !pZone->m_bHandleZone || pZone->IsMissing())
       continue;
     float fDist = pZone->m_BoundingBox.getDistanceTo(vCamPos);
-    pZone->m_fCameraDistance = fDist;
+
+    // closest distance along the predicted path, used for everything but synchronous loading
+    float fPredictedDist = fDist;
+    for (int iStep=1; bPredictMotion && iStep<=STREAMING_PREDICTION_STEPS && fPredictedDist>0.f; iStep++)
+    {
+      const hkvVec3 vPos = vCamPos + vPredictedMotion * ((float)iStep / (float)STREAMING_PREDICTION_STEPS);
+      fPredictedDist = hkvMath::Min(fPredictedDist, pZone->m_BoundingBox.getDistanceTo(vPos));
+    }
+    pZone->m_fCameraDistance = fPredictedDist;
     bool bZoneAdded = false;
     UBYTE &action(pZone->m_iWantedAction);
 
@@ -493,6 +710,11 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
       m_bAnyZoneCaching = true;
       action = ACTION_CALL_LOADINGTICK;
       MARK_ZONE_AS_CHANGING;
+
+      // let the snapshot queue follow the predicted distance as well
+      const float fPriority = -fPredictedDist;
+      if (pZone->m_Snapshot.GetQueue()!=NULL && hkvMath::Abs(pZone->m_Snapshot.GetPriority()-fPriority) > 1.f)
+        pZone->m_Snapshot.SetPriority(fPriority);
     } 
     else if (pZone->IsDestroyingInstances())
     {
@@ -508,7 +730,7 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
         MARK_ZONE_AS_CHANGING;
         continue;
       }
-      if (!pZone->IsStreaming() && fDist<pZone->m_fCacheDistance)
+      if (!pZone->IsStreaming() && fPredictedDist<pZone->m_fCacheDistance)
       {
         action = ACTION_CALL_SCHEDULELOADING;
         MARK_ZONE_AS_CHANGING;
@@ -517,7 +739,7 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
     }
     else
     {
-      if (fDist>pZone->m_fCacheOutDistance) // uncache distance
+      if (fPredictedDist>pZone->m_fCacheOutDistance) // uncache distance
       {
         action = ACTION_CALL_UNLOADINGTICK;
         MARK_ZONE_AS_CHANGING;
@@ -537,6 +759,7 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
   #endif
     m_SnapshotQueue.TickFunction(fTimeDelta);
     m_bAnyZoneCaching |= m_SnapshotQueue.IsBusy();
+    HandleReadAheadQueue();
   #ifdef HK_DEBUG
     Vision::File.SetWarnOnUncachedFiles(false);
   #endif
@@ -636,6 +859,109 @@ void VisionSceneManager_cl::HandleZones(float fTimeDelta)
 }
 
 
+void VisionSceneManager_cl::UpdateStreamingVelocity(const hkvVec3 &vRefPos, float fTimeDelta)
+{
+  if (m_bLastStreamingPosValid && fTimeDelta>0.f)
+  {
+    const hkvVec3 vVelocity = (vRefPos - m_vLastStreamingPos) / fTimeDelta;
+    // smooth over roughly a quarter of a second so that single frame jitter does not affect the prediction
+    const float fBlend = hkvMath::Min(fTimeDelta*4.f, 1.f);
+    m_vStreamingVelocity += (vVelocity - m_vStreamingVelocity) * fBlend;
+  }
+  else if (!m_bLastStreamingPosValid)
+  {
+    m_vStreamingVelocity.setZero();
+  }
+  m_vLastStreamingPos = vRefPos;
+  m_bLastStreamingPosValid = true;
+}
+
+
+void VisionSceneManager_cl::HandleReadAheadQueue()
+{
+  VMemoryStreamManager &loader = Vision::File.GetMemoryStreamManager();
+
+  // the tasks that are still needed by a queued snapshot are moved to the front of the list,
+  // everything behind them has been consumed or is not needed anymore
+  int iNeededTasks = 0;
+  int iPendingTasks = 0;
+  int iBytes = 0;
+  bool bLimitReached = false;
+
+  int iSnapshotCount = 0;
+  VResourceSnapshot **ppSnapshots = m_SnapshotQueue.GetQueue(iSnapshotCount);
+  for (int i=0; i<iSnapshotCount && m_iMaxReadAheadTasks>0; i++)
+  {
+    VResourceSnapshot *pSnapshot = ppSnapshots[i];
+    if (pSnapshot==NULL || !pSnapshot->IsLoaded() || pSnapshot->IsFinished())
+      continue;
+
+    // the current entry is already being handled by the snapshot itself
+    const int iEntryCount = pSnapshot->GetResourceEntryCount();
+    for (int j=hkvMath::Max(pSnapshot->GetCurrentResourceEntry()+1, 0); j<iEntryCount; j++)
+    {
+      VResourceSnapshotEntry &entry = pSnapshot->GetResourceEntry(j);
+      if ((!entry.IsResource() && !entry.IsFile()) || entry.HasReplacementData())
+        continue;
+      if (entry.m_spResource!=NULL && entry.m_spResource->IsLoaded())
+        continue;
+
+      char szBuffer[FS_MAX_PATH];
+      const char *szFilename = pSnapshot->ResolveFilename(entry.GetFileNameSafe(), szBuffer);
+      if (szFilename==NULL || szFilename[0]==0)
+        continue;
+
+      VLoadingTask *pTask = loader.FindPrecachedFile(szFilename);
+      if (pTask==NULL)
+      {
+        // keep the queue order: once a file does not fit into the limits, no later file (also of later
+        // snapshots) is read before it
+        if (bLimitReached || iPendingTasks>=m_iMaxReadAheadTasks || iBytes+entry.m_iFileSize>m_iMaxReadAheadBytes)
+        {
+          bLimitReached = true;
+          break;
+        }
+        pTask = loader.PrecacheFile(szFilename);
+        if (pTask==NULL)
+          continue;
+      }
+
+      int iIndex = -1;
+      if (!m_ReadAheadTaskIndex.Lookup(pTask, iIndex))
+      {
+        iIndex = m_ReadAheadTasks.Add(pTask);
+        m_ReadAheadTaskIndex.SetAt(pTask, iIndex);
+      }
+      if (iIndex<iNeededTasks)
+        continue; // referenced by more than one snapshot
+
+      if (iIndex!=iNeededTasks)
+      {
+        // swap into the needed range
+        VLoadingTaskPtr spOther = m_ReadAheadTasks.GetAt(iNeededTasks);
+        m_ReadAheadTasks.SetAt(iNeededTasks, pTask);
+        m_ReadAheadTasks.SetAt(iIndex, spOther);
+        m_ReadAheadTaskIndex.SetAt(pTask, iNeededTasks);
+        m_ReadAheadTaskIndex.SetAt(spOther.GetPtr(), iIndex);
+      }
+      iNeededTasks++;
+
+      if (!pTask->IsLoaded())
+        iPendingTasks++;
+      iBytes += entry.m_iFileSize;
+    }
+  }
+
+  // release the tasks which are no longer needed; a consumed file is owned by its resource now
+  while (m_ReadAheadTasks.Count()>iNeededTasks)
+  {
+    const int iLast = m_ReadAheadTasks.Count()-1;
+    m_ReadAheadTaskIndex.RemoveKey(m_ReadAheadTasks.GetAt(iLast));
+    m_ReadAheadTasks.RemoveAt(iLast);
+  }
+}
+
+
 void VisionSceneManager_cl::HandleFullResLoadingQueue()
 {
   int iCount = m_FullResQueue.Count();
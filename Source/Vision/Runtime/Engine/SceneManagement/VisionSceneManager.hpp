@@ -13,6 +13,8 @@
 
 #include <Vision/Runtime/Engine/Visibility/VisApiVisibilityZone.hpp>
 #include <Vision/Runtime/Engine/SceneManagement/VisApiZone.hpp>
+#include <Vision/Runtime/Engine/SceneManagement/VisionSpatialIndex.hpp>
+#include <Vision/Runtime/Engine/Visibility/VisionSoftwareOcclusion.hpp>
 
 class VisVisibilityZone_cl;
 
@@ -34,7 +36,7 @@ class VisRCVisibilityZoneCollection_cl : public VRefCountedCollection<VisVisibil
 /// required to make the Vision engine work correctly.
 /// 
 /// By default, the VisionSceneManager_cl class is used.
-class IVisSceneManager_cl : public VRefCounter
+class IVisSceneManager_cl : public VRefCounter, public IVisCallbackHandler_cl
 {
 public:
 
@@ -371,10 +373,121 @@ public:
   ///
   VISION_APIFUNC void GatherEntitiesInBoundingBox(const hkvAlignedBBox &bbox, VisEntityCollection_cl &destList);
 
+  /// \brief
+  ///   Adds all static geometry instances to the passed collection that touch the sphere. See
+  ///   GatherStaticGeometryInBoundingBox.
+  VISION_APIFUNC void GatherStaticGeometryInSphere(const hkvBoundingSphere &sphere, VisStaticGeometryInstanceCollection_cl &destList);
+
+  /// \brief
+  ///   Adds all static geometry instances to the passed collection whose bounding box is intersected
+  ///   by the line segment from vStart to vEnd. See GatherStaticGeometryInBoundingBox.
+  VISION_APIFUNC void GatherStaticGeometryAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisStaticGeometryInstanceCollection_cl &destList);
+
+  /// \brief
+  ///   Adds all entities to the passed collection that touch the sphere. See
+  ///   GatherEntitiesInBoundingBox.
+  VISION_APIFUNC void GatherEntitiesInSphere(const hkvBoundingSphere &sphere, VisEntityCollection_cl &destList);
+
+  /// \brief
+  ///   Adds all visibility zones to the passed collection whose assignment bounding box overlaps
+  ///   the passed box.
+  ///
+  /// Unlike FindVisibilityZones, the number of results is not limited.
+  VISION_APIFUNC void GatherVisibilityZonesInBoundingBox(const hkvAlignedBBox &bbox, VisVisibilityZoneCollection_cl &destList);
+
+  /// \brief
+  ///   Adds all visibility zones to the passed collection whose assignment bounding box overlaps
+  ///   the passed sphere.
+  VISION_APIFUNC void GatherVisibilityZonesInSphere(const hkvBoundingSphere &sphere, VisVisibilityZoneCollection_cl &destList);
+
+  /// \brief
+  ///   Adds all visibility zones to the passed collection whose assignment bounding box is
+  ///   intersected by the line segment from vStart to vEnd.
+  VISION_APIFUNC void GatherVisibilityZonesAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisVisibilityZoneCollection_cl &destList);
+
   /// \brief
   ///   Overridable function to force zone update for handling slew conditions
   VISION_APIFUNC virtual void RepositionAllZones();
 
+  ///
+  /// @}
+  ///
+
+
+  ///
+  /// @name Spatial Index
+  /// @{
+  ///
+
+  /// \brief
+  ///   Returns a bounding volume hierarchy over the assignment bounding boxes of all visibility
+  ///   zones, with the zones as objects.
+  ///
+  /// The index is updated on demand: it is rebuilt when zones are added or removed and refitted
+  /// when assignment boxes have changed, which is checked once per simulation tick (see
+  /// VisGame_cl::GetUpdateSceneCount). The returned index is never modified afterwards, so it can
+  /// be queried from any thread while holding the smart pointer. This function is thread-safe.
+  ///
+  /// All visibility zone and Gather* queries of the scene manager are based on this index and on
+  /// GetStaticGeometryIndex.
+  VISION_APIFUNC VisSpatialIndexPtr GetVisibilityZoneIndex();
+
+  /// \brief
+  ///   Returns a bounding volume hierarchy over the bounding boxes of all static geometry
+  ///   instances, with the instances as objects.
+  ///
+  /// Updated the same way as GetVisibilityZoneIndex. In addition, the index is rebuilt on the next
+  /// query whenever instances have been created or deleted, also within the same tick. Note that the
+  /// index also contains instances which are not assigned to any visibility zone; the Gather*
+  /// functions check the zone assignment of each result when they are called, so instances that are
+  /// added to or removed from zones are handled without a rebuild.
+  VISION_APIFUNC VisSpatialIndexPtr GetStaticGeometryIndex();
+
+  /// \brief
+  ///   Forces the spatial indices to be checked for changes on the next query, instead of once per
+  ///   simulation tick. Call this after moving static geometry instances or changing zone
+  ///   bounding boxes if queries in the same tick need to see the change.
+  VISION_APIFUNC void InvalidateSpatialIndex();
+
+  ///
+  /// @}
+  ///
+
+
+  ///
+  /// @name Software Occluders
+  /// @{
+  ///
+
+  /// \brief
+  ///   Registers an occluder with all visibility collectors that use software occlusion culling.
+  ///
+  /// Occluders must be added and removed on the main thread. The collectors copy the list before their
+  /// visibility tasks start, so the change takes effect with the next visibility determination.
+  /// All occluders are removed when the world is deinitialized, since they usually stand in for
+  /// scene geometry of the world.
+  VISION_APIFUNC void AddSoftwareOccluder(VisSoftwareOccluder_cl *pOccluder);
+
+  /// \brief
+  ///   Removes an occluder previously registered with AddSoftwareOccluder.
+  VISION_APIFUNC void RemoveSoftwareOccluder(VisSoftwareOccluder_cl *pOccluder);
+
+  /// \brief
+  ///   Removes all registered occluders.
+  VISION_APIFUNC void RemoveAllSoftwareOccluders();
+
+  /// \brief
+  ///   Returns the collection of registered occluders.
+  inline const VRefCountedCollection<VisSoftwareOccluder_cl> &GetSoftwareOccluders() const
+  {
+    return m_SoftwareOccluders;
+  }
+
+  /// \brief
+  ///   Removes the software occluders when the world is deinitialized. Derived classes that override
+  ///   this function have to call the base implementation.
+  VISION_APIFUNC virtual void OnHandleCallback(IVisCallbackDataObject_cl *pData) HKV_OVERRIDE;
+
 protected:
 
   VisRCVisibilityZoneCollection_cl m_VisibilityZones;      ///< List of visibility zones.
@@ -385,6 +498,17 @@ protected:
   
   VisZoneRepositionInfo_t m_RepositionInfo;
   bool m_bHandleRepositioning;
+
+  VMutex m_SpatialIndexMutex;                              ///< Protects the spatial indices and the temporary arrays below
+  VisSpatialIndexPtr m_spZoneIndex;
+  VisSpatialIndexPtr m_spStaticGeometryIndex;
+  int m_iZoneIndexUpdateCount;                             ///< Update scene count of the last zone index check
+  int m_iStaticGeometryIndexUpdateCount;                   ///< Update scene count of the last static geometry index check
+  UINT_PTR m_iStaticGeometryTableHash;                     ///< Element table hash of the last static geometry index check
+  DynArray_cl<hkvAlignedBBox> m_SpatialIndexBoxes;
+  DynArray_cl<void *> m_SpatialIndexObjects;
+
+  VRefCountedCollection<VisSoftwareOccluder_cl> m_SoftwareOccluders;  ///< Occluders of the software occlusion culling
   
   ///
   /// @}
@@ -580,6 +704,63 @@ public:
     m_bPreferUnload = bUnload;
   }
 
+  /// \brief
+  ///   Sets how far ahead (in seconds) HandleZones predicts the movement of the streaming reference
+  ///   object.
+  ///
+  /// The velocity of the streaming reference object is measured every tick. A zone is treated as if
+  /// it was as close as the closest point of the predicted path, so zones ahead of a fast moving
+  /// camera are pre-cached earlier and streamed in before zones at the same distance behind it.
+  /// This reduces the number of zones that have to be loaded synchronously once the camera gets
+  /// closer than the zone's loaded distance.
+  ///
+  /// The predicted distance is used for the pre-caching and unloading decisions and for the
+  /// processing order of zones and queued snapshots. Synchronous loading always uses the actual
+  /// distance.
+  ///
+  /// \param fSeconds
+  ///   Prediction time in seconds. 0 disables the prediction. The default is 2 seconds.
+  inline void SetStreamingPredictionTime(float fSeconds)
+  {
+    m_fStreamingPredictionTime = hkvMath::Max(fSeconds, 0.f);
+  }
+
+  /// \brief
+  ///   Returns the value set via SetStreamingPredictionTime.
+  inline float GetStreamingPredictionTime() const
+  {
+    return m_fStreamingPredictionTime;
+  }
+
+  /// \brief
+  ///   Returns the smoothed velocity of the streaming reference object, as measured by HandleZones.
+  inline const hkvVec3& GetStreamingVelocity() const
+  {
+    return m_vStreamingVelocity;
+  }
+
+  /// \brief
+  ///   Configures how the files of queued snapshots are read ahead in background threads.
+  ///
+  /// A snapshot in the queue reads one file at a time and creates the resource from it before it
+  /// requests the next file. HandleZones therefore pre-caches the upcoming files of all queued
+  /// snapshots (in queue order, i.e. by priority) through VMemoryStreamManager::PrecacheFile,
+  /// so that several file reads are in flight and the snapshots find their files in memory.
+  /// Resource creation and the GPU upload of the cached data still happen on the main thread
+  /// within the streaming time budget.
+  ///
+  /// \param iMaxTasks
+  ///   Maximum number of concurrent file reads. 0 disables read-ahead. The default is 4.
+  ///
+  /// \param iMaxBytes
+  ///   Maximum size (in bytes, based on the file sizes stored in the snapshots) of the read-ahead
+  ///   files which have not been consumed by their snapshots yet. The default is 32MB.
+  inline void SetStreamingReadAhead(int iMaxTasks, int iMaxBytes)
+  {
+    m_iMaxReadAheadTasks = iMaxTasks;
+    m_iMaxReadAheadBytes = iMaxBytes;
+  }
+
 
   /// \brief
   ///   Helper function that purges/unloads unused resources while sticking to the passed time limit
@@ -599,7 +780,13 @@ public:
   ///   Internal function
   VISION_APIFUNC void HandleFullResLoadingQueue();
 
+  /// \brief
+  ///   Internal function, see SetStreamingReadAhead
+  VISION_APIFUNC void HandleReadAheadQueue();
+
 protected:
+  void UpdateStreamingVelocity(const hkvVec3 &vRefPos, float fTimeDelta);
+
   bool m_bAnyZoneUnloaded, m_bAnyZoneCaching;
   bool m_bPreferUnload;
 
@@ -610,6 +797,18 @@ protected:
   float m_fStreamingTimeBudget;
   int m_iLastManagerIndex;
 
+  // movement prediction of the streaming reference object
+  hkvVec3 m_vLastStreamingPos;
+  hkvVec3 m_vStreamingVelocity;
+  bool m_bLastStreamingPosValid;
+  float m_fStreamingPredictionTime;
+
+  // background read-ahead of snapshot files
+  VRefCountedCollection<VLoadingTask> m_ReadAheadTasks;
+  VMapPtrToInt m_ReadAheadTaskIndex; ///< index of each task in m_ReadAheadTasks
+  int m_iMaxReadAheadTasks;
+  int m_iMaxReadAheadBytes;
+
   ///
   /// @}
   ///
@@ -0,0 +1,332 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/Engine/Engine.hpp>
+#include <Vision/Runtime/Engine/SceneManagement/VisionSpatialIndex.hpp>
+
+
+// Partially sorts pOrder so that the element at iNth is the one that would be there if the array
+// was sorted by the center coordinate along iAxis, with all smaller ones before it.
+static void SelectNth(int *pOrder, int iCount, int iNth, const hkvVec3 *pCenters, int iAxis)
+{
+  int iLeft = 0;
+  int iRight = iCount-1;
+  while (iRight > iLeft)
+  {
+    const float fPivot = pCenters[pOrder[(iLeft+iRight)/2]].data[iAxis];
+    int i = iLeft;
+    int j = iRight;
+    while (i <= j)
+    {
+      while (pCenters[pOrder[i]].data[iAxis] < fPivot) i++;
+      while (pCenters[pOrder[j]].data[iAxis] > fPivot) j--;
+      if (i <= j)
+      {
+        hkvMath::swap(pOrder[i], pOrder[j]);
+        i++;
+        j--;
+      }
+    }
+    if (iNth <= j)
+      iRight = j;
+    else if (iNth >= i)
+      iLeft = i;
+    else
+      break; // everything between j and i equals the pivot
+  }
+}
+
+
+struct VisSpatialIndexBoxTest_t
+{
+  VisSpatialIndexBoxTest_t(const hkvAlignedBBox &bbox) : m_Box(bbox) {}
+  inline bool operator()(const hkvAlignedBBox &box) const { return box.overlaps(m_Box); }
+  const hkvAlignedBBox &m_Box;
+};
+
+struct VisSpatialIndexSphereTest_t
+{
+  VisSpatialIndexSphereTest_t(const hkvBoundingSphere &sphere) : m_Sphere(sphere) {}
+  inline bool operator()(const hkvAlignedBBox &box) const { return box.overlaps(m_Sphere); }
+  const hkvBoundingSphere &m_Sphere;
+};
+
+// Slab test of a line segment against a box, with the inverse direction computed only once
+struct VisSpatialIndexSegmentTest_t
+{
+  VisSpatialIndexSegmentTest_t(const hkvVec3 &vStart, const hkvVec3 &vEnd) : m_vStart(vStart)
+  {
+    const hkvVec3 vDir = vEnd - vStart;
+    for (int i=0; i<3; i++)
+    {
+      m_bParallel[i] = (vDir.data[i] == 0.f);
+      m_vInvDir.data[i] = m_bParallel[i] ? 0.f : 1.f / vDir.data[i];
+    }
+  }
+
+  inline bool operator()(const hkvAlignedBBox &box) const
+  {
+    float fMin = 0.f;
+    float fMax = 1.f;
+    for (int i=0; i<3; i++)
+    {
+      if (m_bParallel[i])
+      {
+        if (m_vStart.data[i] < box.m_vMin.data[i] || m_vStart.data[i] > box.m_vMax.data[i])
+          return false;
+        continue;
+      }
+      float t0 = (box.m_vMin.data[i] - m_vStart.data[i]) * m_vInvDir.data[i];
+      float t1 = (box.m_vMax.data[i] - m_vStart.data[i]) * m_vInvDir.data[i];
+      if (t0 > t1)
+        hkvMath::swap(t0, t1);
+      fMin = hkvMath::Max(fMin, t0);
+      fMax = hkvMath::Min(fMax, t1);
+      if (fMin > fMax)
+        return false;
+    }
+    return true;
+  }
+
+  hkvVec3 m_vStart;
+  hkvVec3 m_vInvDir;
+  bool m_bParallel[3];
+};
+
+
+// Appends the found objects to a render collection
+struct VisSpatialIndexCollectionOutput_t
+{
+  VisSpatialIndexCollectionOutput_t(VisRenderCollection_cl &destList) : m_DestList(destList) {}
+  inline bool Add(void *pObject) { m_DestList.AppendEntry(pObject); return true; }
+  VisRenderCollection_cl &m_DestList;
+};
+
+// Writes the found objects to a fixed size array and stops the query when it is full
+struct VisSpatialIndexArrayOutput_t
+{
+  VisSpatialIndexArrayOutput_t(void **ppObjects, int iMaxObjects) : m_ppObjects(ppObjects), m_iCount(0), m_iMaxObjects(iMaxObjects) {}
+  inline bool Add(void *pObject) { m_ppObjects[m_iCount++] = pObject; return m_iCount < m_iMaxObjects; }
+  void **m_ppObjects;
+  int m_iCount;
+  int m_iMaxObjects;
+};
+
+
+VisSpatialIndex_cl::VisSpatialIndex_cl() : m_Boxes(0), m_Objects(0, NULL), m_Order(0, -1)
+{
+  m_iObjectCount = 0;
+  m_iNodeCount = 0;
+}
+
+VisSpatialIndex_cl::~VisSpatialIndex_cl()
+{
+}
+
+void VisSpatialIndex_cl::Build(int iCount, const hkvAlignedBBox *pBoxes, void * const *ppObjects)
+{
+  m_iObjectCount = iCount;
+  m_iNodeCount = 0;
+  m_Boxes.EnsureSize(iCount);
+  m_Objects.EnsureSize(iCount);
+  m_Order.EnsureSize(iCount);
+
+  // only objects with a valid box go into the tree
+  DynArray_cl<hkvVec3> centers(iCount);
+  hkvAlignedBBox *pDestBoxes = m_Boxes.GetDataPtr();
+  void **ppDestObjects = m_Objects.GetDataPtr();
+  int *pOrder = m_Order.GetDataPtr();
+  int iValidCount = 0;
+  for (int i=0; i<iCount; i++)
+  {
+    pDestBoxes[i] = pBoxes[i];
+    ppDestObjects[i] = ppObjects[i];
+    if (!pBoxes[i].isValid())
+      continue;
+    centers.GetDataPtr()[i] = pBoxes[i].getCenter();
+    pOrder[iValidCount++] = i;
+  }
+
+  if (iValidCount == 0)
+    return;
+
+  // a tree with leaves of at least VIS_SPATIALINDEX_LEAF_SIZE/2 objects has less than iValidCount nodes
+  m_Nodes.EnsureSize(hkvMath::Max(iValidCount, 1) * 2);
+  BuildNode(0, iValidCount, centers.GetDataPtr());
+}
+
+int VisSpatialIndex_cl::BuildNode(int iFirst, int iCount, const hkvVec3 *pCenters)
+{
+  const int iNode = m_iNodeCount++;
+  const hkvAlignedBBox *pBoxes = m_Boxes.GetDataPtr();
+  int *pOrder = m_Order.GetDataPtr() + iFirst;
+
+  hkvAlignedBBox box, centerBox;
+  box.setInvalid();
+  centerBox.setInvalid();
+  for (int i=0; i<iCount; i++)
+  {
+    box.expandToInclude(pBoxes[pOrder[i]]);
+    centerBox.expandToInclude(pCenters[pOrder[i]]);
+  }
+
+  m_Nodes.GetDataPtr()[iNode].m_Box = box;
+  if (iCount <= VIS_SPATIALINDEX_LEAF_SIZE)
+  {
+    m_Nodes.GetDataPtr()[iNode].m_iFirst = iFirst;
+    m_Nodes.GetDataPtr()[iNode].m_iCount = iCount;
+    return iNode;
+  }
+
+  // split at the median of the longest axis, which keeps the tree balanced
+  hkUint32 iAxis = 0;
+  centerBox.getMaxExtent(&iAxis);
+  const int iHalf = iCount / 2;
+  SelectNth(pOrder, iCount, iHalf, pCenters, (int)iAxis);
+
+  BuildNode(iFirst, iHalf, pCenters);
+  const int iSecond = BuildNode(iFirst + iHalf, iCount - iHalf, pCenters);
+  m_Nodes.GetDataPtr()[iNode].m_iFirst = iSecond;
+  m_Nodes.GetDataPtr()[iNode].m_iCount = 0;
+  return iNode;
+}
+
+bool VisSpatialIndex_cl::Refit(const hkvAlignedBBox *pBoxes)
+{
+  hkvAlignedBBox *pDestBoxes = m_Boxes.GetDataPtr();
+  for (int i=0; i<m_iObjectCount; i++)
+    if (pBoxes[i].isValid() != pDestBoxes[i].isValid())
+      return false;
+  for (int i=0; i<m_iObjectCount; i++)
+    pDestBoxes[i] = pBoxes[i];
+
+  // children always have higher indices than their parent, so a reverse loop visits them first
+  Node_t *pNodes = m_Nodes.GetDataPtr();
+  const int *pOrder = m_Order.GetDataPtr();
+  for (int iNode=m_iNodeCount-1; iNode>=0; iNode--)
+  {
+    Node_t &node = pNodes[iNode];
+    if (node.m_iCount > 0)
+    {
+      node.m_Box.setInvalid();
+      for (int i=0; i<node.m_iCount; i++)
+        node.m_Box.expandToInclude(pDestBoxes[pOrder[node.m_iFirst + i]]);
+    }
+    else
+    {
+      node.m_Box = pNodes[iNode + 1].m_Box;
+      node.m_Box.expandToInclude(pNodes[node.m_iFirst].m_Box);
+    }
+  }
+  return true;
+}
+
+void VisSpatialIndex_cl::CopyFrom(const VisSpatialIndex_cl &other)
+{
+  m_iObjectCount = other.m_iObjectCount;
+  m_iNodeCount = other.m_iNodeCount;
+  m_Boxes = other.m_Boxes;
+  m_Objects = other.m_Objects;
+  m_Order = other.m_Order;
+  m_Nodes = other.m_Nodes;
+}
+
+hkvAlignedBBox VisSpatialIndex_cl::GetBoundingBox() const
+{
+  if (m_iNodeCount == 0)
+  {
+    hkvAlignedBBox box;
+    box.setInvalid();
+    return box;
+  }
+  return m_Nodes.GetDataPtr()[0].m_Box;
+}
+
+template<class TEST, class OUTPUT> int VisSpatialIndex_cl::Find(const TEST &test, OUTPUT &output) const
+{
+  if (m_iNodeCount == 0)
+    return 0;
+
+  const Node_t *pNodes = m_Nodes.GetDataPtr();
+  const hkvAlignedBBox *pBoxes = m_Boxes.GetDataPtr();
+  void * const *ppObjects = m_Objects.GetDataPtr();
+  const int *pOrder = m_Order.GetDataPtr();
+
+  int iStack[VIS_SPATIALINDEX_MAX_DEPTH];
+  int iStackSize = 0;
+  int iNode = 0;
+  int iFound = 0;
+  for (;;)
+  {
+    const Node_t &node = pNodes[iNode];
+    if (test(node.m_Box))
+    {
+      if (node.m_iCount == 0)
+      {
+        VASSERT(iStackSize < VIS_SPATIALINDEX_MAX_DEPTH);
+        iStack[iStackSize++] = node.m_iFirst;
+        iNode++;
+        continue;
+      }
+      for (int i=0; i<node.m_iCount; i++)
+      {
+        const int iObject = pOrder[node.m_iFirst + i];
+        if (node.m_iCount > 1 && !test(pBoxes[iObject]))
+          continue;
+        iFound++;
+        if (!output.Add(ppObjects[iObject]))
+          return iFound;
+      }
+    }
+    if (iStackSize == 0)
+      break;
+    iNode = iStack[--iStackSize];
+  }
+  return iFound;
+}
+
+int VisSpatialIndex_cl::FindInBoundingBox(const hkvAlignedBBox &bbox, VisRenderCollection_cl &destList) const
+{
+  VisSpatialIndexCollectionOutput_t output(destList);
+  return Find(VisSpatialIndexBoxTest_t(bbox), output);
+}
+
+int VisSpatialIndex_cl::FindInBoundingBox(const hkvAlignedBBox &bbox, void **ppObjects, int iMaxObjects) const
+{
+  if (iMaxObjects <= 0)
+    return 0;
+  VisSpatialIndexArrayOutput_t output(ppObjects, iMaxObjects);
+  return Find(VisSpatialIndexBoxTest_t(bbox), output);
+}
+
+int VisSpatialIndex_cl::FindInSphere(const hkvBoundingSphere &sphere, VisRenderCollection_cl &destList) const
+{
+  VisSpatialIndexCollectionOutput_t output(destList);
+  return Find(VisSpatialIndexSphereTest_t(sphere), output);
+}
+
+int VisSpatialIndex_cl::FindAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisRenderCollection_cl &destList) const
+{
+  VisSpatialIndexCollectionOutput_t output(destList);
+  return Find(VisSpatialIndexSegmentTest_t(vStart, vEnd), output);
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
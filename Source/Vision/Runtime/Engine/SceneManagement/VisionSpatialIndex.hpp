@@ -0,0 +1,170 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file VisionSpatialIndex.hpp
+
+#ifndef DEFINE_VISIONSPATIALINDEX
+#define DEFINE_VISIONSPATIALINDEX
+
+class VisRenderCollection_cl;
+
+/// \brief
+///   Maximum depth of a VisSpatialIndex_cl tree. Trees are balanced, so this is sufficient for any
+///   number of objects.
+#define VIS_SPATIALINDEX_MAX_DEPTH  64
+
+/// \brief
+///   Number of objects up to which a node of a VisSpatialIndex_cl is not split any further.
+#define VIS_SPATIALINDEX_LEAF_SIZE  4
+
+
+/// \brief
+///   Bounding volume hierarchy over a set of objects with axis aligned bounding boxes.
+///
+/// The index stores a bounding box and a user pointer per object and answers box, sphere and line
+/// segment queries by visiting only the tree nodes overlapping the query shape. Results are
+/// appended to a render collection, so there is no limit on the number of results.
+///
+/// The tree is built once with Build. If the object boxes change but the set of objects stays the
+/// same, Refit updates the node boxes in linear time without rebuilding the tree.
+///
+/// Queries are read-only and may be performed from multiple threads at the same time, as long as
+/// no thread modifies the index meanwhile. IVisSceneManager_cl therefore never modifies an index
+/// which has been handed out; it builds a new one and keeps the old one alive until the last
+/// reference is released.
+class VisSpatialIndex_cl : public VRefCounter
+{
+public:
+
+  /// \brief
+  ///   Constructor. The index is empty until Build is called.
+  VISION_APIFUNC VisSpatialIndex_cl();
+
+  /// \brief
+  ///   Destructor
+  VISION_APIFUNC virtual ~VisSpatialIndex_cl();
+
+  /// \brief
+  ///   Builds the tree.
+  ///
+  /// \param iCount
+  ///   Number of objects.
+  ///
+  /// \param pBoxes
+  ///   Bounding box of each object. Invalid boxes are allowed; such objects are never returned.
+  ///
+  /// \param ppObjects
+  ///   User pointer of each object, returned by the queries.
+  VISION_APIFUNC void Build(int iCount, const hkvAlignedBBox *pBoxes, void * const *ppObjects);
+
+  /// \brief
+  ///   Replaces the bounding boxes of all objects and updates the node boxes, keeping the tree
+  ///   structure. pBoxes uses the same order as the array passed to Build.
+  ///
+  /// Refitting is fast but the tree gets less efficient if the objects move far. Boxes that
+  /// change between valid and invalid cannot be refitted.
+  ///
+  /// \return
+  ///   false if the index could not be refitted and has to be rebuilt. The index is not modified
+  ///   in that case.
+  VISION_APIFUNC bool Refit(const hkvAlignedBBox *pBoxes);
+
+  /// \brief
+  ///   Copies the tree and the objects of another index.
+  VISION_APIFUNC void CopyFrom(const VisSpatialIndex_cl &other);
+
+  /// \brief
+  ///   Returns the number of objects, in the order passed to Build.
+  inline int GetObjectCount() const { return m_iObjectCount; }
+
+  /// \brief
+  ///   Returns the user pointer of an object.
+  inline void *GetObject(int iIndex) const { VASSERT(iIndex>=0 && iIndex<m_iObjectCount); return m_Objects.GetDataPtr()[iIndex]; }
+
+  /// \brief
+  ///   Returns the bounding box of an object.
+  inline const hkvAlignedBBox &GetObjectBoundingBox(int iIndex) const { VASSERT(iIndex>=0 && iIndex<m_iObjectCount); return m_Boxes.GetDataPtr()[iIndex]; }
+
+  /// \brief
+  ///   Returns the box enclosing all objects (invalid if the index is empty).
+  VISION_APIFUNC hkvAlignedBBox GetBoundingBox() const;
+
+  /// \brief
+  ///   Appends all objects whose bounding box overlaps the passed box to destList.
+  ///
+  /// \return
+  ///   the number of appended objects.
+  VISION_APIFUNC int FindInBoundingBox(const hkvAlignedBBox &bbox, VisRenderCollection_cl &destList) const;
+
+  /// \brief
+  ///   Writes the objects whose bounding box overlaps the passed box to a fixed size array.
+  ///
+  /// This version does not allocate any memory and is meant for frequent queries which typically
+  /// return only very few objects.
+  ///
+  /// \return
+  ///   the number of objects written to ppObjects, at most iMaxObjects. If the result equals
+  ///   iMaxObjects, more objects may overlap the box.
+  VISION_APIFUNC int FindInBoundingBox(const hkvAlignedBBox &bbox, void **ppObjects, int iMaxObjects) const;
+
+  /// \brief
+  ///   Appends all objects whose bounding box overlaps the passed sphere to destList.
+  ///
+  /// \return
+  ///   the number of appended objects.
+  VISION_APIFUNC int FindInSphere(const hkvBoundingSphere &sphere, VisRenderCollection_cl &destList) const;
+
+  /// \brief
+  ///   Appends all objects whose bounding box is intersected by the line segment from vStart to
+  ///   vEnd (or contains it) to destList.
+  ///
+  /// \return
+  ///   the number of appended objects.
+  VISION_APIFUNC int FindAlongLineSegment(const hkvVec3 &vStart, const hkvVec3 &vEnd, VisRenderCollection_cl &destList) const;
+
+protected:
+  /// \brief
+  ///   Tree node. Inner nodes have m_iCount==0; their first child directly follows the node and
+  ///   m_iFirst is the index of the second child. Leaves reference m_iCount entries of m_Order,
+  ///   starting at m_iFirst.
+  struct Node_t
+  {
+    hkvAlignedBBox m_Box;
+    int m_iFirst;
+    int m_iCount;
+  };
+
+  int BuildNode(int iFirst, int iCount, const hkvVec3 *pCenters);
+  template<class TEST, class OUTPUT> int Find(const TEST &test, OUTPUT &output) const;
+
+  int m_iObjectCount;
+  int m_iNodeCount;
+  DynArray_cl<hkvAlignedBBox> m_Boxes;  ///< object boxes, in the order passed to Build
+  DynArray_cl<void *> m_Objects;        ///< user pointers, in the order passed to Build
+  DynArray_cl<int> m_Order;             ///< object indices, sorted by leaf
+  DynArray_cl<Node_t> m_Nodes;
+};
+
+typedef VSmartPtr<VisSpatialIndex_cl> VisSpatialIndexPtr;
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -367,6 +367,19 @@ public:
   ///   Optimized function that removes all static geometry instances from the visibility zone that are currently tagged
   VISION_APIFUNC void RemoveTaggedGeometryInstances();
 
+  /// \brief
+  ///   Notifies the zone that the bounding box of one of its static geometry instances has changed
+  ///
+  /// Visibility collectors keep packed copies of the static geometry bounding boxes of each zone (see
+  /// VisionVisibilityCollector_cl::SetUsePackedBounds). They are rebuilt automatically when instances are
+  /// added or removed, but code that changes the box of an instance which is already assigned to the zone
+  /// has to call this function, so that the boxes of this zone are packed again.
+  inline void OnStaticGeometryBoundsChanged() { m_StaticGeometryBoundsRevision.m_iValue++; }
+
+  /// \brief
+  ///   Returns a counter that is incremented by OnStaticGeometryBoundsChanged
+  inline unsigned int GetStaticGeometryBoundsRevision() const { return m_StaticGeometryBoundsRevision.m_iValue; }
+
   ///
   /// @}
   ///
@@ -554,6 +567,14 @@ protected:
 
   VisOcclusionQueryObjectVisZone_cl m_OccQueryObject;
 
+  // zero-initialized by its own constructor, so the zone constructors do not need to be changed
+  struct RevisionCounter_t
+  {
+    RevisionCounter_t() : m_iValue(0) {}
+    unsigned int m_iValue;
+  };
+  RevisionCounter_t m_StaticGeometryBoundsRevision; ///< See OnStaticGeometryBoundsChanged
+
   ///
   /// @}
   ///
@@ -0,0 +1,415 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/Engine/Engine.hpp>
+#include <Vision/Runtime/Engine/Visibility/VisionSoftwareOcclusion.hpp>
+
+// Relative amount by which the nearest depth of a tested box is moved towards the viewer, so that
+// boxes lying directly on an occluder surface are not culled because of rounding errors.
+#define VIS_SOFTWAREOCCLUSION_DEPTHBIAS   0.001f
+
+// The hierarchical test starts at the finest pyramid level in which a tested box covers at most
+// this many texels in each direction.
+#define VIS_SOFTWAREOCCLUSION_MAXTESTTEXELS  4
+
+
+VisSoftwareOccluder_cl::VisSoftwareOccluder_cl() : m_Vertices(0), m_Indices(0), m_iNumTriangles(0)
+{
+}
+
+VisSoftwareOccluder_cl::~VisSoftwareOccluder_cl()
+{
+}
+
+void VisSoftwareOccluder_cl::SetGeometry(int iNumVertices, const hkvVec3 *pVertices, int iNumTriangles, const void *pIndices, int iIndexType, const hkvMat4 &transform)
+{
+  VASSERT(iNumVertices >= 0 && iNumTriangles >= 0);
+  VASSERT(pIndices != NULL || iNumTriangles*3 <= iNumVertices);
+  VASSERT(iIndexType == VIS_INDEXFORMAT_16 || iIndexType == VIS_INDEXFORMAT_32);
+
+  m_iNumTriangles = 0;
+  m_BoundingBox.setInvalid();
+  m_Vertices.Resize(iNumVertices);
+  m_Indices.Resize(iNumTriangles*3);
+
+  for (int i=0; i<iNumVertices; i++)
+  {
+    m_Vertices[i] = transform.transformPosition(pVertices[i]);
+    m_BoundingBox.expandToInclude(m_Vertices[i]);
+  }
+
+  const unsigned short *pIndices16 = (const unsigned short *)pIndices;
+  const unsigned int *pIndices32 = (const unsigned int *)pIndices;
+  int *pDest = m_Indices.GetDataPtr();
+  for (int i=0; i<iNumTriangles*3; i++)
+  {
+    if (pIndices == NULL)
+      pDest[i] = i;
+    else if (iIndexType == VIS_INDEXFORMAT_32)
+      pDest[i] = (int)pIndices32[i];
+    else
+      pDest[i] = (int)pIndices16[i];
+    VASSERT(pDest[i] < iNumVertices);
+  }
+  m_iNumTriangles = iNumTriangles;
+}
+
+bool VisSoftwareOccluder_cl::SetGeometryFromMesh(VBaseMesh *pMesh, const hkvMat4 &transform)
+{
+  if (pMesh == NULL)
+    return false;
+
+  pMesh->EnsureLoaded();
+  if (!pMesh->IsLoaded())
+    return false;
+
+  IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
+  if (pColMesh == NULL)
+    return false;
+
+  hkvVec3 *pVertexList = NULL;
+  void *pIndexList = NULL;
+  int iIndexType;
+  const int iVertexCount = pColMesh->GetVertexList(pVertexList);
+  const int iIndexCount = pColMesh->GetIndexList(pIndexList, iIndexType);
+  if (iVertexCount == 0 || iIndexCount < 3)
+    return false;
+
+  SetGeometry(iVertexCount, pVertexList, iIndexCount/3, pIndexList, iIndexType, transform);
+  return true;
+}
+
+// *******************************************************************************
+// *  Depth buffer
+// *******************************************************************************
+
+VisSoftwareOcclusionBuffer_cl::VisSoftwareOcclusionBuffer_cl(int iWidth, int iHeight)
+{
+  m_iWidth = m_iHeight = 0;
+  m_iNumLevels = 0;
+  m_bOrthographic = false;
+  m_fNearClip = 1.f;
+  m_fScaleX = m_fScaleY = 1.f;
+  m_iRasterizedTriangles = 0;
+  SetResolution(iWidth, iHeight);
+}
+
+VisSoftwareOcclusionBuffer_cl::~VisSoftwareOcclusionBuffer_cl()
+{
+}
+
+void VisSoftwareOcclusionBuffer_cl::SetResolution(int iWidth, int iHeight)
+{
+  VASSERT(iWidth > 0 && iHeight > 0);
+  m_iWidth = iWidth;
+  m_iHeight = iHeight;
+
+  // Each level halves the resolution (rounding up) down to a single texel
+  m_iNumLevels = 0;
+  while (m_iNumLevels < VIS_SOFTWAREOCCLUSION_MAX_LEVELS)
+  {
+    m_iLevelWidth[m_iNumLevels] = iWidth;
+    m_iLevelHeight[m_iNumLevels] = iHeight;
+    m_Levels[m_iNumLevels].Resize(iWidth*iHeight);
+    m_iNumLevels++;
+    if (iWidth == 1 && iHeight == 1)
+      break;
+    iWidth = (iWidth + 1) / 2;
+    iHeight = (iHeight + 1) / 2;
+  }
+  for (int i=m_iNumLevels; i<VIS_SOFTWAREOCCLUSION_MAX_LEVELS; i++)
+    m_Levels[i].Reset();
+}
+
+void VisSoftwareOcclusionBuffer_cl::BeginFrameInternal(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fNearClip)
+{
+  VASSERT(fNearClip > 0.f);
+  m_vPos = vPos;
+  m_vDir = mOrientation.getAxis(0);
+  m_vRight = mOrientation.getAxis(1);
+  m_vUp = mOrientation.getAxis(2);
+  m_fNearClip = fNearClip;
+  m_iRasterizedTriangles = 0;
+
+  float *pDepth = m_Levels[0].GetDataPtr();
+  const int iCount = m_iWidth * m_iHeight;
+  for (int i=0; i<iCount; i++)
+    pDepth[i] = -FLT_MAX;
+}
+
+void VisSoftwareOcclusionBuffer_cl::BeginFrame(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fFovX, float fFovY, float fNearClip)
+{
+  BeginFrameInternal(vPos, mOrientation, fNearClip);
+  m_bOrthographic = false;
+  m_fScaleX = (float)m_iWidth * 0.5f / hkvMath::tanRad(fFovX * hkvMath::pi() / 360.f);
+  m_fScaleY = (float)m_iHeight * 0.5f / hkvMath::tanRad(fFovY * hkvMath::pi() / 360.f);
+}
+
+void VisSoftwareOcclusionBuffer_cl::BeginFrameOrthographic(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fSizeX, float fSizeY, float fNearClip)
+{
+  VASSERT(fSizeX > 0.f && fSizeY > 0.f);
+  BeginFrameInternal(vPos, mOrientation, fNearClip);
+  m_bOrthographic = true;
+  m_fScaleX = (float)m_iWidth / fSizeX;
+  m_fScaleY = (float)m_iHeight / fSizeY;
+}
+
+inline void VisSoftwareOcclusionBuffer_cl::ToViewSpace(const hkvVec3 &vWorld, hkvVec3 &vView) const
+{
+  const hkvVec3 vDiff = vWorld - m_vPos;
+  vView.set(vDiff.dot(m_vRight), vDiff.dot(m_vUp), vDiff.dot(m_vDir));
+}
+
+// Inverse depth is linear in screen space for perspective projections (and view space depth is
+// linear for orthographic ones), so it can be interpolated with screen space barycentrics.
+inline float VisSoftwareOcclusionBuffer_cl::GetNearness(float fViewDepth) const
+{
+  return m_bOrthographic ? -fViewDepth : 1.f / fViewDepth;
+}
+
+void VisSoftwareOcclusionBuffer_cl::RasterizeOccluder(const VisSoftwareOccluder_cl *pOccluder)
+{
+  VASSERT(pOccluder != NULL);
+  const hkvVec3 *pVertices = pOccluder->GetVertices();
+  const int *pIndices = pOccluder->GetIndices();
+  const int iNumTriangles = pOccluder->GetTriangleCount();
+  for (int i=0; i<iNumTriangles; i++, pIndices+=3)
+    RasterizeTriangle(pVertices[pIndices[0]], pVertices[pIndices[1]], pVertices[pIndices[2]]);
+}
+
+void VisSoftwareOcclusionBuffer_cl::RasterizeTriangle(const hkvVec3 &v0, const hkvVec3 &v1, const hkvVec3 &v2)
+{
+  hkvVec3 vView[3];
+  ToViewSpace(v0, vView[0]);
+  ToViewSpace(v1, vView[1]);
+  ToViewSpace(v2, vView[2]);
+
+  const bool bInside0 = vView[0].z >= m_fNearClip;
+  const bool bInside1 = vView[1].z >= m_fNearClip;
+  const bool bInside2 = vView[2].z >= m_fNearClip;
+  if (!bInside0 && !bInside1 && !bInside2)
+    return;
+  if (bInside0 && bInside1 && bInside2)
+  {
+    RasterizeClippedTriangle(vView);
+    return;
+  }
+
+  // Clip against the near plane; the result has at most four vertices and is rasterized as a fan
+  hkvVec3 vClipped[4];
+  int iNumClipped = 0;
+  for (int i=0; i<3; i++)
+  {
+    const hkvVec3 &vA = vView[i];
+    const hkvVec3 &vB = vView[(i+1)%3];
+    const bool bInsideA = vA.z >= m_fNearClip;
+    const bool bInsideB = vB.z >= m_fNearClip;
+    if (bInsideA)
+      vClipped[iNumClipped++] = vA;
+    if (bInsideA != bInsideB)
+    {
+      const float t = (m_fNearClip - vA.z) / (vB.z - vA.z);
+      vClipped[iNumClipped] = vA + (vB - vA) * t;
+      vClipped[iNumClipped].z = m_fNearClip;
+      iNumClipped++;
+    }
+  }
+
+  VASSERT(iNumClipped == 3 || iNumClipped == 4);
+  RasterizeClippedTriangle(vClipped);
+  if (iNumClipped == 4)
+  {
+    vClipped[1] = vClipped[0];
+    RasterizeClippedTriangle(&vClipped[1]);
+  }
+}
+
+void VisSoftwareOcclusionBuffer_cl::RasterizeClippedTriangle(const hkvVec3 *pView)
+{
+  // Project to pixel coordinates, y pointing down
+  const float fCenterX = (float)m_iWidth * 0.5f;
+  const float fCenterY = (float)m_iHeight * 0.5f;
+  float x[3], y[3], n[3];
+  for (int i=0; i<3; i++)
+  {
+    const float fInvZ = m_bOrthographic ? 1.f : 1.f / pView[i].z;
+    x[i] = fCenterX + pView[i].x * fInvZ * m_fScaleX;
+    y[i] = fCenterY - pView[i].y * fInvZ * m_fScaleY;
+    n[i] = GetNearness(pView[i].z);
+  }
+
+  // Two-sided: flip the winding of clockwise triangles instead of culling them
+  float fArea = (x[1]-x[0])*(y[2]-y[0]) - (x[2]-x[0])*(y[1]-y[0]);
+  if (fArea < 0.f)
+  {
+    hkvMath::swap(x[1], x[2]);
+    hkvMath::swap(y[1], y[2]);
+    hkvMath::swap(n[1], n[2]);
+    fArea = -fArea;
+  }
+  if (fArea < 1e-8f)
+    return;
+
+  // Pixels whose centers may be covered
+  const int iMinX = hkvMath::Max((int)hkvMath::floor(hkvMath::Min(x[0], hkvMath::Min(x[1], x[2])) - 0.5f), 0);
+  const int iMaxX = hkvMath::Min((int)hkvMath::ceil(hkvMath::Max(x[0], hkvMath::Max(x[1], x[2])) - 0.5f), m_iWidth - 1);
+  const int iMinY = hkvMath::Max((int)hkvMath::floor(hkvMath::Min(y[0], hkvMath::Min(y[1], y[2])) - 0.5f), 0);
+  const int iMaxY = hkvMath::Min((int)hkvMath::ceil(hkvMath::Max(y[0], hkvMath::Max(y[1], y[2])) - 0.5f), m_iHeight - 1);
+  if (iMinX > iMaxX || iMinY > iMaxY)
+    return;
+
+  m_iRasterizedTriangles++;
+
+  // Edge functions: e_i(px,py) is the doubled area of the triangle opposite to vertex i, so the
+  // barycentric weight of vertex i is e_i/fArea. They are stepped incrementally per pixel.
+  float fStepX[3], fStepY[3], fRow[3];
+  const float fStartX = (float)iMinX + 0.5f;
+  const float fStartY = (float)iMinY + 0.5f;
+  for (int i=0; i<3; i++)
+  {
+    const int a = (i+1)%3, b = (i+2)%3;
+    fStepX[i] = y[a] - y[b];
+    fStepY[i] = x[b] - x[a];
+    fRow[i] = (x[b]-x[a])*(fStartY-y[a]) - (y[b]-y[a])*(fStartX-x[a]);
+  }
+
+  const float fInvArea = 1.f / fArea;
+  float *pRow = m_Levels[0].GetDataPtr() + iMinY*m_iWidth;
+  for (int py=iMinY; py<=iMaxY; py++, pRow+=m_iWidth)
+  {
+    float e0 = fRow[0], e1 = fRow[1], e2 = fRow[2];
+    for (int px=iMinX; px<=iMaxX; px++)
+    {
+      if (e0 >= 0.f && e1 >= 0.f && e2 >= 0.f)
+      {
+        const float fNearness = (e0*n[0] + e1*n[1] + e2*n[2]) * fInvArea;
+        if (fNearness > pRow[px])
+          pRow[px] = fNearness;
+      }
+      e0 += fStepX[0]; e1 += fStepX[1]; e2 += fStepX[2];
+    }
+    fRow[0] += fStepY[0]; fRow[1] += fStepY[1]; fRow[2] += fStepY[2];
+  }
+}
+
+void VisSoftwareOcclusionBuffer_cl::EndFrame()
+{
+  // Each texel of a coarser level stores the farthest (smallest) nearness of the texels it covers
+  for (int iLevel=1; iLevel<m_iNumLevels; iLevel++)
+  {
+    const int iSrcWidth = m_iLevelWidth[iLevel-1];
+    const int iSrcHeight = m_iLevelHeight[iLevel-1];
+    const int iWidth = m_iLevelWidth[iLevel];
+    const int iHeight = m_iLevelHeight[iLevel];
+    const float *pSrc = m_Levels[iLevel-1].GetDataPtr();
+    float *pDest = m_Levels[iLevel].GetDataPtr();
+
+    for (int y=0; y<iHeight; y++)
+    {
+      const int y0 = y*2;
+      const int y1 = hkvMath::Min(y0+1, iSrcHeight-1);
+      for (int x=0; x<iWidth; x++)
+      {
+        const int x0 = x*2;
+        const int x1 = hkvMath::Min(x0+1, iSrcWidth-1);
+        const float f0 = hkvMath::Min(pSrc[y0*iSrcWidth+x0], pSrc[y0*iSrcWidth+x1]);
+        const float f1 = hkvMath::Min(pSrc[y1*iSrcWidth+x0], pSrc[y1*iSrcWidth+x1]);
+        pDest[y*iWidth+x] = hkvMath::Min(f0, f1);
+      }
+    }
+  }
+}
+
+bool VisSoftwareOcclusionBuffer_cl::IsOccluded(const hkvAlignedBBox &box) const
+{
+  const float fCenterX = (float)m_iWidth * 0.5f;
+  const float fCenterY = (float)m_iHeight * 0.5f;
+  float fMinX = FLT_MAX, fMaxX = -FLT_MAX;
+  float fMinY = FLT_MAX, fMaxY = -FLT_MAX;
+  float fMinZ = FLT_MAX;
+
+  for (int i=0; i<8; i++)
+  {
+    const hkvVec3 vCorner((i&1) ? box.m_vMax.x : box.m_vMin.x, (i&2) ? box.m_vMax.y : box.m_vMin.y, (i&4) ? box.m_vMax.z : box.m_vMin.z);
+    hkvVec3 vView(hkvNoInitialization);
+    ToViewSpace(vCorner, vView);
+
+    // Boxes intersecting the near plane can't be tested against the projected depth buffer
+    if (vView.z < m_fNearClip)
+      return false;
+
+    const float fInvZ = m_bOrthographic ? 1.f : 1.f / vView.z;
+    const float fX = fCenterX + vView.x * fInvZ * m_fScaleX;
+    const float fY = fCenterY - vView.y * fInvZ * m_fScaleY;
+    fMinX = hkvMath::Min(fMinX, fX); fMaxX = hkvMath::Max(fMaxX, fX);
+    fMinY = hkvMath::Min(fMinY, fY); fMaxY = hkvMath::Max(fMaxY, fY);
+    fMinZ = hkvMath::Min(fMinZ, vView.z);
+  }
+
+  // Covered pixels, expanded by one pixel since occluder coverage is only sampled at pixel centers.
+  // Boxes reaching outside the buffer are partially outside the view and treated as visible.
+  const int x0 = (int)hkvMath::floor(fMinX) - 1;
+  const int x1 = (int)hkvMath::floor(fMaxX) + 1;
+  const int y0 = (int)hkvMath::floor(fMinY) - 1;
+  const int y1 = (int)hkvMath::floor(fMaxY) + 1;
+  if (x0 < 0 || y0 < 0 || x1 >= m_iWidth || y1 >= m_iHeight)
+    return false;
+
+  const float fBoxNearness = GetNearness(fMinZ * (1.f - VIS_SOFTWAREOCCLUSION_DEPTHBIAS));
+
+  // Start at the finest level in which the box covers only a few texels
+  int iLevel = 0;
+  while (iLevel < m_iNumLevels-1 && ((x1>>iLevel)-(x0>>iLevel) >= VIS_SOFTWAREOCCLUSION_MAXTESTTEXELS || (y1>>iLevel)-(y0>>iLevel) >= VIS_SOFTWAREOCCLUSION_MAXTESTTEXELS))
+    iLevel++;
+
+  return IsRegionOccluded(iLevel, x0>>iLevel, y0>>iLevel, x1>>iLevel, y1>>iLevel, x0, y0, x1, y1, fBoxNearness);
+}
+
+bool VisSoftwareOcclusionBuffer_cl::IsRegionOccluded(int iLevel, int x0, int y0, int x1, int y1, int iPixelX0, int iPixelY0, int iPixelX1, int iPixelY1, float fNearness) const
+{
+  const int iWidth = m_iLevelWidth[iLevel];
+  const float *pLevel = m_Levels[iLevel].GetDataPtr();
+  for (int y=y0; y<=y1; y++)
+  {
+    const float *pRow = pLevel + y*iWidth;
+    for (int x=x0; x<=x1; x++)
+    {
+      if (pRow[x] > fNearness)
+        continue;
+
+      // Coarse texels also cover pixels outside of the tested rectangle, so only a texel of the
+      // full resolution buffer proves that the box is visible. Otherwise refine the 2x2 children
+      // which overlap the rectangle.
+      if (iLevel == 0)
+        return false;
+      const int iChildLevel = iLevel - 1;
+      const int cx0 = hkvMath::Max(x*2, iPixelX0>>iChildLevel);
+      const int cy0 = hkvMath::Max(y*2, iPixelY0>>iChildLevel);
+      const int cx1 = hkvMath::Min(x*2+1, iPixelX1>>iChildLevel);
+      const int cy1 = hkvMath::Min(y*2+1, iPixelY1>>iChildLevel);
+      if (!IsRegionOccluded(iChildLevel, cx0, cy0, cx1, cy1, iPixelX0, iPixelY0, iPixelX1, iPixelY1, fNearness))
+        return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -0,0 +1,237 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file VisionSoftwareOcclusion.hpp
+
+#ifndef DEFINE_VISIONSOFTWAREOCCLUSION
+#define DEFINE_VISIONSOFTWAREOCCLUSION
+
+class VBaseMesh;
+
+/// \brief
+///   Maximum number of hierarchical-Z levels of a VisSoftwareOcclusionBuffer_cl
+#define VIS_SOFTWAREOCCLUSION_MAX_LEVELS  12
+
+
+/// \brief
+///   Occluder geometry for the software occlusion culling stage of VisionVisibilityCollector_cl.
+///
+/// Occluders are triangle meshes in world space. They are rasterized into the software depth
+/// buffer of every visibility collector that has the VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION behavior
+/// flag set. Good occluders are large, closed and have few triangles, for instance the collision
+/// mesh of a large static building or a simplified terrain replacement mesh.
+///
+/// Occluders are only used after they have been registered with IVisSceneManager_cl::AddSoftwareOccluder.
+/// All occluders are removed automatically when the world is deinitialized.
+///
+/// Occluder geometry should lie inside the visible geometry it stands in for, otherwise objects
+/// behind the visible surfaces may be culled. Occluders must not be added, removed or modified
+/// while visibility determination is running.
+class VisSoftwareOccluder_cl : public VRefCounter
+{
+public:
+
+  /// \brief
+  ///   Constructor. The occluder has no geometry until SetGeometry or SetGeometryFromMesh is
+  ///   called.
+  VISION_APIFUNC VisSoftwareOccluder_cl();
+
+  /// \brief
+  ///   Destructor
+  VISION_APIFUNC virtual ~VisSoftwareOccluder_cl();
+
+  /// \brief
+  ///   Sets the occluder geometry from an indexed triangle list.
+  ///
+  /// \param iNumVertices
+  ///   Number of vertices in pVertices.
+  ///
+  /// \param pVertices
+  ///   Vertex positions in the space defined by transform. They are transformed to world space and
+  ///   copied.
+  ///
+  /// \param iNumTriangles
+  ///   Number of triangles.
+  ///
+  /// \param pIndices
+  ///   Three indices per triangle, of the type defined by iIndexType. If NULL, the vertices are
+  ///   interpreted as a non-indexed triangle list.
+  ///
+  /// \param iIndexType
+  ///   VIS_INDEXFORMAT_16 or VIS_INDEXFORMAT_32.
+  ///
+  /// \param transform
+  ///   Object to world space transformation.
+  VISION_APIFUNC void SetGeometry(int iNumVertices, const hkvVec3 *pVertices, int iNumTriangles, const void *pIndices, int iIndexType, const hkvMat4 &transform);
+
+  /// \brief
+  ///   Sets the occluder geometry from the collision mesh of the passed mesh (the render mesh is
+  ///   used if the mesh has no collision mesh).
+  ///
+  /// \param pMesh
+  ///   The mesh, for instance the mesh of a static mesh instance.
+  ///
+  /// \param transform
+  ///   Object to world space transformation, for instance VisStaticMeshInstance_cl::GetTransform.
+  ///
+  /// \return
+  ///   false if no geometry could be retrieved from the mesh.
+  VISION_APIFUNC bool SetGeometryFromMesh(VBaseMesh *pMesh, const hkvMat4 &transform);
+
+  /// \brief
+  ///   Returns the world space bounding box of the occluder geometry.
+  inline const hkvAlignedBBox &GetBoundingBox() const { return m_BoundingBox; }
+
+  /// \brief
+  ///   Returns the number of triangles.
+  inline int GetTriangleCount() const { return m_iNumTriangles; }
+
+  /// \brief
+  ///   Returns the world space vertex positions.
+  inline const hkvVec3 *GetVertices() const { return m_Vertices.GetDataPtr(); }
+
+  /// \brief
+  ///   Returns three vertex indices per triangle.
+  inline const int *GetIndices() const { return m_Indices.GetDataPtr(); }
+
+
+protected:
+  DynArray_cl<hkvVec3> m_Vertices;
+  DynArray_cl<int> m_Indices;
+  int m_iNumTriangles;
+  hkvAlignedBBox m_BoundingBox;
+};
+
+typedef VSmartPtr<VisSoftwareOccluder_cl> VisSoftwareOccluderPtr;
+
+
+/// \brief
+///   CPU depth buffer with a hierarchical-Z pyramid, used by the software occlusion culling stage of
+///   VisionVisibilityCollector_cl.
+///
+/// Occluder triangles are rasterized from the point of view of the collector's source object.
+/// Afterwards, the farthest depth of each 2x2 block is propagated into a pyramid of coarser levels,
+/// so that the bounding box of a scene element can first be tested against a few coarse texels and
+/// only the texels which fail are refined.
+///
+/// The test is conservative with respect to the depth values: a box is only reported as occluded
+/// if its nearest point is behind the occluders in all buffer pixels covered by its projection, and
+/// boxes which intersect the near plane or project outside the buffer are never occluded. Coverage
+/// is sampled at pixel centers, so a thin gap between two occluders which is smaller than a pixel
+/// may be closed.
+class VisSoftwareOcclusionBuffer_cl
+{
+public:
+
+  /// \brief
+  ///   Constructor
+  ///
+  /// \param iWidth
+  ///   Buffer width in pixels.
+  ///
+  /// \param iHeight
+  ///   Buffer height in pixels.
+  VISION_APIFUNC VisSoftwareOcclusionBuffer_cl(int iWidth = 256, int iHeight = 128);
+
+  /// \brief
+  ///   Destructor
+  VISION_APIFUNC ~VisSoftwareOcclusionBuffer_cl();
+
+  /// \brief
+  ///   Changes the buffer resolution. Must not be called while the buffer is in use.
+  VISION_APIFUNC void SetResolution(int iWidth, int iHeight);
+
+  /// \brief
+  ///   Returns the buffer width in pixels.
+  inline int GetWidth() const { return m_iWidth; }
+
+  /// \brief
+  ///   Returns the buffer height in pixels.
+  inline int GetHeight() const { return m_iHeight; }
+
+  /// \brief
+  ///   Clears the buffer and sets up a perspective projection. Field of view values are in
+  ///   degrees; the axes of mOrientation are the viewing direction, right and up vectors.
+  VISION_APIFUNC void BeginFrame(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fFovX, float fFovY, float fNearClip);
+
+  /// \brief
+  ///   Clears the buffer and sets up an orthographic projection with the passed view extents.
+  VISION_APIFUNC void BeginFrameOrthographic(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fSizeX, float fSizeY, float fNearClip);
+
+  /// \brief
+  ///   Rasterizes all triangles of an occluder into the depth buffer.
+  VISION_APIFUNC void RasterizeOccluder(const VisSoftwareOccluder_cl *pOccluder);
+
+  /// \brief
+  ///   Builds the hierarchical-Z pyramid. Has to be called after all occluders have been
+  ///   rasterized and before IsOccluded is called.
+  VISION_APIFUNC void EndFrame();
+
+  /// \brief
+  ///   Returns true if the passed world space box is completely hidden by the rasterized
+  ///   occluders.
+  VISION_APIFUNC bool IsOccluded(const hkvAlignedBBox &box) const;
+
+  /// \brief
+  ///   Returns the number of occluder triangles rasterized since the last BeginFrame.
+  inline int GetRasterizedTriangleCount() const { return m_iRasterizedTriangles; }
+
+  /// \brief
+  ///   Returns the depth values of a pyramid level. Each value is the inverse of the view space
+  ///   depth for perspective projections and the negative view space depth for orthographic
+  ///   projections, so larger values are nearer; -FLT_MAX means that no occluder has been
+  ///   rasterized. Level 0 is the full resolution buffer.
+  inline const float *GetLevel(int iLevel, int &iWidth, int &iHeight) const
+  {
+    VASSERT(iLevel >= 0 && iLevel < m_iNumLevels);
+    iWidth = m_iLevelWidth[iLevel];
+    iHeight = m_iLevelHeight[iLevel];
+    return m_Levels[iLevel].GetDataPtr();
+  }
+
+  /// \brief
+  ///   Returns the number of pyramid levels.
+  inline int GetLevelCount() const { return m_iNumLevels; }
+
+protected:
+  void BeginFrameInternal(const hkvVec3 &vPos, const hkvMat3 &mOrientation, float fNearClip);
+  inline void ToViewSpace(const hkvVec3 &vWorld, hkvVec3 &vView) const;
+  inline float GetNearness(float fViewDepth) const;
+  void RasterizeTriangle(const hkvVec3 &v0, const hkvVec3 &v1, const hkvVec3 &v2);
+  void RasterizeClippedTriangle(const hkvVec3 *pView);
+  bool IsRegionOccluded(int iLevel, int x0, int y0, int x1, int y1, int iPixelX0, int iPixelY0, int iPixelX1, int iPixelY1, float fNearness) const;
+
+  int m_iWidth, m_iHeight;
+  int m_iNumLevels;
+  int m_iLevelWidth[VIS_SOFTWAREOCCLUSION_MAX_LEVELS];
+  int m_iLevelHeight[VIS_SOFTWAREOCCLUSION_MAX_LEVELS];
+  DynArray_cl<float> m_Levels[VIS_SOFTWAREOCCLUSION_MAX_LEVELS];
+
+  bool m_bOrthographic;
+  hkvVec3 m_vPos, m_vDir, m_vRight, m_vUp;
+  float m_fNearClip;
+  float m_fScaleX, m_fScaleY;     ///< view space to pixel scale (divided by the depth for perspective projections)
+  int m_iRasterizedTriangles;
+};
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
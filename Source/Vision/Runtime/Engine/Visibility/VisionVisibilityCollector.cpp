@@ -24,18 +24,208 @@ extern char _binary_spu_SPUVisibilityJob_bin_start[];
 extern char _binary_spu_SPUVisibilityJob_bin_size[];
 bool VisionVisibilityCollector_cl::s_bMultithreaded = false;
 bool VisionVisibilityCollector_cl::s_bUseWorkflow = true;
+bool VisionVisibilityCollector_cl::s_bUseZoneJobs = false;
 #else
 bool VisionVisibilityCollector_cl::s_bMultithreaded = true;
 bool VisionVisibilityCollector_cl::s_bUseWorkflow = false;
+bool VisionVisibilityCollector_cl::s_bUseZoneJobs = true;
 #endif
 
 #else
 
 bool VisionVisibilityCollector_cl::s_bMultithreaded = false;
 bool VisionVisibilityCollector_cl::s_bUseWorkflow = false;
+bool VisionVisibilityCollector_cl::s_bUseZoneJobs = false;
 
 #endif
 
+int VisionVisibilityCollector_cl::s_iZoneJobMinElementCount = 64;
+bool VisionVisibilityCollector_cl::s_bUsePackedBounds = true;
+unsigned int VisionVisibilityCollector_cl::s_iPackedBoundsRevision = 0;
+
+
+// *******************************************************************************
+// *  Packed bounding boxes
+// *
+// *  Blocks of 4 bounding boxes are stored as minX[4],minY[4],minZ[4],maxX[4],
+// *  maxY[4],maxZ[4] so that they can be tested against a frustum plane with a
+// *  few SIMD instructions.
+// *******************************************************************************
+
+#define VIS_PACKEDBOUNDS_BLOCKSIZE    4
+#define VIS_PACKEDBOUNDS_BLOCKFLOATS  (6*VIS_PACKEDBOUNDS_BLOCKSIZE)
+
+#if ((defined(WIN32) && !defined(_M_ARM)) || defined(__SSE__)) && !defined(_VISION_XENON)
+  #include <xmmintrin.h>
+  #define VIS_PACKEDBOUNDS_SSE
+#elif defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define VIS_PACKEDBOUNDS_NEON
+#endif
+
+static inline void PackBoundingBox(float *pBlock, int iLane, const hkvAlignedBBox &box)
+{
+  pBlock[iLane]      = box.m_vMin.x;
+  pBlock[iLane + 4]  = box.m_vMin.y;
+  pBlock[iLane + 8]  = box.m_vMin.z;
+  pBlock[iLane + 12] = box.m_vMax.x;
+  pBlock[iLane + 16] = box.m_vMax.y;
+  pBlock[iLane + 20] = box.m_vMax.z;
+}
+
+// Returns a 4 bit mask in which bit n is set if box n of the block overlaps the frustum. This is equivalent to
+// VisFrustum_cl::Overlaps(box, iPlaneFlags): per plane, the box corner with the smallest plane distance is selected
+// component by component, and the box is outside if that distance is not negative.
+static inline int GetPackedOverlapMask(const VisFrustum_cl &frustum, int iPlaneFlags, const float *pBlock)
+{
+  if (iPlaneFlags == 0)
+    return 0xf;
+
+  const unsigned int iNumPlanes = frustum.GetNumPlanes();
+
+#if defined(VIS_PACKEDBOUNDS_SSE)
+  const __m128 minX = _mm_loadu_ps(pBlock);
+  const __m128 minY = _mm_loadu_ps(pBlock + 4);
+  const __m128 minZ = _mm_loadu_ps(pBlock + 8);
+  const __m128 maxX = _mm_loadu_ps(pBlock + 12);
+  const __m128 maxY = _mm_loadu_ps(pBlock + 16);
+  const __m128 maxZ = _mm_loadu_ps(pBlock + 20);
+  const __m128 zero = _mm_setzero_ps();
+  int iMask = 0xf;
+  for (unsigned int i=0; i<iNumPlanes && iMask!=0; i++)
+  {
+    if (!(iPlaneFlags & (1<<i)))
+      continue;
+    const hkvPlane *pPlane = frustum.GetPlane(i);
+    const __m128 a = _mm_set1_ps(pPlane->m_vNormal.x);
+    const __m128 b = _mm_set1_ps(pPlane->m_vNormal.y);
+    const __m128 c = _mm_set1_ps(pPlane->m_vNormal.z);
+    const __m128 d = _mm_set1_ps(pPlane->m_fNegDist);
+    __m128 r = _mm_add_ps(_mm_min_ps(_mm_mul_ps(minX,a), _mm_mul_ps(maxX,a)), _mm_min_ps(_mm_mul_ps(minY,b), _mm_mul_ps(maxY,b)));
+    r = _mm_add_ps(_mm_add_ps(r, _mm_min_ps(_mm_mul_ps(minZ,c), _mm_mul_ps(maxZ,c))), d);
+    iMask &= _mm_movemask_ps(_mm_cmplt_ps(r, zero));
+  }
+  return iMask;
+
+#elif defined(VIS_PACKEDBOUNDS_NEON)
+  const float32x4_t minX = vld1q_f32(pBlock);
+  const float32x4_t minY = vld1q_f32(pBlock + 4);
+  const float32x4_t minZ = vld1q_f32(pBlock + 8);
+  const float32x4_t maxX = vld1q_f32(pBlock + 12);
+  const float32x4_t maxY = vld1q_f32(pBlock + 16);
+  const float32x4_t maxZ = vld1q_f32(pBlock + 20);
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  uint32x4_t inside = vdupq_n_u32(0xffffffff);
+  for (unsigned int i=0; i<iNumPlanes; i++)
+  {
+    if (!(iPlaneFlags & (1<<i)))
+      continue;
+    const hkvPlane *pPlane = frustum.GetPlane(i);
+    const float32x4_t a = vdupq_n_f32(pPlane->m_vNormal.x);
+    const float32x4_t b = vdupq_n_f32(pPlane->m_vNormal.y);
+    const float32x4_t c = vdupq_n_f32(pPlane->m_vNormal.z);
+    const float32x4_t d = vdupq_n_f32(pPlane->m_fNegDist);
+    float32x4_t r = vaddq_f32(vminq_f32(vmulq_f32(minX,a), vmulq_f32(maxX,a)), vminq_f32(vmulq_f32(minY,b), vmulq_f32(maxY,b)));
+    r = vaddq_f32(vaddq_f32(r, vminq_f32(vmulq_f32(minZ,c), vmulq_f32(maxZ,c))), d);
+    inside = vandq_u32(inside, vcltq_f32(r, zero));
+  }
+  const uint32x4_t m = vshrq_n_u32(inside, 31);
+  return (int)(vgetq_lane_u32(m,0) | (vgetq_lane_u32(m,1)<<1) | (vgetq_lane_u32(m,2)<<2) | (vgetq_lane_u32(m,3)<<3));
+
+#else
+  int iMask = 0xf;
+  for (unsigned int i=0; i<iNumPlanes && iMask!=0; i++)
+  {
+    if (!(iPlaneFlags & (1<<i)))
+      continue;
+    const hkvPlane *pPlane = frustum.GetPlane(i);
+    for (int j=0; j<VIS_PACKEDBOUNDS_BLOCKSIZE; j++)
+    {
+      float r = hkvMath::Min(pBlock[j]*pPlane->m_vNormal.x, pBlock[j+12]*pPlane->m_vNormal.x)
+              + hkvMath::Min(pBlock[j+4]*pPlane->m_vNormal.y, pBlock[j+16]*pPlane->m_vNormal.y)
+              + hkvMath::Min(pBlock[j+8]*pPlane->m_vNormal.z, pBlock[j+20]*pPlane->m_vNormal.z)
+              + pPlane->m_fNegDist;
+      if (!(r < 0.f))
+        iMask &= ~(1<<j);
+    }
+  }
+  return iMask;
+#endif
+}
+
+
+/// \brief
+///   Internal class holding the packed bounding boxes of the static geometry instances of one
+///   visibility zone. See VisionVisibilityCollector_cl::SetUsePackedBounds.
+class VisZonePackedBounds_cl
+{
+public:
+  VisZonePackedBounds_cl() : m_Blocks(0, 0.f)
+  {
+    m_pZone = NULL;
+    m_pSourceData = NULL;
+    m_iCount = -1;
+    m_iHash = 0;
+    m_iRevision = 0;
+  }
+
+  // The pointer sum catches instances that were replaced without changing the count. It only reads
+  // the zone's pointer array, not the instances themselves.
+  static UINT_PTR ComputeHash(VisStaticGeometryInstance_cl * const *pInstances, int iCount)
+  {
+    UINT_PTR iHash = 0;
+    for (int i=0; i<iCount; i++)
+      iHash += (UINT_PTR)pInstances[i] * (UINT_PTR)(i+1);
+    return iHash;
+  }
+
+  // Both counters only ever increase, so their sum changes whenever one of them does
+  static inline unsigned int GetRevision(const VisVisibilityZone_cl *pZone)
+  {
+    return VisionVisibilityCollector_cl::s_iPackedBoundsRevision + pZone->GetStaticGeometryBoundsRevision();
+  }
+
+  bool IsUpToDate(VisVisibilityZone_cl *pZone) const
+  {
+    const VisStaticGeometryInstanceCollection_cl *pInstances = pZone->GetStaticGeometryInstances();
+    const int iCount = (int)pInstances->GetNumEntries();
+    return m_pZone == pZone && m_iCount == iCount && m_pSourceData == pInstances->GetDataPtr() &&
+      m_iRevision == GetRevision(pZone) && m_iHash == ComputeHash(pInstances->GetDataPtr(), iCount);
+  }
+
+  void Build(VisVisibilityZone_cl *pZone)
+  {
+    const VisStaticGeometryInstanceCollection_cl *pInstances = pZone->GetStaticGeometryInstances();
+    VisStaticGeometryInstance_cl * const *pData = pInstances->GetDataPtr();
+    const int iCount = (int)pInstances->GetNumEntries();
+    const int iNumBlocks = (iCount + VIS_PACKEDBOUNDS_BLOCKSIZE - 1) / VIS_PACKEDBOUNDS_BLOCKSIZE;
+
+    m_Blocks.EnsureSize(iNumBlocks * VIS_PACKEDBOUNDS_BLOCKFLOATS);
+    float *pBlock = m_Blocks.GetDataPtr();
+    for (int i=0; i<iNumBlocks*VIS_PACKEDBOUNDS_BLOCKSIZE; i++)
+    {
+      // unused lanes of the last block repeat the last box; their result is masked out
+      const int iSource = hkvMath::Min(i, iCount-1);
+      PackBoundingBox(pBlock + (i/VIS_PACKEDBOUNDS_BLOCKSIZE)*VIS_PACKEDBOUNDS_BLOCKFLOATS, i%VIS_PACKEDBOUNDS_BLOCKSIZE, pData[iSource]->GetBoundingBox());
+    }
+
+    m_pZone = pZone;
+    m_pSourceData = pData;
+    m_iCount = iCount;
+    m_iHash = ComputeHash(pData, iCount);
+    m_iRevision = GetRevision(pZone);
+  }
+
+  inline const float *GetBlocks() const { return m_Blocks.GetDataPtr(); }
+
+  VisVisibilityZone_cl *m_pZone;
+  const void *m_pSourceData;
+  int m_iCount;
+  UINT_PTR m_iHash;
+  unsigned int m_iRevision;
+  DynArray_cl<float> m_Blocks;
+};
+
 
 VisCallback_cl VISION_ALIGN(16) IVisVisibilityCollector_cl::OnVisibilityCollectorCreated;
 VisCallback_cl VISION_ALIGN(16) IVisVisibilityCollector_cl::OnVisibilityCollectorDestroyed;
@@ -72,7 +262,7 @@ VisVisibilityStreamConfig_t defaultVisStreamConfig;
 
 VisionVisibilityCollector_cl::VisionVisibilityCollector_cl(VisSceneElementTypes_e eSceneElementTypes)
   : IVisVisibilityCollector_cl(), m_VisibleVisibilityZones(64,256), m_EntityFlags(256, 0), m_VisObjectFlags(256, 0), m_LightFlags(64, 0), m_VisibilityZoneVisitedFlags(32,0), m_VisibilityZoneFlags(32,0),
-  m_TraversalProtocol(64, 128), m_iTraversalProtocolSize(0),
+  m_TraversalProtocol(64, 128), m_iTraversalProtocolSize(0), m_ZoneTasks(0, NULL), m_iZoneTaskCount(0), m_ZonePackedBounds(0, NULL),
   m_StreamConfigs(1, defaultVisStreamConfig), targetPortal((hkvVec3*) &tempMem1[0],(hkvPlane*) &tempMem2[0], sizeof(tempMem1)/sizeof(hkvPlane))
 #if defined(WIN32)
   ,m_EntityLODStates(2048, VLODState()), m_iEntityPlaneFlagsMask(-1)
@@ -113,6 +303,10 @@ VisionVisibilityCollector_cl::VisionVisibilityCollector_cl(VisSceneElementTypes_
   m_eStatus = VIS_VISIBILITYSTATUS_READY;
   m_bUseCameraBBox = false;
   m_bUsedWorkflow = false;
+  m_bUseZoneJobs = false;
+  m_bUsePackedBounds = false;
+  m_pSoftwareOcclusionBuffer = NULL;
+  m_iSoftwareOccludedCount = 0;
 
   m_pStartZone = NULL;
 
@@ -143,6 +337,12 @@ VisionVisibilityCollector_cl::~VisionVisibilityCollector_cl()
   V_SAFE_DELETE(m_pVisibleTransparentPassStaticGeometryInstances);
 
   V_SAFE_DELETE(m_pTask);
+  for (unsigned int i=0; i<m_ZoneTasks.GetSize(); i++)
+    V_SAFE_DELETE(m_ZoneTasks[i]);
+  for (unsigned int i=0; i<m_ZonePackedBounds.GetSize(); i++)
+    V_SAFE_DELETE(m_ZonePackedBounds[i]);
+  V_SAFE_DELETE(m_pSoftwareOcclusionBuffer);
+  m_SoftwareOccluders.Clear();
   if (m_pWorkflow)
     VStreamProcessor::DestroyWorkflow(m_pWorkflow);
 
@@ -245,6 +445,12 @@ void VisionVisibilityCollector_cl::OnDoVisibilityDetermination(int iFilterBitmas
   m_iFrustumStackDepth = 0;
   ClearVisibilityData();
 
+  // the occluders may be added and removed on the main thread while the visibility task runs
+  if (m_iBehaviorFlags & VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION)
+    m_SoftwareOccluders = Vision::GetSceneManager()->GetSoftwareOccluders();
+  else
+    m_SoftwareOccluders.Clear();
+
   { // trigger callbacks on all attached components: 
     VisVisibilityCollectorDataObject_cl cbdata(&Vision::Callbacks.OnStartVisibilityDetermination,this);
     cbdata.m_pSender->TriggerCallbacks(&cbdata);
@@ -310,6 +516,27 @@ void VisionVisibilityCollector_cl::PerformVisibilityDetermination(int iFilterBit
   m_bUseCameraBBox = false;
   m_iTraversalProtocolSize = 0;
 
+  // Zone jobs write into private result buffers, which is not possible for the stream processing
+  // variant. The LOD hysteresis manager keeps per-element state that is not safe to update from
+  // several threads, so it also forces the serial path.
+  m_bUseZoneJobs = s_bUseZoneJobs && !s_bUseWorkflow && Vision::GetThreadManager()->GetThreadCount() > 0;
+#ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+  if (m_pLODHysteresisManager->GetThreshold(VLHT_WORLDGEOMETRY) > 0.0f || m_pLODHysteresisManager->GetThreshold(VLHT_ENTITIES) > 0.0f)
+    m_bUseZoneJobs = false;
+#endif //SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+
+  // The packed boxes of a zone are only rebuilt in the traversing thread, so the array must not grow
+  // while zone jobs are reading it.
+  m_bUsePackedBounds = s_bUsePackedBounds && !Vision::Editor.IsInEditor();
+  if (m_bUsePackedBounds)
+    m_ZonePackedBounds.EnsureSize(Vision::GetSceneManager()->GetNumVisibilityZones());
+
+#if defined(WIN32)
+  // GetLODState must not resize the array while zone jobs are running
+  if (m_bUseZoneJobs)
+    m_EntityLODStates.EnsureSize(VisBaseEntity_cl::ElementManagerGetSize());
+#endif
+
   if (m_pOverrideFrustum)
   {
     // If we are simply starting from a given base frustum, make a copy of it
@@ -390,6 +617,13 @@ void VisionVisibilityCollector_cl::PerformVisibilityDetermination(int iFilterBit
   // Perform (recursive) scene traversal
   TraverseScene(pStartZone);
 
+  if (m_bUseZoneJobs)
+    FinishZoneCullingTasks();
+
+  m_iSoftwareOccludedCount = 0;
+  if (m_iBehaviorFlags & VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION)
+    PerformSoftwareOcclusionCulling();
+
 #ifdef SUPPORTS_MULTITHREADING
   if (s_bUseWorkflow)
   {
@@ -813,8 +1047,8 @@ void VisionVisibilityCollector_cl::PostProcessVisibilityResults()
 
         const int iFlags = (*pVisObjects)->GetVisTestFlags();
 
-        // this test has not been performed in the workflow version
-        if (m_bUsedWorkflow && !(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN))
+        // this test has not been performed in the workflow version and in the zone jobs
+        if ((m_bUsedWorkflow || m_bUseZoneJobs) && !(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN))
           if (!(*pVisObjects)->OnTestVisible(this, GetBaseFrustum()))
           {
             m_pVisibleVisObjects->FlagForRemoval(i);
@@ -856,8 +1090,8 @@ void VisionVisibilityCollector_cl::PostProcessVisibilityResults()
 
       const int iFlags = (*pVisObjects)->GetVisTestFlags();
 
-      // this test has not been performed in the workflow version
-      if (m_bUsedWorkflow && !(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN))
+      // this test has not been performed in the workflow version and in the zone jobs
+      if ((m_bUsedWorkflow || m_bUseZoneJobs) && !(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN))
       {
         if (!(*pVisObjects)->OnTestVisible(this, GetBaseFrustum()))
         {
@@ -1354,6 +1588,170 @@ void VisionVisibilityCollector_cl::WaitForAllTasks()
 }
 
 
+void VisionVisibilityCollector_cl::AddZoneCullingTask(VisVisibilityZone_cl* pZone, VisSceneElementTypes_e eSceneElement, int iNumElements, VisFrustum_cl* pFrustum,
+  int iPlaneFlags, const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult)
+{
+  if (iNumElements == 0)
+    return;
+
+  if (m_ZoneTasks[m_iZoneTaskCount] == NULL)
+    m_ZoneTasks[m_iZoneTaskCount] = new VisZoneCullingTask_cl(this);
+  VisZoneCullingTask_cl *pTask = m_ZoneTasks[m_iZoneTaskCount++];
+  VASSERT(pTask->GetState()!=TASKSTATE_EXECUTING && pTask->GetState()!=TASKSTATE_PENDING);
+
+  pTask->m_pZone = pZone;
+  pTask->m_eSceneElement = eSceneElement;
+  pTask->m_iNumElements = iNumElements;
+  pTask->m_bHasFrustum = (pFrustum != NULL);
+  if (pFrustum != NULL)
+    pTask->m_Frustum.CopyFrom(*pFrustum);
+  pTask->m_iPlaneFlags = iPlaneFlags;
+  pTask->m_vCameraPos = vCameraPos;
+  pTask->m_fLODScaleSqr = fLODScaleSqr;
+  pTask->m_eClipResult = eClipResult;
+
+  // Small zones are not worth the scheduling overhead. Their results still go into the task's own
+  // buffer, so that the merge order matches the traversal order.
+  if (iNumElements < s_iZoneJobMinElementCount)
+    pTask->Run(NULL);
+  else
+    Vision::GetThreadManager()->ScheduleTask(pTask, 1);
+}
+
+
+void VisionVisibilityCollector_cl::FinishZoneCullingTasks()
+{
+  VThreadManager *pThreadManager = Vision::GetThreadManager();
+
+  int iRequiredGeoInstances = m_pVisibleStaticGeometryInstances->GetNumEntries();
+  int iRequiredEntities = m_pVisibleEntities->GetNumEntries();
+  int iRequiredVisObjects = m_pVisibleVisObjects->GetNumEntries();
+  for (int i=0; i<m_iZoneTaskCount; i++)
+  {
+    VisZoneCullingTask_cl *pTask = m_ZoneTasks[i];
+    if (pTask->GetState()!=TASKSTATE_FINISHED && pTask->GetState()!=TASKSTATE_UNASSIGNED)
+      pThreadManager->WaitForTask(pTask, true);
+    iRequiredGeoInstances += pTask->m_VisibleGeometryInstances.GetNumEntries();
+    iRequiredEntities += pTask->m_VisibleEntities.GetNumEntries();
+    iRequiredVisObjects += pTask->m_VisibleVisObjects.GetNumEntries();
+  }
+
+  m_pVisibleStaticGeometryInstances->EnsureSize(iRequiredGeoInstances);
+  m_pVisibleEntities->EnsureSize(iRequiredEntities);
+  m_pVisibleVisObjects->EnsureSize(iRequiredVisObjects);
+
+  for (int i=0; i<m_iZoneTaskCount; i++)
+  {
+    VisZoneCullingTask_cl *pTask = m_ZoneTasks[i];
+    if (!pTask->m_VisibleGeometryInstances.IsEmpty())
+      m_pVisibleStaticGeometryInstances->AppendCollection(pTask->m_VisibleGeometryInstances);
+    if (!pTask->m_VisibleEntities.IsEmpty())
+      m_pVisibleEntities->AppendCollection(pTask->m_VisibleEntities);
+    if (!pTask->m_VisibleVisObjects.IsEmpty())
+      m_pVisibleVisObjects->AppendCollection(pTask->m_VisibleVisObjects);
+    pTask->m_pZone = NULL;
+  }
+  m_iZoneTaskCount = 0;
+}
+
+
+void VisionVisibilityCollector_cl::UpdatePackedGeometryBounds(VisVisibilityZone_cl* pZone)
+{
+  const int iZoneIndex = pZone->GetIndex();
+  if (iZoneIndex < 0 || iZoneIndex >= (int)m_ZonePackedBounds.GetSize())
+    return;
+
+  VisZonePackedBounds_cl *pPackedBounds = m_ZonePackedBounds[iZoneIndex];
+  if (pPackedBounds == NULL)
+  {
+    pPackedBounds = new VisZonePackedBounds_cl();
+    m_ZonePackedBounds[iZoneIndex] = pPackedBounds;
+  }
+  if (!pPackedBounds->IsUpToDate(pZone))
+    pPackedBounds->Build(pZone);
+}
+
+
+const VisZonePackedBounds_cl *VisionVisibilityCollector_cl::GetPackedGeometryBounds(VisVisibilityZone_cl* pZone, int iNumGeomInstancesInZone) const
+{
+  const int iZoneIndex = pZone->GetIndex();
+  if (!m_bUsePackedBounds || iZoneIndex < 0 || iZoneIndex >= (int)m_ZonePackedBounds.GetSize())
+    return NULL;
+
+  // UpdatePackedGeometryBounds has been called for this zone in the current traversal; the count
+  // check just guards against callers that skipped it
+  const VisZonePackedBounds_cl *pPackedBounds = m_ZonePackedBounds.GetDataPtr()[iZoneIndex];
+  if (pPackedBounds == NULL || pPackedBounds->m_pZone != pZone || pPackedBounds->m_iCount != iNumGeomInstancesInZone)
+    return NULL;
+  return pPackedBounds;
+}
+
+void VisionVisibilityCollector_cl::PerformSoftwareOcclusionCulling()
+{
+  // The stream processing workflow collects its results later, and an override frustum has no
+  // projection we could rasterize with. The automatic frustum projection is not supported either.
+  if (s_bUseWorkflow || m_pOverrideFrustum != NULL || (m_iBehaviorFlags & VIS_VISCOLLECTOR_USEFOV) == 0 || m_iFrustumStackDepth == 0)
+    return;
+  if (m_eProjectionType != VIS_PROJECTIONTYPE_PERSPECTIVE && m_eProjectionType != VIS_PROJECTIONTYPE_ORTHOGRAPHIC)
+    return;
+
+  // snapshot taken in OnDoVisibilityDetermination
+  const VRefCountedCollection<VisSoftwareOccluder_cl> &occluders = m_SoftwareOccluders;
+  const int iNumOccluders = occluders.Count();
+  if (iNumOccluders == 0)
+    return;
+
+  if (m_pSoftwareOcclusionBuffer == NULL)
+    m_pSoftwareOcclusionBuffer = new VisSoftwareOcclusionBuffer_cl();
+
+  hkvVec3 vPos(hkvNoInitialization);
+  hkvMat3 mOrientation(hkvNoInitialization);
+  m_pSourceObject->GetRotationMatrix(mOrientation);
+  vPos = m_pSourceObject->GetPosition();
+  if (m_eProjectionType == VIS_PROJECTIONTYPE_ORTHOGRAPHIC)
+    m_pSoftwareOcclusionBuffer->BeginFrameOrthographic(vPos, mOrientation, m_fOrthographicSize[0], m_fOrthographicSize[1], m_fClipPlanes[0]);
+  else
+    m_pSoftwareOcclusionBuffer->BeginFrame(vPos, mOrientation, m_fFov[0], m_fFov[1], m_fClipPlanes[0]);
+
+  // Only occluders inside the base frustum can hide anything
+  const VisFrustum_cl &baseFrustum = m_FrustumStack[0];
+  for (int i=0; i<iNumOccluders; i++)
+  {
+    const VisSoftwareOccluder_cl *pOccluder = occluders.GetAt(i);
+    if (pOccluder->GetTriangleCount() > 0 && baseFrustum.Overlaps(pOccluder->GetBoundingBox()))
+      m_pSoftwareOcclusionBuffer->RasterizeOccluder(pOccluder);
+  }
+  if (m_pSoftwareOcclusionBuffer->GetRasterizedTriangleCount() == 0)
+    return;
+  m_pSoftwareOcclusionBuffer->EndFrame();
+
+  // Compact the collections in place; PostProcessVisibilityResults takes care of duplicates
+  const int iNumEntities = m_pVisibleEntities->GetNumEntries();
+  VisBaseEntity_cl **pEntities = m_pVisibleEntities->GetDataPtr();
+  int iVisibleEntities = 0;
+  for (int i=0; i<iNumEntities; i++)
+  {
+    if (m_pSoftwareOcclusionBuffer->IsOccluded(*pEntities[i]->GetCurrentVisBoundingBoxPtr()))
+      continue;
+    pEntities[iVisibleEntities++] = pEntities[i];
+  }
+  m_pVisibleEntities->SetNumEntries(iVisibleEntities);
+
+  const int iNumGeoInstances = m_pVisibleStaticGeometryInstances->GetNumEntries();
+  VisStaticGeometryInstance_cl **pGeoInstances = m_pVisibleStaticGeometryInstances->GetDataPtr();
+  int iVisibleGeoInstances = 0;
+  for (int i=0; i<iNumGeoInstances; i++)
+  {
+    if (m_pSoftwareOcclusionBuffer->IsOccluded(pGeoInstances[i]->GetBoundingBox()))
+      continue;
+    pGeoInstances[iVisibleGeoInstances++] = pGeoInstances[i];
+  }
+  m_pVisibleStaticGeometryInstances->SetNumEntries(iVisibleGeoInstances);
+
+  m_iSoftwareOccludedCount = (iNumEntities - iVisibleEntities) + (iNumGeoInstances - iVisibleGeoInstances);
+}
+
+
 void VisionVisibilityCollector_cl::CollectVisibleSceneElements(VisVisibilityZone_cl *pZone, VisFrustum_cl *pFrustum)
 {
   int iPlaneFlags = 0;
@@ -1418,6 +1816,9 @@ void VisionVisibilityCollector_cl::CollectVisibleSceneElements(VisVisibilityZone
   int iNumVisObjectsInNode = pZone->GetVisObjects()->GetNumEntries();
   m_bUsedWorkflow = false;
 
+  if (m_bUsePackedBounds && (m_eSceneElementFlags & VIS_SCENEELEMENT_WORLDGEOMETRY) && eClipResult != VIS_CLIPPINGRESULT_UNCHANGED && iNumGeomInstancesInZone > 0)
+    UpdatePackedGeometryBounds(pZone);
+
 #ifdef SUPPORTS_MULTITHREADING
   if (s_bUseWorkflow && pFrustum != NULL)
   {
@@ -1474,6 +1875,18 @@ void VisionVisibilityCollector_cl::CollectVisibleSceneElements(VisVisibilityZone
   }
   else
 
+
+  if (m_bUseZoneJobs)
+  {
+    if (m_eSceneElementFlags & VIS_SCENEELEMENT_WORLDGEOMETRY)
+      AddZoneCullingTask(pZone, VIS_SCENEELEMENT_WORLDGEOMETRY, iNumGeomInstancesInZone, pFrustum, iPlaneFlags, vCameraPos, fLODScaleSqr, eClipResult);
+    if (m_eSceneElementFlags & VIS_SCENEELEMENT_ENTITIES)
+      AddZoneCullingTask(pZone, VIS_SCENEELEMENT_ENTITIES, iNumEntitiesInNode, pFrustum, iPlaneFlags, vCameraPos, fLODScaleSqr, eClipResult);
+    if (m_eSceneElementFlags & VIS_SCENEELEMENT_VISOBJECTS)
+      AddZoneCullingTask(pZone, VIS_SCENEELEMENT_VISOBJECTS, iNumVisObjectsInNode, pFrustum, iPlaneFlags, vCameraPos, fLODScaleSqr, eClipResult);
+  }
+  else
+
 #endif  // SUPPORTS_MULTITHREADING
   {
     if (m_eSceneElementFlags & VIS_SCENEELEMENT_WORLDGEOMETRY)
@@ -1512,15 +1925,40 @@ void VisionVisibilityCollector_cl::CollectVisibleSceneElements(VisVisibilityZone
 }
 
 void VisionVisibilityCollector_cl::CollectWorldGeometry(VisVisibilityZone_cl* pZone, int iNumGeomInstancesInZone, VisFrustum_cl* pFrustum, int iPlaneFlags,
-  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult)
+  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult, VisStaticGeometryInstanceCollection_cl *pDestList)
 {
   if (iNumGeomInstancesInZone == 0)
     return;
 
-  m_pVisibleStaticGeometryInstances->EnsureSize(m_pVisibleStaticGeometryInstances->GetNumEntries() + iNumGeomInstancesInZone);
+  if (pDestList == NULL)
+    pDestList = m_pVisibleStaticGeometryInstances;
+  pDestList->EnsureSize(pDestList->GetNumEntries() + iNumGeomInstancesInZone);
   VisStaticGeometryInstance_cl **pDataInZone = pZone->GetStaticGeometryInstances()->GetDataPtr();
   VASSERT(pDataInZone != NULL);
 
+  const VisZonePackedBounds_cl *pPackedBounds = (eClipResult != VIS_CLIPPINGRESULT_UNCHANGED) ? GetPackedGeometryBounds(pZone, iNumGeomInstancesInZone) : NULL;
+  if (pPackedBounds != NULL)
+  {
+    // Test 4 packed boxes at a time; only the instances that overlap the frustum are touched.
+    // IsClipped does not modify any state, so testing it after the frustum does not change the result.
+    const float *pBlock = pPackedBounds->GetBlocks();
+    for (int iFirst = 0; iFirst < iNumGeomInstancesInZone; iFirst += VIS_PACKEDBOUNDS_BLOCKSIZE, pBlock += VIS_PACKEDBOUNDS_BLOCKFLOATS)
+    {
+      int iMask = GetPackedOverlapMask(*pFrustum, iPlaneFlags, pBlock);
+      if (iNumGeomInstancesInZone - iFirst < VIS_PACKEDBOUNDS_BLOCKSIZE)
+        iMask &= (1 << (iNumGeomInstancesInZone - iFirst)) - 1;
+      for (int j = 0; iMask != 0; j++, iMask >>= 1)
+      {
+        if (!(iMask & 1))
+          continue;
+        VisStaticGeometryInstance_cl *pGeoInstance = pDataInZone[iFirst + j];
+        if (!pGeoInstance->IsClipped(m_iFilterBitmask, vCameraPos, fLODScaleSqr))
+          pDestList->AppendEntryFast(pGeoInstance);
+      }
+    }
+    return;
+  }
+
   // Prefetch first 2 instances (we look ahead 2 in the loop below).  For each instance do 2 prefetches to make sure
   // sure we get all the data referenced in case the object straddles a cache line.  m_BoundingBox is the first piece
   // of data referenced in the instance and m_fNearClipDistance will ensure we get the rest of the object.
@@ -1548,7 +1986,7 @@ void VisionVisibilityCollector_cl::CollectWorldGeometry(VisVisibilityZone_cl* pZ
     {
       continue;
     }
-    m_pVisibleStaticGeometryInstances->AppendEntryFast(pGeoInstance);
+    pDestList->AppendEntryFast(pGeoInstance);
   }
   // last 2 elements
   for (; i < iNumGeomInstancesInZone; i++, pDataInZone++)
@@ -1562,14 +2000,16 @@ void VisionVisibilityCollector_cl::CollectWorldGeometry(VisVisibilityZone_cl* pZ
     {
       continue;
     }
-    m_pVisibleStaticGeometryInstances->AppendEntryFast(pGeoInstance);
+    pDestList->AppendEntryFast(pGeoInstance);
   }
 }
 
 void VisionVisibilityCollector_cl::CollectEntities(VisVisibilityZone_cl* pZone, int iNumEntitiesInNode, VisFrustum_cl* pFrustum, int iPlaneFlags,
-  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult)
+  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult, VisEntityCollection_cl *pDestList)
 {
-  m_pVisibleEntities->EnsureSize(m_pVisibleEntities->GetNumEntries() + iNumEntitiesInNode);
+  if (pDestList == NULL)
+    pDestList = m_pVisibleEntities;
+  pDestList->EnsureSize(pDestList->GetNumEntries() + iNumEntitiesInNode);
   VisBaseEntity_cl **pDataInNode = pZone->GetEntities()->GetDataPtr();
 
   #if defined(WIN32)
@@ -1577,10 +2017,23 @@ void VisionVisibilityCollector_cl::CollectEntities(VisVisibilityZone_cl* pZone,
     iPlaneFlags &= m_iEntityPlaneFlagsMask;
   #endif
 
+  // Entities move, so their boxes are gathered in groups of 4 and tested together instead of being cached
+  const bool bPackedTest = m_bUsePackedBounds && (eClipResult != VIS_CLIPPINGRESULT_UNCHANGED);
+  float packedBlock[VIS_PACKEDBOUNDS_BLOCKFLOATS];
+  int iOverlapMask = 0;
+
   for (int i=0; i<iNumEntitiesInNode; i++, pDataInNode++)
   {
     VisBaseEntity_cl *pEntity = *pDataInNode;
 
+    if (bPackedTest && (i % VIS_PACKEDBOUNDS_BLOCKSIZE) == 0)
+    {
+      const int iBlockCount = hkvMath::Min(VIS_PACKEDBOUNDS_BLOCKSIZE, iNumEntitiesInNode - i);
+      for (int j=0; j<VIS_PACKEDBOUNDS_BLOCKSIZE; j++)
+        PackBoundingBox(packedBlock, j, *pDataInNode[hkvMath::Min(j, iBlockCount-1)]->GetCurrentVisBoundingBoxPtr());
+      iOverlapMask = GetPackedOverlapMask(*pFrustum, iPlaneFlags, packedBlock);
+    }
+
     #if defined(WIN32)
       // needed for dissolve feature in simulation package (so only needed in windows version)
       VLODState& lodState(GetLODState(pEntity->GetNumber()));
@@ -1600,20 +2053,27 @@ void VisionVisibilityCollector_cl::CollectEntities(VisVisibilityZone_cl* pZone,
     if (pEntity->IsNearOrFarClipped(fDistSqr))
       continue;
 
-    if (eClipResult != VIS_CLIPPINGRESULT_UNCHANGED)
+    if (bPackedTest)
+    {
+      if (!(iOverlapMask & (1 << (i % VIS_PACKEDBOUNDS_BLOCKSIZE))))
+        continue;
+    }
+    else if (eClipResult != VIS_CLIPPINGRESULT_UNCHANGED)
     {
       const hkvAlignedBBox *pBox = pEntity->GetCurrentVisBoundingBoxPtr();
       if (!pFrustum->Overlaps(*pBox, iPlaneFlags)) 
         continue;
     }
-    m_pVisibleEntities->AppendEntryFast((VisBaseEntity_cl *)pEntity);
+    pDestList->AppendEntryFast((VisBaseEntity_cl *)pEntity);
   }
 }
 
 void VisionVisibilityCollector_cl::CollectVisElements(VisVisibilityZone_cl* pZone, int iNumVisObjectsInNode, VisFrustum_cl* pFrustum, int iPlaneFlags,
-  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult)
+  const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult, VisVisibilityObjectCollection_cl *pDestList)
 {
-  m_pVisibleVisObjects->EnsureSize(m_pVisibleVisObjects->GetNumEntries() + iNumVisObjectsInNode);
+  if (pDestList == NULL)
+    pDestList = m_pVisibleVisObjects;
+  pDestList->EnsureSize(pDestList->GetNumEntries() + iNumVisObjectsInNode);
   VisVisibilityObject_cl **pDataInNode = pZone->GetVisObjects()->GetDataPtr();
 
   for (int i=0; i<iNumVisObjectsInNode; i++, pDataInNode++)
@@ -1630,11 +2090,13 @@ void VisionVisibilityCollector_cl::CollectVisElements(VisVisibilityZone_cl* pZon
         continue;
     }
 
-    if (!(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN))
+    // OnTestVisible is user code that is not required to be thread-safe. Zone jobs (pDestList is a
+    // task's private list) leave it to the serial pass in PostProcessVisibilityResults.
+    if (!(iFlags&VISTESTFLAGS_TESTVISIBLE_NOT_OVERRIDDEN) && pDestList==m_pVisibleVisObjects)
       if (!pVisObject->OnTestVisible(this, pFrustum))
         continue;
 
-    m_pVisibleVisObjects->AppendEntryFast(pVisObject);
+    pDestList->AppendEntryFast(pVisObject);
   }
 }
 
@@ -2002,6 +2464,48 @@ void VisVisibilityCollectorTask_cl::Run(VManagedThread *pThread)
   m_pVisibilityCollector->PerformVisibilityDetermination(m_iFilterBitmask);
 }
 
+
+V_IMPLEMENT_DYNAMIC(VisZoneCullingTask_cl,VThreadedTask,Vision::GetEngineModule());
+
+VisZoneCullingTask_cl::VisZoneCullingTask_cl(VisionVisibilityCollector_cl *pVisibilityCollector)
+  : m_VisibleGeometryInstances(0, 256), m_VisibleEntities(0, 256), m_VisibleVisObjects(0, 256)
+{
+  m_pVisibilityCollector = pVisibilityCollector;
+  m_pZone = NULL;
+  m_eSceneElement = VIS_SCENEELEMENT_WORLDGEOMETRY;
+  m_iNumElements = 0;
+  m_bHasFrustum = false;
+  m_iPlaneFlags = 0;
+  m_vCameraPos.setZero();
+  m_fLODScaleSqr = 1.0f;
+  m_eClipResult = VIS_CLIPPINGRESULT_UNCHANGED;
+}
+
+void VisZoneCullingTask_cl::Run(VManagedThread *pThread)
+{
+  VisFrustum_cl *pFrustum = m_bHasFrustum ? &m_Frustum : NULL;
+
+  m_VisibleGeometryInstances.Clear();
+  m_VisibleEntities.Clear();
+  m_VisibleVisObjects.Clear();
+
+  switch (m_eSceneElement)
+  {
+  case VIS_SCENEELEMENT_WORLDGEOMETRY:
+    m_pVisibilityCollector->CollectWorldGeometry(m_pZone, m_iNumElements, pFrustum, m_iPlaneFlags, m_vCameraPos, m_fLODScaleSqr, m_eClipResult, &m_VisibleGeometryInstances);
+    break;
+  case VIS_SCENEELEMENT_ENTITIES:
+    m_pVisibilityCollector->CollectEntities(m_pZone, m_iNumElements, pFrustum, m_iPlaneFlags, m_vCameraPos, m_fLODScaleSqr, m_eClipResult, &m_VisibleEntities);
+    break;
+  case VIS_SCENEELEMENT_VISOBJECTS:
+    m_pVisibilityCollector->CollectVisElements(m_pZone, m_iNumElements, pFrustum, m_iPlaneFlags, m_vCameraPos, m_fLODScaleSqr, m_eClipResult, &m_VisibleVisObjects);
+    break;
+  default:
+    VASSERT(!"Unsupported scene element type for zone culling task");
+    break;
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // IVisVisibilityCollectorComponent_cl
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
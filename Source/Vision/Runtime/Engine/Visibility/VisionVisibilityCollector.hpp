@@ -14,9 +14,12 @@
 #include <Vision/Runtime/Engine/Visibility/VisApiObject3DVis.hpp>
 #include <Vision/Runtime/Engine/Visibility/VisApiPortal.hpp>
 #include <Vision/Runtime/Engine/Visibility/StreamProcessVisibilityJob.hpp>
+#include <Vision/Runtime/Engine/Visibility/VisionSoftwareOcclusion.hpp>
 
 // Forward declarations
 class VisVisibilityCollectorTask_cl;
+class VisZoneCullingTask_cl;
+class VisZonePackedBounds_cl;
 class VStreamProcessingWorkflow;
 class VLODHysteresisManager;
 
@@ -46,6 +49,10 @@ enum VisSceneElementTypes_e
 /// VIS_VISCOLLECTOR_USEZONEOCCLUSIONQUERY: Specify this flag if occlusion queries should be
 /// performed for portals and visibility zone bounding boxes.
 /// 
+/// VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION: Specify this flag if the visible entities and static
+/// geometry instances should additionally be tested against a CPU depth buffer of the registered
+/// VisSoftwareOccluder_cl objects. Requires VIS_VISCOLLECTOR_USEFOV.
+/// 
 /// VIS_VISCOLLECTOR_DEFAULTS_CAMERA: Defaults typically used for cameras/render contexts.
 /// 
 /// VIS_VISCOLLECTOR_DEFAULTS_LIGHT: Defaults typically used for omni lights.
@@ -54,6 +61,7 @@ enum VisVisibilityCollectorBehavior_e
   VIS_VISCOLLECTOR_USEFOV = 1,
   VIS_VISCOLLECTOR_USEPORTALS = 8,
   VIS_VISCOLLECTOR_USEZONEOCCLUSIONQUERY = 16,
+  VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION = 32,
   VIS_VISCOLLECTOR_DEFAULTS_CAMERA = VIS_VISCOLLECTOR_USEPORTALS | VIS_VISCOLLECTOR_USEFOV,
   VIS_VISCOLLECTOR_DEFAULTS_LIGHT = VIS_VISCOLLECTOR_USEPORTALS
 };
@@ -893,6 +901,87 @@ public:
   ///   Returns whether multi-threaded visibility determination is enabled or disabled.
   static inline bool GetMultithreaded() { return s_bMultithreaded; }
 
+
+  /// \brief
+  ///   Enables/disables per-zone culling jobs.
+  /// 
+  /// When enabled, the portal traversal stays serial, but the culling of the static geometry
+  /// instances, entities and visibility objects of each visited visibility zone is scheduled as a
+  /// separate VisZoneCullingTask_cl in the thread manager. Idle worker threads pick up these jobs
+  /// while the traversal continues. Each job writes into its own result buffer, and the buffers are
+  /// merged in traversal order at the end of PerformVisibilityDetermination, so the results are
+  /// identical to the single-threaded path.
+  /// 
+  /// Zone jobs are not used for the stream processing workflow or while LOD hysteresis thresholding
+  /// is active. Enabled by default on all platforms that support multithreading, except
+  /// Playstation 3.
+  static inline void SetUseZoneJobs(bool bStatus) { s_bUseZoneJobs = bStatus; }
+
+
+  /// \brief
+  ///   Returns whether per-zone culling jobs are enabled. See SetUseZoneJobs.
+  static inline bool GetUseZoneJobs() { return s_bUseZoneJobs; }
+
+
+  /// \brief
+  ///   Sets the minimum number of scene elements of one type a zone must contain for its culling to
+  ///   be scheduled as a separate job.
+  /// 
+  /// Zones with fewer elements are culled immediately in the traversing thread, since the overhead
+  /// of scheduling would outweigh the work. The default value is 64.
+  static inline void SetZoneJobMinElementCount(int iCount) { s_iZoneJobMinElementCount = iCount; }
+
+
+  /// \brief
+  ///   Returns the value previously set with SetZoneJobMinElementCount.
+  static inline int GetZoneJobMinElementCount() { return s_iZoneJobMinElementCount; }
+
+
+  /// \brief
+  ///   Enables/disables SIMD frustum culling of packed bounding boxes.
+  /// 
+  /// When enabled, each visibility collector keeps the bounding boxes of the static geometry
+  /// instances of every visited visibility zone in a packed structure-of-arrays layout and tests
+  /// four boxes at a time against the frustum planes. Only the instances that overlap the frustum
+  /// are accessed afterwards. Entity bounding boxes are gathered in groups of four and tested the
+  /// same way. The results are identical to VisFrustum_cl::Overlaps.
+  /// 
+  /// The packed boxes are rebuilt automatically when instances are added to or removed from a zone.
+  /// Code that modifies the bounding box of a static geometry instance which is already assigned
+  /// to a zone has to call VisVisibilityZone_cl::OnStaticGeometryBoundsChanged on these zones (or
+  /// InvalidatePackedBounds to rebuild all zones). Packed boxes are not used inside vForge. Enabled
+  /// by default.
+  static inline void SetUsePackedBounds(bool bStatus) { s_bUsePackedBounds = bStatus; }
+
+
+  /// \brief
+  ///   Returns whether SIMD frustum culling of packed bounding boxes is enabled. See
+  ///   SetUsePackedBounds.
+  static inline bool GetUsePackedBounds() { return s_bUsePackedBounds; }
+
+
+  /// \brief
+  ///   Forces all visibility collectors to rebuild their packed static geometry bounding boxes.
+  ///   See SetUsePackedBounds.
+  static inline void InvalidatePackedBounds() { s_iPackedBoundsRevision++; }
+
+
+  /// \brief
+  ///   Returns the software occlusion buffer of this collector, or NULL if software occlusion
+  ///   culling has not been performed yet.
+  /// 
+  /// If the VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION behavior flag is set, the registered
+  /// VisSoftwareOccluder_cl objects are rasterized into this buffer after the scene traversal, and
+  /// all visible entities and static geometry instances whose bounding boxes are hidden behind them
+  /// are removed before the results are post-processed.
+  inline VisSoftwareOcclusionBuffer_cl *GetSoftwareOcclusionBuffer() const { return m_pSoftwareOcclusionBuffer; }
+
+
+  /// \brief
+  ///   Returns the number of entities and static geometry instances removed by the last software
+  ///   occlusion culling pass.
+  inline int GetSoftwareOccludedCount() const { return m_iSoftwareOccludedCount; }
+
   inline void SetOverrideStartZone(VisVisibilityZone_cl *pZone) { m_pStartZone = pZone; }
   inline VisVisibilityZone_cl *GetOverrideStartZone() const { return m_pStartZone; }
 
@@ -1015,19 +1104,53 @@ protected:
   VISION_APIFUNC void DeInitVisibilityTask(VStreamProcessingTask *pTask);
 
   /// \brief
-  ///   Performs visibility collection for world geometry
+  ///   Schedules (or immediately executes) a zone culling job for one scene element type of the
+  ///   passed visibility zone. See SetUseZoneJobs.
+  VISION_APIFUNC void AddZoneCullingTask(VisVisibilityZone_cl* pZone, VisSceneElementTypes_e eSceneElement, int iNumElements, VisFrustum_cl* pFrustum,
+                                         int iPlaneFlags, const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult);
+
+  /// \brief
+  ///   Waits for all zone culling jobs and appends their results to the collections of visible
+  ///   scene elements in traversal order.
+  VISION_APIFUNC void FinishZoneCullingTasks();
+
+  /// \brief
+  ///   Rebuilds the packed static geometry bounding boxes of the passed zone if they are out of
+  ///   date. Must not be called while zone culling jobs for this zone are running.
+  VISION_APIFUNC void UpdatePackedGeometryBounds(VisVisibilityZone_cl* pZone);
+
+  /// \brief
+  ///   Returns the packed static geometry bounding boxes of the passed zone, or NULL if there are
+  ///   none for the current state of the zone.
+  VISION_APIFUNC const VisZonePackedBounds_cl *GetPackedGeometryBounds(VisVisibilityZone_cl* pZone, int iNumGeomInstancesInZone) const;
+
+  /// \brief
+  ///   Rasterizes the registered software occluders and removes hidden entities and static geometry
+  ///   instances from the collections of visible scene elements. Called at the end of
+  ///   PerformVisibilityDetermination if VIS_VISCOLLECTOR_USESOFTWAREOCCLUSION is set.
+  VISION_APIFUNC void PerformSoftwareOcclusionCulling();
+
+  /// \brief
+  ///   Performs visibility collection for world geometry. If pDestList is NULL, the visible
+  ///   instances are added to the collector's own collection.
   VISION_APIFUNC void CollectWorldGeometry(VisVisibilityZone_cl* pZone, int iNumGeomInstancesInZone, VisFrustum_cl* pFrustum, int iPlaneFlags,
-                                           const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult);
+                                           const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult,
+                                           VisStaticGeometryInstanceCollection_cl *pDestList = NULL);
 
   /// \brief
-  ///   Performs visibility collection for entities
+  ///   Performs visibility collection for entities. If pDestList is NULL, the visible entities are
+  ///   added to the collector's own collection.
   VISION_APIFUNC void CollectEntities(VisVisibilityZone_cl* pZone, int iNumEntitiesInNode, VisFrustum_cl* pFrustum, int iPlaneFlags,
-                                      const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult);
+                                      const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult,
+                                      VisEntityCollection_cl *pDestList = NULL);
 
   /// \brief
-  ///   Performs visibility collection for visbility elements
+  ///   Performs visibility collection for visbility elements. If pDestList is NULL, the visible
+  ///   objects are added to the collector's own collection. Otherwise OnTestVisible is not called
+  ///   here, but in the serial PostProcessVisibilityResults pass.
   VISION_APIFUNC void CollectVisElements(VisVisibilityZone_cl* pZone, int iNumVisObjectsInNode, VisFrustum_cl* pFrustum, int iPlaneFlags,
-                                         const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult);
+                                         const hkvVec3& vCameraPos, float fLODScaleSqr, VisClippingResult_e eClipResult,
+                                         VisVisibilityObjectCollection_cl *pDestList = NULL);
 
   #ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
     /// \brief
@@ -1095,6 +1218,24 @@ protected:
 
   VISION_APIDATA static bool s_bMultithreaded;         ///< If true, multi-threading is used (can be used in conjunction with stream processing)
   VISION_APIDATA static bool s_bUseWorkflow;           ///< If true, stream processing variant is used
+  VISION_APIDATA static bool s_bUseZoneJobs;           ///< If true, the culling of each visited zone is scheduled as separate jobs
+  VISION_APIDATA static int s_iZoneJobMinElementCount; ///< Zones with fewer elements of a type are culled in the traversing thread
+
+  // Relevant for zone culling jobs only:
+  bool m_bUseZoneJobs;                                 ///< Zone jobs are used in the current PerformVisibilityDetermination call
+  DynArray_cl<VisZoneCullingTask_cl *> m_ZoneTasks;    ///< Pool of zone culling tasks; the first m_iZoneTaskCount are in use
+  int m_iZoneTaskCount;
+
+  // Relevant for packed bounding boxes only:
+  VISION_APIDATA static bool s_bUsePackedBounds;       ///< If true, SIMD frustum culling of packed bounding boxes is used
+  VISION_APIDATA static unsigned int s_iPackedBoundsRevision; ///< Incremented by InvalidatePackedBounds
+  bool m_bUsePackedBounds;                             ///< Packed boxes are used in the current PerformVisibilityDetermination call
+  DynArray_cl<VisZonePackedBounds_cl *> m_ZonePackedBounds; ///< Packed static geometry boxes, indexed by visibility zone index
+
+  // Relevant for software occlusion culling only:
+  VisSoftwareOcclusionBuffer_cl *m_pSoftwareOcclusionBuffer; ///< Created on first use
+  VRefCountedCollection<VisSoftwareOccluder_cl> m_SoftwareOccluders; ///< Registered occluders, copied on the main thread before the visibility task starts
+  int m_iSoftwareOccludedCount;
   int m_iContextRenderFlags;
 
   #ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
@@ -1159,6 +1300,9 @@ protected:
 public:
   V_DECLARE_DYNAMIC_DLLEXP(VisionVisibilityCollector_cl,VISION_APIDATA)
 
+  friend class VisZoneCullingTask_cl;
+  friend class VisZonePackedBounds_cl;
+
 };
 
 typedef VSmartPtr<IVisVisibilityCollector_cl> IVisVisibilityCollectorPtr;
@@ -1186,6 +1330,40 @@ private:
 };
 
 
+/// \brief
+///   Task class that culls the scene elements of one type in a single visibility zone. See
+///   VisionVisibilityCollector_cl::SetUseZoneJobs.
+class VisZoneCullingTask_cl : public VThreadedTask
+{
+public:
+  VisZoneCullingTask_cl(VisionVisibilityCollector_cl *pVisibilityCollector);
+
+  virtual void Run(VManagedThread *pThread);
+
+  /// \brief
+  ///   RTTI macro
+  V_DECLARE_DYNAMIC_DLLEXP(VisZoneCullingTask_cl, VISION_APIFUNC);
+
+private:
+  friend class VisionVisibilityCollector_cl;
+
+  VisionVisibilityCollector_cl *m_pVisibilityCollector;
+  VisVisibilityZone_cl *m_pZone;
+  VisSceneElementTypes_e m_eSceneElement;
+  int m_iNumElements;
+  bool m_bHasFrustum;
+  VisFrustum_cl m_Frustum;          ///< copy, since the traversal modifies its frustum stack while the job runs
+  int m_iPlaneFlags;
+  hkvVec3 m_vCameraPos;
+  float m_fLODScaleSqr;
+  VisClippingResult_e m_eClipResult;
+
+  VisStaticGeometryInstanceCollection_cl m_VisibleGeometryInstances;
+  VisEntityCollection_cl m_VisibleEntities;
+  VisVisibilityObjectCollection_cl m_VisibleVisObjects;
+};
+
+
 /// \brief
 ///   Component class that can be attached to instances of IVisVisibilityCollector_cl via
 ///   AddComponent.
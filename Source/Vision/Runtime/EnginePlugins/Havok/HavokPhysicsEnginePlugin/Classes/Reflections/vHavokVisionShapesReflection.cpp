@@ -37,7 +37,8 @@ extern const hkClass hkpConvexVerticesShapeClass;
 
 const hkInternalClassMember hkvConvexVerticesShape::Members[] =
 {
-	{ "iFileTime", HK_NULL, HK_NULL, hkClassMember::TYPE_INT64, hkClassMember::TYPE_VOID, 0, 0, HK_OFFSET_OF(hkvConvexVerticesShape,m_iFileTime), HK_NULL }
+	{ "iFileTime", HK_NULL, HK_NULL, hkClassMember::TYPE_INT64, hkClassMember::TYPE_VOID, 0, 0, HK_OFFSET_OF(hkvConvexVerticesShape,m_iFileTime), HK_NULL },
+	{ "iContentHash", HK_NULL, HK_NULL, hkClassMember::TYPE_UINT64, hkClassMember::TYPE_VOID, 0, 0, HK_OFFSET_OF(hkvConvexVerticesShape,m_iContentHash), HK_NULL }
 };
 extern const hkClass hkvConvexVerticesShapeClass;
 const hkClass hkvConvexVerticesShapeClass(
@@ -53,7 +54,7 @@ const hkClass hkvConvexVerticesShapeClass(
 	HK_NULL, // defaults
 	HK_NULL, // attributes
 	0, // flags
-	hkUint32(0) // version
+	hkUint32(1) // version
 	);
 #ifndef HK_HKCLASS_DEFINITION_ONLY
 const hkClass& HK_CALL hkvConvexVerticesShape::staticClass()
@@ -161,6 +162,7 @@ extern const hkClass hkpBvCompressedMeshShapeClass;
 const hkInternalClassMember hkvBvCompressedMeshShape::Members[] =
 {
 	{ "iFileTime", HK_NULL, HK_NULL, hkClassMember::TYPE_INT64, hkClassMember::TYPE_VOID, 0, 0, HK_OFFSET_OF(hkvBvCompressedMeshShape,m_iFileTime), HK_NULL },
+	{ "iContentHash", HK_NULL, HK_NULL, hkClassMember::TYPE_UINT64, hkClassMember::TYPE_VOID, 0, 0, HK_OFFSET_OF(hkvBvCompressedMeshShape,m_iContentHash), HK_NULL },
 	{ "materials", &hkvMeshMaterialClass, HK_NULL, hkClassMember::TYPE_ARRAY, hkClassMember::TYPE_STRUCT, 0, 0, HK_OFFSET_OF(hkvBvCompressedMeshShape,m_materials), HK_NULL }
 };
 extern const hkClass hkvBvCompressedMeshShapeClass;
@@ -177,7 +179,7 @@ const hkClass hkvBvCompressedMeshShapeClass(
 	HK_NULL, // defaults
 	HK_NULL, // attributes
 	0, // flags
-	hkUint32(0) // version
+	hkUint32(1) // version
 	);
 #ifndef HK_HKCLASS_DEFINITION_ONLY
 const hkClass& HK_CALL hkvBvCompressedMeshShape::staticClass()
@@ -14,7 +14,6 @@
 #include <Common/Base/Config/hkConfigVersion.h>
 #include <Common/Base/System/Io/Writer/Buffered/hkBufferedStreamWriter.h>
 #include <Common/Base/System/Io/Reader/Buffered/hkBufferedStreamReader.h>
-#include <Common/Base/Reflection/hkClassMemberAccessor.h>
 #include <Common/Serialize/Util/hkSerializeUtil.h>
 #include <Common/Base/Reflection/Registry/hkVtableClassRegistry.h>
 
@@ -117,7 +116,7 @@ bool vHavokCachedShape::SaveTerrainSectorShape(const VTerrainSector *pSector, co
 // Loading
 // -------------------------------------------------------------------------- //
 
-hkvConvexVerticesShape* vHavokCachedShape::LoadConvexShape(VBaseMesh *pMesh, const hkvVec3& vScale, bool bShrinkToFit)
+hkvConvexVerticesShape* vHavokCachedShape::LoadConvexShape(VBaseMesh *pMesh, const hkvVec3& vScale, bool bShrinkToFit, hkUint64 *pContentHash)
 {
 #ifndef SUPPORTS_HKT
   return HK_NULL;
@@ -131,8 +130,21 @@ hkvConvexVerticesShape* vHavokCachedShape::LoadConvexShape(VBaseMesh *pMesh, con
   hkvConvexVerticesShape *pShape = (hkvConvexVerticesShape*)LoadShape(szCachedShapeName, hkvConvexVerticesShapeClass);
   if ((Vision::Editor.IsInEditor() || IsHktUpToDateCheckingEnabled()) && pShape!=HK_NULL)
   {
-    if (!IsHktUpToDate(pMesh, pShape, hkvConvexVerticesShapeClass))
+    const IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
+    VASSERT(pColMesh != NULL);
+
+    // the file time is a cheap early-out, the content hash is only computed when it matches
+    hkUint64 iContentHash = (pContentHash != NULL) ? *pContentHash : 0;
+    if (iContentHash == 0 && pShape->GetFileTime() == pColMesh->GetFileTime())
+      iContentHash = ComputeConvexShapeHash(pColMesh, vScale, bShrinkToFit);
+    if (pContentHash != NULL)
+      *pContentHash = iContentHash;
+
+    if (!IsHktUpToDate(pMesh, pShape->GetFileTime(), pColMesh->GetFileTime(), pShape->GetContentHash(), iContentHash))
+    {
+      pShape->removeReference();
       return HK_NULL;
+    }
   }
 
   return pShape;
@@ -140,7 +152,7 @@ hkvConvexVerticesShape* vHavokCachedShape::LoadConvexShape(VBaseMesh *pMesh, con
 }
 
 hkvBvCompressedMeshShape* vHavokCachedShape::LoadMeshShape(VBaseMesh *pMesh, const hkvVec3& vScale, VisStaticMeshInstance_cl::VisCollisionBehavior_e eCollisionBehavior, 
-                                           VisWeldingType_e eWeldingType)
+                                           VisWeldingType_e eWeldingType, hkUint64 *pContentHash)
 {
 #ifndef SUPPORTS_HKT
   return HK_NULL;
@@ -154,8 +166,21 @@ hkvBvCompressedMeshShape* vHavokCachedShape::LoadMeshShape(VBaseMesh *pMesh, con
   hkvBvCompressedMeshShape *pShape = (hkvBvCompressedMeshShape*)LoadShape(szCachedShapeName, hkvBvCompressedMeshShapeClass);
   if ((Vision::Editor.IsInEditor() || IsHktUpToDateCheckingEnabled()) && pShape!=HK_NULL)
   {
-    if (!IsHktUpToDate(pMesh, pShape, hkvBvCompressedMeshShapeClass))
+    const IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
+    VASSERT(pColMesh != NULL);
+
+    // the file time is a cheap early-out, the content hash is only computed when it matches
+    hkUint64 iContentHash = (pContentHash != NULL) ? *pContentHash : 0;
+    if (iContentHash == 0 && pShape->GetFileTime() == pColMesh->GetFileTime())
+      iContentHash = ComputeMeshShapeHash(pColMesh, vScale, eCollisionBehavior, eWeldingType);
+    if (pContentHash != NULL)
+      *pContentHash = iContentHash;
+
+    if (!IsHktUpToDate(pMesh, pShape->GetFileTime(), pColMesh->GetFileTime(), pShape->GetContentHash(), iContentHash))
+    {
+      pShape->removeReference();
       return HK_NULL;
+    }
   }
 
   return pShape;
@@ -312,25 +337,16 @@ hkpShape* vHavokCachedShape::LoadShape(const char *szCachedShapeName, const hkCl
   return pShape;
 }
 
-bool vHavokCachedShape::IsHktUpToDate(VBaseMesh *pMesh, hkpShape *pShape, const hkClass &expectedClass)
+bool vHavokCachedShape::IsHktUpToDate(VBaseMesh *pMesh, hkInt64 iCachedFileTime, hkInt64 iFileTime, hkUint64 iCachedHash, hkUint64 iExpectedHash)
 {
-  VASSERT(pMesh!=NULL && pShape!=NULL);
+  VASSERT(pMesh != NULL);
 
   const vHavokPhysicsModule *pModule = vHavokPhysicsModule::GetInstance();
   VASSERT(pModule != NULL);
   const bool bForceHktShapeCaching = pModule->IsHktShapeCachingEnforced();
 
-  // Get the collision mesh 
-  const IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
-  VASSERT(pColMesh != NULL);
-
-  // Get m_iFileTime member of custom Vision shape class via reflection
-  hkClassMemberAccessor accessor(pShape, expectedClass, "iFileTime");
-  VASSERT(accessor.isOk());
-  hkInt64 iFileTime = accessor.asInt64();
-
-  // Check whether cached file is still up to date
-  if (iFileTime != pColMesh->GetFileTime())
+  // Check whether cached file is still up to date and has been cooked from the current collision geometry with the current parameters
+  if (iCachedFileTime != iFileTime || iCachedHash != iExpectedHash)
   {
     if (!Vision::Editor.IsInEditor() && !bForceHktShapeCaching)
       Vision::Error.Warning("vHavokCachedShape::Load for %s failed since HKT file is outdated. Please re-generate HKT file (see documentation for details).", pMesh->GetFilename());
@@ -340,6 +356,119 @@ bool vHavokCachedShape::IsHktUpToDate(VBaseMesh *pMesh, hkpShape *pShape, const
   return true;
 }
 
+
+// -------------------------------------------------------------------------- //
+// Content hash
+// -------------------------------------------------------------------------- //
+
+// 64 bit FNV-1a
+#define HKVIS_CONTENT_HASH_OFFSET_BASIS  14695981039346656037ULL
+#define HKVIS_CONTENT_HASH_PRIME         1099511628211ULL
+
+static hkUint64 HashBytes(hkUint64 iHash, const void *pData, int iSize)
+{
+  const hkUint8 *pBytes = (const hkUint8*)pData;
+  for (int i=0; i<iSize; i++)
+    iHash = (iHash ^ pBytes[i]) * HKVIS_CONTENT_HASH_PRIME;
+  return iHash;
+}
+
+static inline hkUint64 HashInt(hkUint64 iHash, int iValue)
+{
+  return HashBytes(iHash, &iValue, sizeof(iValue));
+}
+
+static inline hkUint64 HashFloat(hkUint64 iHash, float fValue)
+{
+  return HashBytes(iHash, &fValue, sizeof(fValue));
+}
+
+static inline hkUint64 HashScale(hkUint64 iHash, const hkvVec3& vScale)
+{
+  // Use Havok instead of Vision scale to account for global HavokToVision scale.
+  const hkvVec3 vHavokScale = vScale * vHavokConversionUtils::GetVision2HavokScale();
+  iHash = HashFloat(iHash, vHavokScale.x);
+  iHash = HashFloat(iHash, vHavokScale.y);
+  return HashFloat(iHash, vHavokScale.z);
+}
+
+// Hashes everything of the collision mesh that vHavokShapeFactory uses for cooking.
+static hkUint64 HashCollisionMesh(hkUint64 iHash, const IVCollisionMesh *pColMesh)
+{
+  const VSimpleCollisionMeshBase *pMeshBase = pColMesh->GetMeshData();
+  VASSERT(pMeshBase != NULL);
+
+  const int iVertexCount = pMeshBase->GetVertexCount();
+  iHash = HashInt(iHash, iVertexCount);
+  if (iVertexCount > 0)
+    iHash = HashBytes(iHash, pMeshBase->GetVertexPtr(), iVertexCount*pMeshBase->GetVertexStride());
+
+  const int iIndexCount = pMeshBase->GetIndexCount();
+  iHash = HashInt(iHash, iIndexCount);
+  if (pMeshBase->m_pIndex16 != NULL)
+    iHash = HashBytes(iHash, pMeshBase->m_pIndex16, iIndexCount*sizeof(unsigned short));
+  else if (pMeshBase->m_pIndex32 != NULL)
+    iHash = HashBytes(iHash, pMeshBase->m_pIndex32, iIndexCount*sizeof(unsigned int));
+
+  const int iSubmeshCount = pColMesh->GetSubmeshCount();
+  iHash = HashInt(iHash, iSubmeshCount);
+  for (int i=0; i<iSubmeshCount; i++)
+  {
+    const VPhysicsSubmesh &submesh = pColMesh->GetSubmeshes()[i];
+    iHash = HashInt(iHash, submesh.iStartIndex);
+    iHash = HashInt(iHash, submesh.iNumIndices);
+    iHash = HashInt(iHash, submesh.iFirstVertexIndex);
+    iHash = HashInt(iHash, submesh.iLastVertexIndex);
+    iHash = HashInt(iHash, submesh.iGroupFilter);
+  }
+
+  const short *pTriSrfIndices = pColMesh->GetTriSrfIndices();
+  iHash = HashInt(iHash, pTriSrfIndices!=NULL ? 1 : 0);
+  if (pTriSrfIndices != NULL)
+  {
+    iHash = HashBytes(iHash, pTriSrfIndices, (iIndexCount/3)*sizeof(short));
+
+    const int iMaterialCount = pColMesh->GetMaterialCount();
+    iHash = HashInt(iHash, iMaterialCount);
+    for (int i=0; i<iMaterialCount; i++)
+    {
+      const VColMeshMaterial &material = pColMesh->GetMaterials()[i];
+      iHash = HashFloat(iHash, material.fDynamicFriction);
+      iHash = HashFloat(iHash, material.fRestitution);
+      const int iUserDataLen = material.szUserData.GetLen();
+      iHash = HashInt(iHash, iUserDataLen);
+      if (iUserDataLen > 0)
+        iHash = HashBytes(iHash, material.szUserData.AsChar(), iUserDataLen);
+    }
+  }
+
+  return iHash;
+}
+
+hkUint64 vHavokCachedShape::ComputeConvexShapeHash(const IVCollisionMesh *pColMesh, const hkvVec3& vScale, bool bShrinkToFit)
+{
+  VASSERT(pColMesh != NULL);
+
+  hkUint64 iHash = HKVIS_CONTENT_HASH_OFFSET_BASIS;
+  iHash = HashBytes(iHash, "C", 1);
+  iHash = HashScale(iHash, vScale);
+  iHash = HashInt(iHash, bShrinkToFit ? 1 : 0);
+  return HashCollisionMesh(iHash, pColMesh);
+}
+
+hkUint64 vHavokCachedShape::ComputeMeshShapeHash(const IVCollisionMesh *pColMesh, const hkvVec3& vScale, VisStaticMeshInstance_cl::VisCollisionBehavior_e eCollisionBehavior, 
+                                                 VisWeldingType_e eWeldingType)
+{
+  VASSERT(pColMesh != NULL);
+
+  hkUint64 iHash = HKVIS_CONTENT_HASH_OFFSET_BASIS;
+  iHash = HashBytes(iHash, "M", 1);
+  iHash = HashScale(iHash, vScale);
+  iHash = HashInt(iHash, (int)eCollisionBehavior);
+  iHash = HashInt(iHash, (int)eWeldingType);
+  return HashCollisionMesh(iHash, pColMesh);
+}
+
 /*
  * Havok SDK - Base file, BUILD(#20131019)
  * 
@@ -100,9 +100,14 @@ public:
   /// \param bShrinkToFit
   ///   Specifies whether convex shape is shrunken by convex radius so that its surface is as close as possible to the graphical one.
   /// 
+  /// \param pContentHash
+  ///   Optional. If it points to a non-zero value, that value is used as the expected content hash (see ComputeConvexShapeHash).
+  ///   Otherwise the hash computed for the up to date check is returned in it, so that it can be reused for cooking the shape.
+  ///   It stays 0 if no hash had to be computed.
+  /// 
   /// \returns 
   ///   Pointer to loaded shape if successful, NULL otherwise.
-  static hkvConvexVerticesShape* LoadConvexShape(VBaseMesh *pMesh, const hkvVec3& vScale, bool bShrinkToFit);
+  static hkvConvexVerticesShape* LoadConvexShape(VBaseMesh *pMesh, const hkvVec3& vScale, bool bShrinkToFit, hkUint64 *pContentHash = NULL);
 
   /// \brief
   ///   Loads hkvBvCompressedMeshShape from HKT file. 
@@ -119,10 +124,13 @@ public:
   /// \param eWeldingType
   ///   Welding type.
   ///
+  /// \param pContentHash
+  ///   Optional, see LoadConvexShape (with ComputeMeshShapeHash).
+  ///
   /// \returns 
   ///   Pointer to loaded shape if successful, NULL otherwise.
   static hkvBvCompressedMeshShape* LoadMeshShape(VBaseMesh *pMesh, const hkvVec3& vScale, VisStaticMeshInstance_cl::VisCollisionBehavior_e eCollisionBehavior, 
-                                                 VisWeldingType_e eWeldingType);
+                                                 VisWeldingType_e eWeldingType, hkUint64 *pContentHash = NULL);
 
 #ifdef SUPPORTS_TERRAIN
   /// \brief
@@ -146,7 +154,7 @@ public:
   ///
 
   /// \brief
-  ///   Returns whether HKT files are checked on loading for being up to date.
+  ///   Returns whether HKT files are checked on loading for being up to date (see ComputeConvexShapeHash).
   VHAVOK_IMPEXP static inline bool IsHktUpToDateCheckingEnabled() 
   {
     return s_bCheckHktUpToDate;
@@ -170,6 +178,52 @@ public:
   /// @}
   ///
 
+  ///
+  /// @name Content Hash
+  /// @{
+  ///
+
+  /// \brief
+  ///   Computes the content hash of a convex shape. 
+  ///
+  /// The hash covers the vertices, indices, sub meshes and materials of the collision mesh as well as all parameters 
+  /// the shape is cooked with. It is stored in the HKT file and used to decide whether the file is still up to date.
+  ///
+  /// \note
+  ///   Storing the hash raised the reflected version of hkvConvexVerticesShape and hkvBvCompressedMeshShape to 1.
+  ///   HKT files written before fail to load and have to be re-generated, e.g. with the HavokShapePreCooker sample.
+  ///
+  /// \param pColMesh
+  ///   Collision mesh the shape is created from.
+  /// 
+  /// \param vScale
+  ///   Scale of the corresponding mesh.
+  /// 
+  /// \param bShrinkToFit
+  ///   Specifies whether convex shape is shrunken by convex radius.
+  VHAVOK_IMPEXP static hkUint64 ComputeConvexShapeHash(const IVCollisionMesh *pColMesh, const hkvVec3& vScale, bool bShrinkToFit);
+
+  /// \brief
+  ///   Computes the content hash of a mesh shape. See ComputeConvexShapeHash.
+  ///
+  /// \param pColMesh
+  ///   Collision mesh the shape is created from.
+  /// 
+  /// \param vScale
+  ///   Scale of the corresponding mesh.
+  /// 
+  /// \param eCollisionBehavior
+  ///   Collision behavior.
+  ///
+  /// \param eWeldingType
+  ///   Welding type.
+  VHAVOK_IMPEXP static hkUint64 ComputeMeshShapeHash(const IVCollisionMesh *pColMesh, const hkvVec3& vScale, 
+    VisStaticMeshInstance_cl::VisCollisionBehavior_e eCollisionBehavior, VisWeldingType_e eWeldingType);
+
+  ///
+  /// @}
+  ///
+
   ///
   /// @name Path helpers 
   /// @{
@@ -201,7 +255,7 @@ private:
 
   static hkpShape* LoadShape(const char *szCachedShapeName, const hkClass &expectedClass);
 
-  static bool IsHktUpToDate(VBaseMesh *pMesh, hkpShape *pShape, const hkClass &expectedClass);
+  static bool IsHktUpToDate(VBaseMesh *pMesh, hkInt64 iCachedFileTime, hkInt64 iFileTime, hkUint64 iCachedHash, hkUint64 iExpectedHash);
 
   static bool s_bCheckHktUpToDate; // When true, HKT files are checked on loading whether they are still up to date.
 
@@ -111,6 +111,16 @@ unsigned int g_iHavokMaxThreads = hkvMath::Min<int> (vHavokCpuJobThreadPool::MAX
 #define RAYCAST_THREAD_THRESHOLD 10
 #define RAYCAST_THREAD_RESULTS_PER_CMD 10 // please note: MAXIMUM_RESULTS_CAPACITY = 32
 
+#define RAYCAST_BATCH_MIN_GROUP_SIZE 4            // smaller groups of a raycast batch are cast without a broadphase AABB cache
+#define RAYCAST_BATCH_MAX_GROUP_SIZE 64
+#define RAYCAST_BATCH_COHERENCE_FACTOR hkReal(2.0) // maximum group extent relative to the largest ray of the group
+#define RAYCAST_BATCH_MIN_GROUP_EXTENT hkReal(1.0) // groups of short rays may always grow to this extent (in Havok units)
+#define RAYCAST_BATCH_MAX_TASKS 16
+
+#define HAVOK2VISION_PARALLEL_THRESHOLD 512       // minimum number of rigid bodies to synchronize in parallel
+#define HAVOK2VISION_MIN_CHUNK_SIZE 128
+#define HAVOK2VISION_MAX_TASKS 16
+
 #define BROADPHASE_SIZE_TOLERANCE hkReal(10.0)
 
 // -------------------------------------------------------------------------- //
@@ -383,6 +393,274 @@ protected:
 
 };
 
+// -------------------------------------------------------------------------- //
+// Batched raycasts                                                           //
+// -------------------------------------------------------------------------- //
+
+// Sort key of a ray in a raycast batch
+struct vHavokRaycastBatchKey
+{
+  hkUint32 m_iKey;
+  int m_iRay;
+};
+
+static bool CompareRaycastBatchKeys(const vHavokRaycastBatchKey &a, const vHavokRaycastBatchKey &b)
+{
+  if (a.m_iKey != b.m_iKey)
+    return a.m_iKey < b.m_iKey;
+  return a.m_iRay < b.m_iRay;
+}
+
+// Inserts two zero bits between each of the lower 10 bits of x (for 3D Morton codes)
+static inline hkUint32 SpreadMortonBits(hkUint32 x)
+{
+  x &= 0x3ff;
+  x = (x | (x << 16)) & 0x030000ff;
+  x = (x | (x <<  8)) & 0x0300f00f;
+  x = (x | (x <<  4)) & 0x030c30c3;
+  x = (x | (x <<  2)) & 0x09249249;
+  return x;
+}
+
+static inline hkReal GetMaxExtent(const hkAabb &aabb)
+{
+  hkVector4 vExtents;
+  aabb.getExtents(vExtents);
+  return vExtents.horizontalMax<3>().getReal();
+}
+
+/// Rays of a vHavokPhysicsModule::PerformRaycasts call, sorted into groups of spatially coherent rays.
+/// The rays that only collect the closest hit come first, followed by the rays that collect all hits.
+class vHavokRaycastBatch
+{
+public:
+  struct Group_t
+  {
+    hkAabb m_aabb;        ///< bounding box of all rays of the group
+    int m_iFirstRay;
+    int m_iRayCount;
+    bool m_bUseCache;     ///< whether a broadphase AABB cache is built for the group
+    bool m_bSinglePoint;  ///< whether all rays of the group share the same start point
+  };
+
+  vHavokRaycastBatch(const hkpWorld *pWorld) : m_pWorld(pWorld), m_iNumClosestHitRays(0)
+  {
+  }
+
+  void Init(VisPhysicsRaycastBase_cl **ppRaycastData, int iCount)
+  {
+    // Convert the rays and compute the bounding box of the whole batch
+    hkArray<hkpWorldRayCastInput> inputs;
+    inputs.setSize(iCount);
+    hkAabb batchAabb;
+    batchAabb.setEmpty();
+    for (int i=0; i<iCount; i++)
+    {
+      hkpWorldRayCastInput &input = inputs[i];
+      vHavokConversionUtils::VisVecToPhysVecWorld(ppRaycastData[i]->vRayStart, input.m_from);
+      vHavokConversionUtils::VisVecToPhysVecWorld(ppRaycastData[i]->vRayEnd, input.m_to);
+      input.m_enableShapeCollectionFilter = true;
+      input.m_filterInfo = ppRaycastData[i]->iCollisionBitmask;
+      batchAabb.includePoint(input.m_from);
+      batchAabb.includePoint(input.m_to);
+    }
+
+    // Sort the rays by their collector type and by the Morton code of their center, so that
+    // neighboring rays end up next to each other
+    hkVector4 vBatchExtents;
+    batchAabb.getExtents(vBatchExtents);
+    hkReal fQuantize[3];
+    for (int k=0; k<3; k++)
+      fQuantize[k] = (vBatchExtents(k) > hkReal(0)) ? hkReal(1023) / vBatchExtents(k) : hkReal(0);
+
+    hkArray<vHavokRaycastBatchKey> keys;
+    keys.setSize(iCount);
+    m_iNumClosestHitRays = 0;
+    for (int i=0; i<iCount; i++)
+    {
+      const hkpWorldRayCastInput &input = inputs[i];
+      hkUint32 iKey = 0;
+      for (int k=0; k<3; k++)
+      {
+        const hkReal fCenter = hkReal(0.5) * (input.m_from(k) + input.m_to(k));
+        const int iCell = hkvMath::clamp((int)((fCenter - batchAabb.m_min(k)) * fQuantize[k]), 0, 1023);
+        iKey |= SpreadMortonBits((hkUint32)iCell) << k;
+      }
+
+      if (ppRaycastData[i]->allHits())
+        iKey |= 0x80000000;
+      else
+        m_iNumClosestHitRays++;
+
+      keys[i].m_iKey = iKey;
+      keys[i].m_iRay = i;
+    }
+    hkAlgorithm::quickSort(keys.begin(), iCount, CompareRaycastBatchKeys);
+
+    // Sweep through the sorted rays and grow each group as long as its bounding box stays
+    // small compared to the rays in it
+    m_inputs.setSize(iCount);
+    m_rayIndex.setSize(iCount);
+    m_groups.clear();
+    m_groups.reserve(iCount);
+
+    Group_t *pGroup = HK_NULL;
+    hkReal fMaxRayExtent = hkReal(0);
+    for (int i=0; i<iCount; i++)
+    {
+      const hkpWorldRayCastInput &input = inputs[keys[i].m_iRay];
+      m_inputs[i] = input;
+      m_rayIndex[i] = keys[i].m_iRay;
+
+      hkAabb rayAabb;
+      rayAabb.setFromLine(input.m_from, input.m_to);
+      const hkReal fRayExtent = GetMaxExtent(rayAabb);
+
+      if (pGroup != HK_NULL && i != m_iNumClosestHitRays && pGroup->m_iRayCount < RAYCAST_BATCH_MAX_GROUP_SIZE)
+      {
+        hkAabb mergedAabb;
+        mergedAabb.setUnion(pGroup->m_aabb, rayAabb);
+        const hkReal fNewMaxRayExtent = hkvMath::Max(fMaxRayExtent, fRayExtent);
+        if (GetMaxExtent(mergedAabb) <= RAYCAST_BATCH_COHERENCE_FACTOR * hkvMath::Max(fNewMaxRayExtent, RAYCAST_BATCH_MIN_GROUP_EXTENT))
+        {
+          pGroup->m_aabb = mergedAabb;
+          pGroup->m_iRayCount++;
+          pGroup->m_bSinglePoint = pGroup->m_bSinglePoint && input.m_from.allExactlyEqual<3>(m_inputs[pGroup->m_iFirstRay].m_from);
+          fMaxRayExtent = fNewMaxRayExtent;
+          continue;
+        }
+      }
+
+      pGroup = &m_groups.expandOne();
+      pGroup->m_aabb = rayAabb;
+      pGroup->m_iFirstRay = i;
+      pGroup->m_iRayCount = 1;
+      pGroup->m_bSinglePoint = true;
+      fMaxRayExtent = fRayExtent;
+    }
+
+    // Building the AABB cache only pays off if it is used by a couple of rays
+    for (int i=0; i<m_groups.getSize(); i++)
+      m_groups[i].m_bUseCache = (m_groups[i].m_iRayCount >= RAYCAST_BATCH_MIN_GROUP_SIZE);
+
+    m_closestHitCollectors.setSize(m_iNumClosestHitRays);
+    m_allHitCollectors.setSize(iCount - m_iNumClosestHitRays);
+  }
+
+  /// Casts the rays of the groups iFirstGroup..iFirstGroup+iGroupCount-1. Can be called from
+  /// multiple threads at the same time for distinct groups while the world is locked read-only.
+  void CastGroups(int iFirstGroup, int iGroupCount)
+  {
+    m_pWorld->markForRead();
+    const hkpBroadPhase &broadPhase = *m_pWorld->getBroadPhase();
+    const hkpCollisionFilter *pFilter = m_pWorld->getCollisionFilter();
+
+    hkpWorldRayCaster rayCaster;
+    hkpBroadPhaseAabbCache *pCache = HK_NULL;
+    int iCacheSize = 0;
+
+    for (int g=iFirstGroup; g<iFirstGroup+iGroupCount; g++)
+    {
+      const Group_t &group = m_groups[g];
+
+      const hkpBroadPhaseAabbCache *pGroupCache = HK_NULL;
+      if (group.m_bUseCache)
+      {
+        // The cache memory is reused for all groups of this call
+        if (pCache == HK_NULL)
+        {
+          iCacheSize = broadPhase.getAabbCacheSize();
+          pCache = hkAllocateStack<hkpBroadPhaseAabbCache>(iCacheSize, "vHavokRaycastBatch");
+        }
+        broadPhase.calcAabbCache(group.m_aabb, pCache);
+        pGroupCache = pCache;
+      }
+
+      if (group.m_bSinglePoint && group.m_iRayCount > 1)
+      {
+        const int iStride = (group.m_iFirstRay < m_iNumClosestHitRays) ? sizeof(hkpClosestRayHitCollector) : sizeof(hkpAllRayHitCollector);
+        rayCaster.castRaysFromSinglePoint(broadPhase, &m_inputs[group.m_iFirstRay], group.m_iRayCount, pFilter, pGroupCache,
+          GetCollector(group.m_iFirstRay), iStride);
+      }
+      else
+      {
+        for (int i=group.m_iFirstRay; i<group.m_iFirstRay+group.m_iRayCount; i++)
+          rayCaster.castRay(broadPhase, m_inputs[i], pFilter, pGroupCache, *GetCollector(i));
+      }
+    }
+
+    if (pCache != HK_NULL)
+      hkDeallocateStack(pCache, iCacheSize);
+    m_pWorld->unmarkForRead();
+  }
+
+  inline hkpRayHitCollector* GetCollector(int iSortedRay)
+  {
+    if (iSortedRay < m_iNumClosestHitRays)
+      return &m_closestHitCollectors[iSortedRay];
+    return &m_allHitCollectors[iSortedRay - m_iNumClosestHitRays];
+  }
+
+  const hkpWorld *m_pWorld;
+  int m_iNumClosestHitRays;
+  hkArray<hkpWorldRayCastInput> m_inputs;   ///< rays in sorted order
+  hkArray<int> m_rayIndex;                  ///< index of each sorted ray in the array passed to Init
+  hkArray<Group_t> m_groups;
+  hkArray<hkpClosestRayHitCollector> m_closestHitCollectors;
+  hkArray<hkpAllRayHitCollector> m_allHitCollectors;
+};
+
+/// Task that casts a range of groups of a vHavokRaycastBatch
+class vHavokRaycastBatchTask : public VThreadedTask
+{
+public:
+  vHavokRaycastBatchTask() : m_pBatch(HK_NULL), m_iFirstGroup(0), m_iGroupCount(0) {}
+  virtual ~vHavokRaycastBatchTask() {}
+
+  vHavokRaycastBatch *m_pBatch;
+  int m_iFirstGroup, m_iGroupCount;
+
+  virtual void Run(VManagedThread *pThread) HKV_OVERRIDE
+  {
+    m_pBatch->CastGroups(m_iFirstGroup, m_iGroupCount);
+  }
+};
+
+
+// -------------------------------------------------------------------------- //
+// Parallel Havok to Vision synchronization                                   //
+// -------------------------------------------------------------------------- //
+
+/// Task that computes the owner transformations of a range of rigid bodies
+class vHavokOwnerSyncTask : public VThreadedTask
+{
+public:
+  vHavokOwnerSyncTask() : m_pWorld(HK_NULL), m_ppRigidBodies(HK_NULL), m_pTransforms(HK_NULL), m_iCount(0) {}
+  virtual ~vHavokOwnerSyncTask() {}
+
+  const hkpWorld *m_pWorld;
+  vHavokRigidBody **m_ppRigidBodies;
+  vHavokOwnerTransform *m_pTransforms;
+  int m_iCount;
+
+  virtual void Run(VManagedThread *pThread) HKV_OVERRIDE
+  {
+    m_pWorld->markForRead();
+    for (int i = 0; i < m_iCount; i++)
+    {
+      vHavokRigidBody *pRigidBody = m_ppRigidBodies[i];
+      vHavokOwnerTransform &transform = m_pTransforms[i];
+
+      // Same condition as in vHavokRigidBody::UpdateOwner
+      transform.m_bUpdate = pRigidBody->IsOwnerUpdateRequired() && (pRigidBody->GetOwner() != NULL);
+      if (transform.m_bUpdate)
+        pRigidBody->GetHavok2VisionTransformation(transform.m_mRotation, transform.m_vPosition);
+    }
+    m_pWorld->unmarkForRead();
+  }
+};
+
+
 VHavokTask::VHavokTask(vHavokPhysicsModule *pModule)
 {
   m_pModule = pModule;
@@ -1482,6 +1760,7 @@ BOOL vHavokPhysicsModule::OnDeInitPhysics()
 
       V_SAFE_DELETE(m_pRayCasterSingle);
     V_SAFE_DELETE(m_pRayCasterMultiple);
+    m_rigidBodyOwnerTransforms.Reset();
 
     // Clean up physics
     if (m_pPhysicsWorld)
@@ -1651,6 +1930,10 @@ void vHavokPhysicsModule::OnRunPhysics( float fDuration )
     m_bUpdateFilter = false;
   }
 
+  // Swap in static mesh shapes that have been cooked in the background in the meantime
+  if (vHavokShapeFactory::GetPendingCookingTaskCount() > 0)
+    vHavokShapeFactory::ProcessCookingTasks(false);
+
   // Skip step when simulation is paused or is being stepped externally
   if (m_bPaused || m_steppedExternally)
     return;
@@ -1883,9 +2166,16 @@ void vHavokPhysicsModule::UpdateHavok2Vision()
   // Update rigid bodies
   {
     int iCount = m_simulatedRigidBodies.Count();
-    for (int i = 0; i < iCount; i++)
+    if (iCount >= HAVOK2VISION_PARALLEL_THRESHOLD && Vision::GetThreadManager()->GetThreadCount() > 0)
+    {
+      UpdateRigidBodyOwnersParallel();
+    }
+    else
     {
-      m_simulatedRigidBodies.GetAt(i)->UpdateOwner();
+      for (int i = 0; i < iCount; i++)
+      {
+        m_simulatedRigidBodies.GetAt(i)->UpdateOwner();
+      }
     }
   }  
 
@@ -1899,6 +2189,48 @@ void vHavokPhysicsModule::UpdateHavok2Vision()
   }  
 }
 
+void vHavokPhysicsModule::UpdateRigidBodyOwnersParallel()
+{
+  const int iCount = m_simulatedRigidBodies.Count();
+  vHavokRigidBody **ppRigidBodies = m_simulatedRigidBodies.GetPtrs();
+  m_rigidBodyOwnerTransforms.EnsureSize(iCount);
+  vHavokOwnerTransform *pTransforms = m_rigidBodyOwnerTransforms.GetDataPtr();
+
+  // Compute the transformations in chunks; the first chunk is processed in this thread
+  VThreadManager *pThreadManager = Vision::GetThreadManager();
+  int iTaskCount = hkvMath::Min(pThreadManager->GetThreadCount() + 1, iCount / HAVOK2VISION_MIN_CHUNK_SIZE);
+  iTaskCount = hkvMath::clamp(iTaskCount, 1, HAVOK2VISION_MAX_TASKS);
+
+  vHavokOwnerSyncTask tasks[HAVOK2VISION_MAX_TASKS];
+  for (int t = 0; t < iTaskCount; t++)
+  {
+    const int iFirst = (iCount * t) / iTaskCount;
+    const int iEnd = (iCount * (t + 1)) / iTaskCount;
+    tasks[t].m_pWorld = m_pPhysicsWorld;
+    tasks[t].m_ppRigidBodies = ppRigidBodies + iFirst;
+    tasks[t].m_pTransforms = pTransforms + iFirst;
+    tasks[t].m_iCount = iEnd - iFirst;
+    if (t > 0)
+      pThreadManager->ScheduleTask(&tasks[t]);
+  }
+
+  tasks[0].Run(NULL);
+  for (int t = 1; t < iTaskCount; t++)
+    pThreadManager->WaitForTask(&tasks[t], true);
+
+  // Apply the transformations in this thread, since this triggers engine callbacks
+  for (int i = 0; i < iCount; i++)
+  {
+    const vHavokOwnerTransform &transform = pTransforms[i];
+    if (!transform.m_bUpdate)
+      continue;
+
+    VisObject3D_cl *pOwner3d = ppRigidBodies[i]->GetOwner3D();
+    pOwner3d->SetPosition(transform.m_vPosition);
+    pOwner3d->SetRotationMatrix(transform.m_mRotation);
+  }
+}
+
 void vHavokPhysicsModule::SetPhysicsTickCount(int iTickCount,
   int iMaxTicksPerFrame, bool bFixedTicksPerFrame, float fMinPhysicsTimeStep, float fMaxPhysicsTimeStep)
 {
@@ -2110,7 +2442,7 @@ void vHavokPhysicsModule::PerformRaycast(VisPhysicsRaycastBase_cl *pRaycastData)
 
   // Note that in Havok there are lots of ways to speed up raycasting if you can batch them
   // and if they have some sort of coherence (See OptimizedWorldRaycast example in the Havok SDK)
-  // This will just do the raycast as asked, so will not be able to batch etc
+  // This will just do the raycast as asked, so will not be able to batch etc (use PerformRaycasts for that)
   m_pPhysicsWorld->lock();
 
   hkpWorldRayCastInput input;
@@ -2152,6 +2484,108 @@ void vHavokPhysicsModule::PerformRaycast(VisPhysicsRaycastBase_cl *pRaycastData)
   m_pPhysicsWorld->unlock();
 }
 
+void vHavokPhysicsModule::PerformRaycasts(VisPhysicsRaycastBase_cl **ppRaycastData, int iCount)
+{
+  VVERIFY_OR_RET(ppRaycastData != NULL || iCount == 0);
+  if (iCount <= 0)
+    return;
+
+  WaitForSimulationToComplete();
+
+  if (!m_pPhysicsWorld)
+    CreateWorld();
+
+  // Read-only locking allows the collision queries to run in multiple threads
+  m_pPhysicsWorld->lockReadOnly();
+
+  vHavokRaycastBatch batch(m_pPhysicsWorld);
+  batch.Init(ppRaycastData, iCount);
+
+  const int iGroupCount = batch.m_groups.getSize();
+  VThreadManager *pThreadManager = Vision::GetThreadManager();
+  int iTaskCount = 1;
+  if (iCount > RAYCAST_THREAD_THRESHOLD && iGroupCount > 1)
+  {
+    iTaskCount = hkvMath::Min(pThreadManager->GetThreadCount() + 1, iCount / RAYCAST_THREAD_THRESHOLD);
+    iTaskCount = hkvMath::Min(hkvMath::Min(iTaskCount, iGroupCount), RAYCAST_BATCH_MAX_TASKS);
+  }
+
+  if (iTaskCount > 1)
+  {
+    // Distribute the groups to tasks with roughly the same number of rays. The first task
+    // is executed in this thread.
+    vHavokRaycastBatchTask tasks[RAYCAST_BATCH_MAX_TASKS];
+    int iFirstGroup = 0;
+    int iRaysSoFar = 0;
+    for (int t=0; t<iTaskCount; t++)
+    {
+      const int iRayLimit = (iCount * (t+1)) / iTaskCount;
+      int iEndGroup = iFirstGroup;
+      do
+      {
+        iRaysSoFar += batch.m_groups[iEndGroup].m_iRayCount;
+        iEndGroup++;
+      } while (iEndGroup < iGroupCount - (iTaskCount-1-t) && iRaysSoFar < iRayLimit);
+
+      tasks[t].m_pBatch = &batch;
+      tasks[t].m_iFirstGroup = iFirstGroup;
+      tasks[t].m_iGroupCount = iEndGroup - iFirstGroup;
+      if (t > 0)
+        pThreadManager->ScheduleTask(&tasks[t]);
+      iFirstGroup = iEndGroup;
+    }
+    VASSERT(iFirstGroup == iGroupCount);
+
+    tasks[0].Run(NULL);
+    for (int t=1; t<iTaskCount; t++)
+      pThreadManager->WaitForTask(&tasks[t], true);
+  }
+  else
+  {
+    batch.CastGroups(0, iGroupCount);
+  }
+
+  m_pPhysicsWorld->unlockReadOnly();
+
+  // Pass the hits to the raycast objects in the original order
+  hkArray<int> sortedRay;
+  sortedRay.setSize(iCount);
+  for (int i=0; i<iCount; i++)
+    sortedRay[batch.m_rayIndex[i]] = i;
+
+  m_pPhysicsWorld->lock();
+
+  for (int i=0; i<iCount; i++)
+  {
+    const int iSortedRay = sortedRay[i];
+    if (iSortedRay < batch.m_iNumClosestHitRays)
+    {
+      const hkpWorldRayCastOutput& hit = batch.m_closestHitCollectors[iSortedRay].getHit();
+      if (hit.hasHit())
+      {
+        ForwardRaycastData(ppRaycastData[i], &hit);
+      }
+    }
+    else
+    {
+      hkpAllRayHitCollector& collector = batch.m_allHitCollectors[iSortedRay - batch.m_iNumClosestHitRays];
+      collector.sortHits();
+
+      const hkArray<hkpWorldRayCastOutput>& hits = collector.getHits();
+      for (int j=0; j<hits.getSize(); j++)
+      {
+        const hkpWorldRayCastOutput& hit = hits[j];
+        if (hit.hasHit())
+        {
+          ForwardRaycastData(ppRaycastData[i], &hit);
+        }
+      }
+    }
+  }
+
+  m_pPhysicsWorld->unlock();
+}
+
 void vHavokPhysicsModule::EnqueueRaycast(VisPhysicsRaycastBase_cl *pRaycastData)
 {
   pRaycastData->onEnqueued();
@@ -2733,6 +3167,21 @@ void vHavokPhysicsModule::RemoveStaticMesh(vHavokStaticMesh *pStaticMesh)
   m_simulatedStaticMeshes.Remove(pStaticMesh);
 }
 
+void vHavokPhysicsModule::ReplaceStaticMeshShape(const hkpShape *pOldShape, hkpShape *pNewShape)
+{
+  VVERIFY_OR_RET(pOldShape!=NULL && pNewShape!=NULL);
+
+  if (m_pPhysicsWorld)
+    m_pPhysicsWorld->markForWrite();
+
+  const int iCount = m_simulatedStaticMeshes.Count();
+  for (int i = 0; i < iCount; i++)
+    m_simulatedStaticMeshes.GetAt(i)->ReplaceShape(pOldShape, pNewShape);
+
+  if (m_pPhysicsWorld)
+    m_pPhysicsWorld->unmarkForWrite();
+}
+
 
 // -------------------------------------------------------------------------- //
 // Terrain Management                                                         //
@@ -3755,6 +4204,9 @@ void vHavokPhysicsModule::TriggerCollisionScriptFunction(IVObjectComponent *pPhy
     VASSERT_MSG(false, "Unknown Collision!");
   }
 
+  // the handle only saves hashing the name; the function is looked up in the script globals on every call
+  static int s_iOnCollisionHandle = VScriptResourceManager::GlobalManager().GetFunctionHandle("OnCollision");
+
   //execute the callback on every script component with matching callback
   for(int i=0; i<pReceiver->Components().Count();i++)
   {
@@ -3763,7 +4215,7 @@ void vHavokPhysicsModule::TriggerCollisionScriptFunction(IVObjectComponent *pPhy
       VScriptComponent *pScriptComponent = (VScriptComponent *)(pReceiver->Components().GetPtrs()[i]);
 
       if(pScriptComponent->GetScriptInstance()!=NULL && pScriptComponent->HasFunction(VSCRIPT_FUNC_ONCOLLISION))
-        pScriptComponent->GetScriptInstance()->ExecuteCollisionFunc("OnCollision", &scriptInfo);
+        pScriptComponent->GetScriptInstance()->ExecuteCollisionFunc(s_iOnCollisionHandle, &scriptInfo);
     }
   }
 }
@@ -152,6 +152,16 @@ public:
   virtual void Run(VManagedThread *pThread) HKV_OVERRIDE;
 };
 
+/// \brief
+///   Owner transformation of a rigid body, computed on a worker thread and applied in the main thread
+///   (see vHavokPhysicsModule::UpdateHavok2Vision).
+struct vHavokOwnerTransform
+{
+  hkvMat3 m_mRotation;
+  hkvVec3 m_vPosition;
+  bool m_bUpdate;       ///< false if the owner does not need to be updated
+};
+
 /// \brief
 ///   Generic callback data object for callbacks triggered by a vHavokPhysics
 //    module.
@@ -409,6 +419,28 @@ public:
   /// 
   VHAVOK_IMPEXP virtual void EnqueueRaycast(VisPhysicsRaycastBase_cl *pRaycastData) HKV_OVERRIDE;
 
+  /// 
+  /// \brief
+  ///   Immediately performs a batch of raycast operations. 
+  ///
+  /// The rays are sorted into groups of spatially coherent rays (e.g. line-of-sight tests fanning out from the
+  /// same position or the rays of a shotgun blast). For each group, a broadphase AABB cache is built once, so the
+  /// single rays of the group only have to traverse the broadphase objects inside the group's bounding box. Rays
+  /// sharing the same start point are cast together. For large batches, the groups are distributed to the worker
+  /// threads of the thread manager.
+  ///
+  /// The results are identical to calling PerformRaycast for each ray. All hit callbacks are triggered in the
+  /// calling thread after all rays have been cast, in the order of the passed rays.
+  /// 
+  /// \param ppRaycastData
+  ///   Array of raycast implementations defining the raycast behavior. These objects are also used for storing the
+  ///   results. Please note: use hkpGroupFilter::calcFilterInfo() to setup the iCollisionBitmask member 
+  ///
+  /// \param iCount
+  ///   Number of rays in ppRaycastData
+  /// 
+  VHAVOK_IMPEXP void PerformRaycasts(VisPhysicsRaycastBase_cl **ppRaycastData, int iCount);
+
   /// 
   /// \brief
   ///   Method called by the Vision engine whenever a new static mesh instance has been created.
@@ -1289,6 +1321,7 @@ protected:
   friend class vHavokConstraint;
   friend class vHavokConstraintChain;
   friend class vHavokStaticMesh;
+  friend class vHavokShapeFactory;
   friend class vHavokContactListener;
 #ifdef SUPPORTS_TERRAIN
   friend class vHavokTerrain;
@@ -1375,6 +1408,19 @@ protected:
   ///
   void RemoveStaticMesh(vHavokStaticMesh *pStaticMesh);
 
+  ///
+  /// \brief
+  ///   Replaces the shape of all static meshes that currently use pOldShape.
+  ///   Used by vHavokShapeFactory to swap in shapes that have been cooked in the background.
+  ///   
+  /// \param pOldShape
+  ///   Shape to be replaced.
+  ///
+  /// \param pNewShape
+  ///   New shape.
+  ///
+  void ReplaceStaticMeshShape(const hkpShape *pOldShape, hkpShape *pNewShape);
+
 #if defined(SUPPORTS_TERRAIN)
 
   ///
@@ -1495,6 +1541,16 @@ protected:
   ///
   void UpdateHavok2Vision();
 
+  ///
+  /// \brief
+  ///   Updates transforms of the simulated rigid bodies in parallel.
+  ///
+  /// The transformations are computed in chunks by tasks of the Vision thread manager. Setting
+  /// them on the owner objects triggers engine callbacks, so this is done afterwards in the calling
+  /// thread, in the order of the rigid body collection.
+  ///
+  void UpdateRigidBodyOwnersParallel();
+
   ///
   /// \brief
   ///   Performs the simulation for one frame.
@@ -1634,6 +1690,8 @@ protected:
 
   VArray<hkpEntityListener*> m_entityListenersToIgnore;
 
+  DynArray_cl<vHavokOwnerTransform> m_rigidBodyOwnerTransforms;                  ///< Owner transformations of the simulated rigid bodies, see UpdateRigidBodyOwnersParallel.
+
   hkSemaphoreBusyWait* m_pSweepSemaphore;                                         ///< Internally used to synchronized batched sweep tests.
 
   int m_iVisualDebuggerPort;                                                      ///< The port to configure to listen at for Visual Debugger Connections.
@@ -1301,15 +1301,31 @@ void vHavokRigidBody::UpdateOwner()
 {
   // No need to update inactive objects. This is *very* important for performance, since it avoids unnecessary state updates
   // inside the Vision Engine.
-  if (m_bAddedToWorld && (m_spRigidBody->isActive()))
+  if (IsOwnerUpdateRequired())
     UpdateHavok2Vision();
 }
 
+bool vHavokRigidBody::IsOwnerUpdateRequired() const
+{
+  return m_bAddedToWorld && (m_spRigidBody->isActive());
+}
+
 void vHavokRigidBody::UpdateHavok2Vision()
 {
   VisObject3D_cl *pOwner3d = GetOwner3D();
   VVERIFY_OR_RET(m_spRigidBody && GetOwner());
 
+  hkvVec3 vNewPos;
+  hkvMat3 vNewRot;
+  GetHavok2VisionTransformation(vNewRot, vNewPos);
+
+  // Set the transformation in Vision
+  pOwner3d->SetPosition(vNewPos);
+  pOwner3d->SetRotationMatrix(vNewRot);
+}
+
+void vHavokRigidBody::GetHavok2VisionTransformation(hkvMat3& mRotation, hkvVec3& vPosition) const
+{
   // Get the transformation from Havok
   hkTransform hkTf = m_spRigidBody->getTransform();
 
@@ -1318,13 +1334,7 @@ void vHavokRigidBody::UpdateHavok2Vision()
   vOffset._setRotatedDir(hkTf.getRotation(), vOffset);
   hkTf.getTranslation().sub(vOffset);
 
-  hkvVec3 vNewPos;
-  hkvMat3 vNewRot;
-  vHavokConversionUtils::PhysTransformToVisMatVecWorld(hkTf, vNewRot, vNewPos);
-
-  // Set the transformation in Vision
-  pOwner3d->SetPosition(vNewPos);
-  pOwner3d->SetRotationMatrix(vNewRot);
+  vHavokConversionUtils::PhysTransformToVisMatVecWorld(hkTf, mRotation, vPosition);
 }
 
 void vHavokRigidBody::UpdateVision2Havok()
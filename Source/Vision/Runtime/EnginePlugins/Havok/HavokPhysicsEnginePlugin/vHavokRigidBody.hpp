@@ -607,6 +607,28 @@ public:
   /// will typically not have to call this function manually.
   ///
   VHAVOK_IMPEXP void UpdateHavok2Vision();
+
+  ///
+  /// \brief
+  ///   Returns whether UpdateOwner needs to update the owner object, i.e. whether the rigid body
+  ///   is added to the physics world and active.
+  ///
+  VHAVOK_IMPEXP bool IsOwnerUpdateRequired() const;
+
+  ///
+  /// \brief
+  ///   Computes the transformation that UpdateHavok2Vision sets on the owner object.
+  ///
+  /// This function only reads Havok data and does not modify the owner, so the physics module can
+  /// call it from worker threads while the physics world is marked for reading.
+  ///
+  /// \param mRotation
+  ///   Receives the rotation of the owner object.
+  ///
+  /// \param vPosition
+  ///   Receives the position of the owner object.
+  ///
+  VHAVOK_IMPEXP void GetHavok2VisionTransformation(hkvMat3& mRotation, hkvVec3& vPosition) const;
   
   ///
   /// \brief
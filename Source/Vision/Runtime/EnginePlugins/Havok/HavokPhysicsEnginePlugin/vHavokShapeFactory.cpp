@@ -26,14 +26,19 @@
 #include <Physics2012/Collide/Shape/HeightField/TriSampledHeightField/hkpTriSampledHeightFieldBvTreeShape.h>
 #include <Physics2012/Internal/Collide/BvCompressedMesh/hkpBvCompressedMeshShape.h>
 #include <Physics2012/Internal/Collide/BvCompressedMesh/hkpBvCompressedMeshShapeCinfo.h> 
+#include <Physics2012/Collide/Shape/Convex/Box/hkpBoxShape.h>
+#include <Physics2012/Collide/Shape/Convex/ConvexTranslate/hkpConvexTranslateShape.h>
 
 #include <Common/Base/Config/hkConfigVersion.h>
 #include <Common/Base/Container/LocalArray/hkLocalArray.h>
+#include <Common/Base/Types/Geometry/Aabb/hkAabb.h>
 #include <Common/Base/Reflection/Registry/hkVtableClassRegistry.h>
 #include <Common/Base/Reflection/hkClass.h>
 
 // Initialize static members
 vHavokShapeCache* vHavokShapeFactory::m_pShapeCacheTable = NULL;
+VPListT<vHavokShapeCookingTask> vHavokShapeFactory::m_CookingTasks;
+bool vHavokShapeFactory::m_bBackgroundCooking = false;
 
 // -------------------------------------------------------------------------- //
 // Init/ Deinit                                                               //
@@ -48,6 +53,9 @@ void vHavokShapeFactory::Init()
 
 void vHavokShapeFactory::Deinit()
 {
+  // Usually ClearCache has already processed all tasks
+  ProcessCookingTasks(true);
+
   V_SAFE_DELETE(m_pShapeCacheTable);
 }
 
@@ -128,7 +136,8 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateConvexHullShapeFromMesh(VBaseMesh *
   stridedVerts.m_vertices    = (const hkReal*)geom.m_vertices.begin();
 
   // Create convex shape
-  hkvConvexVerticesShape *pConvexShape = new hkvConvexVerticesShape(pColMesh->GetFileTime(), stridedVerts, config);
+  const hkUint64 iContentHash = vHavokCachedShape::ComputeConvexShapeHash(pColMesh, vScaleIn, bShrinkShape);
+  hkvConvexVerticesShape *pConvexShape = new hkvConvexVerticesShape(pColMesh->GetFileTime(), stridedVerts, config, iContentHash);
 
   // Add shape to cache
   if (bCacheShape)
@@ -214,7 +223,8 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromMesh(VBaseMesh* pMesh, con
   ci.m_collisionFilterInfoMode = hkpBvCompressedMeshShape::PER_PRIMITIVE_DATA_NONE; // Collision info
   ci.m_userDataMode = hkpBvCompressedMeshShape::PER_PRIMITIVE_DATA_NONE; // Materials
   ci.m_weldingType = vHavokConversionUtils::VisToHkWeldingType(eWeldingType);
-  hkvBvCompressedMeshShape* pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, pColMesh->GetFileTime());
+  const hkUint64 iContentHash = vHavokCachedShape::ComputeMeshShapeHash(pColMesh, vScale, VisStaticMeshInstance_cl::VIS_COLLISION_BEHAVIOR_CUSTOM, eWeldingType);
+  hkvBvCompressedMeshShape* pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, pColMesh->GetFileTime(), iContentHash);
 
   if (pCompressedMeshShape->getNumChildShapes() <= 0)
   {
@@ -306,6 +316,7 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromStaticMeshInstances(const
   // Check whether shape has been already cached for this mesh with the respective scaling.
   // We are just caching single static mesh instances and no static mesh collections.
   hkpShape *pCachedShape = HK_NULL; 
+  hkUint64 iConvexContentHash = 0, iMeshContentHash = 0; // computed at most once, by the up to date check of the HKT files
   if (iCount == 1)
   {
     // first, find the convex version
@@ -326,7 +337,7 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromStaticMeshInstances(const
     if (bAllowStaticMeshCaching)
     {
       // first, find the convex version
-      pCachedShape = vHavokCachedShape::LoadConvexShape(meshInstances[0]->GetMesh(), vScale, bShrinkByCvxRadius);
+      pCachedShape = vHavokCachedShape::LoadConvexShape(meshInstances[0]->GetMesh(), vScale, bShrinkByCvxRadius, &iConvexContentHash);
       if (pCachedShape)
       {
         *szShapeCacheId = AddShape(szShapeId, pCachedShape);
@@ -339,7 +350,7 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromStaticMeshInstances(const
       else
       {
         // then find the mesh version
-        pCachedShape = vHavokCachedShape::LoadMeshShape(meshInstances[0]->GetMesh(), vScale, meshInstances[0]->GetCollisionBehavior(), eWeldingType);
+        pCachedShape = vHavokCachedShape::LoadMeshShape(meshInstances[0]->GetMesh(), vScale, meshInstances[0]->GetCollisionBehavior(), eWeldingType, &iMeshContentHash);
       }
       if (pCachedShape )
       {
@@ -377,12 +388,36 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromStaticMeshInstances(const
   IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
   const bool bIsConvex = pColMesh->GetType()==VIS_COLMESH_GEOTYPE_CONVEXHULL;
 
+  // The content hash is only stored for single mesh instances, since merged shapes are never cached.
+  hkUint64 iContentHash = 0;
+  if (iCount == 1)
+  {
+    iContentHash = bIsConvex ? iConvexContentHash : iMeshContentHash;
+    if (iContentHash == 0)
+    {
+      iContentHash = bIsConvex ? 
+        vHavokCachedShape::ComputeConvexShapeHash(pColMesh, vScale, bShrinkByCvxRadius) :
+        vHavokCachedShape::ComputeMeshShapeHash(pColMesh, vScale, pMeshInstance->GetCollisionBehavior(), eWeldingType);
+    }
+
+    // Cook on a worker thread and use a placeholder in the meantime
+    if ((iCreationFlags & VShapeCreationFlags_ALLOW_BACKGROUND_COOKING) && m_bBackgroundCooking && !Vision::Editor.IsInEditor())
+    {
+      hkpShape *pPlaceholder = StartCookingTask(pMeshInstance, referenceTransform, szShapeId, vScale, bIsConvex, iCreationFlags, eWeldingType, iContentHash);
+      if (pPlaceholder != HK_NULL)
+      {
+        *szShapeCacheId = AddShape(szShapeId, pPlaceholder);
+        return pPlaceholder;
+      }
+    }
+  }
+
   // Only create a convex shape if a single mesh instance is used, since otherwise merging multiple mesh instances in one single convex hull
   // will provide in most cases not the desired behavior. Moreover we can only create either a convex hull or a concave mesh shape, therefore
   // mesh instances with different collision type can't be merged into one shape.
   hkpShape *pShape = (bIsConvex && iCount==1) ?
-    CreateConvexShapeFromStaticMeshInstances(meshInstances, referenceTransform, bShrinkByCvxRadius) : 
-    CreateMeshShapeFromStaticMeshInstances(meshInstances, referenceTransform, bAllowPerTriCollisionInfo, eWeldingType);
+    CreateConvexShapeFromStaticMeshInstances(meshInstances, referenceTransform, bShrinkByCvxRadius, iContentHash) : 
+    CreateMeshShapeFromStaticMeshInstances(meshInstances, referenceTransform, bAllowPerTriCollisionInfo, eWeldingType, iContentHash);
 
   // We are just caching single static mesh instances and no static mesh collections.
   if (iCount == 1)
@@ -401,29 +436,33 @@ hkRefNew<hkpShape> vHavokShapeFactory::CreateShapeFromStaticMeshInstances(const
   return pShape;
 }
 
-hkpShape* vHavokShapeFactory::CreateConvexShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, hkvMat4 &refTransform, bool shrinkByCvxRadius)
+// Builds the geometry of a single static mesh instance for a convex shape in reference space.
+static bool BuildConvexShapeInput(const VisStaticMeshInstance_cl *pMeshInstance, const hkvMat4 &refTransform, hkGeometry &geom, hkInt64 &iFileTime)
 {
-  VVERIFY_OR_RET_VAL(meshInstances.GetLength()==1, NULL);
-
   // Get the collision mesh for the static mesh instance
-  VisStaticMeshInstance_cl *pMeshInstance = meshInstances[0];
   VisStaticMesh_cl *pMesh = pMeshInstance->GetMesh();
   IVCollisionMesh *pColMesh = pMesh->GetCollisionMesh(true, true);
-  VVERIFY_OR_RET_VAL(pColMesh!=NULL, NULL);
+  VVERIFY_OR_RET_VAL(pColMesh!=NULL, false);
 
   // We transform each static mesh into the reference space.
   hkvMat4 mTransform = refTransform;
   mTransform = mTransform.multiply (pMeshInstance->GetTransform());
 
-  hkGeometry geom;
   int iNumColMeshes = hkvMath::Max(pColMesh->GetSubmeshCount(), 1);
   for (int i=0;i<iNumColMeshes;i++)
-    BuildGeomFromCollisionMesh(pColMesh, i, mTransform, false, geom);
- 
+    vHavokShapeFactory::BuildGeomFromCollisionMesh(pColMesh, i, mTransform, false, geom);
+
+  iFileTime = pColMesh->GetFileTime();
+  return true;
+}
+
+// Creates the convex shape from the gathered input. Does not access any engine state, so it can run on a worker thread.
+static hkvConvexVerticesShape* CookConvexShape(const hkGeometry &geom, bool bShrinkByCvxRadius, hkInt64 iFileTime, hkUint64 iContentHash)
+{
   // Set the build configuration to set planes equations and connectivity automatically
   hkpConvexVerticesShape::BuildConfig config;
   config.m_createConnectivity = true;
-  config.m_shrinkByConvexRadius = shrinkByCvxRadius;
+  config.m_shrinkByConvexRadius = bShrinkByCvxRadius;
 
   hkStridedVertices stridedVerts;
   stridedVerts.m_numVertices = geom.m_vertices.getSize();
@@ -431,23 +470,16 @@ hkpShape* vHavokShapeFactory::CreateConvexShapeFromStaticMeshInstances(const Vis
   stridedVerts.m_vertices    = (const hkReal*)geom.m_vertices.begin();
 
   // Create convex shape
-  hkvConvexVerticesShape *pConvexShape = new hkvConvexVerticesShape(pColMesh->GetFileTime(), stridedVerts, config);
-  
-  return pConvexShape;
+  return new hkvConvexVerticesShape(iFileTime, stridedVerts, config, iContentHash);
 }
 
-hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, hkvMat4 &refTransform, 
-                                                                     bool bAllowPerTriCollisionInfo, VisWeldingType_e eWeldingType)
+// Builds the geometry, materials and per triangle collision info of static mesh instances for a mesh shape in reference space.
+static void BuildMeshShapeInput(const VisStaticMeshInstCollection &meshInstances, const hkvMat4 &refTransform, bool bAllowPerTriCollisionInfo, 
+                                hkGeometry &geom, hkvMeshMaterialCache &materials, hkArray<hkUint8> &collisionMask, hkInt64 &iFileTime)
 {
   int iCount = meshInstances.GetLength();
-  VVERIFY_OR_RET_VAL(iCount>0, NULL);
-
-  hkGeometry geom;
-  hkInt64 iFileTime = 0;
 
   // Iterate all the passed mesh instances
-  hkvMeshMaterialCache materials;
-  hkArray<hkUint8> collisionMask;
   int subPartIndex = 0;
   for (int i = 0; i < iCount; i++)
   { 
@@ -476,7 +508,7 @@ hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisSt
       for (int i=0;i<iNumColMeshes;i++)
       {
         int startingNumVerts = geom.m_vertices.getSize();
-        BuildGeomFromCollisionMesh(pColMesh, i, mTransform, false, geom);
+        vHavokShapeFactory::BuildGeomFromCollisionMesh(pColMesh, i, mTransform, false, geom);
         int endNumVerts = geom.m_vertices.getSize();
         int endNumTris = geom.m_triangles.getSize();
         VASSERT( (endNumVerts - startingNumVerts) > 0 );
@@ -532,7 +564,12 @@ hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisSt
       ++subPartIndex;     
     }
   }
+}
 
+// Creates the mesh shape from the gathered input. Does not access any engine state, so it can run on a worker thread.
+static hkvBvCompressedMeshShape* CookMeshShape(const hkGeometry &geom, hkvMeshMaterialCache &materials, hkArray<hkUint8> &collisionMask, 
+                                               VisWeldingType_e eWeldingType, hkInt64 iFileTime, hkUint64 iContentHash)
+{
   const bool bHaveTriCDData = collisionMask.getSize() > 0;
   vHavokCompressedInfoCinfo ci( &geom, bHaveTriCDData ? collisionMask.begin() : HK_NULL );
   ci.m_weldingType = vHavokConversionUtils::VisToHkWeldingType(eWeldingType);
@@ -542,12 +579,12 @@ hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisSt
   if ( materials.getSize() > 0 && materials.getSize() < 255)
   {
     ci.m_userDataMode = hkpBvCompressedMeshShape::PER_PRIMITIVE_DATA_8_BIT; 
-    pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, materials, iFileTime);
+    pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, materials, iFileTime, iContentHash);
   }
   else
   {
     ci.m_userDataMode = hkpBvCompressedMeshShape::PER_PRIMITIVE_DATA_NONE; 
-    pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, iFileTime);
+    pCompressedMeshShape = new hkvBvCompressedMeshShape(ci, iFileTime, iContentHash);
   }
   VASSERT_MSG(pCompressedMeshShape->getNumChildShapes() > 0, "hkvBvCompressedMeshShape could not be created for static model!");
 
@@ -556,6 +593,237 @@ hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisSt
   return pCompressedMeshShape;
 }
 
+hkpShape* vHavokShapeFactory::CreateConvexShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, hkvMat4 &refTransform, bool shrinkByCvxRadius,
+                                                                       hkUint64 iContentHash)
+{
+  VVERIFY_OR_RET_VAL(meshInstances.GetLength()==1, NULL);
+
+  hkGeometry geom;
+  hkInt64 iFileTime = 0;
+  if (!BuildConvexShapeInput(meshInstances[0], refTransform, geom, iFileTime))
+    return NULL;
+
+  return CookConvexShape(geom, shrinkByCvxRadius, iFileTime, iContentHash);
+}
+
+hkpShape* vHavokShapeFactory::CreateMeshShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, hkvMat4 &refTransform, 
+                                                                     bool bAllowPerTriCollisionInfo, VisWeldingType_e eWeldingType, hkUint64 iContentHash)
+{
+  int iCount = meshInstances.GetLength();
+  VVERIFY_OR_RET_VAL(iCount>0, NULL);
+
+  hkGeometry geom;
+  hkInt64 iFileTime = 0;
+  hkvMeshMaterialCache materials;
+  hkArray<hkUint8> collisionMask;
+  BuildMeshShapeInput(meshInstances, refTransform, bAllowPerTriCollisionInfo, geom, materials, collisionMask, iFileTime);
+
+  return CookMeshShape(geom, materials, collisionMask, eWeldingType, iFileTime, iContentHash);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Havok Shape - Background Cooking                                           //
+// -------------------------------------------------------------------------- //
+
+/// Task that cooks the shape of a single static mesh instance from geometry gathered on the main thread
+class vHavokShapeCookingTask : public VThreadedTask
+{
+public:
+  vHavokShapeCookingTask() 
+    : m_bConvex(false), m_bShrinkByCvxRadius(false), m_eCollisionBehavior(VisStaticMeshInstance_cl::VIS_COLLISION_BEHAVIOR_CUSTOM), 
+      m_eWeldingType(VIS_WELDING_TYPE_NONE), m_iFileTime(0), m_iContentHash(0), m_pPlaceholder(HK_NULL), m_pResult(HK_NULL) 
+  {
+  }
+
+  virtual ~vHavokShapeCookingTask()
+  {
+    if (m_pResult != HK_NULL)
+      m_pResult->removeReference();
+    if (m_pPlaceholder != HK_NULL)
+      m_pPlaceholder->removeReference();
+  }
+
+  virtual void Run(VManagedThread *pThread) HKV_OVERRIDE
+  {
+    if (m_bConvex)
+      m_pResult = CookConvexShape(m_geom, m_bShrinkByCvxRadius, m_iFileTime, m_iContentHash);
+    else
+      m_pResult = CookMeshShape(m_geom, m_materials, m_collisionMask, m_eWeldingType, m_iFileTime, m_iContentHash);
+  }
+
+  // Input
+  hkGeometry m_geom;
+  hkvMeshMaterialCache m_materials;
+  hkArray<hkUint8> m_collisionMask;
+  bool m_bConvex, m_bShrinkByCvxRadius;
+  VisStaticMeshInstance_cl::VisCollisionBehavior_e m_eCollisionBehavior;
+  VisWeldingType_e m_eWeldingType;
+  hkInt64 m_iFileTime;
+  hkUint64 m_iContentHash;
+
+  // Needed to swap the result in and to save it to a HKT file
+  VString m_sShapeId;
+  VisStaticMeshPtr m_spMesh;
+  hkvVec3 m_vScale;
+  hkpShape *m_pPlaceholder;
+
+  // Output
+  hkpShape *m_pResult;
+};
+
+// Creates a box shape that encloses the passed geometry. The box is never smaller than the mesh shape tolerance.
+static hkpShape* CreatePlaceholderShape(const hkGeometry &geom)
+{
+  hkAabb aabb;
+  aabb.setEmpty();
+  for (int i=0; i<geom.m_vertices.getSize(); i++)
+    aabb.includePoint(geom.m_vertices[i]);
+
+  hkVector4 vHalfExtents; aabb.getHalfExtents(vHalfExtents);
+  hkVector4 vMinHalfExtents; vMinHalfExtents.setAll(hkReal(HKVIS_MESH_SHAPE_TOLERANCE));
+  vHalfExtents.setMax(vHalfExtents, vMinHalfExtents);
+  hkVector4 vCenter; aabb.getCenter(vCenter);
+
+  hkpBoxShape *pBox = new hkpBoxShape(vHalfExtents, hkReal(0));
+  hkpConvexTranslateShape *pShape = new hkpConvexTranslateShape(pBox, vCenter);
+  pBox->removeReference();
+
+  return pShape;
+}
+
+void vHavokShapeFactory::EnableBackgroundCooking(bool bEnable)
+{
+  m_bBackgroundCooking = bEnable;
+}
+
+bool vHavokShapeFactory::IsBackgroundCookingEnabled()
+{
+  return m_bBackgroundCooking;
+}
+
+int vHavokShapeFactory::GetPendingCookingTaskCount()
+{
+  return m_CookingTasks.GetLength();
+}
+
+hkpShape* vHavokShapeFactory::StartCookingTask(const VisStaticMeshInstance_cl *pMeshInstance, const hkvMat4 &refTransform, const char *szShapeId,
+                                               const hkvVec3& vScale, bool bConvex, int iCreationFlags, VisWeldingType_e eWeldingType, hkUint64 iContentHash)
+{
+  // Without worker threads the task would be executed on the main thread anyway
+  if (Vision::GetThreadManager()->GetThreadCount() <= 0)
+    return HK_NULL;
+
+  vHavokShapeCookingTask *pTask = new vHavokShapeCookingTask;
+  pTask->m_bConvex = bConvex;
+  pTask->m_bShrinkByCvxRadius = (iCreationFlags & VShapeCreationFlags_SHRINK) != 0;
+  pTask->m_eCollisionBehavior = pMeshInstance->GetCollisionBehavior();
+  pTask->m_eWeldingType = eWeldingType;
+  pTask->m_iContentHash = iContentHash;
+  pTask->m_sShapeId = szShapeId;
+  pTask->m_spMesh = pMeshInstance->GetMesh();
+  pTask->m_vScale = vScale;
+
+  // Gather the input on the calling thread, since the collision mesh may be loaded on demand
+  if (bConvex)
+  {
+    if (!BuildConvexShapeInput(pMeshInstance, refTransform, pTask->m_geom, pTask->m_iFileTime))
+    {
+      V_SAFE_DELETE(pTask);
+      return HK_NULL;
+    }
+  }
+  else
+  {
+    VisStaticMeshInstCollection meshInstances;
+    meshInstances.Append(const_cast<VisStaticMeshInstance_cl*>(pMeshInstance));
+    const bool bAllowPerTriCollisionInfo = (iCreationFlags & VShapeCreationFlags_ALLOW_PERTRICOLINFO) != 0;
+    BuildMeshShapeInput(meshInstances, refTransform, bAllowPerTriCollisionInfo, pTask->m_geom, pTask->m_materials, pTask->m_collisionMask, pTask->m_iFileTime);
+  }
+
+  if (pTask->m_geom.m_vertices.getSize() == 0)
+  {
+    V_SAFE_DELETE(pTask);
+    return HK_NULL;
+  }
+
+  // The task keeps a reference on the placeholder so it can be identified when swapping the result in
+  hkpShape *pPlaceholder = CreatePlaceholderShape(pTask->m_geom);
+  pPlaceholder->addReference();
+  pTask->m_pPlaceholder = pPlaceholder;
+
+  if (!Vision::GetThreadManager()->ScheduleTask(pTask))
+  {
+    V_SAFE_DELETE(pTask);
+    pPlaceholder->removeReference();
+    return HK_NULL;
+  }
+  m_CookingTasks.Append(pTask);
+
+  return pPlaceholder;
+}
+
+void vHavokShapeFactory::FinishCookingTask(vHavokShapeCookingTask *pTask)
+{
+  hkpShape *pShape = pTask->m_pResult;
+  hkpShape *pPlaceholder = pTask->m_pPlaceholder;
+  if (pShape == HK_NULL)
+  {
+    Vision::Error.Warning("vHavokShapeFactory: Background cooking of the physics shape for [%s] failed.", pTask->m_spMesh->GetFilename());
+    return;
+  }
+
+  // Only swap the result in if the placeholder is still cached under its ID. Otherwise the cache has been cleared 
+  // in the meantime and the result is discarded.
+  VASSERT(m_pShapeCacheTable != NULL);
+  vHavokShapeCache::Iterator iter = m_pShapeCacheTable->findKey(pTask->m_sShapeId);
+  if (!m_pShapeCacheTable->isValid(iter) || m_pShapeCacheTable->getValue(iter) != pPlaceholder)
+    return;
+
+  // Replace the cache entry. The key is kept, so the cache IDs stored in the static meshes remain valid.
+  pShape->addReference();
+  m_pShapeCacheTable->setValue(iter, pShape);
+  pPlaceholder->removeReference();
+
+  // Replace the placeholder in all static meshes that use it
+  vHavokPhysicsModule *pModule = vHavokPhysicsModule::GetInstance();
+  if (pModule != NULL)
+    pModule->ReplaceStaticMeshShape(pPlaceholder, pShape);
+
+  // Only cache shape to HKT file when inside vForge or when enforced.
+  const bool bAllowStaticMeshCaching = vHavokPhysicsModule_GetDefaultWorldRuntimeSettings().m_bEnableShapeCaching==TRUE;
+  const bool bForceHktShapeCaching = pModule!=NULL && pModule->IsHktShapeCachingEnforced();
+  if ((Vision::Editor.IsInEditor() && bAllowStaticMeshCaching) || bForceHktShapeCaching)
+  {
+    if (pTask->m_bConvex)
+      vHavokCachedShape::SaveConvexShape(pTask->m_spMesh, pTask->m_vScale, pTask->m_bShrinkByCvxRadius, (hkvConvexVerticesShape*)pShape);
+    else
+      vHavokCachedShape::SaveMeshShape(pTask->m_spMesh, pTask->m_vScale, pTask->m_eCollisionBehavior, pTask->m_eWeldingType, (hkvBvCompressedMeshShape*)pShape);
+  }
+}
+
+void vHavokShapeFactory::ProcessCookingTasks(bool bWaitForAll)
+{
+  int i = 0;
+  while (i < m_CookingTasks.GetLength())
+  {
+    vHavokShapeCookingTask *pTask = m_CookingTasks[i];
+    if (pTask->GetState() != TASKSTATE_FINISHED)
+    {
+      if (!bWaitForAll)
+      {
+        i++;
+        continue;
+      }
+      Vision::GetThreadManager()->WaitForTask(pTask, true);
+    }
+
+    m_CookingTasks.RemoveAt(i);
+    FinishCookingTask(pTask);
+    V_SAFE_DELETE(pTask);
+  }
+}
+
 
 // -------------------------------------------------------------------------- //
 // Havok Shape - Terrain                                                      //
@@ -668,6 +936,9 @@ bool vHavokShapeFactory::ClearCache()
 {
   VASSERT(m_pShapeCacheTable != NULL);
 
+  // Pending tasks hold references on their placeholder shapes
+  ProcessCookingTasks(true);
+
   // Iterate all shapes in cache and check whether all shapes have a reference count 
   // of 1 before we call removeReferecne(). If so return true, false otherwise.
   bool bRefCountSafe = true;
@@ -22,6 +22,8 @@
 
 typedef hkStorageStringMap<hkpShape*> vHavokShapeCache;
 
+class vHavokShapeCookingTask;
+
 /// 
 /// \brief
 ///   Factory class with static functions to create Havok shapes.
@@ -65,7 +67,8 @@ public:
     VShapeCreationFlags_CACHE_SHAPE         = V_BIT(0), ///< Allow runtime/ disc shape caching 
     VShapeCreationFlags_USE_VCOLMESH        = V_BIT(1), ///< Try using collision mesh (.vcolmesh)
     VShapeCreationFlags_SHRINK              = V_BIT(2), ///< Shrink by the convex radius
-    VShapeCreationFlags_ALLOW_PERTRICOLINFO = V_BIT(3)  ///< Allow per triangle collision info for static mesh shapes
+    VShapeCreationFlags_ALLOW_PERTRICOLINFO = V_BIT(3), ///< Allow per triangle collision info for static mesh shapes
+    VShapeCreationFlags_ALLOW_BACKGROUND_COOKING = V_BIT(4) ///< Allow cooking a missing static mesh shape on a worker thread (see EnableBackgroundCooking)
   };
 
   /// 
@@ -141,7 +144,8 @@ public:
   ///   if shape could be retrieved.
   ///
   /// \returns
-  ///   Pointer to Havok Physics shape based on hkvBvCompressedMeshShape.
+  ///   Pointer to Havok Physics shape based on hkvBvCompressedMeshShape. If the shape of a single mesh instance is
+  ///   cooked in the background (see EnableBackgroundCooking), a placeholder box shape is returned instead.
   /// 
   VHAVOK_IMPEXP static hkRefNew<hkpShape> CreateShapeFromStaticMeshInstances(
     const VisStaticMeshInstCollection &meshInstances, int iCreationFlags, const char **szShapeCacheId);
@@ -167,6 +171,63 @@ public:
   /// @}
   ///
 
+  ///
+  /// @name Background Cooking
+  /// @{
+  ///
+
+  /// 
+  /// \brief
+  ///   Enables cooking of missing static mesh shapes on worker threads.
+  /// 
+  /// When enabled, CreateShapeFromStaticMeshInstances does not cook the shape of a single static mesh instance 
+  /// on the calling thread if neither the runtime cache nor an up to date HKT file provides it, as long as 
+  /// VShapeCreationFlags_ALLOW_BACKGROUND_COOKING is passed. Instead, the collision geometry is gathered, a cooking 
+  /// task is scheduled on the thread manager and a box shape enclosing the geometry is returned as placeholder. 
+  /// The placeholder is cached under the ID of the final shape, so all instances of the same mesh share it.
+  ///
+  /// Finished tasks are processed by ProcessCookingTasks, which the physics module calls once per simulation step:
+  /// the cooked shape replaces the placeholder in the cache and in all static meshes that still use it, and it is
+  /// saved to a HKT file if HKT shape caching is enforced.
+  ///
+  /// \param bEnable
+  ///   Toggles background cooking.
+  ///
+  /// \note
+  ///   Until the cooked shape is swapped in, collisions and ray casts use the placeholder box. Use it for level streaming
+  ///   or large scenes where the first frames after loading do not depend on exact static collision, and pre-cook HKT 
+  ///   files for shipping builds. Background cooking is disabled by default and never used inside vForge.
+  ///
+  VHAVOK_IMPEXP static void EnableBackgroundCooking(bool bEnable);
+
+  /// 
+  /// \brief
+  ///   Returns whether missing static mesh shapes may be cooked on worker threads.
+  /// 
+  VHAVOK_IMPEXP static bool IsBackgroundCookingEnabled();
+
+  /// 
+  /// \brief
+  ///   Returns the number of background cooking tasks that have not been processed yet.
+  /// 
+  VHAVOK_IMPEXP static int GetPendingCookingTaskCount();
+
+  /// 
+  /// \brief
+  ///   Swaps the results of finished background cooking tasks in.
+  /// 
+  /// Must be called from the main thread while the physics simulation is not running.
+  ///
+  /// \param bWaitForAll
+  ///   If true, the function waits for all pending tasks (or runs them in the calling thread), otherwise only 
+  ///   tasks that have already finished are processed.
+  ///
+  VHAVOK_IMPEXP static void ProcessCookingTasks(bool bWaitForAll = false);
+
+  ///
+  /// @}
+  ///
+
   ///
   /// @name Havok Physics Shape Caching
   /// @{
@@ -206,7 +267,8 @@ public:
   ///   Purges all cached shapes.
   /// 
   /// When clearing the cache, the reference of the shape factory to all cached shapes
-  /// is released and the internal table is cleared.
+  /// is released and the internal table is cleared. Pending background cooking tasks are
+  /// completed and processed before.
   ///
   /// \return
   ///   Returns TRUE if no other references to the shapes exist. It is advised to ensure
@@ -340,14 +402,14 @@ public:
   static void ExtractScaling(const hkvMat4 &mat, hkvVec3& destScaling);  
   
   /// \brief
-  ///   Creates a convex hull shape for the given static mesh instances.
+  ///   Creates a convex hull shape for the given static mesh instances. iContentHash is stored in the shape (see vHavokCachedShape::ComputeConvexShapeHash).
   static hkpShape* CreateConvexShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, 
-    hkvMat4 &transform, bool shrinkByCvxRadius);
+    hkvMat4 &transform, bool shrinkByCvxRadius, hkUint64 iContentHash = 0);
 
   /// \brief
-  ///   Creates a mesh shape for the given static mesh instances.
+  ///   Creates a mesh shape for the given static mesh instances. iContentHash is stored in the shape (see vHavokCachedShape::ComputeMeshShapeHash).
   static hkpShape* CreateMeshShapeFromStaticMeshInstances(const VisStaticMeshInstCollection &meshInstances, 
-    hkvMat4 &transform, bool bAllowPerTriCollisionInfo, VisWeldingType_e eWeldingType);
+    hkvMat4 &transform, bool bAllowPerTriCollisionInfo, VisWeldingType_e eWeldingType, hkUint64 iContentHash = 0);
   
 #ifdef SUPPORTS_SNAPSHOT_CREATION
 
@@ -370,7 +432,13 @@ public:
   ///
 
 private:
+  static hkpShape* StartCookingTask(const VisStaticMeshInstance_cl *pMeshInstance, const hkvMat4 &refTransform, const char *szShapeId,
+    const hkvVec3& vScale, bool bConvex, int iCreationFlags, VisWeldingType_e eWeldingType, hkUint64 iContentHash);
+  static void FinishCookingTask(vHavokShapeCookingTask *pTask);
+
   static vHavokShapeCache *m_pShapeCacheTable;  ///< Cached shapes stored in hash map.
+  static VPListT<vHavokShapeCookingTask> m_CookingTasks; ///< Scheduled background cooking tasks that have not been processed yet.
+  static bool m_bBackgroundCooking;             ///< Whether missing static mesh shapes may be cooked on worker threads.
 };
 
 #endif // VHAVOKSHAPEFACTORY_HPP_INCLUDED
@@ -13,6 +13,7 @@
 #include <Vision/Runtime/EnginePlugins/Havok/HavokPhysicsEnginePlugin/vHavokConversionUtils.hpp>
 
 #include <Common/Base/Reflection/Registry/hkVtableClassRegistry.h>
+#include <Physics2012/Dynamics/Constraint/hkpConstraintInstance.h>
 
 
 // --------------------------------------------------------------------------
@@ -21,6 +22,7 @@
 
 void vHavokStaticMesh::SetDebugRendering (bool bEnable)
 {
+  m_bDebugRendering = bEnable;
   vHavokPhysicsModule* pInstance = vHavokPhysicsModule::GetInstance();
 
   // Get ID (cast from collidable pointer as its is used for display geometry ID)
@@ -49,7 +51,7 @@ void vHavokStaticMesh::SetDebugRendering (bool bEnable)
 
 
 vHavokStaticMesh::vHavokStaticMesh(vHavokPhysicsModule &module)
-  : m_pRigidBody(NULL), m_bInitialized(FALSE), m_module(module), m_iNumValidStaticMeshes(0), m_szShapeCacheId(NULL)
+  : m_pRigidBody(NULL), m_bInitialized(FALSE), m_module(module), m_iNumValidStaticMeshes(0), m_szShapeCacheId(NULL), m_bDebugRendering(false)
 {
 }
 
@@ -162,6 +164,25 @@ void vHavokStaticMesh::RemoveStaticMesh(VisStaticMeshInstance_cl *pMesh)
 // Havok Rigid Body Creation
 // --------------------------------------------------------------------------
 
+// When CollisionBehavior_e::FromFile was selected and there is no collisionFilterInfo available from file (due to old vcolmesh format, convex shape),
+// a default collisionFilterInfo will be used.
+static hkUint32 GetDefaultCollisionFilterInfo(hkUint32 iCollisionFilterInfo, const hkpShape *pShape)
+{
+  if (iCollisionFilterInfo==0)
+  {
+    bool bHasMaterialCacheData = false;
+    const hkClass *pClass = pShape->getClassType();
+    if (pClass == &hkvBvCompressedMeshShapeClass)
+    {
+      const hkvBvCompressedMeshShape *pMeshShape = (hkvBvCompressedMeshShape*)(pShape);
+      bHasMaterialCacheData = pMeshShape->m_userData != HK_NULL;
+    }
+    if (!bHasMaterialCacheData)
+      return vHavokPhysicsModule::HK_LAYER_COLLIDABLE_STATIC;
+  }
+  return iCollisionFilterInfo;
+}
+
 void vHavokStaticMesh::CreateHkRigidBody()
 {
   // Create the Havok shape
@@ -194,26 +215,13 @@ void vHavokStaticMesh::CreateHkRigidBody()
   // Create the shape. 
   // We can either create the shape from mem, or serialize it in (if cached).
   // Do not set vHavokShapeFactory::VShapeCreationFlags_SHRINK, so back compat. Better to have as an option.
-  const int iCreationFlags = (pMeshInstance->GetCollisionBehavior()==VisStaticMeshInstance_cl::VIS_COLLISION_BEHAVIOR_FROMFILE) ? 
-                             vHavokShapeFactory::VShapeCreationFlags_ALLOW_PERTRICOLINFO : 0;
+  // Static mesh shapes may be cooked in the background (see vHavokShapeFactory::EnableBackgroundCooking). 
+  int iCreationFlags = vHavokShapeFactory::VShapeCreationFlags_ALLOW_BACKGROUND_COOKING;
+  if (pMeshInstance->GetCollisionBehavior()==VisStaticMeshInstance_cl::VIS_COLLISION_BEHAVIOR_FROMFILE)
+    iCreationFlags |= vHavokShapeFactory::VShapeCreationFlags_ALLOW_PERTRICOLINFO;
   hkRefPtr<hkpShape> spShape = vHavokShapeFactory::CreateShapeFromStaticMeshInstances(m_staticMeshes, iCreationFlags, &m_szShapeCacheId);
   cInfo.m_shape = spShape;
-
-  // When CollisionBehavior_e::FromFile was selected and there is no collisionFilterInfo available from file (due to old vcolmesh format, convex shape),
-  // a default collisionFilterInfo will be used.
-  if (cInfo.m_collisionFilterInfo==0)
-  {
-    bool bHasMaterialCacheData = false;
-    const hkpShape *pShape = (hkpShape*)spShape.val();
-    const hkClass *pClass = pShape->getClassType();
-    if (pClass == &hkvBvCompressedMeshShapeClass)
-    {
-      const hkvBvCompressedMeshShape *pMeshShape = (hkvBvCompressedMeshShape*)(pShape);
-      bHasMaterialCacheData = pMeshShape->m_userData != HK_NULL;
-    }
-    if (!bHasMaterialCacheData)
-      cInfo.m_collisionFilterInfo = vHavokPhysicsModule::HK_LAYER_COLLIDABLE_STATIC;
-  }
+  cInfo.m_collisionFilterInfo = GetDefaultCollisionFilterInfo(cInfo.m_collisionFilterInfo, spShape.val());
   cInfo.m_numShapeKeysInContactPointProperties = -1; 	// Ensure shape keys are stored.
   m_pRigidBody = new hkpRigidBody(cInfo);
 
@@ -245,6 +253,42 @@ void vHavokStaticMesh::RemoveHkRigidBody()
   m_szShapeCacheId = NULL;
 }
 
+void vHavokStaticMesh::ReplaceShape(const hkpShape *pOldShape, hkpShape *pNewShape)
+{
+  if (m_pRigidBody==NULL || m_pRigidBody->getCollidable()->getShape()!=pOldShape)
+    return;
+
+  // hkpRigidBody::setShape is not meant for bodies in the world, so take the fixed body out for the swap.
+  // Removing the body also removes the constraints attached to it, so they are kept alive and added back afterwards
+  hkpWorld *pWorld = m_pRigidBody->getWorld();
+  hkArray<hkpConstraintInstance*> constraints;
+  if (pWorld)
+  {
+    m_pRigidBody->getAllConstraints(constraints);
+    for (int i=0;i<constraints.getSize();i++)
+      constraints[i]->addReference();
+    pWorld->removeEntity(m_pRigidBody);
+  }
+
+  m_pRigidBody->setShape(pNewShape);
+
+  hkUint32 iCollisionFilterInfo = m_staticMeshes[0]->GetCollisionBitmask() & ~(1<<15);
+  m_pRigidBody->setCollisionFilterInfo(GetDefaultCollisionFilterInfo(iCollisionFilterInfo, pNewShape));
+
+  if (pWorld)
+  {
+    pWorld->addEntity(m_pRigidBody);
+    for (int i=0;i<constraints.getSize();i++)
+    {
+      pWorld->addConstraint(constraints[i]);
+      constraints[i]->removeReference();
+    }
+  }
+
+  // the display geometry is recreated for the new shape
+  SetDebugRendering(m_bDebugRendering);
+}
+
 
 
 // --------------------------------------------------------------------------
@@ -337,7 +381,7 @@ void vHavokStaticMesh::UpdateVision2Havok()
 
   if (bUpdateDebugRendering)
   {
-    SetDebugRendering (false);
+    SetDebugRendering (m_bDebugRendering);
   }
 }
 
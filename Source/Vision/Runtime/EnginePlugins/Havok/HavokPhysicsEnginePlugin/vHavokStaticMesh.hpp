@@ -217,6 +217,9 @@ public:
 
   /// \brief
   ///   Enables or disabled debug rendering of the Havok Physics representation.
+  ///
+  /// The state is kept when the shape of the rigid body is replaced. Debug rendering is also enabled
+  /// for all static meshes by vHavokPhysicsModule::m_bDebugRenderStaticMeshes.
   VHAVOK_IMPEXP void SetDebugRendering (bool bEnable);
 
   ///
@@ -241,6 +244,16 @@ protected:
   ///   Common deinitialisation code that is used both for DisposeObject and on destruction.
   ///
   void CommonDeinit();
+
+  ///
+  /// \brief
+  ///   Replaces the shape of the rigid body if it currently is pOldShape. Called by the physics module
+  ///   when a shape that has been cooked in the background replaces its placeholder. The world must be marked for write.
+  ///   Constraints attached to the rigid body and the debug rendering state are kept.
+  ///
+  void ReplaceShape(const hkpShape *pOldShape, hkpShape *pNewShape);
+
+  friend class vHavokPhysicsModule;
   
   hkpRigidBody *m_pRigidBody;                   ///< Pointer to the internal Havok Physics rigid body instance
   bool m_bInitialized;                          ///< Indicates whether object has been initialized with one of the Init functions.
@@ -251,6 +264,7 @@ protected:
   int m_iNumValidStaticMeshes;                  ///< Number of valid static mesh instances managed by this instance.
   hkvVec3 m_vScale;								              ///< The scale this static mesh was created with.
   const char *m_szShapeCacheId;                 ///< ID of shape of the rigid body in runtime cache table (points to memory in cache table). 
+  bool m_bDebugRendering;                       ///< Debug rendering state set with SetDebugRendering
 };
 
 #endif // VHAVOKSTATICMESH_HPP_INCLUDED
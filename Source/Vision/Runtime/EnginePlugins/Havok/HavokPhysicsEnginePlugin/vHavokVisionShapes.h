@@ -44,7 +44,7 @@ extern const hkTypeInfo hkvConvexVerticesShapeTypeInfo;
 ///   Custom shape class that extends the hkpConvexVerticesShape.
 class hkvConvexVerticesShape: public hkpConvexVerticesShape
 {   
-  // +version(0)
+  // +version(1)
 
 public:
   HK_DECLARE_CLASS_ALLOCATOR(HK_MEMORY_CLASS_SHAPE);
@@ -53,9 +53,10 @@ public:
   /// \brief
   ///   Constructor
   hkvConvexVerticesShape(hkInt64 iFileTime, const hkStridedVertices& vertices, 
-    const hkpConvexVerticesShape::BuildConfig& config=hkpConvexVerticesShape::BuildConfig())
+    const hkpConvexVerticesShape::BuildConfig& config=hkpConvexVerticesShape::BuildConfig(), hkUint64 iContentHash=0)
     : hkpConvexVerticesShape(vertices, config)
     , m_iFileTime(iFileTime)
+    , m_iContentHash(iContentHash)
   {
   }
 
@@ -73,12 +74,20 @@ public:
     return m_iFileTime;
   }
 
+  /// \brief
+  ///   Returns the hash of the collision geometry and cooking parameters the shape has been created from (0 if unknown).
+  HK_FORCE_INLINE hkUint64 GetContentHash() const
+  {
+    return m_iContentHash;
+  }
+
   /// \brief
   ///   hkReferencedObject implementation.
   VHAVOK_IMPEXP virtual const hkClass* getClassType() const HK_OVERRIDE; 
 
 private:
   hkInt64 m_iFileTime; ///< system time at which corresponding .vcolmesh has been exported
+  hkUint64 m_iContentHash; ///< hash of the collision geometry and cooking parameters. Added in version 1, so older HKT files fail to load and have to be re-generated
 
 };
 
@@ -126,7 +135,7 @@ extern const hkTypeInfo hkvBvCompressedMeshShapeTypeInfo;
 ///   Custom shape class that extends the hkpBvCompressedMeshShape.
 class hkvBvCompressedMeshShape: public hkpBvCompressedMeshShape
 {   
-  // +version(0)
+  // +version(1)
 
 public:
   HK_DECLARE_CLASS_ALLOCATOR(HK_MEMORY_CLASS_SHAPE);
@@ -134,16 +143,16 @@ public:
 
   /// \brief
   ///   Constructor
-  hkvBvCompressedMeshShape(const hkpBvCompressedMeshShapeCinfo& cInfo, hkvMeshMaterialCache &materials, hkInt64 iFileTime)
-    : hkpBvCompressedMeshShape(cInfo), m_iFileTime(iFileTime)
+  hkvBvCompressedMeshShape(const hkpBvCompressedMeshShapeCinfo& cInfo, hkvMeshMaterialCache &materials, hkInt64 iFileTime, hkUint64 iContentHash=0)
+    : hkpBvCompressedMeshShape(cInfo), m_iFileTime(iFileTime), m_iContentHash(iContentHash)
   {
     m_materials = materials; 
   }
 
   /// \brief
   ///   Constructor without material information
-  hkvBvCompressedMeshShape(const hkpBvCompressedMeshShapeCinfo& cInfo, hkInt64 iFileTime)
-    : hkpBvCompressedMeshShape(cInfo), m_iFileTime(iFileTime)
+  hkvBvCompressedMeshShape(const hkpBvCompressedMeshShapeCinfo& cInfo, hkInt64 iFileTime, hkUint64 iContentHash=0)
+    : hkpBvCompressedMeshShape(cInfo), m_iFileTime(iFileTime), m_iContentHash(iContentHash)
   {
   }
 
@@ -168,12 +177,20 @@ public:
     return m_iFileTime;
   }
 
+  /// \brief
+  ///   Returns the hash of the collision geometry and cooking parameters the shape has been created from (0 if unknown).
+  HK_FORCE_INLINE hkUint64 GetContentHash() const
+  {
+    return m_iContentHash;
+  }
+
   /// \brief
   ///   hkReferencedObject implementation.
   VHAVOK_IMPEXP virtual const hkClass* getClassType() const HK_OVERRIDE;
 
 private:
   hkInt64 m_iFileTime; // system time at which corresponding .vcolmesh had been exported
+  hkUint64 m_iContentHash; // hash of the collision geometry and cooking parameters. Added in version 1, so older HKT files fail to load and have to be re-generated
   hkvMeshMaterialCache m_materials;
 
 };
@@ -216,6 +216,8 @@ VTransitionSet::VTransitionSet()
   m_iTargetCount = 0;
   m_pTransitionPairs = NULL;
   m_pSequenceSet = NULL;
+  m_pTransitionTable = NULL;
+  m_pTransitionSource = NULL;
 }
 
 VTransitionSet::~VTransitionSet()
@@ -226,6 +228,12 @@ VTransitionSet::~VTransitionSet()
 VTransitionDef* VTransitionSet::GetTransitionDef(VisAnimSequence_cl *pTargetSequence) const
 {
   VASSERT(pTargetSequence);
+
+  // use the index of the parent table if this set is part of it
+  const VTransitionTable *pTable = m_pTransitionTable;
+  if (pTable && pTable->m_bLookupIndicesValid && this>=pTable->m_pTransitionSet && this<pTable->m_pTransitionSet+pTable->m_iTransitionSetCount)
+    return pTable->LookupTransitionPair((int)(this-pTable->m_pTransitionSet), pTargetSequence);
+
   const VTransitionPair_t *pPair = m_pTransitionPairs;
   for (int i = 0; i < m_iTargetCount; i++, pPair++)
   {
@@ -239,6 +247,8 @@ bool VTransitionSet::AddTransitionPair(VisAnimSequence_cl *pTargetSequence, VTra
 {
   m_pTransitionPairs[iIndex].pTargetSequence = pTargetSequence;
   m_pTransitionPairs[iIndex].pTransition = pTransition;
+  if (m_pTransitionTable)
+    m_pTransitionTable->InvalidateLookupIndices();
   return true;
 }
 
@@ -360,6 +370,8 @@ VTransitionTable::VTransitionTable(VTransitionManager *pParentManager, VDynamicM
   m_iTransitionSetCount = 0;
   m_pTransitionSet = NULL;
   m_bBrokenVersion3 = false;
+  m_iIndexedTargetCount = 0;
+  m_bLookupIndicesValid = false;
 }
 
 VTransitionTable::~VTransitionTable()
@@ -370,11 +382,112 @@ VTransitionTable::~VTransitionTable()
   V_SAFE_DELETE_ARRAY(m_pSequenceSet);
 }
 
+// Returns a hash table size for the passed number of entries
+static inline UINT GetLookupHashSize(int iCount)
+{
+  // odd sizes spread the (aligned) pointer keys better
+  return (UINT)hkvMath::Max(iCount*2, 16) + 1;
+}
+
+void VTransitionTable::UpdateLookupIndices()
+{
+  m_TransitionSetIndex.RemoveAll();
+  m_SequenceDefIndex.RemoveAll();
+  m_TransitionDefIndex.RemoveAll();
+  m_SequenceSetIndex.RemoveAll();
+  m_TargetSequenceIndex.RemoveAll();
+  m_TransitionPairIndex.RemoveAll();
+
+  m_TransitionSetIndex.InitHashTable(GetLookupHashSize(m_iTransitionSetCount));
+  m_SequenceDefIndex.InitHashTable(GetLookupHashSize(m_iSequenceDefCount));
+  m_TransitionDefIndex.InitHashTable(GetLookupHashSize(m_iTransitionDefCount));
+
+  // the first entry wins in all indices, like in a linear search
+  int iValue;
+  for (int i = 0; i < m_iTransitionSetCount; i++)
+  {
+    const void *pSource = m_pTransitionSet[i].GetSourceSequence();
+    if (pSource && !m_TransitionSetIndex.Lookup(pSource, iValue))
+      m_TransitionSetIndex.SetAt(pSource, i);
+  }
+
+  for (int i = 0; i < m_iSequenceDefCount; i++)
+  {
+    const void *pSequence = m_pSequenceDef[i].GetOwnerSequence();
+    if (pSequence && !m_SequenceDefIndex.Lookup(pSequence, iValue))
+      m_SequenceDefIndex.SetAt(pSequence, i);
+  }
+
+  for (int i = 0; i < m_iTransitionDefCount; i++)
+    if (!m_TransitionDefIndex.Lookup(m_pTransitionDef[i].m_iID, iValue))
+      m_TransitionDefIndex.SetAt(m_pTransitionDef[i].m_iID, i);
+
+  VSequenceSet *pSet;
+  for (int i = 0; i < m_iSequenceSetCount; i++)
+  {
+    const char *szFilename = m_pSequenceSet[i].m_szFilename;
+    if (szFilename && !m_SequenceSetIndex.Lookup(szFilename, pSet))
+      m_SequenceSetIndex.SetAt(szFilename, &m_pSequenceSet[i]);
+  }
+
+  // (source, target) pairs: target sequences get a dense index, so a pair is keyed by a single integer
+  int iPairCount = 0;
+  m_iIndexedTargetCount = 0;
+  for (int i = 0; i < m_iTransitionSetCount; i++)
+  {
+    const VTransitionSet &set = m_pTransitionSet[i];
+    for (int j = 0; j < set.m_iTargetCount; j++)
+    {
+      const void *pTarget = set.m_pTransitionPairs[j].pTargetSequence;
+      if (!pTarget)
+        continue;
+      iPairCount++;
+      if (!m_TargetSequenceIndex.Lookup(pTarget, iValue))
+        m_TargetSequenceIndex.SetAt(pTarget, m_iIndexedTargetCount++);
+    }
+  }
+
+  m_TransitionPairIndex.InitHashTable(GetLookupHashSize(iPairCount));
+  void *pDef;
+  for (int i = 0; i < m_iTransitionSetCount; i++)
+  {
+    const VTransitionSet &set = m_pTransitionSet[i];
+    for (int j = 0; j < set.m_iTargetCount; j++)
+    {
+      const VTransitionSet::VTransitionPair_t &pair = set.m_pTransitionPairs[j];
+      if (!pair.pTargetSequence)
+        continue;
+      VVERIFY(m_TargetSequenceIndex.Lookup(pair.pTargetSequence, iValue));
+      const int iKey = i * m_iIndexedTargetCount + iValue;
+      if (!m_TransitionPairIndex.Lookup(iKey, pDef))
+        m_TransitionPairIndex.SetAt(iKey, pair.pTransition);
+    }
+  }
+
+  m_bLookupIndicesValid = true;
+}
+
+VTransitionDef* VTransitionTable::LookupTransitionPair(int iSetIndex, VisAnimSequence_cl *pTargetSequence) const
+{
+  VASSERT(m_bLookupIndicesValid);
+  int iTargetIndex;
+  void *pDef;
+  if (!m_TargetSequenceIndex.Lookup(pTargetSequence, iTargetIndex) ||
+      !m_TransitionPairIndex.Lookup(iSetIndex * m_iIndexedTargetCount + iTargetIndex, pDef))
+    return NULL;
+  return (VTransitionDef *)pDef;
+}
+
 VTransitionSet* VTransitionTable::GetTransitionSet(VisAnimSequence_cl *pSourceSequence) const
 {
-  // todo: possibly optimized by using better lookup strategy (e.g. map)
   VASSERT(pSourceSequence);
 
+  if (m_bLookupIndicesValid)
+  {
+    int iIndex;
+    return m_TransitionSetIndex.Lookup(pSourceSequence, iIndex) ? &m_pTransitionSet[iIndex] : NULL;
+  }
+
   for (int i = 0; i < m_iTransitionSetCount; i++)
     if (pSourceSequence == m_pTransitionSet[i].GetSourceSequence())
       return &m_pTransitionSet[i];
@@ -389,6 +502,15 @@ VTransitionDef* VTransitionTable::GetTransitionDef(VisAnimSequence_cl *pSourceSe
   VASSERT(pSourceSequence);
   VASSERT(pTargetSequence);
 
+  // Resolve the pair directly
+  if (m_bLookupIndicesValid)
+  {
+    int iSetIndex;
+    if (!m_TransitionSetIndex.Lookup(pSourceSequence, iSetIndex))
+      return NULL;
+    return LookupTransitionPair(iSetIndex, pTargetSequence);
+  }
+
   // Get transition set of source animation
   VTransitionSet *pTransitionSet = GetTransitionSet(pSourceSequence);
   if (!pTransitionSet)
@@ -404,7 +526,12 @@ VTransitionDef* VTransitionTable::GetTransitionDef(VisAnimSequence_cl *pSourceSe
   
 VTransitionDef* VTransitionTable::GetTransitionDef(int iID) const
 {
-  // todo: possibly optimized by using better lookup strategy (e.g. map)
+  if (m_bLookupIndicesValid)
+  {
+    int iIndex;
+    return m_TransitionDefIndex.Lookup(iID, iIndex) ? &m_pTransitionDef[iIndex] : NULL;
+  }
+
   for (int i = 0; i < m_iTransitionDefCount; i++)
     if (m_pTransitionDef[i].m_iID == iID)
       return &m_pTransitionDef[i];
@@ -413,9 +540,14 @@ VTransitionDef* VTransitionTable::GetTransitionDef(int iID) const
 
 VSequenceDef* VTransitionTable::GetSequenceDef(VisAnimSequence_cl* pSequence) const
 {
-  // todo: possibly optimized by using better lookup strategy (e.g. map)
   VASSERT(pSequence);
 
+  if (m_bLookupIndicesValid)
+  {
+    int iIndex;
+    return m_SequenceDefIndex.Lookup(pSequence, iIndex) ? &m_pSequenceDef[iIndex] : NULL;
+  }
+
   for (int i = 0; i < m_iSequenceDefCount; i++)
     if (pSequence == m_pSequenceDef[i].GetOwnerSequence())
       return &m_pSequenceDef[i];
@@ -424,9 +556,13 @@ VSequenceDef* VTransitionTable::GetSequenceDef(VisAnimSequence_cl* pSequence) co
 
 VSequenceSet* VTransitionTable::GetSequenceSet(const char* szFilename) const
 {
-  // todo: possibly optimized by using better lookup strategy (e.g. map)
   VASSERT(szFilename);
 
+  // the string map may not compare case sensitively, so verify the result
+  VSequenceSet *pSet;
+  if (m_bLookupIndicesValid && m_SequenceSetIndex.Lookup(szFilename, pSet) && strcmp(szFilename, pSet->m_szFilename) == 0)
+    return pSet;
+
   for (int i = 0; i < m_iSequenceSetCount; i++)
     if (strcmp(szFilename, m_pSequenceSet[i].m_szFilename) == 0)
       return &m_pSequenceSet[i];
@@ -597,6 +733,8 @@ void VTransitionTable::SerializeX( VArchive &ar )
         ar >> pSets[i];
       }
     }
+
+    UpdateLookupIndices();
   }
   else
   {
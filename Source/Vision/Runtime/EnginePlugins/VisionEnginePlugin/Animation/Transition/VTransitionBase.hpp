@@ -1488,6 +1488,57 @@ public:
   ///
 
 
+  ///
+  /// @name Lookup Indices
+  /// @{
+  ///
+
+
+  ///
+  /// \brief
+  ///   Builds the hash indices that are used by the lookup functions.
+  ///
+  /// The indices map source sequences to transition sets, (source, target) pairs to transition
+  /// definitions, IDs to transition definitions, sequences to sequence definitions and file names
+  /// to sequence sets, so the transition state machine resolves a transition in constant time.
+  ///
+  /// The indices are built automatically after loading a transition table. Allocating new table
+  /// data and VTransitionSet::AddTransitionPair invalidate them; the lookup functions then fall
+  /// back to scanning the arrays until this function is called again.
+  ///
+  /// \note
+  ///   Call this function after setting up a transition table in code. If any other table data
+  ///   (e.g. a transition ID or the source sequence of a transition set) is modified directly,
+  ///   call InvalidateLookupIndices or this function afterwards.
+  ///
+  ANIMATION_IMPEXP void UpdateLookupIndices();
+
+
+  ///
+  /// \brief
+  ///   Marks the lookup indices as outdated, see UpdateLookupIndices.
+  ///
+  inline void InvalidateLookupIndices()
+  {
+    m_bLookupIndicesValid = false;
+  }
+
+
+  ///
+  /// \brief
+  ///   Indicates whether the lookup indices are up to date, see UpdateLookupIndices.
+  ///
+  inline bool HasValidLookupIndices() const
+  {
+    return m_bLookupIndicesValid;
+  }
+
+
+  ///
+  /// @}
+  ///
+
+
   ///
   /// @name Allocating Data 
   /// @{
@@ -1508,6 +1559,7 @@ public:
   {
     if (m_iSequenceDefCount == iCount)
       return m_pSequenceDef;
+    InvalidateLookupIndices();
     V_SAFE_DELETE_ARRAY(m_pSequenceDef);
     m_iSequenceDefCount = iCount;
     if (iCount > 0)
@@ -1530,6 +1582,7 @@ public:
   {
     if (m_iSequenceSetCount == iCount)
       return m_pSequenceSet;
+    InvalidateLookupIndices();
     V_SAFE_DELETE_ARRAY(m_pSequenceSet);
     m_iSequenceSetCount = iCount;
     if (iCount > 0)
@@ -1562,6 +1615,7 @@ public:
   {
     if (m_iTransitionDefCount == iCount)
       return m_pTransitionDef;
+    InvalidateLookupIndices();
     V_SAFE_DELETE_ARRAY(m_pTransitionDef);
     m_iTransitionDefCount = iCount;
     if (iCount > 0)
@@ -1584,6 +1638,7 @@ public:
   {
     if (m_iTransitionSetCount == iCount)
       return m_pTransitionSet;
+    InvalidateLookupIndices();
     V_SAFE_DELETE_ARRAY(m_pTransitionSet);
     m_iTransitionSetCount = iCount;
     if (iCount > 0)
@@ -1604,6 +1659,7 @@ protected:
   ANIMATION_IMPEXP virtual BOOL Unload();
 
   VisAnimSequence_cl* DeserializeBlendSequence(VArchive &ar, char iLocalVersion);
+  VTransitionDef* LookupTransitionPair(int iSetIndex, VisAnimSequence_cl *pTargetSequence) const;
 
   VDynamicMesh *m_pMesh;                            ///< Owner entity model
 
@@ -1620,6 +1676,16 @@ protected:
   int m_iTransitionDefCount;                        ///< Number of allocated transition definitions
 
   bool m_bBrokenVersion3;   // local version 3 had some compatibility issues
+
+  // Lookup indices, see UpdateLookupIndices
+  VMapCPtrToInt m_TransitionSetIndex;               ///< Source sequence -> index in m_pTransitionSet
+  VMapCPtrToInt m_SequenceDefIndex;                 ///< Sequence -> index in m_pSequenceDef
+  VMapIntToInt m_TransitionDefIndex;                ///< Transition ID -> index in m_pTransitionDef
+  VStrMap<VSequenceSet> m_SequenceSetIndex;         ///< File name -> sequence set
+  VMapCPtrToInt m_TargetSequenceIndex;              ///< Target sequence -> dense target index
+  VMapIntToPtr m_TransitionPairIndex;               ///< Set index * m_iIndexedTargetCount + target index -> transition definition
+  int m_iIndexedTargetCount;                        ///< Number of distinct target sequences
+  bool m_bLookupIndicesValid;
 };
 
 #endif // VTRANSITIONBASE_HPP_INCLUDED
@@ -100,6 +100,7 @@ VTransitionTable *VTransitionManager::CreateDefaultTransitionTable(VDynamicMesh
     }
   }
 
+  pTable->UpdateLookupIndices();
   return pTable;
 }
 
@@ -0,0 +1,167 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Animation/Transition/VTransitionManager.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// VTransitionTableTest
+///////////////////////////////////////////////////////////////////////////////////
+
+// Builds a transition table in code like VTransitionManager::CreateDefaultTransitionTable (64 sequences,
+// every sequence can blend to every other one, 8 transition definitions) and lets 1000 state machines
+// switch to random states for 100 steps. Every switch performs the lookups of VTransitionStateMachine::SetState
+// (sequence definition of the target and transition definition of the pair). This runs once with the
+// lookup indices and once with the linear scans that are used while the indices are invalid, and both have
+// to resolve the same definitions. The time per step is printed to the test log.
+class VTransitionTableTest : public VTestClass
+{
+public:
+  virtual void DescribeTest() HKV_OVERRIDE
+  {
+    SetTestName("Transition table lookups");
+    AddSubTest("Indexed lookups match the linear scans");
+  }
+
+  virtual VBool Init() HKV_OVERRIDE;
+  virtual void InitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool RunSubTest(int iTest) HKV_OVERRIDE;
+  virtual void DeInitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool DeInit() HKV_OVERRIDE;
+
+  V_DECLARE_DYNCREATE(VTransitionTableTest);
+
+protected:
+  VRefCountedCollection<VisAnimSequence_cl> m_Sequences;
+  VDynamicMeshPtr m_spMesh;
+  VTransitionTablePtr m_spTable;
+};
+
+V_IMPLEMENT_DYNCREATE(VTransitionTableTest, VTestClass, &g_VisionEngineModule);
+
+
+#define TRANSITIONTEST_SEQUENCES    64
+#define TRANSITIONTEST_DEFINITIONS  8
+
+VBool VTransitionTableTest::Init()
+{
+  for (int i=0;i<TRANSITIONTEST_SEQUENCES;i++)
+    m_Sequences.Add(new VisSkeletalAnimSequence_cl());
+
+  m_spMesh = new VDynamicMesh();
+  m_spTable = new VTransitionTable(&VTransitionManager::GlobalManager(), m_spMesh);
+  VTransitionDef *pDefs = m_spTable->AllocateTransitionDefs(TRANSITIONTEST_DEFINITIONS);
+  for (int i=0;i<TRANSITIONTEST_DEFINITIONS;i++)
+  {
+    pDefs[i].m_eType = TRANSITION_TYPE_CROSSFADE;
+    pDefs[i].m_fBlendDuration = 0.1f*(float)(i+1);
+    pDefs[i].m_iID = i;
+  }
+
+  VSequenceDef *pSequenceDefs = m_spTable->AllocateSequenceDefs(TRANSITIONTEST_SEQUENCES);
+  VTransitionSet *pSets = m_spTable->AllocateTransitionSets(TRANSITIONTEST_SEQUENCES);
+  for (int i=0;i<TRANSITIONTEST_SEQUENCES;i++)
+  {
+    pSequenceDefs[i].Init(m_Sequences.GetAt(i), m_spTable, NULL);
+    pSets[i].AllocateTargets(TRANSITIONTEST_SEQUENCES-1);
+    pSets[i].Init(m_Sequences.GetAt(i), m_spTable, NULL);
+    int iIndex = 0;
+    for (int j=0;j<TRANSITIONTEST_SEQUENCES;j++)
+      if (j!=i)
+        VTEST_RETURN(pSets[i].AddTransitionPair(m_Sequences.GetAt(j), &pDefs[(i+j)%TRANSITIONTEST_DEFINITIONS], iIndex++), FALSE);
+  }
+
+  return TRUE;
+}
+
+VBool VTransitionTableTest::RunSubTest(int iTest)
+{
+  const int iStateMachineCount = 1000;
+  const int iSteps = 100;
+
+  // the same random switches for both runs
+  DynArray_cl<int> targets(iStateMachineCount*iSteps);
+  DynArray_cl<int> states(iStateMachineCount);
+  DynArray_cl<VTransitionDef *> resolved(iStateMachineCount*iSteps);
+  VRandom randGen(4321);
+  for (int i=0;i<iStateMachineCount*iSteps;i++)
+    targets.GetDataPtr()[i] = (int)(randGen.GetInt()%TRANSITIONTEST_SEQUENCES);
+
+  double fTimeMS[2];
+  for (int iIndexed=1;iIndexed>=0;iIndexed--)
+  {
+    if (iIndexed)
+      m_spTable->UpdateLookupIndices();
+    else
+      m_spTable->InvalidateLookupIndices();
+    for (int i=0;i<iStateMachineCount;i++)
+      states.GetDataPtr()[i] = i%TRANSITIONTEST_SEQUENCES;
+
+    bool bResolved = true;
+    bool bSameResult = true;
+    const uint64 iStartTime = VGLGetTimer();
+    const int *pTarget = targets.GetDataPtr();
+    VTransitionDef **pResolved = resolved.GetDataPtr();
+    for (int iStep=0;iStep<iSteps;iStep++)
+    {
+      for (int i=0;i<iStateMachineCount;i++,pTarget++,pResolved++)
+      {
+        int &iState(states.GetDataPtr()[i]);
+        if (*pTarget==iState)
+          continue;
+        VisAnimSequence_cl *pSource = m_Sequences.GetAt(iState);
+        VisAnimSequence_cl *pTargetSequence = m_Sequences.GetAt(*pTarget);
+        VSequenceDef *pSequenceDef = m_spTable->GetSequenceDef(pTargetSequence);
+        VTransitionDef *pTransition = m_spTable->GetTransitionDef(pSource, pTargetSequence);
+        if (pSequenceDef==NULL || pSequenceDef->GetOwnerSequence()!=pTargetSequence || pTransition==NULL)
+          bResolved = false;
+        if (iIndexed)
+          *pResolved = pTransition;
+        else if (*pResolved!=pTransition)
+          bSameResult = false;
+        iState = *pTarget;
+      }
+    }
+    fTimeMS[iIndexed] = (double)(VGLGetTimer()-iStartTime)*1000.0/((double)VGLGetTimerResolution()*(double)iSteps);
+
+    VTESTM(bResolved, "Not all transitions have been resolved %s the lookup indices", iIndexed ? "with" : "without");
+    VTESTM(bSameResult, "The lookup indices resolve other transitions than the linear scans");
+  }
+
+  for (int i=0;i<TRANSITIONTEST_DEFINITIONS;i++)
+    VTEST(m_spTable->GetTransitionDef(i)!=NULL && m_spTable->GetTransitionDef(i)->m_iID==i);
+
+  Printf("%i state machines, %i sequences: indexed %.4f ms, linear scans %.4f ms per step",
+    iStateMachineCount, TRANSITIONTEST_SEQUENCES, fTimeMS[1], fTimeMS[0]);
+  return FALSE;
+}
+
+VBool VTransitionTableTest::DeInit()
+{
+  m_spTable = NULL;
+  m_spMesh = NULL;
+  m_Sequences.Clear();
+  return TRUE;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -12,6 +12,24 @@
 #include <Vision/Runtime/Engine/Animation/VisApiAnimNormalizeMixerNode.hpp>
 #include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
 
+// *******************************************************************************
+// *  Packed LOD batch data (see VEntityLODComponentManager::UpdateLODs)
+// *
+// *  Blocks of 4 components are stored as posX[4],posY[4],posZ[4],minDist[4],maxDist[4],
+// *  so the camera distances and the level range test need a few SIMD instructions.
+// *******************************************************************************
+
+#define ENTITYLOD_BLOCKSIZE     4
+#define ENTITYLOD_BLOCKFLOATS   (5*ENTITYLOD_BLOCKSIZE)
+
+#if ((defined(WIN32) && !defined(_M_ARM)) || defined(__SSE__)) && !defined(_VISION_XENON)
+  #include <xmmintrin.h>
+  #define ENTITYLOD_SSE
+#elif defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define ENTITYLOD_NEON
+#endif
+
 /// =========================================================================== ///
 /// Entity LOD Level Info Methods                                               ///
 /// =========================================================================== ///
@@ -71,6 +89,7 @@ VEntityLODComponent::VEntityLODComponent(int iComponentFlags)
   , Level_UltraLow_Distance(1500.0f * Vision::World.GetGlobalUnitScaling())
   , m_iCurrentLevel(-1)
   , m_pLevels(NULL)
+  , m_bAnimFrozenByLOD(false)
 {
 }
 
@@ -86,6 +105,7 @@ void VEntityLODComponent::CommonInit()
     return;
 
   // Get number of LOD levels
+  SetAnimationFrozenByLOD(false);
   V_SAFE_DELETE_ARRAY(m_pLevels);
   m_pLevels = new VEntityLODLevelInfo[LOD_LevelCount + 1];
 
@@ -173,12 +193,28 @@ void VEntityLODComponent::SetLODLevel(VEntityLODLevel_e newLevel)
 
 void VEntityLODComponent::UpdateLOD()
 {
-  float fDistance = GetDistanceToCamera();
+  float fThreshold = 0.0f;
+#ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+  fThreshold = VLODHysteresisManager::GetThreshold(VLHT_ENTITIES);
+#endif //SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+
+  UpdateLOD(GetDistanceToCamera(), fThreshold);
+}
+
+void VEntityLODComponent::UpdateLOD(float fDistance, float fThreshold)
+{
+  const int iLevel = ComputeLODLevel(fDistance, fThreshold);
+
+  // Only use thresholding if current level is initialized.
+  if (fThreshold > 0.0f && m_iCurrentLevel != -1)
+    UpdateClipReference();
+
+  ApplyLOD(iLevel);
+}
 
-  // compute LOD level
+int VEntityLODComponent::ComputeLODLevel(float fDistance, float fThreshold) const
+{
   int iLevel = 0;
-#ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
-  float fThreshold = VLODHysteresisManager::GetThreshold(VLHT_ENTITIES);
 
   // Only use thresholding if current level is initialized.
   if (fThreshold > 0.0f && m_iCurrentLevel != -1)
@@ -211,13 +247,8 @@ void VEntityLODComponent::UpdateLOD()
           break;
       }
     }
-
-    VisBaseEntity_cl *pEntity = vstatic_cast<VisBaseEntity_cl*>(m_pOwner);
-    if (pEntity != NULL)
-      pEntity->SetClipSettings(pEntity->GetNearClipDistance(), pEntity->GetFarClipDistance(), &pEntity->GetPosition());
   }
   else
-#endif //SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
   {
     for (int i = 0; i <= LOD_LevelCount; i++)
     {
@@ -226,7 +257,48 @@ void VEntityLODComponent::UpdateLOD()
     }
   }
 
-  ApplyLOD(iLevel);
+  return iLevel;
+}
+
+void VEntityLODComponent::GetCurrentLevelRange(float fThreshold, float &fMin, float &fMax) const
+{
+  // No level yet: empty range, so the level is always computed
+  if (m_iCurrentLevel == -1)
+  {
+    fMin = hkvMath::FloatMaxPos();
+    fMax = -hkvMath::FloatMaxPos();
+    return;
+  }
+
+  // The range may be smaller than the one actually computed by ComputeLODLevel, but never larger
+  fMin = (m_iCurrentLevel > 0) ? m_pLevels[m_iCurrentLevel].m_fMinSwitchDistance : -hkvMath::FloatMaxPos();
+  fMax = hkvMath::FloatMaxPos();
+  if (m_iCurrentLevel >= LOD_LevelCount)
+    return;
+
+  if (fThreshold > 0.0f)
+  {
+    fMax = m_pLevels[m_iCurrentLevel].m_fMaxSwitchDistance + fThreshold;
+  }
+  else
+  {
+    for (int i = m_iCurrentLevel + 1; i <= LOD_LevelCount; i++)
+      fMax = hkvMath::Min(fMax, m_pLevels[i].m_fMinSwitchDistance);
+  }
+}
+
+void VEntityLODComponent::UpdateClipReference()
+{
+  VisBaseEntity_cl *pEntity = vstatic_cast<VisBaseEntity_cl*>(m_pOwner);
+  if (pEntity == NULL)
+    return;
+
+  // Skip entities that have not moved since the last update
+  const hkvVec3 &vPos = pEntity->GetPosition();
+  if (pEntity->GetClipMode() == VIS_LOD_TEST_CLIPPOSITION && pEntity->GetClipReference().isIdentical(vPos))
+    return;
+
+  pEntity->SetClipSettings(pEntity->GetNearClipDistance(), pEntity->GetFarClipDistance(), &vPos);
 }
 
 void VEntityLODComponent::ApplyLOD(int newLevel)
@@ -234,6 +306,9 @@ void VEntityLODComponent::ApplyLOD(int newLevel)
   if (m_iCurrentLevel == newLevel)
     return;
 
+  // The freeze only applies to the anim config of the previous level
+  SetAnimationFrozenByLOD(false);
+
   m_iCurrentLevel = newLevel;
 
   VisBaseEntity_cl *pEntity = vstatic_cast<VisBaseEntity_cl*>(m_pOwner);
@@ -242,9 +317,26 @@ void VEntityLODComponent::ApplyLOD(int newLevel)
   if (info.m_spMesh != NULL)
   {
     pEntity->SetMesh(info.m_spMesh, info.m_spAnimConfig);
+
+    if (newLevel > 0 && newLevel == LOD_LevelCount && VEntityLODComponentManager::GlobalManager().GetSkipLowestLevelAnimation())
+      SetAnimationFrozenByLOD(true);
   }
 }
 
+void VEntityLODComponent::SetAnimationFrozenByLOD(bool bFrozen)
+{
+  if (m_bAnimFrozenByLOD == bFrozen || m_pLevels == NULL || m_iCurrentLevel < 0)
+    return;
+
+  // Leave configs alone that have been frozen by other code
+  VisAnimConfig_cl *pAnimConfig = m_pLevels[m_iCurrentLevel].m_spAnimConfig;
+  if (pAnimConfig == NULL || (bFrozen && pAnimConfig->GetFrozen()))
+    return;
+
+  pAnimConfig->SetFrozen(bFrozen);
+  m_bAnimFrozenByLOD = bFrozen;
+}
+
 bool VEntityLODComponent::ConnectToExistingAnimConfig()
 {
   // First check if there is a transition state machine
@@ -470,17 +562,156 @@ void VEntityLODComponent::Serialize( VArchive &ar )
 /// VEntityLODComponentManager IVisCallbackHandler_cl Overrides                 ///
 /// =========================================================================== ///
 
-void VEntityLODComponentManager::OnHandleCallback(IVisCallbackDataObject_cl *pData)
+VEntityLODComponentManager::VEntityLODComponentManager()
 {
-  if (pData->m_pSender == &Vision::Callbacks.OnUpdateSceneFinished)
+  for (int i = 0; i <= VLOD_ULTRALOW; i++)
+    m_iUpdateInterval[i] = 1;
+  m_bSkipLowestLevelAnimation = false;
+  m_iFrameCounter = 0;
+}
+
+void VEntityLODComponentManager::SetSkipLowestLevelAnimation(bool bSkip)
+{
+  if (m_bSkipLowestLevelAnimation == bSkip)
+    return;
+  m_bSkipLowestLevelAnimation = bSkip;
+
+  const int iCount = m_Components.Count();
+  for (int i = 0; i < iCount; i++)
   {
-    // call update function on every component
-    const int iCount = m_Components.Count();
-    for (int i = 0; i < iCount; i++)
+    VEntityLODComponent *pComponent = m_Components.GetAt(i);
+    const int iLevel = pComponent->m_iCurrentLevel;
+    if (!bSkip)
+      pComponent->SetAnimationFrozenByLOD(false);
+    else if (iLevel > 0 && iLevel == pComponent->LOD_LevelCount && pComponent->m_pLevels[iLevel].m_spMesh != NULL)
+      pComponent->SetAnimationFrozenByLOD(true);
+  }
+}
+
+// Computes the camera distances of a block of components and returns a bit mask of the components
+// whose distance is outside of the range of their current level
+static int ComputeBlockDistances(const float *pBlock, const hkvVec3 &vCameraPos, float *pDistance)
+{
+#if defined(ENTITYLOD_SSE)
+  const __m128 dx = _mm_sub_ps(_mm_loadu_ps(pBlock), _mm_set1_ps(vCameraPos.x));
+  const __m128 dy = _mm_sub_ps(_mm_loadu_ps(pBlock + 4), _mm_set1_ps(vCameraPos.y));
+  const __m128 dz = _mm_sub_ps(_mm_loadu_ps(pBlock + 8), _mm_set1_ps(vCameraPos.z));
+  const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx), _mm_mul_ps(dy,dy)), _mm_mul_ps(dz,dz)));
+  _mm_storeu_ps(pDistance, dist);
+  const __m128 inRange = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(pBlock + 12), dist), _mm_cmplt_ps(dist, _mm_loadu_ps(pBlock + 16)));
+  return ~_mm_movemask_ps(inRange) & 0xf;
+
+#elif defined(ENTITYLOD_NEON)
+  // ARMv7 NEON has no exact square root, so only the squared distances are computed in SIMD
+  const float32x4_t dx = vsubq_f32(vld1q_f32(pBlock), vdupq_n_f32(vCameraPos.x));
+  const float32x4_t dy = vsubq_f32(vld1q_f32(pBlock + 4), vdupq_n_f32(vCameraPos.y));
+  const float32x4_t dz = vsubq_f32(vld1q_f32(pBlock + 8), vdupq_n_f32(vCameraPos.z));
+  vst1q_f32(pDistance, vaddq_f32(vaddq_f32(vmulq_f32(dx,dx), vmulq_f32(dy,dy)), vmulq_f32(dz,dz)));
+  int iMask = 0;
+  for (int j=0; j<ENTITYLOD_BLOCKSIZE; j++)
+  {
+    pDistance[j] = hkvMath::sqrt(pDistance[j]);
+    if (!(pBlock[j+12] <= pDistance[j] && pDistance[j] < pBlock[j+16]))
+      iMask |= 1<<j;
+  }
+  return iMask;
+
+#else
+  int iMask = 0;
+  for (int j=0; j<ENTITYLOD_BLOCKSIZE; j++)
+  {
+    const float dx = pBlock[j] - vCameraPos.x;
+    const float dy = pBlock[j+4] - vCameraPos.y;
+    const float dz = pBlock[j+8] - vCameraPos.z;
+    pDistance[j] = hkvMath::sqrt(dx*dx + dy*dy + dz*dz);
+    if (!(pBlock[j+12] <= pDistance[j] && pDistance[j] < pBlock[j+16]))
+      iMask |= 1<<j;
+  }
+  return iMask;
+#endif
+}
+
+void VEntityLODComponentManager::UpdateLODs()
+{
+  const int iCount = m_Components.Count();
+  if (iCount == 0)
+    return;
+  m_iFrameCounter++;
+
+  float fThreshold = 0.0f;
+#ifdef SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+  fThreshold = VLODHysteresisManager::GetThreshold(VLHT_ENTITIES);
+#endif //SUPPORTS_LOD_HYSTERESIS_THRESHOLDING
+
+  // Collect the components that are due in this frame (same conditions as in VEntityLODComponent::PerFrameUpdate).
+  // The frame offset spreads components with the same update interval across the frames.
+  m_BatchComponents.EnsureSize(iCount);
+  VEntityLODComponent **pBatch = m_BatchComponents.GetDataPtr();
+  int iBatchCount = 0;
+  for (int i = 0; i < iCount; i++)
+  {
+    VEntityLODComponent *pComponent = m_Components.GetAt(i);
+    if (pComponent->LOD_LevelMode != VLOD_AUTO || pComponent->m_pLevels == NULL)
+      continue;
+
+    const int iLevel = pComponent->m_iCurrentLevel;
+    if (iLevel >= 0 && (m_iFrameCounter + (unsigned int)i) % (unsigned int)m_iUpdateInterval[hkvMath::Min(iLevel, (int)VLOD_ULTRALOW)] != 0)
+      continue;
+
+    if (!vstatic_cast<VisBaseEntity_cl*>(pComponent->m_pOwner)->WasVisibleInAnyLastFrame())
+      continue;
+
+    pBatch[iBatchCount++] = pComponent;
+  }
+  if (iBatchCount == 0)
+    return;
+
+  // Pack positions and level ranges. Unused slots of the last block are never evaluated.
+  const int iBlockCount = (iBatchCount + ENTITYLOD_BLOCKSIZE - 1) / ENTITYLOD_BLOCKSIZE;
+  m_BatchData.EnsureSize(iBlockCount*ENTITYLOD_BLOCKFLOATS);
+  m_BatchDistance.EnsureSize(iBlockCount*ENTITYLOD_BLOCKSIZE);
+  float *pData = m_BatchData.GetDataPtr();
+  float *pDistance = m_BatchDistance.GetDataPtr();
+  for (int i = 0; i < iBlockCount*ENTITYLOD_BLOCKSIZE; i++)
+  {
+    float *pSlot = &pData[(i/ENTITYLOD_BLOCKSIZE)*ENTITYLOD_BLOCKFLOATS + (i%ENTITYLOD_BLOCKSIZE)];
+    if (i < iBatchCount)
+    {
+      const hkvVec3 &vPos = vstatic_cast<VisBaseEntity_cl*>(pBatch[i]->m_pOwner)->GetPosition();
+      pSlot[0] = vPos.x;
+      pSlot[4] = vPos.y;
+      pSlot[8] = vPos.z;
+      pBatch[i]->GetCurrentLevelRange(fThreshold, pSlot[12], pSlot[16]);
+    }
+    else
     {
-      m_Components.GetAt(i)->PerFrameUpdate();
+      pSlot[0] = pSlot[4] = pSlot[8] = pSlot[12] = pSlot[16] = 0.0f;
     }
   }
+
+  // Compute all distances and only evaluate the components whose level may change
+  const hkvVec3 vCameraPos = Vision::Camera.GetCurrentCameraPosition();
+  for (int iBlock = 0; iBlock < iBlockCount; iBlock++)
+  {
+    const int iFirst = iBlock*ENTITYLOD_BLOCKSIZE;
+    const int iMask = ComputeBlockDistances(&pData[iBlock*ENTITYLOD_BLOCKFLOATS], vCameraPos, &pDistance[iFirst]);
+    const int iSlots = hkvMath::Min(ENTITYLOD_BLOCKSIZE, iBatchCount - iFirst);
+    for (int j = 0; j < iSlots; j++)
+    {
+      if (iMask & (1<<j))
+        pBatch[iFirst+j]->UpdateLOD(pDistance[iFirst+j], fThreshold);
+      else if (fThreshold > 0.0f)
+        pBatch[iFirst+j]->UpdateClipReference();
+    }
+  }
+}
+
+void VEntityLODComponentManager::OnHandleCallback(IVisCallbackDataObject_cl *pData)
+{
+  if (pData->m_pSender == &Vision::Callbacks.OnUpdateSceneFinished)
+  {
+    UpdateLODs();
+  }
   else if (pData->m_pSender == &Vision::Callbacks.OnAfterSceneLoaded)
   {
     // call update function on every component
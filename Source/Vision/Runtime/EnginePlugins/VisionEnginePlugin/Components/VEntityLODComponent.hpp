@@ -171,6 +171,7 @@ public:
   {
     for (int i=0; i < LOD_LevelCount; i++)
       m_pLevels[i].m_spAnimConfig->SetFrozen(bNewState);
+    m_bAnimFrozenByLOD = false;
   }
 
   ///
@@ -426,6 +427,21 @@ private:
   // Private functions
   void InitializeLODLevelInfo(int iLevel, const char* szMeshFilename, float fMinDistance, float fMaxDistance);
 
+  // Computes the LOD level for the passed camera distance. Uses hysteresis if fThreshold>0 and a level has been set before.
+  int ComputeLODLevel(float fDistance, float fThreshold) const;
+
+  // Updates the LOD level for the passed camera distance (see UpdateLOD)
+  void UpdateLOD(float fDistance, float fThreshold);
+
+  // Returns the camera distance range [fMin..fMax[ in which ComputeLODLevel keeps the current level
+  void GetCurrentLevelRange(float fThreshold, float &fMin, float &fMax) const;
+
+  // Moves the clip reference position to the owner position, as required by LOD hysteresis
+  void UpdateClipReference();
+
+  // Freezes or unfreezes the anim config of the current level, see VEntityLODComponentManager::SetSkipLowestLevelAnimation
+  void SetAnimationFrozenByLOD(bool bFrozen);
+
   // Set the result generator as the animation root node on the final result of each LOD.
   void SetSkeletalAnimRootNode(IVisAnimResultGenerator_cl *pRoot, bool bAppyMotionDelta);
 
@@ -443,6 +459,7 @@ private:
   VString Level_High_Mesh;              ///< High level mesh defined by owner entity mesh
   int m_iCurrentLevel;                  ///< Current LOD level
   VEntityLODLevelInfo *m_pLevels;       ///< Information about LOD levels
+  bool m_bAnimFrozenByLOD;              ///< Anim config of the current level has been frozen by this component
 };
 
 
@@ -460,12 +477,25 @@ class VEntityLODComponentCollection : public VRefCountedCollection<VEntityLODCom
 ///   Manager for all VPlayableCharacterComponent instance
 ///
 /// This manager class has a list of all available VEntityLODComponent instances
-/// and takes care of calling their VEntityLODComponent::PerFrameUpdate function
-/// each frame.
+/// and updates their LOD level each frame.
+///
+/// The update is batched: the owner positions and the distance range in which each component
+/// keeps its current level are packed into arrays, and all camera distances are computed and
+/// tested in one SIMD pass. Only components whose level can change are evaluated further, so the
+/// result is the same as calling VEntityLODComponent::PerFrameUpdate on every component.
+///
+/// Components at far LOD levels can be updated less frequently (see SetUpdateInterval), and the
+/// animation of components at their lowest level can be skipped (see SetSkipLowestLevelAnimation).
 ///
 class VEntityLODComponentManager : public IVisCallbackHandler_cl
 {
 public:
+  ///
+  /// \brief
+  ///   Constructor
+  ///
+  VEntityLODComponentManager();
+
   ///
   /// \brief
   ///   Gets the singleton of the manager
@@ -509,11 +539,77 @@ public:
   ///  
   virtual void OnHandleCallback(IVisCallbackDataObject_cl *pData);
 
+  ///
+  /// \brief
+  ///   Updates the LOD level of all components in auto mode whose owner was visible in the last frame
+  ///
+  /// This function is called by OnHandleCallback after the scene has been updated.
+  ///
+  EFFECTS_IMPEXP void UpdateLODs();
+
+  ///
+  /// \brief
+  ///   Sets the interval (in frames) at which the LOD of components at the passed level is re-evaluated
+  ///
+  /// The default is 1 for all levels, i.e. every frame. Larger values for far levels save CPU time
+  /// for large numbers of entities, at the cost of switching their LOD a few frames late. The
+  /// updates are distributed evenly across the frames.
+  ///
+  /// \param iLevel
+  ///   LOD level (VLOD_HIGH..VLOD_ULTRALOW)
+  ///
+  /// \param iFrames
+  ///   Update interval in frames (>=1)
+  ///
+  inline void SetUpdateInterval(int iLevel, int iFrames)
+  {
+    VASSERT(iLevel>=VLOD_HIGH && iLevel<=VLOD_ULTRALOW && iFrames>=1);
+    m_iUpdateInterval[iLevel] = hkvMath::Max(iFrames, 1);
+  }
+
+  ///
+  /// \brief
+  ///   Returns the update interval (in frames) of the passed LOD level, see SetUpdateInterval
+  ///
+  inline int GetUpdateInterval(int iLevel) const
+  {
+    VASSERT(iLevel>=VLOD_HIGH && iLevel<=VLOD_ULTRALOW);
+    return m_iUpdateInterval[iLevel];
+  }
+
+  ///
+  /// \brief
+  ///   If enabled, the anim config of components at their lowest LOD level is frozen, so its
+  ///   animation is not updated anymore until the component switches to another level
+  ///
+  /// Only applies to components with more than one LOD level. Anim configs that have already been
+  /// frozen by other code are left untouched. Disabled by default.
+  ///
+  EFFECTS_IMPEXP void SetSkipLowestLevelAnimation(bool bSkip);
+
+  ///
+  /// \brief
+  ///   Returns the value set with SetSkipLowestLevelAnimation
+  ///
+  inline bool GetSkipLowestLevelAnimation() const
+  {
+    return m_bSkipLowestLevelAnimation;
+  }
+
 protected:
 
   /// Holds the collection of all instances of VEntityLODComponent
   VEntityLODComponentCollection m_Components;
 
+  int m_iUpdateInterval[VLOD_ULTRALOW+1];   ///< Update interval in frames per LOD level
+  bool m_bSkipLowestLevelAnimation;
+  unsigned int m_iFrameCounter;
+
+  // Per-frame batch data
+  DynArray_cl<VEntityLODComponent*> m_BatchComponents;  ///< Components that are evaluated in this frame
+  DynArray_cl<float> m_BatchData;                       ///< Per block of 4 components: position x,y,z, min and max distance (4 floats each)
+  DynArray_cl<float> m_BatchDistance;                   ///< Camera distance per component
+
   /// One global instance of our manager
   static VEntityLODComponentManager g_GlobalManager;
 
@@ -56,9 +56,22 @@ void VFollowPathComponent::Init()
 
 void VFollowPathComponent::PerFrameUpdate()
 {
-  if (!GetOwner())
+  float fCurrentParam;
+  if (!AdvanceTime(fCurrentParam))
     return;
 
+  const VPathArcLengthTable *pTable = ConstantSpeed ? VFollowPathComponentManager::GlobalManager().GetArcLengthTable(m_pPath) : NULL;
+
+  hkvVec3 vPos, vDir;
+  EvaluatePathPoint(fCurrentParam, pTable, vPos, vDir);
+  ApplyPathPoint(vPos, vDir);
+}
+
+bool VFollowPathComponent::AdvanceTime(float &fParam)
+{
+  if (!GetOwner())
+    return false;
+
   // Check whether path object is set. If not look for the respective path and if no path
   // object can be found output a warning. This is only done in the first frame update of 
   // this component as we do not want to call the init function each frame.
@@ -68,15 +81,10 @@ void VFollowPathComponent::PerFrameUpdate()
     {
       Init();
       m_bFirstFrame = false;
-      if (!m_pPath)
-        return;
     }
-    return;
+    return false;
   }
 
-  // Get owner 3D object
-  VisObject3D_cl *pObject3D = (VisObject3D_cl *)m_pOwner;
-
   // Get time since last frame
   m_fCurrentTime += Vision::GetTimer()->GetTimeDifference();
   if (m_fCurrentTime > Time)
@@ -84,22 +92,30 @@ void VFollowPathComponent::PerFrameUpdate()
     if (Looped)
       m_fCurrentTime = 0.f;
     else
-      return;
+      return false;
   }
 
   // Calculate current relative parameter value [0..1]
-  float fCurrentParam = m_fCurrentTime / Time;
+  fParam = m_fCurrentTime / Time;
+  return true;
+}
 
-  // Evaluate current position on path
-  hkvVec3 vPos;
-  hkvVec3 vDir;
+void VFollowPathComponent::EvaluatePathPoint(float fParam, const VPathArcLengthTable *pTable, hkvVec3 &vPos, hkvVec3 &vDir) const
+{
+  // For constant speed, map the relative arc length to the path parameter
+  if (pTable != NULL)
+    fParam = pTable->GetPathParameter(fParam);
+
+  m_pPath->EvalPoint(fParam, vPos, Direction ? &vDir : NULL, NULL);
+}
+
+void VFollowPathComponent::ApplyPathPoint(const hkvVec3 &vPos, const hkvVec3 &vDir)
+{
+  // Get owner 3D object
+  VisObject3D_cl *pObject3D = (VisObject3D_cl *)m_pOwner;
 
   if (Direction)
   {
-    if (ConstantSpeed)
-      m_pPath->EvalPointSmooth(fCurrentParam, vPos, &vDir, NULL);
-    else
-      m_pPath->EvalPoint(fCurrentParam, vPos, &vDir, NULL);
     pObject3D->SetUseEulerAngles(true); 
     pObject3D->SetPosition(vPos + PositionOffset);
     pObject3D->SetDirection(vDir);
@@ -107,15 +123,80 @@ void VFollowPathComponent::PerFrameUpdate()
   }
   else
   {
-    if (ConstantSpeed)
-      m_pPath->EvalPointSmooth(fCurrentParam, vPos, NULL, NULL);
-    else
-      m_pPath->EvalPoint(fCurrentParam, vPos, NULL, NULL);
     pObject3D->SetPosition(vPos + PositionOffset);
   }
 }
 
 
+/// =========================================================================== ///
+/// Path Arc Length Table                                                       ///
+/// =========================================================================== ///
+
+VPathArcLengthTable::VPathArcLengthTable()
+{
+  m_pPath = NULL;
+  m_iPathChangedFrame = -1;
+  m_iPathNodeCount = 0;
+  m_bPathClosed = false;
+  m_iSampleCount = 0;
+  m_fLength = 0.f;
+  m_iLastUsedUpdate = 0;
+}
+
+void VPathArcLengthTable::Build(VisPath_cl *pPath)
+{
+  VASSERT(pPath != NULL);
+  m_pPath = pPath;
+  m_iPathChangedFrame = pPath->GetLastChangedFrame();
+  m_iPathNodeCount = pPath->GetPathNodeCount();
+  m_bPathClosed = (pPath->IsClosed() == TRUE);
+  m_iSampleCount = 0;
+  m_fLength = 0.f;
+
+  const int iSegments = m_bPathClosed ? m_iPathNodeCount : (m_iPathNodeCount - 1);
+  if (iSegments < 1)
+    return;
+
+  // Accumulate the chord lengths between evenly spaced path parameters
+  const int iSamples = iSegments * PATH_ARCLENGTH_SAMPLES_PER_SEGMENT;
+  const float fStep = 1.f / (float)iSamples;
+  DynArray_cl<float> distance(iSamples + 1);
+  float *pDistance = distance.GetDataPtr();
+
+  hkvVec3 vPrev, vPos;
+  pPath->EvalPoint(0.f, vPrev);
+  pDistance[0] = 0.f;
+  for (int i = 1; i <= iSamples; i++)
+  {
+    pPath->EvalPoint((float)i * fStep, vPos);
+    pDistance[i] = pDistance[i - 1] + (vPos - vPrev).getLength();
+    vPrev = vPos;
+  }
+
+  m_fLength = pDistance[iSamples];
+  if (m_fLength <= HKVMATH_LARGE_EPSILON)
+    return; // degenerated path: GetPathParameter returns the relative length unchanged
+
+  // Invert: path parameter at evenly spaced arc lengths
+  m_Parameter.EnsureSize(iSamples + 1);
+  float *pParameter = m_Parameter.GetDataPtr();
+  int iInterval = 0;
+  for (int i = 0; i < iSamples; i++)
+  {
+    const float fDistance = (float)i * fStep * m_fLength;
+    while (iInterval < iSamples - 1 && pDistance[iInterval + 1] < fDistance)
+      iInterval++;
+
+    const float fIntervalLength = pDistance[iInterval + 1] - pDistance[iInterval];
+    const float fFraction = (fIntervalLength > 0.f) ? hkvMath::clamp((fDistance - pDistance[iInterval]) / fIntervalLength, 0.f, 1.f) : 0.f;
+    pParameter[i] = ((float)iInterval + fFraction) * fStep;
+  }
+  pParameter[iSamples] = 1.f;
+
+  m_iSampleCount = iSamples;
+}
+
+
 /// =========================================================================== ///
 /// IVObjectComponent Overrides                                                 ///
 /// =========================================================================== ///
@@ -209,6 +290,195 @@ void VFollowPathComponent::Serialize( VArchive &ar )
 }
 
 
+/// =========================================================================== ///
+/// Follow Path Component Manager                                               ///
+/// =========================================================================== ///
+
+#define FOLLOWPATH_PARALLEL_THRESHOLD 256       // minimum number of moved components to evaluate in parallel
+#define FOLLOWPATH_MIN_CHUNK_SIZE 64
+#define FOLLOWPATH_MAX_TASKS 16
+
+/// Task that evaluates the path points of a range of components
+class VFollowPathEvaluateTask : public VThreadedTask
+{
+public:
+  VFollowPathEvaluateTask() : m_pUpdates(NULL), m_pOrder(NULL), m_iCount(0) {}
+  virtual ~VFollowPathEvaluateTask() {}
+
+  VFollowPathComponentManager::PathUpdate_t *m_pUpdates;
+  const int *m_pOrder;
+  int m_iCount;
+
+  virtual void Run(VManagedThread *pThread) HKV_OVERRIDE
+  {
+    for (int i = 0; i < m_iCount; i++)
+    {
+      VFollowPathComponentManager::PathUpdate_t &update = m_pUpdates[m_pOrder[i]];
+      update.m_pComponent->EvaluatePathPoint(update.m_fParam, update.m_pTable, update.m_vPos, update.m_vDir);
+    }
+  }
+};
+
+VFollowPathComponentManager::VFollowPathComponentManager()
+{
+  m_bHandleOnUpdateSceneBegin = false;
+  m_iUpdateCounter = 0;
+}
+
+const VPathArcLengthTable *VFollowPathComponentManager::GetArcLengthTable(VisPath_cl *pPath)
+{
+  VASSERT(pPath != NULL);
+
+  void *pValue = NULL;
+  VPathArcLengthTable *pTable;
+  if (m_ArcLengthTables.Lookup(pPath, pValue))
+  {
+    pTable = (VPathArcLengthTable *)pValue;
+  }
+  else
+  {
+    pTable = new VPathArcLengthTable();
+    m_ArcLengthTables.SetAt(pPath, pTable);
+  }
+
+  if (!pTable->IsUpToDate(pPath))
+    pTable->Build(pPath);
+
+  pTable->m_iLastUsedUpdate = m_iUpdateCounter;
+  return pTable;
+}
+
+void VFollowPathComponentManager::ReleaseArcLengthTables()
+{
+  VPOSITION pos = m_ArcLengthTables.GetStartPosition();
+  while (pos)
+  {
+    const void *pKey;
+    void *pValue;
+    m_ArcLengthTables.GetNextPair(pos, pKey, pValue);
+    delete (VPathArcLengthTable *)pValue;
+  }
+  m_ArcLengthTables.RemoveAll();
+}
+
+void VFollowPathComponentManager::ReleaseUnusedArcLengthTables()
+{
+  // Tables are only referenced by their path pointer, so drop the tables of all paths that have not been
+  // used in this update; their path might not exist anymore
+  const int iCount = m_ArcLengthTables.GetCount();
+  if (iCount == 0)
+    return;
+
+  DynArray_cl<const void *> unused(iCount);
+  const void **pUnused = unused.GetDataPtr();
+  int iUnusedCount = 0;
+
+  VPOSITION pos = m_ArcLengthTables.GetStartPosition();
+  while (pos)
+  {
+    const void *pKey;
+    void *pValue;
+    m_ArcLengthTables.GetNextPair(pos, pKey, pValue);
+    VPathArcLengthTable *pTable = (VPathArcLengthTable *)pValue;
+    if (pTable->m_iLastUsedUpdate != m_iUpdateCounter)
+    {
+      delete pTable;
+      pUnused[iUnusedCount++] = pKey;
+    }
+  }
+
+  for (int i = 0; i < iUnusedCount; i++)
+    m_ArcLengthTables.RemoveKey(pUnused[i]);
+}
+
+void VFollowPathComponentManager::UpdateComponents()
+{
+  m_iUpdateCounter++;
+
+  // Advance the time of all components. This may initialize components, so it happens in this thread.
+  const int iComponentCount = m_Components.Count();
+  m_Updates.EnsureSize(iComponentCount);
+  PathUpdate_t *pUpdates = m_Updates.GetDataPtr();
+  m_PathGroups.RemoveAll();
+  m_PathGroupStart.EnsureSize(1);
+  int iCount = 0;
+  int iGroupCount = 0;
+
+  for (int i = 0; i < iComponentCount; i++)
+  {
+    VFollowPathComponent *pComponent = m_Components.GetAt(i);
+    PathUpdate_t &update = pUpdates[iCount];
+    if (!pComponent->AdvanceTime(update.m_fParam))
+      continue;
+
+    update.m_pComponent = pComponent;
+    update.m_pTable = pComponent->ConstantSpeed ? GetArcLengthTable(pComponent->m_pPath) : NULL;
+
+    if (!m_PathGroups.Lookup(pComponent->m_pPath, update.m_iGroup))
+    {
+      update.m_iGroup = iGroupCount++;
+      m_PathGroups.SetAt(pComponent->m_pPath, update.m_iGroup);
+      m_PathGroupStart.EnsureSize(iGroupCount + 1);
+      m_PathGroupStart.GetDataPtr()[update.m_iGroup] = 0;
+    }
+    m_PathGroupStart.GetDataPtr()[update.m_iGroup]++;
+    iCount++;
+  }
+
+  ReleaseUnusedArcLengthTables();
+
+  if (iCount == 0)
+    return;
+
+  // Sort the components by path (counting sort), so the components that share a path are evaluated together
+  int *pGroupStart = m_PathGroupStart.GetDataPtr();
+  int iOffset = 0;
+  for (int g = 0; g < iGroupCount; g++)
+  {
+    const int iGroupSize = pGroupStart[g];
+    pGroupStart[g] = iOffset;
+    iOffset += iGroupSize;
+  }
+
+  m_UpdateOrder.EnsureSize(iCount);
+  int *pOrder = m_UpdateOrder.GetDataPtr();
+  for (int i = 0; i < iCount; i++)
+    pOrder[pGroupStart[pUpdates[i].m_iGroup]++] = i;
+
+  // Evaluate the path points. Evaluating only reads the paths and tables, so it is split into chunks
+  // for the worker threads if there are enough components; the first chunk is processed in this thread.
+  VThreadManager *pThreadManager = Vision::GetThreadManager();
+  int iTaskCount = 1;
+  if (iCount >= FOLLOWPATH_PARALLEL_THRESHOLD && pThreadManager->GetThreadCount() > 0)
+  {
+    iTaskCount = hkvMath::Min(pThreadManager->GetThreadCount() + 1, iCount / FOLLOWPATH_MIN_CHUNK_SIZE);
+    iTaskCount = hkvMath::clamp(iTaskCount, 1, FOLLOWPATH_MAX_TASKS);
+  }
+
+  VFollowPathEvaluateTask tasks[FOLLOWPATH_MAX_TASKS];
+  for (int t = 0; t < iTaskCount; t++)
+  {
+    const int iFirst = (iCount * t) / iTaskCount;
+    const int iEnd = (iCount * (t + 1)) / iTaskCount;
+    tasks[t].m_pUpdates = pUpdates;
+    tasks[t].m_pOrder = pOrder + iFirst;
+    tasks[t].m_iCount = iEnd - iFirst;
+    if (t > 0)
+      pThreadManager->ScheduleTask(&tasks[t]);
+  }
+
+  tasks[0].Run(NULL);
+  for (int t = 1; t < iTaskCount; t++)
+    pThreadManager->WaitForTask(&tasks[t], true);
+
+  // Move the owner objects in this thread and in component order, since this triggers engine callbacks
+  for (int i = 0; i < iCount; i++)
+  {
+    const PathUpdate_t &update = pUpdates[i];
+    update.m_pComponent->ApplyPathPoint(update.m_vPos, update.m_vDir);
+  }
+}
+
 void VFollowPathComponentManager::SetHandleOnUpdateSceneBegin(bool bOnUpdateSceneBegin)
 {
   // unregister old callback
@@ -244,11 +514,7 @@ void VFollowPathComponentManager::OnHandleCallback(IVisCallbackDataObject_cl *pD
   {
     // call update function on every component
     if (Vision::Editor.IsPlaying())
-    {
-      const int iCount = m_Components.Count();
-      for (int i=0;i<iCount;i++)
-        m_Components.GetAt(i)->PerFrameUpdate();
-    }
+      UpdateComponents();
   }
   else if (pData->m_pSender == &Vision::Callbacks.OnAfterSceneLoaded)
   {
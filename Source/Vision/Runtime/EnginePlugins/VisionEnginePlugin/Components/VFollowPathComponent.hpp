@@ -20,6 +20,82 @@
 #define FOLLOWPATHCOMPONENT_VERSION_2          2     // constant speed flag
 #define FOLLOWPATHCOMPONENT_VERSION_CURRENT    2     // Current version
 
+#define PATH_ARCLENGTH_SAMPLES_PER_SEGMENT     32    // Arc length table entries per path segment
+
+class VFollowPathComponentManager;
+
+///
+/// \brief
+///   Arc length reparameterization of a path, used by VFollowPathComponent for constant speed movement
+///
+/// The table maps a relative arc length [0..1] to the path parameter of VisPath_cl::EvalPoint, so a point
+/// at constant speed is evaluated with one table lookup and one EvalPoint call, instead of the iterative
+/// approximation of VisPath_cl::EvalPointSmooth.
+///
+/// The table stores the path parameter at evenly spaced arc lengths, with PATH_ARCLENGTH_SAMPLES_PER_SEGMENT
+/// entries per path segment, and interpolates linearly in between.
+///
+/// \see
+///   VFollowPathComponentManager::GetArcLengthTable
+///
+class VPathArcLengthTable
+{
+public:
+  EFFECTS_IMPEXP VPathArcLengthTable();
+
+  ///
+  /// \brief
+  ///   Samples the passed path and builds the table
+  ///
+  EFFECTS_IMPEXP void Build(VisPath_cl *pPath);
+
+  ///
+  /// \brief
+  ///   Indicates whether the table has been built for the current state of the passed path
+  ///
+  inline bool IsUpToDate(const VisPath_cl *pPath) const
+  {
+    return m_pPath == pPath && m_iPathChangedFrame == pPath->GetLastChangedFrame() &&
+      m_iPathNodeCount == pPath->GetPathNodeCount() && m_bPathClosed == (pPath->IsClosed() == TRUE);
+  }
+
+  ///
+  /// \brief
+  ///   Returns the path parameter for VisPath_cl::EvalPoint at the passed relative arc length [0..1]
+  ///
+  inline float GetPathParameter(float fRelativeLength) const
+  {
+    if (m_iSampleCount == 0)
+      return fRelativeLength;
+    const float f = hkvMath::clamp(fRelativeLength, 0.f, 1.f) * (float)m_iSampleCount;
+    const int i = hkvMath::Min((int)f, m_iSampleCount - 1);
+    const float *pParam = &m_Parameter.GetDataPtr()[i];
+    return pParam[0] + (pParam[1] - pParam[0]) * (f - (float)i);
+  }
+
+  ///
+  /// \brief
+  ///   Returns the length of the path as measured when building the table
+  ///
+  inline float GetLength() const
+  {
+    return m_fLength;
+  }
+
+private:
+  friend class VFollowPathComponentManager;
+
+  const VisPath_cl *m_pPath;
+  int m_iPathChangedFrame;
+  int m_iPathNodeCount;
+  bool m_bPathClosed;
+  int m_iSampleCount;               ///< number of intervals; m_Parameter holds m_iSampleCount+1 values
+  float m_fLength;
+  DynArray_cl<float> m_Parameter;   ///< path parameter at relative arc length i/m_iSampleCount
+
+  unsigned int m_iLastUsedUpdate;  ///< used by VFollowPathComponentManager to release unused tables
+};
+
 /// 
 /// \brief
 ///   Path component that can be added 3D objects so they will be able to follow path objects.
@@ -129,6 +205,17 @@ public:
   ///
 
 private:  
+  friend class VFollowPathComponentManager;
+  friend class VFollowPathEvaluateTask;
+
+  // Advances the time and returns the relative position on the path, or false if the owner does not have to be moved
+  bool AdvanceTime(float &fParam);
+
+  // Evaluates the path at the passed relative position. Only reads the path, so it can run on any thread.
+  void EvaluatePathPoint(float fParam, const VPathArcLengthTable *pTable, hkvVec3 &vPos, hkvVec3 &vDir) const;
+
+  // Moves the owner object to an evaluated path point
+  void ApplyPathPoint(const hkvVec3 &vPos, const hkvVec3 &vDir);
 
   // Exposed to vForge:
 
@@ -164,13 +251,23 @@ class VFollowPathComponentCollection : public VRefCountedCollection<VFollowPathC
 ///   Manager for all VPlayableCharacterComponent instance
 ///
 /// This manager class has a list of all available VFollowPathComponent instances
-/// and takes care of calling their VFollowPathComponent::PerFrameUpdate function
-/// on each frame.
+/// and updates them on each frame.
+///
+/// The update is batched: the time of all components is advanced first, then the path points
+/// are evaluated grouped by path (split across VThreadManager tasks for large numbers of components),
+/// and finally the owner objects are moved on the main thread in the order of the components.
+/// The manager also holds one VPathArcLengthTable per path that is used for constant speed movement.
 ///
 class VFollowPathComponentManager : public IVisCallbackHandler_cl
 {
 public:
 
+  ///
+  /// \brief
+  ///   Constructor
+  ///
+  VFollowPathComponentManager();
+
   ///
   /// \brief
   ///   Gets the singleton of the manager
@@ -210,6 +307,8 @@ public:
     }
     
     Vision::Callbacks.OnAfterSceneLoaded -= this;
+
+    ReleaseArcLengthTables();
   }
 
   ///
@@ -238,11 +337,52 @@ public:
   ///  
   virtual void OnHandleCallback(IVisCallbackDataObject_cl *pData);
 
+  ///
+  /// \brief
+  ///   Updates all components. Called by OnHandleCallback while the scene is simulated
+  ///
+  EFFECTS_IMPEXP void UpdateComponents();
+
+  ///
+  /// \brief
+  ///   Returns the arc length table of a path. The table is built or rebuilt if necessary
+  ///
+  /// Tables of paths that are not used by any component in a frame are released by UpdateComponents.
+  /// Must be called from the main thread.
+  ///
+  EFFECTS_IMPEXP const VPathArcLengthTable *GetArcLengthTable(VisPath_cl *pPath);
+
+  ///
+  /// \brief
+  ///   Releases all arc length tables
+  ///
+  EFFECTS_IMPEXP void ReleaseArcLengthTables();
+
 protected:
+  friend class VFollowPathEvaluateTask;
+
+  void ReleaseUnusedArcLengthTables();
+
+  /// Per-component data of the batched update
+  struct PathUpdate_t
+  {
+    VFollowPathComponent *m_pComponent;
+    const VPathArcLengthTable *m_pTable;  ///< NULL for components that do not move at constant speed
+    int m_iGroup;                         ///< index of the path in the current frame
+    float m_fParam;
+    hkvVec3 m_vPos, m_vDir;
+  };
 
   /// Holds the collection of all instances of VFollowPathComponent
   VFollowPathComponentCollection m_Components;
 
+  VMapCPtrToPtr m_ArcLengthTables;        ///< path -> VPathArcLengthTable
+  unsigned int m_iUpdateCounter;
+  DynArray_cl<PathUpdate_t> m_Updates;    ///< components that are moved in the current frame
+  DynArray_cl<int> m_UpdateOrder;         ///< indices into m_Updates, grouped by path
+  DynArray_cl<int> m_PathGroupStart;      ///< first entry in m_UpdateOrder per path used in the current frame
+  VMapCPtrToInt m_PathGroups;             ///< path -> index of the path in the current frame
+
   /// One global instance of our manager
   static VFollowPathComponentManager g_GlobalManager;
 
@@ -21,6 +21,7 @@
 VGUICommandBuffer::VGUICommandBuffer() : m_Commands(0,0)
 {
   m_iCommandCount = 0;
+  m_iDrawCount = 0;
   m_eCacheState = Cache_Dirty;
   m_fLastDepth = FLT_MAX;
 }
@@ -28,18 +29,22 @@ VGUICommandBuffer::VGUICommandBuffer() : m_Commands(0,0)
 void VGUICommandBuffer::Reset()
 {
   m_iCommandCount = 0;
+  m_iDrawCount = 0;
   m_fLastDepth = FLT_MAX;
+
+  m_iLastCommand = COMMAND_INVALID;
+  m_pLastTex = NULL;
+  m_iLastState = 0;
+  m_pLastShader = NULL;
+  m_iLastCommandBlockPos = 0;
 }
 
 void VGUICommandBuffer::Draw2DBuffer(int iVertexCount, Overlay2DVertex_t *pVertices, VTextureObject *pTexture, const VSimpleRenderState_t &iProperties)
 {
   if (m_iLastCommand==COMMAND_DRAW && m_pLastTex==pTexture && m_iLastState==iProperties) // append
   {
-    if (m_eCacheState != Cache_DryRun)
-    {
-      int *pOldVertexCount = ((int *)&m_Commands.GetDataPtr()[m_iLastCommandBlockPos]);
-      (*pOldVertexCount) += iVertexCount;
-    }
+    int *pOldVertexCount = ((int *)&m_Commands.GetDataPtr()[m_iLastCommandBlockPos]);
+    (*pOldVertexCount) += iVertexCount;
   }
   else
   {
@@ -58,11 +63,8 @@ void VGUICommandBuffer::Draw2DBufferWithShader(int iVertexCount, Overlay2DVertex
 {
   if (m_iLastCommand==COMMAND_DRAWSHADER && m_pLastTex==pTexture && m_pLastShader==&shader) // append
   {
-    if (m_eCacheState != Cache_DryRun)
-    {
-      int *pOldVertexCount = ((int *)&m_Commands.GetDataPtr()[m_iLastCommandBlockPos]);
-      (*pOldVertexCount) += iVertexCount;
-    }
+    int *pOldVertexCount = ((int *)&m_Commands.GetDataPtr()[m_iLastCommandBlockPos]);
+    (*pOldVertexCount) += iVertexCount;
   }
   else
   {
@@ -107,11 +109,8 @@ void VGUICommandBuffer::Append(const void *pData, int iByteCount)
 {
   if (!iByteCount)
     return;
-  if (m_eCacheState != Cache_DryRun)
-  {
-    m_Commands.EnsureSize(m_iCommandCount + iByteCount);
-    memcpy(&m_Commands.GetDataPtr()[m_iCommandCount],pData,iByteCount);
-  }
+  m_Commands.EnsureSize(m_iCommandCount + iByteCount);
+  memcpy(&m_Commands.GetDataPtr()[m_iCommandCount],pData,iByteCount);
   m_iCommandCount += iByteCount;
 }
 
@@ -135,22 +134,14 @@ bool VGUICommandBuffer::UpdateCache(IVRenderableItem *pItem, VGraphicsInfo &Grap
 
   if (m_eCacheState == Cache_Dirty)
   {
-    m_iLastCommand = COMMAND_INVALID;
-    m_pLastTex = NULL;
-    m_iLastState = 0;
-    m_pLastShader = NULL;
-    m_iLastCommandBlockPos = 0;
-
-    m_eCacheState = Cache_DryRun;
+    // Record the item in a single pass. The buffer grows as needed and keeps its size for the next recording.
+    m_eCacheState = Cache_Recording;
     VGraphicsInfo newGfx(*this,Graphics.GUIContext); // note this calls scissor already so reset afterwards
     newGfx.ClippingStack = Graphics.ClippingStack;
 
     Reset();
     pItem->OnPaint(newGfx,parentState);
-
-    m_eCacheState = Cache_FinalRun;
-    Reset();
-    pItem->OnPaint(newGfx,parentState);
+    MergeCommands();
 
     m_eCacheState = Cache_Valid;
     ProcessCache(Graphics,parentState);
@@ -160,6 +151,104 @@ bool VGUICommandBuffer::UpdateCache(IVRenderableItem *pItem, VGraphicsInfo &Grap
   return false;
 }
 
+void VGUICommandBuffer::MergeCommands()
+{
+  // Removes scissor and depth commands that do not change the state and coalesces the draw calls that become adjacent
+  // that way. The buffer is compacted in place, since the output is never larger than the input read so far.
+  char *pBuffer = m_Commands.GetDataPtr();
+  int iSrcPos = 0;
+  int iDestPos = 0;
+  int iLastDrawPos = -1; // position of the vertex count of the draw command at the end of the output, or -1
+
+  // The renderer state at playback time is unknown, so the first scissor and depth commands are always kept
+  bool bScissorKnown = false, bScissorNull = false;
+  VRectanglef scissorRect;
+  bool bDepthKnown = false;
+  float fDepth = 0.f;
+
+  m_iDrawCount = 0;
+
+  while (iSrcPos<m_iCommandCount)
+  {
+    const char cmd = pBuffer[iSrcPos++];
+    switch (cmd)
+    {
+    case COMMAND_DRAW:
+    case COMMAND_DRAWSHADER: {
+        const int iVertexCount = *((int *)&pBuffer[iSrcPos]);
+        const int iHeaderSize = sizeof(int) + sizeof(VTextureObject *) + ((cmd==COMMAND_DRAW) ? sizeof(VSimpleRenderState_t) : sizeof(VCompiledShaderPass *));
+        const int iVertexSize = sizeof(Overlay2DVertex_t)*iVertexCount;
+
+        bool bCompatible = false;
+        if (iLastDrawPos>=0 && pBuffer[iLastDrawPos-1]==cmd)
+        {
+          const int iPropertiesOfs = sizeof(int) + sizeof(VTextureObject *);
+          bCompatible = *((VTextureObject **)&pBuffer[iLastDrawPos+sizeof(int)]) == *((VTextureObject **)&pBuffer[iSrcPos+sizeof(int)]);
+          if (bCompatible && cmd==COMMAND_DRAW)
+            bCompatible = *((VSimpleRenderState_t *)&pBuffer[iLastDrawPos+iPropertiesOfs]) == *((VSimpleRenderState_t *)&pBuffer[iSrcPos+iPropertiesOfs]);
+          else if (bCompatible)
+            bCompatible = *((VCompiledShaderPass **)&pBuffer[iLastDrawPos+iPropertiesOfs]) == *((VCompiledShaderPass **)&pBuffer[iSrcPos+iPropertiesOfs]);
+        }
+
+        if (bCompatible) // append vertices to previous draw
+        {
+          *((int *)&pBuffer[iLastDrawPos]) += iVertexCount;
+          memmove(&pBuffer[iDestPos],&pBuffer[iSrcPos+iHeaderSize],iVertexSize);
+          iDestPos += iVertexSize;
+        }
+        else
+        {
+          pBuffer[iDestPos++] = cmd;
+          iLastDrawPos = iDestPos;
+          memmove(&pBuffer[iDestPos],&pBuffer[iSrcPos],iHeaderSize+iVertexSize);
+          iDestPos += iHeaderSize+iVertexSize;
+          m_iDrawCount++;
+        }
+        iSrcPos += iHeaderSize+iVertexSize;
+      }break;
+    case COMMAND_SCISSOR: {
+        const bool bIsNull = *((bool *)&pBuffer[iSrcPos]);
+        const int iSize = sizeof(bool) + (bIsNull ? 0 : sizeof(VRectanglef));
+        const VRectanglef *pRect = bIsNull ? NULL : (const VRectanglef *)&pBuffer[iSrcPos+sizeof(bool)];
+        if (!bScissorKnown || bScissorNull!=bIsNull || (!bIsNull && memcmp(&scissorRect,pRect,sizeof(VRectanglef))!=0))
+        {
+          bScissorKnown = true;
+          bScissorNull = bIsNull;
+          if (!bIsNull)
+            scissorRect = *pRect;
+          pBuffer[iDestPos++] = cmd;
+          memmove(&pBuffer[iDestPos],&pBuffer[iSrcPos],iSize);
+          iDestPos += iSize;
+          iLastDrawPos = -1;
+        }
+        iSrcPos += iSize;
+      }break;
+    case COMMAND_DEPTH: {
+        const float fNewDepth = *((float *)&pBuffer[iSrcPos]);
+        if (!bDepthKnown || fNewDepth!=fDepth)
+        {
+          bDepthKnown = true;
+          fDepth = fNewDepth;
+          pBuffer[iDestPos++] = cmd;
+          memmove(&pBuffer[iDestPos],&pBuffer[iSrcPos],sizeof(float));
+          iDestPos += sizeof(float);
+          iLastDrawPos = -1;
+        }
+        iSrcPos += sizeof(float);
+      }break;
+    default:
+      VASSERT_MSG(FALSE,"Invalid command buffer");
+      return;
+    }
+  }
+
+  VASSERT_MSG(iSrcPos==m_iCommandCount,"Invalid command buffer length");
+  m_iCommandCount = iDestPos;
+
+  // recording would have to start over after merging
+  m_iLastCommand = COMMAND_INVALID;
+}
+
 #define TEST_CACHE_SPEED
 #undef TEST_CACHE_SPEED
 
@@ -198,7 +287,9 @@ void VGUICommandBuffer::ProcessCache(VGraphicsInfo &Graphics, const VItemRenderI
         bool bIsNull = *((bool *)&pBuffer[iPos]); iPos+=sizeof(bool);
         VRectanglef *pRect = NULL;
         if (!bIsNull)
+        {
           pRect = (VRectanglef *)&pBuffer[iPos];iPos+=sizeof(VRectanglef);
+        }
         #ifndef TEST_CACHE_SPEED
           renderer.SetScissorRect(pRect);
         #endif
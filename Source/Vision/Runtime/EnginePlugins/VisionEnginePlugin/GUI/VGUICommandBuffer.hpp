@@ -35,6 +35,18 @@ public:
     m_eCacheState = Cache_Dirty;
   }
 
+  /// \brief Returns the number of draw calls that are issued when the cache is processed. Only valid after UpdateCache.
+  inline int GetDrawCount() const
+  {
+    return m_iDrawCount;
+  }
+
+  /// \brief Returns the size of the recorded commands in bytes. Only valid after UpdateCache.
+  inline int GetCommandBufferSize() const
+  {
+    return m_iCommandCount;
+  }
+
   // IVRender2DInterface overrides
   virtual void Draw2DBuffer(int iVertexCount, Overlay2DVertex_t *pVertices, VTextureObject *pTexture, const VSimpleRenderState_t &iProperties) HKV_OVERRIDE;
   virtual void Draw2DBufferWithShader(int iVertexCount, Overlay2DVertex_t *pVertices, VTextureObject *pTexture, VCompiledShaderPass &shader) HKV_OVERRIDE;
@@ -48,17 +60,18 @@ protected:
   {
     Cache_Valid = 0,
     Cache_Dirty,
-    Cache_DryRun,
-    Cache_FinalRun
+    Cache_Recording
   };
 
   void Reset();
   void Append(const void *pData, int iByteCount);
   void AppendCommand(char cmd, const void *pData=NULL, int iByteCount=0);
+  void MergeCommands();
   void ProcessCache(VGraphicsInfo &Graphics, const VItemRenderInfo &parentState);
 
   CacheState_e m_eCacheState;
   int m_iCommandCount;
+  int m_iDrawCount;
   DynArray_cl<char> m_Commands;
 
   // cache:
@@ -0,0 +1,208 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/GUI/VMenuIncludes.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// VGUICommandBufferTest
+///////////////////////////////////////////////////////////////////////////////////
+
+// Loads the dialogs of the base data that the sample applications show (profiling menu and mobile exit
+// dialog) through the GUI manager and paints each of them twice into a renderer that only records the
+// calls: once directly, and once through the command buffer of the dialog (VWindowBase::SetUseCaching),
+// which records the dialog and merges compatible draws. The direct paint issues one draw call per
+// recorded draw command, so the two draw counts are the counts before and after merging. Merging must
+// not increase the number of draw calls, and both paths have to render the same vertices with the same
+// texture, state, scissor rectangle and depth.
+class VGUICommandBufferTest : public VTestClass
+{
+public:
+  virtual void DescribeTest() HKV_OVERRIDE
+  {
+    SetTestName("GUI command buffer");
+    AddSubTest("GUI/ProfilingMenu.xml");
+    AddSubTest("GUI/MobileExitDialog.xml");
+  }
+
+  virtual VBool Init() HKV_OVERRIDE;
+  virtual void InitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool RunSubTest(int iTest) HKV_OVERRIDE;
+  virtual void DeInitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool DeInit() HKV_OVERRIDE;
+
+  V_DECLARE_DYNCREATE(VGUICommandBufferTest);
+
+protected:
+  IVGUIContextPtr m_spContext;
+};
+
+V_IMPLEMENT_DYNCREATE(VGUICommandBufferTest, VTestClass, &g_VisionEngineModule);
+
+
+// renderer that records every vertex with the state it has been drawn with
+class VDrawRecordingRenderer : public IVRender2DInterface
+{
+public:
+  VDrawRecordingRenderer() : m_Vertices(0)
+  {
+    m_iDrawCount = 0;
+    m_iVertexCount = 0;
+    m_bScissor = false;
+    m_fDepth = 0.f;
+  }
+
+  virtual void Draw2DBuffer(int iVertexCount, Overlay2DVertex_t *pVertices, VTextureObject *pTexture, const VSimpleRenderState_t &iProperties) HKV_OVERRIDE
+  {
+    AddVertices(iVertexCount, pVertices, pTexture, iProperties, NULL);
+  }
+
+  virtual void Draw2DBufferWithShader(int iVertexCount, Overlay2DVertex_t *pVertices, VTextureObject *pTexture, VCompiledShaderPass &shader) HKV_OVERRIDE
+  {
+    AddVertices(iVertexCount, pVertices, pTexture, VSimpleRenderState_t(), &shader);
+  }
+
+  virtual void SetScissorRect(const VRectanglef *pScreenRect) HKV_OVERRIDE
+  {
+    m_bScissor = pScreenRect!=NULL;
+    if (m_bScissor)
+      m_Scissor = *pScreenRect;
+  }
+
+  virtual void SetDepth(float fZCoord) HKV_OVERRIDE {m_fDepth = fZCoord;}
+  virtual float GetDepth() const HKV_OVERRIDE {return m_fDepth;}
+  virtual void SetTransformation(const hkvVec4 *pScaleAndOfs) HKV_OVERRIDE {}
+
+  // returns true if both renderers received the same vertices with the same state, regardless of the draw calls
+  bool RendersSameAs(const VDrawRecordingRenderer &other) const
+  {
+    if (m_iVertexCount!=other.m_iVertexCount)
+      return false;
+    for (int i=0;i<m_iVertexCount;i++)
+    {
+      const DrawnVertex_t &a(m_Vertices.GetDataPtr()[i]);
+      const DrawnVertex_t &b(other.m_Vertices.GetDataPtr()[i]);
+      if (memcmp(&a.m_Vertex, &b.m_Vertex, sizeof(Overlay2DVertex_t))!=0 || a.m_pTexture!=b.m_pTexture ||
+        !(a.m_State==b.m_State) || a.m_pShader!=b.m_pShader || a.m_fDepth!=b.m_fDepth || a.m_bScissor!=b.m_bScissor)
+        return false;
+      if (a.m_bScissor && memcmp(&a.m_Scissor, &b.m_Scissor, sizeof(VRectanglef))!=0)
+        return false;
+    }
+    return true;
+  }
+
+  int m_iDrawCount;
+  int m_iVertexCount;
+
+protected:
+  struct DrawnVertex_t
+  {
+    Overlay2DVertex_t m_Vertex;
+    VTextureObject *m_pTexture;
+    VSimpleRenderState_t m_State;
+    VCompiledShaderPass *m_pShader;
+    bool m_bScissor;
+    VRectanglef m_Scissor;
+    float m_fDepth;
+  };
+
+  void AddVertices(int iVertexCount, const Overlay2DVertex_t *pVertices, VTextureObject *pTexture, const VSimpleRenderState_t &state, VCompiledShaderPass *pShader)
+  {
+    m_iDrawCount++;
+    for (int i=0;i<iVertexCount;i++)
+    {
+      DrawnVertex_t &v(m_Vertices[m_iVertexCount++]);
+      v.m_Vertex = pVertices[i];
+      v.m_pTexture = pTexture;
+      v.m_State = state;
+      v.m_pShader = pShader;
+      v.m_bScissor = m_bScissor;
+      v.m_Scissor = m_Scissor;
+      v.m_fDepth = m_fDepth;
+    }
+  }
+
+  DynArray_cl<DrawnVertex_t> m_Vertices;
+  bool m_bScissor;
+  VRectanglef m_Scissor;
+  float m_fDepth;
+};
+
+
+VBool VGUICommandBufferTest::Init()
+{
+  // skins and fonts of the mobile dialogs, like VisSampleApp loads them
+  VTEST_RETURN(VGUIManager::GlobalManager().LoadResourceFile("GUI/MenuSystemMobile.xml"), FALSE);
+  m_spContext = new VGUIMainContext(NULL);
+  return TRUE;
+}
+
+VBool VGUICommandBufferTest::RunSubTest(int iTest)
+{
+  const char *szDialog = (iTest==0) ? "GUI/ProfilingMenu.xml" : "GUI/MobileExitDialog.xml";
+
+  // The dialog is built as a plain VDialog like VDialogResource::CreateInstance does it, since the dialog
+  // classes of these resources (with their click handlers) are only registered on mobile platforms.
+  VDialogResource *pRes = VGUIManager::GlobalManager().LoadDialog(szDialog);
+  if (pRes!=NULL)
+    pRes->EnsureLoaded();
+  VTESTM(pRes!=NULL && pRes->m_pXMLNode!=NULL, "Failed to load %s", szDialog);
+  if (pRes==NULL || pRes->m_pXMLNode==NULL)
+    return FALSE;
+
+  char szPath[FS_MAX_PATH];
+  pRes->GetFilePath(szPath);
+  VDialogPtr spDialog = new VDialog();
+  spDialog->InitDialog(m_spContext, pRes, NULL);
+  VTEST_RETURN(spDialog->Build(pRes->m_pXMLNode, szPath, false), FALSE);
+  spDialog->OnBuildFinished();
+  spDialog->SetVisible(true);
+
+  VItemRenderInfo state(m_spContext, NULL);
+
+  VDrawRecordingRenderer direct;
+  VGraphicsInfo directGraphics(direct, *m_spContext);
+  spDialog->SetUseCaching(false);
+  spDialog->OnPaint(directGraphics, state);
+
+  VDrawRecordingRenderer cached;
+  VGraphicsInfo cachedGraphics(cached, *m_spContext);
+  spDialog->SetUseCaching(true);
+  spDialog->OnPaint(cachedGraphics, state);
+
+  VTESTM(direct.m_iDrawCount>0, "%s does not draw anything", szDialog);
+  VTESTM(cached.m_iDrawCount<=direct.m_iDrawCount, "%s: merging increases the draw calls from %i to %i", szDialog, direct.m_iDrawCount, cached.m_iDrawCount);
+  VTESTM(cached.RendersSameAs(direct), "%s renders differently through the command buffer", szDialog);
+  Printf("%s: %i draw calls before merging, %i after merging (%i vertices)", szDialog, direct.m_iDrawCount, cached.m_iDrawCount, direct.m_iVertexCount);
+
+  spDialog->SetUseCaching(false);
+  return FALSE;
+}
+
+VBool VGUICommandBufferTest::DeInit()
+{
+  m_spContext = NULL;
+  return TRUE;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -0,0 +1,417 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Memory/VThreadCachingMemoryManager.hpp>
+
+#include <new>
+
+#if defined(WIN32)
+  #define V_THREADCACHE_USE_FLS
+#elif defined(_VISION_POSIX)
+  #define V_THREADCACHE_USE_PTHREAD_KEY
+  #include <pthread.h>
+#endif
+
+#define V_THREADCACHE_GRANULARITY 16                ///< Size classes are 16, 32, ... 128 bytes, so all blocks are 16 byte aligned
+#define V_THREADCACHE_SPAN_HEADER_SIZE 64           ///< The first blocks of a span start after the header
+#define V_THREADCACHE_SPANS_PER_CHUNK 16            ///< Spans are allocated from the CRT in chunks of this many spans
+#define V_THREADCACHE_SPAN_MAGIC 0x53504E53
+
+// Span map: one byte per possible span address, split into leaves of 64K entries. 32 bit address
+// spaces need a single leaf; on 64 bit platforms, 64K leaves cover 48 bit addresses.
+#define V_THREADCACHE_MAP_LEAF_BITS 16
+#define V_THREADCACHE_MAP_LEAF_SIZE (1 << V_THREADCACHE_MAP_LEAF_BITS)
+#define V_THREADCACHE_MAP_TOP_SIZE  (sizeof(void*) > 4 ? (1 << 16) : 1)
+
+
+// Header at the start of each span
+struct VSmallBlockSpan
+{
+  unsigned int m_iMagic;
+  int m_iClass;
+  VSmallBlockThreadCache* volatile m_pOwner;  ///< NULL while the span is orphaned
+  void* volatile m_pRemoteFreeList;           ///< Blocks freed by other threads (lock-free push, taken as a whole by the owner)
+  VSmallBlockSpan* m_pNext;                   ///< Next span of the owner or in the orphan list
+  char* m_pUnused;                            ///< First block that has never been handed out
+  char* m_pEnd;
+};
+
+// Per-thread free lists
+struct VSmallBlockThreadCache
+{
+  VThreadCachingMemoryManager* m_pManager;
+  void* m_pFreeList[V_THREADCACHE_NUMBER_OF_CLASSES];
+  VSmallBlockSpan* m_pSpans[V_THREADCACHE_NUMBER_OF_CLASSES];  ///< Owned spans; only the first one can have unused blocks
+};
+
+
+static inline int GetSizeClass(size_t iSize)
+{
+  return iSize == 0 ? 0 : (int)((iSize - 1) / V_THREADCACHE_GRANULARITY);
+}
+
+static inline size_t GetClassSize(int iClass)
+{
+  return (size_t)(iClass + 1) * V_THREADCACHE_GRANULARITY;
+}
+
+static inline void PushRemote(VSmallBlockSpan* pSpan, void* ptr)
+{
+  // Push-only on this side and take-all on the owner side, so there is no ABA problem
+  void* pHead;
+  do
+  {
+    pHead = pSpan->m_pRemoteFreeList;
+    *(void**)ptr = pHead;
+  }
+  while (VAtomic::CompareExchangePointer(&pSpan->m_pRemoteFreeList, ptr, pHead) != pHead);
+}
+
+static inline void* TakeRemote(VSmallBlockSpan* pSpan)
+{
+  void* pHead;
+  do
+  {
+    pHead = pSpan->m_pRemoteFreeList;
+  }
+  while (pHead != NULL && VAtomic::CompareExchangePointer(&pSpan->m_pRemoteFreeList, NULL, pHead) != pHead);
+  return pHead;
+}
+
+
+// *******************************************************************************
+// *  VThreadCachingMemoryManager
+// *******************************************************************************
+
+#if defined(V_THREADCACHE_USE_FLS)
+void WINAPI VThreadCachingMemoryManager::OnThreadExit(void* pData)
+#else
+void VThreadCachingMemoryManager::OnThreadExit(void* pData)
+#endif
+{
+  VSmallBlockThreadCache* pCache = (VSmallBlockThreadCache*)pData;
+  if (pCache != NULL)
+    pCache->m_pManager->ReleaseThreadCache(pCache);
+}
+
+VThreadCachingMemoryManager::VThreadCachingMemoryManager()
+{
+  V_COMPILE_ASSERT(sizeof(VSmallBlockSpan) <= V_THREADCACHE_SPAN_HEADER_SIZE);
+  V_COMPILE_ASSERT(V_THREADCACHE_NUMBER_OF_CLASSES * V_THREADCACHE_GRANULARITY == V_THREADCACHE_MAX_SIZE);
+
+  for (int i=0; i<V_THREADCACHE_NUMBER_OF_CLASSES; i++)
+    m_pOrphanedSpans[i] = NULL;
+  m_pSharedCache = NULL;
+  m_pReserve = m_pReserveEnd = NULL;
+  m_iSpanCount = 0;
+  m_iRefillCount = 0;
+
+  const size_t iTopSize = V_THREADCACHE_MAP_TOP_SIZE * sizeof(unsigned char*);
+  m_pSpanMap = VMemoryManager_CRT::Alloc(iTopSize);
+  memset(m_pSpanMap, 0, iTopSize);
+
+#if defined(V_THREADCACHE_USE_FLS)
+  m_iThreadCacheKey = FlsAlloc(OnThreadExit);
+  VASSERT(m_iThreadCacheKey != FLS_OUT_OF_INDEXES);
+#elif defined(V_THREADCACHE_USE_PTHREAD_KEY)
+  pthread_key_t key;
+  int iResult = pthread_key_create(&key, OnThreadExit);
+  VASSERT(iResult == 0);
+  m_iThreadCacheKey = (size_t)key;
+#endif
+}
+
+VThreadCachingMemoryManager::~VThreadCachingMemoryManager()
+{
+  // Spans, caches and the thread local storage key are deliberately kept: releasing the key would
+  // run the exit callback of other threads which may still be using their caches.
+}
+
+VSmallBlockThreadCache* VThreadCachingMemoryManager::GetThreadCache()
+{
+#if defined(V_THREADCACHE_USE_FLS)
+  VSmallBlockThreadCache* pCache = (VSmallBlockThreadCache*)FlsGetValue((DWORD)m_iThreadCacheKey);
+#elif defined(V_THREADCACHE_USE_PTHREAD_KEY)
+  VSmallBlockThreadCache* pCache = (VSmallBlockThreadCache*)pthread_getspecific((pthread_key_t)m_iThreadCacheKey);
+#else
+  VSmallBlockThreadCache* pCache = m_pSharedCache;
+#endif
+  if (pCache != NULL)
+    return pCache;
+
+  // The cache itself must not come from the small block spans
+  pCache = (VSmallBlockThreadCache*)VMemoryManager_CRT::Alloc(sizeof(VSmallBlockThreadCache));
+  memset(pCache, 0, sizeof(VSmallBlockThreadCache));
+  pCache->m_pManager = this;
+
+#if defined(V_THREADCACHE_USE_FLS)
+  FlsSetValue((DWORD)m_iThreadCacheKey, pCache);
+#elif defined(V_THREADCACHE_USE_PTHREAD_KEY)
+  pthread_setspecific((pthread_key_t)m_iThreadCacheKey, pCache);
+#else
+  m_pSharedCache = pCache;
+#endif
+  return pCache;
+}
+
+void VThreadCachingMemoryManager::ReleaseThreadCache(VSmallBlockThreadCache* pCache)
+{
+  // Free blocks go to the remote lists of their spans, so that the thread which adopts a span
+  // also gets them back
+  for (int iClass=0; iClass<V_THREADCACHE_NUMBER_OF_CLASSES; iClass++)
+  {
+    void* ptr = pCache->m_pFreeList[iClass];
+    while (ptr != NULL)
+    {
+      void* pNext = *(void**)ptr;
+      PushRemote(FindSpan(ptr), ptr);
+      ptr = pNext;
+    }
+  }
+
+  {
+    VMutexLocker lock(m_Mutex);
+    for (int iClass=0; iClass<V_THREADCACHE_NUMBER_OF_CLASSES; iClass++)
+    {
+      VSmallBlockSpan* pSpan = pCache->m_pSpans[iClass];
+      while (pSpan != NULL)
+      {
+        VSmallBlockSpan* pNext = pSpan->m_pNext;
+        pSpan->m_pOwner = NULL;
+        pSpan->m_pNext = m_pOrphanedSpans[iClass];
+        m_pOrphanedSpans[iClass] = pSpan;
+        pSpan = pNext;
+      }
+    }
+  }
+
+  VMemoryManager_CRT::Free(pCache);
+}
+
+VSmallBlockSpan* VThreadCachingMemoryManager::FindSpan(void* ptr) const
+{
+  const size_t iIndex = (size_t)ptr / V_THREADCACHE_SPAN_SIZE;
+  const size_t iTop = iIndex >> V_THREADCACHE_MAP_LEAF_BITS;
+  if (iTop >= V_THREADCACHE_MAP_TOP_SIZE)
+    return NULL;
+  // Frees do not take the mutex, so the leaf is read with acquire semantics to see its cleared entries
+  const unsigned char* pLeaf = (const unsigned char*)VAtomic::LoadPointerAcquire(&((void* volatile*)m_pSpanMap)[iTop]);
+  if (pLeaf == NULL || pLeaf[iIndex & (V_THREADCACHE_MAP_LEAF_SIZE-1)] == 0)
+    return NULL;
+  return (VSmallBlockSpan*)(iIndex * V_THREADCACHE_SPAN_SIZE);
+}
+
+bool VThreadCachingMemoryManager::RegisterSpan(VSmallBlockSpan* pSpan)
+{
+  // Called with m_Mutex locked. Leaves are published before any block of the span is handed out,
+  // so a thread that got a block from another thread always sees its leaf.
+  const size_t iIndex = (size_t)pSpan / V_THREADCACHE_SPAN_SIZE;
+  const size_t iTop = iIndex >> V_THREADCACHE_MAP_LEAF_BITS;
+  if (iTop >= V_THREADCACHE_MAP_TOP_SIZE)
+    return false;
+
+  void* volatile* ppLeaves = (void* volatile*)m_pSpanMap;
+  unsigned char* pLeaf = (unsigned char*)ppLeaves[iTop];
+  if (pLeaf == NULL)
+  {
+    pLeaf = (unsigned char*)VMemoryManager_CRT::Alloc(V_THREADCACHE_MAP_LEAF_SIZE);
+    if (pLeaf == NULL)
+      return false;
+    memset(pLeaf, 0, V_THREADCACHE_MAP_LEAF_SIZE);
+    // FindSpan reads the leaves without the mutex, so the cleared leaf is published with release semantics
+    VAtomic::StorePointerRelease(&ppLeaves[iTop], pLeaf);
+  }
+  pLeaf[iIndex & (V_THREADCACHE_MAP_LEAF_SIZE-1)] = 1;
+  return true;
+}
+
+VSmallBlockSpan* VThreadCachingMemoryManager::AcquireSpan(VSmallBlockThreadCache* pCache, int iClass)
+{
+  VMutexLocker lock(m_Mutex);
+  m_iRefillCount++;
+
+  // Prefer spans of exited threads
+  VSmallBlockSpan* pSpan = m_pOrphanedSpans[iClass];
+  if (pSpan != NULL)
+  {
+    m_pOrphanedSpans[iClass] = pSpan->m_pNext;
+  }
+  else
+  {
+    if (m_pReserve == m_pReserveEnd)
+    {
+      const size_t iChunkSize = (size_t)V_THREADCACHE_SPANS_PER_CHUNK * V_THREADCACHE_SPAN_SIZE;
+      m_pReserve = (char*)VMemoryManager_CRT::AlignedAlloc(iChunkSize, V_THREADCACHE_SPAN_SIZE);
+      if (m_pReserve == NULL)
+      {
+        m_pReserveEnd = NULL;
+        return NULL;
+      }
+      m_pReserveEnd = m_pReserve + iChunkSize;
+    }
+
+    pSpan = (VSmallBlockSpan*)m_pReserve;
+    if (!RegisterSpan(pSpan))
+      return NULL;
+    m_pReserve += V_THREADCACHE_SPAN_SIZE;
+    m_iSpanCount++;
+
+    pSpan->m_iMagic = V_THREADCACHE_SPAN_MAGIC;
+    pSpan->m_iClass = iClass;
+    pSpan->m_pRemoteFreeList = NULL;
+    pSpan->m_pUnused = (char*)pSpan + V_THREADCACHE_SPAN_HEADER_SIZE;
+    pSpan->m_pEnd = (char*)pSpan + V_THREADCACHE_SPAN_SIZE;
+  }
+
+  pSpan->m_pOwner = pCache;
+  pSpan->m_pNext = pCache->m_pSpans[iClass];
+  pCache->m_pSpans[iClass] = pSpan;
+  return pSpan;
+}
+
+void* VThreadCachingMemoryManager::Refill(VSmallBlockThreadCache* pCache, int iClass)
+{
+  const size_t iBlockSize = GetClassSize(iClass);
+
+  // Never used blocks of the current span
+  VSmallBlockSpan* pSpan = pCache->m_pSpans[iClass];
+  if (pSpan != NULL && pSpan->m_pUnused + iBlockSize <= pSpan->m_pEnd)
+  {
+    void* ptr = pSpan->m_pUnused;
+    pSpan->m_pUnused += iBlockSize;
+    return ptr;
+  }
+
+  // Blocks which other threads have freed in the meantime
+  for (; pSpan != NULL; pSpan = pSpan->m_pNext)
+  {
+    void* pList = TakeRemote(pSpan);
+    if (pList != NULL)
+    {
+      pCache->m_pFreeList[iClass] = *(void**)pList;
+      return pList;
+    }
+  }
+
+  // A new or orphaned span. Orphaned spans may have unused blocks, freed blocks or neither (if all
+  // of their blocks are still in use, in which case they are kept for the blocks freed later).
+  for (;;)
+  {
+    pSpan = AcquireSpan(pCache, iClass);
+    if (pSpan == NULL)
+      return NULL;
+    void* pList = TakeRemote(pSpan);
+    if (pList != NULL)
+    {
+      pCache->m_pFreeList[iClass] = *(void**)pList;
+      return pList;
+    }
+    if (pSpan->m_pUnused + iBlockSize <= pSpan->m_pEnd)
+    {
+      void* ptr = pSpan->m_pUnused;
+      pSpan->m_pUnused += iBlockSize;
+      return ptr;
+    }
+  }
+}
+
+void* VThreadCachingMemoryManager::Alloc(size_t iSize)
+{
+  if (iSize > V_THREADCACHE_MAX_SIZE)
+    return VMemoryManager_CRT::Alloc(iSize);
+
+  const int iClass = GetSizeClass(iSize);
+
+#if !defined(V_THREADCACHE_USE_FLS) && !defined(V_THREADCACHE_USE_PTHREAD_KEY)
+  VMutexLocker lock(m_SharedCacheMutex);
+#endif
+
+  VSmallBlockThreadCache* pCache = GetThreadCache();
+  void* ptr = pCache->m_pFreeList[iClass];
+  if (ptr != NULL)
+  {
+    pCache->m_pFreeList[iClass] = *(void**)ptr;
+    return ptr;
+  }
+
+  ptr = Refill(pCache, iClass);
+  if (ptr == NULL) // out of spans (or span outside of the mapped address range)
+    return VMemoryManager_CRT::Alloc(iSize);
+  return ptr;
+}
+
+void VThreadCachingMemoryManager::Free(void* ptr)
+{
+  if (ptr == NULL)
+    return;
+
+  VSmallBlockSpan* pSpan = FindSpan(ptr);
+  if (pSpan == NULL)
+  {
+    VMemoryManager_CRT::Free(ptr);
+    return;
+  }
+  VASSERT(pSpan->m_iMagic == V_THREADCACHE_SPAN_MAGIC);
+
+#if !defined(V_THREADCACHE_USE_FLS) && !defined(V_THREADCACHE_USE_PTHREAD_KEY)
+  VMutexLocker lock(m_SharedCacheMutex);
+#endif
+
+  VSmallBlockThreadCache* pCache = GetThreadCache();
+  if (pSpan->m_pOwner == pCache)
+  {
+    *(void**)ptr = pCache->m_pFreeList[pSpan->m_iClass];
+    pCache->m_pFreeList[pSpan->m_iClass] = ptr;
+  }
+  else
+  {
+    PushRemote(pSpan, ptr);
+  }
+}
+
+size_t VThreadCachingMemoryManager::MemSize(void* ptr)
+{
+  VSmallBlockSpan* pSpan = FindSpan(ptr);
+  if (pSpan == NULL)
+    return VMemoryManager_CRT::MemSize(ptr);
+  return GetClassSize(pSpan->m_iClass);
+}
+
+
+IVMemoryManager* GetThreadCachingMemoryManager()
+{
+  // Constructed on first use (usually before any other static initializer allocates) and never
+  // destroyed, see ~VThreadCachingMemoryManager
+  static VThreadCachingMemoryManager* s_pManager = NULL;
+  static union
+  {
+    char m_Data[sizeof(VThreadCachingMemoryManager)];
+    double m_fAlign;
+    void* m_pAlign;
+  } s_Storage;
+
+  if (s_pManager == NULL)
+    s_pManager = new (s_Storage.m_Data) VThreadCachingMemoryManager();
+  return s_pManager;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
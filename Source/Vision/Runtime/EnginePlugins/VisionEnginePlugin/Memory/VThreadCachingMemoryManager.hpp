@@ -0,0 +1,126 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file VThreadCachingMemoryManager.hpp
+
+#ifndef VTHREADCACHINGMEMORYMANAGER_HPP
+#define VTHREADCACHINGMEMORYMANAGER_HPP
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Rendering/Effects/EffectsModule.hpp>
+#include <Vision/Runtime/Base/System/Memory/Manager/VMemoryManager_CRT.hpp>
+
+struct VSmallBlockSpan;
+struct VSmallBlockThreadCache;
+
+#define V_THREADCACHE_NUMBER_OF_CLASSES 8
+#define V_THREADCACHE_MAX_SIZE 128
+#define V_THREADCACHE_SPAN_SIZE (64*1024)
+
+
+/// \brief
+///   Small block memory manager with per-thread caches, for applications that allocate heavily from
+///   several threads (replacement for VSmallBlockMemoryManager)
+///
+/// VSmallBlockMemoryManager serializes all allocations and deallocations through a single mutex, so
+/// worker threads which allocate at the same time (particles, visibility, physics, animation) block
+/// each other. VThreadCachingMemoryManager serves allocations of up to 128 bytes from free lists that
+/// are private to the allocating thread and do not need any locking:
+///   \li Memory is carved from 64KB spans which are aligned to their size. Each span belongs to one
+///     size class and one thread, so a block is mapped to its span with a single mask operation.
+///   \li Blocks freed by the owning thread go back to its private free list.
+///   \li Blocks freed by other threads are pushed onto a lock-free list of their span, and the
+///     owning thread collects them when its private free list runs empty.
+///   \li The shared mutex is only taken when a thread needs a new span, i.e. once per several
+///     hundred allocations of a size class.
+///
+/// When a thread exits, its spans (including the free blocks) are handed over to the next thread
+/// that needs a span of the same size class. Spans are never returned to the operating system.
+/// Larger allocations and all aligned allocations are passed to VMemoryManager_CRT.
+///
+/// Per-thread caches are available on Windows and POSIX platforms. On all other platforms, all
+/// threads share one cache which is protected by the mutex, which behaves like
+/// VSmallBlockMemoryManager.
+///
+/// Use DEFINE_THREADCACHING_MEMORYMANAGER in the application to install this manager. The
+/// application has to link the VisionEnginePlugin.
+class VThreadCachingMemoryManager : public VMemoryManager_CRT
+{
+public:
+
+  /// \brief
+  ///   Constructor.
+  EFFECTS_IMPEXP VThreadCachingMemoryManager();
+
+  /// \brief
+  ///   Destructor. Does not release any spans, since blocks may still be referenced by static
+  ///   objects which are destroyed later.
+  EFFECTS_IMPEXP virtual ~VThreadCachingMemoryManager();
+
+  EFFECTS_IMPEXP virtual void* Alloc(size_t iSize) HKV_OVERRIDE;
+  EFFECTS_IMPEXP virtual void Free(void* ptr) HKV_OVERRIDE;
+
+  EFFECTS_IMPEXP virtual size_t MemSize(void* ptr) HKV_OVERRIDE;
+
+  /// \brief
+  ///   Returns the number of spans allocated so far.
+  inline int GetSpanCount() const { return m_iSpanCount; }
+
+  /// \brief
+  ///   Returns how often a thread had to take the shared mutex to get a new span.
+  inline int GetRefillCount() const { return m_iRefillCount; }
+
+private:
+#if defined(WIN32)
+  static void WINAPI OnThreadExit(void* pData);
+#else
+  static void OnThreadExit(void* pData);
+#endif
+
+  VSmallBlockThreadCache* GetThreadCache();
+  void ReleaseThreadCache(VSmallBlockThreadCache* pCache);
+  void* Refill(VSmallBlockThreadCache* pCache, int iClass);
+  VSmallBlockSpan* AcquireSpan(VSmallBlockThreadCache* pCache, int iClass);
+  VSmallBlockSpan* FindSpan(void* ptr) const;
+  bool RegisterSpan(VSmallBlockSpan* pSpan);
+
+  VMutex m_Mutex;                                                      ///< Protects the orphaned spans, the span reserve and the span map
+  VSmallBlockSpan* m_pOrphanedSpans[V_THREADCACHE_NUMBER_OF_CLASSES];  ///< Spans of exited threads, per size class
+  char* m_pReserve;                                                    ///< Spans that have been allocated from the CRT but not handed out yet
+  char* m_pReserveEnd;
+  void* m_pSpanMap;                                                    ///< Span registry, see FindSpan
+  size_t m_iThreadCacheKey;                                            ///< Thread local storage index of the per-thread caches
+  VSmallBlockThreadCache* m_pSharedCache;                              ///< Used on platforms without thread local storage
+  VMutex m_SharedCacheMutex;                                           ///< Protects the shared cache
+  int m_iSpanCount;
+  int m_iRefillCount;
+};
+
+
+/// \brief
+///   Gets the VThreadCachingMemoryManager instance. It is constructed on first use and never destroyed.
+EFFECTS_IMPEXP IVMemoryManager* GetThreadCachingMemoryManager();
+
+#define DEFINE_THREADCACHING_MEMORYMANAGER DEFINE_MEMORYMANAGER(GetThreadCachingMemoryManager())
+
+
+#endif //VTHREADCACHINGMEMORYMANAGER_HPP
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
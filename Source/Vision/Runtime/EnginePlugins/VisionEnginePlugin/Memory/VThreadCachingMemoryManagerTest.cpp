@@ -0,0 +1,230 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Memory/VThreadCachingMemoryManager.hpp>
+#include <Vision/Runtime/Base/System/Memory/Manager/VSmallBlockMemoryManager.hpp>
+#include <Vision/Runtime/Base/System/Threading/Thread/VThread.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// VThreadCachingMemoryManagerTest
+///////////////////////////////////////////////////////////////////////////////////
+
+// Every thread frees and allocates blocks of 8..128 bytes in random slots of a window of live blocks,
+// so blocks are not freed in allocation order. This runs with 1, 4, 8 and 16 threads, once on
+// VSmallBlockMemoryManager and once on the manager returned by GetThreadCachingMemoryManager. The
+// blocks are tagged, and the test fails if a block has been handed out twice or overwritten. The
+// allocation rate of both managers is printed to the test log. The last subtest frees blocks on
+// another thread than the one that allocated them, which goes through the remote free lists.
+class VThreadCachingMemoryManagerTest : public VTestClass
+{
+public:
+  virtual void DescribeTest() HKV_OVERRIDE
+  {
+    SetTestName("Thread caching memory manager");
+    AddSubTest("1 thread");
+    AddSubTest("4 threads");
+    AddSubTest("8 threads");
+    AddSubTest("16 threads");
+    AddSubTest("Frees from other threads");
+  }
+
+  virtual VBool Init() HKV_OVERRIDE {return TRUE;}
+  virtual void InitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool RunSubTest(int iTest) HKV_OVERRIDE;
+  virtual void DeInitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool DeInit() HKV_OVERRIDE {return TRUE;}
+
+  V_DECLARE_DYNCREATE(VThreadCachingMemoryManagerTest);
+};
+
+V_IMPLEMENT_DYNCREATE(VThreadCachingMemoryManagerTest, VTestClass, &g_VisionEngineModule);
+
+
+#define ALLOCATION_TEST_WINDOW 256
+#define ALLOCATION_TEST_MAX_THREADS 16
+
+struct AllocationTestData_t
+{
+  IVMemoryManager *m_pManager;
+  int m_iAllocations;
+  int m_iSeed;
+  bool m_bIntact;
+  unsigned char **m_pBlocks; // blocks to free, for the frees from other threads
+};
+
+static inline unsigned char GetBlockTag(int iIndex, int iSeed)
+{
+  return (unsigned char)(iIndex+iSeed);
+}
+
+static void RunAllocations(AllocationTestData_t *pData)
+{
+  unsigned char *pLive[ALLOCATION_TEST_WINDOW];
+  int iLiveSize[ALLOCATION_TEST_WINDOW];
+  unsigned char iLiveTag[ALLOCATION_TEST_WINDOW];
+  memset(pLive, 0, sizeof(pLive));
+  VRandom randGen(pData->m_iSeed);
+  bool bIntact = true;
+
+  for (int i=0;i<pData->m_iAllocations;i++)
+  {
+    const int iSlot = randGen.GetInt() & (ALLOCATION_TEST_WINDOW-1);
+    if (pLive[iSlot]!=NULL)
+    {
+      bIntact = bIntact && pLive[iSlot][0]==iLiveTag[iSlot] && pLive[iSlot][iLiveSize[iSlot]-1]==iLiveTag[iSlot];
+      pData->m_pManager->Free(pLive[iSlot]);
+    }
+
+    const int iSize = 8 + (int)(randGen.GetInt()%121);
+    unsigned char *pBlock = (unsigned char *)pData->m_pManager->Alloc(iSize);
+    bIntact = bIntact && pBlock!=NULL;
+    if (pBlock!=NULL)
+    {
+      iLiveTag[iSlot] = GetBlockTag(i, pData->m_iSeed);
+      pBlock[0] = pBlock[iSize-1] = iLiveTag[iSlot];
+    }
+    pLive[iSlot] = pBlock;
+    iLiveSize[iSlot] = iSize;
+  }
+
+  for (int iSlot=0;iSlot<ALLOCATION_TEST_WINDOW;iSlot++)
+    if (pLive[iSlot]!=NULL)
+    {
+      bIntact = bIntact && pLive[iSlot][0]==iLiveTag[iSlot] && pLive[iSlot][iLiveSize[iSlot]-1]==iLiveTag[iSlot];
+      pData->m_pManager->Free(pLive[iSlot]);
+    }
+  pData->m_bIntact = bIntact;
+}
+
+static void RunFrees(AllocationTestData_t *pData)
+{
+  for (int i=0;i<pData->m_iAllocations;i++)
+    pData->m_pManager->Free(pData->m_pBlocks[i]);
+  pData->m_bIntact = true;
+}
+
+#if defined(WIN32)
+static DWORD __stdcall AllocationTestThreadFunc(LPVOID pArg)
+#else
+static void* AllocationTestThreadFunc(void* pArg)
+#endif
+{
+  AllocationTestData_t *pData = (AllocationTestData_t *)pArg;
+  if (pData->m_pBlocks!=NULL)
+    RunFrees(pData);
+  else
+    RunAllocations(pData);
+  return 0;
+}
+
+static bool RunTestThreads(AllocationTestData_t *pData, int iThreadCount)
+{
+  VThread *pThreads[ALLOCATION_TEST_MAX_THREADS];
+  for (int i=0;i<iThreadCount;i++)
+  {
+    pData[i].m_bIntact = false;
+    pThreads[i] = new VThread(AllocationTestThreadFunc, &pData[i], -1, THREADPRIORITY_NORMAL);
+  }
+  for (int i=0;i<iThreadCount;i++)
+    pThreads[i]->Start();
+
+  bool bIntact = true;
+  for (int i=0;i<iThreadCount;i++)
+  {
+    pThreads[i]->Join();
+    delete pThreads[i];
+    bIntact = bIntact && pData[i].m_bIntact;
+  }
+  return bIntact;
+}
+
+VBool VThreadCachingMemoryManagerTest::RunSubTest(int iTest)
+{
+  IVMemoryManager *pThreadCachingManager = GetThreadCachingMemoryManager();
+
+  if (iTest<4)
+  {
+    const int iThreadCounts[] = {1, 4, 8, 16};
+    const int iThreadCount = iThreadCounts[iTest];
+    const int iAllocationsPerThread = 1000000;
+    VSmallBlockMemoryManager smallBlockManager;
+    IVMemoryManager *pManagers[2] = {&smallBlockManager, pThreadCachingManager};
+    double fAllocsPerSec[2];
+
+    for (int iManager=0;iManager<2;iManager++)
+    {
+      AllocationTestData_t data[ALLOCATION_TEST_MAX_THREADS];
+      for (int i=0;i<iThreadCount;i++)
+      {
+        data[i].m_pManager = pManagers[iManager];
+        data[i].m_iAllocations = iAllocationsPerThread;
+        data[i].m_iSeed = i*977;
+        data[i].m_pBlocks = NULL;
+      }
+
+      const uint64 iStartTime = VGLGetTimer();
+      VTESTM(RunTestThreads(data, iThreadCount), "%s: blocks have been overwritten with %i threads",
+        (iManager==0) ? "VSmallBlockMemoryManager" : "VThreadCachingMemoryManager", iThreadCount);
+      const double fSeconds = (double)(VGLGetTimer()-iStartTime)/(double)VGLGetTimerResolution();
+      fAllocsPerSec[iManager] = (double)iThreadCount*(double)iAllocationsPerThread/hkvMath::Max(fSeconds, 0.000001);
+    }
+
+    Printf("%i threads: VSmallBlockMemoryManager %.2f M allocations/s, VThreadCachingMemoryManager %.2f M allocations/s",
+      iThreadCount, fAllocsPerSec[0]*0.000001, fAllocsPerSec[1]*0.000001);
+    return FALSE;
+  }
+
+  // allocate on this thread, free on another one, then allocate the same sizes again on this thread
+  const int iBlockCount = 20000;
+  DynArray_cl<unsigned char *> blocks(iBlockCount);
+  unsigned char **pBlocks = blocks.GetDataPtr();
+  for (int iRound=0;iRound<2;iRound++)
+  {
+    for (int i=0;i<iBlockCount;i++)
+    {
+      const int iSize = 8 + (i%121);
+      pBlocks[i] = (unsigned char *)pThreadCachingManager->Alloc(iSize);
+      VTEST_RETURN(pBlocks[i]!=NULL, FALSE);
+      pBlocks[i][0] = pBlocks[i][iSize-1] = GetBlockTag(i, iRound);
+    }
+    bool bIntact = true;
+    for (int i=0;i<iBlockCount;i++)
+    {
+      const int iSize = 8 + (i%121);
+      bIntact = bIntact && pBlocks[i][0]==GetBlockTag(i, iRound) && pBlocks[i][iSize-1]==GetBlockTag(i, iRound);
+    }
+    VTESTM(bIntact, "Blocks have been handed out twice after frees from another thread");
+
+    AllocationTestData_t data;
+    data.m_pManager = pThreadCachingManager;
+    data.m_iAllocations = iBlockCount;
+    data.m_iSeed = 0;
+    data.m_pBlocks = pBlocks;
+    RunTestThreads(&data, 1);
+  }
+
+  return FALSE;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -9,6 +9,7 @@
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleConstraint.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleGroupBase.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleSIMD.hpp>
 #include <Vision/Runtime/Base/ThirdParty/tinyXML/TinyXMLHelper.hpp>
 #include <Vision/Runtime/Base/Graphics/Video/VRenderInterface.hpp>
 #include <Vision/Runtime/Engine/System/VisApiSerialization.hpp>
@@ -107,7 +108,9 @@ VisParticleConstraint_cl *VisParticleConstraint_cl::CreateConstraint(TiXmlElemen
   CREATE_INSTANCE(VisParticleAffectorFan_cl);
   CREATE_INSTANCE(VisParticleAffectorCyclone_cl);
   CREATE_INSTANCE(VisParticleAffectorGravityPoint_cl);
-//  CREATE_INSTANCE(VisParticleConstraintTerrain_cl); // not supported
+#if defined (SUPPORTS_TERRAIN)
+  CREATE_INSTANCE(VisParticleConstraintTerrain_cl);
+#endif
   
   // add more classes here
 
@@ -335,6 +338,93 @@ void VisParticleConstraintList_cl::SerializeX( VArchive &ar )
   }
 }
 
+
+// active constraint and its forced behavior, gathered by HandleParticlesFused
+struct FusedConstraint_t
+{
+  VisParticleConstraint_cl *m_pConstraint;
+  VIS_CONSTRAINT_REFLECT_BEHAVIOR_e m_eForceBehavior;
+};
+
+void VisParticleConstraintList_cl::HandleParticlesFused(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, unsigned int iAffectMask, const VisParticleConstraintList_cl *pNoRemoveList)
+{
+  VASSERT(pGroup);
+  int i;
+  const int iMaxActive = m_iConstraintCount + (pNoRemoveList ? pNoRemoveList->m_iConstraintCount : 0);
+  if (iMaxActive==0)
+    return;
+
+  VMemoryTempBuffer<32*sizeof(FusedConstraint_t)> activeBuffer(iMaxActive*(int)sizeof(FusedConstraint_t));
+  FusedConstraint_t *pActive = (FusedConstraint_t *)activeBuffer.GetBuffer();
+  int iActiveCount = 0;
+
+  // gather the active constraints of this list and remove the dead ones (same as HandleParticles)
+  {
+    VisParticleConstraint_cl **pConstraint = m_Constraint.GetDataPtr();
+    VIS_CONSTRAINT_REFLECT_BEHAVIOR_e *pForceBehavior = m_ForceBehavior.GetDataPtr();
+    const int iCount = m_iConstraintCount;
+    m_iConstraintCount = 0;
+    for (i=0;i<iCount;i++)
+    {
+      if (!pConstraint[i]) continue;
+      if (pConstraint[i]->IsFlaggedForRemoval())
+      {
+        pConstraint[i]->Release();
+        pConstraint[i] = NULL;
+        continue;
+      }
+
+      m_iConstraintCount = i+1;
+      if (pConstraint[i]->IsActive() && (pConstraint[i]->m_iAffectBitMask & iAffectMask))
+      {
+        pActive[iActiveCount].m_pConstraint = pConstraint[i];
+        pActive[iActiveCount].m_eForceBehavior = pForceBehavior[i];
+        iActiveCount++;
+      }
+    }
+  }
+
+  // the second list is not modified (same as HandleParticlesNoRemove)
+  if (pNoRemoveList!=NULL)
+  {
+    VisParticleConstraint_cl **pConstraint = pNoRemoveList->m_Constraint.GetDataPtr();
+    VIS_CONSTRAINT_REFLECT_BEHAVIOR_e *pForceBehavior = pNoRemoveList->m_ForceBehavior.GetDataPtr();
+    for (i=0;i<pNoRemoveList->m_iConstraintCount;i++)
+      if (pConstraint[i]!=NULL && pConstraint[i]->IsActive() && (pConstraint[i]->m_iAffectBitMask & iAffectMask))
+      {
+        pActive[iActiveCount].m_pConstraint = pConstraint[i];
+        pActive[iActiveCount].m_eForceBehavior = pForceBehavior[i];
+        iActiveCount++;
+      }
+  }
+
+  // Consecutive constraints that support ranges are applied block by block, so the particle memory is only
+  // streamed once for all of them. Other constraints still see the full array and keep their position in the order.
+  int iStart = 0;
+  while (iStart<iActiveCount)
+  {
+    if (!pActive[iStart].m_pConstraint->SupportsParticleRange())
+    {
+      pActive[iStart].m_pConstraint->HandleParticles(pGroup,fTimeDelta,pActive[iStart].m_eForceBehavior);
+      iStart++;
+      continue;
+    }
+
+    int iEnd = iStart+1;
+    while (iEnd<iActiveCount && pActive[iEnd].m_pConstraint->SupportsParticleRange())
+      iEnd++;
+
+    const int iParticleCount = pGroup->GetPhysicsParticleCount();
+    for (int iBlock=0;iBlock<iParticleCount;iBlock+=PARTICLE_CONSTRAINT_BLOCKSIZE)
+    {
+      const int iBlockCount = hkvMath::Min(iParticleCount-iBlock,PARTICLE_CONSTRAINT_BLOCKSIZE);
+      for (i=iStart;i<iEnd;i++)
+        pActive[i].m_pConstraint->HandleParticleRange(pGroup,fTimeDelta,pActive[i].m_eForceBehavior,iBlock,iBlockCount);
+    }
+    iStart = iEnd;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////
 // constraint helper classes
 ////////////////////////////////////////////////////////////////////
@@ -599,6 +689,109 @@ static inline bool TestCapsuleCollision(
 }
 
 
+////////////////////////////////////////////////////////////////////
+// SIMD early-out tests. Each test returns a lane mask of the particles that potentially touch the
+// constraint shape. Only these particles are passed to the exact scalar handling above.
+////////////////////////////////////////////////////////////////////
+
+// extra distance (in world units) for tests that are not evaluated exactly like the scalar code
+#define CONSTRAINT_SIMD_TOLERANCE   1.f
+
+// loads position and radius of up to four consecutive particles. Missing lanes repeat the first particle
+static inline void GatherParticles4(const Particle_t *p, int iStride, int iNum, ParticleReal4 &x, ParticleReal4 &y, ParticleReal4 &z, ParticleReal4 &r)
+{
+  const Particle_t *p1 = (iNum>1) ? (const Particle_t *)(((const char *)p)+iStride) : p;
+  const Particle_t *p2 = (iNum>2) ? (const Particle_t *)(((const char *)p)+iStride*2) : p;
+  const Particle_t *p3 = (iNum>3) ? (const Particle_t *)(((const char *)p)+iStride*3) : p;
+  x = PARTICLE4_SET4(p->pos[0],p1->pos[0],p2->pos[0],p3->pos[0]);
+  y = PARTICLE4_SET4(p->pos[1],p1->pos[1],p2->pos[1],p3->pos[1]);
+  z = PARTICLE4_SET4(p->pos[2],p1->pos[2],p2->pos[2],p3->pos[2]);
+  r = PARTICLE4_MUL(PARTICLE4_SET4(p->size,p1->size,p2->size,p3->size),PARTICLE4_SET(0.5f));
+}
+
+// same expression as in HandleConstraintPlane_Min
+static inline ParticleReal4 TouchPlaneMin4(const ParticleReal4 &c, const ParticleReal4 &vPlaneVal, const ParticleReal4 &r)
+{
+  return PARTICLE4_CMPLT(PARTICLE4_SUB(c,vPlaneVal),r);
+}
+
+// same expression as in HandleConstraintPlane_Max
+static inline ParticleReal4 TouchPlaneMax4(const ParticleReal4 &c, const ParticleReal4 &vPlaneVal, const ParticleReal4 &r)
+{
+  return PARTICLE4_CMPLT(PARTICLE4_SUB(vPlaneVal,c),r);
+}
+
+// plane equation splatted into SIMD registers
+struct ParticlePlane4_t
+{
+  inline void Set(const hkvPlane &plane)
+  {
+    m_NormalX = PARTICLE4_SET(plane.m_vNormal.x);
+    m_NormalY = PARTICLE4_SET(plane.m_vNormal.y);
+    m_NormalZ = PARTICLE4_SET(plane.m_vNormal.z);
+    m_NegDist = PARTICLE4_SET(plane.m_fNegDist-CONSTRAINT_SIMD_TOLERANCE);
+  }
+
+  ParticleReal4 m_NormalX, m_NormalY, m_NormalZ, m_NegDist;
+};
+
+// see HandleConstraintPlane
+static inline ParticleReal4 TouchPlane4(const ParticlePlane4_t &plane, const ParticleReal4 &x, const ParticleReal4 &y, const ParticleReal4 &z, const ParticleReal4 &r)
+{
+  const ParticleReal4 fDist = PARTICLE4_MADD(plane.m_NormalX,x,PARTICLE4_MADD(plane.m_NormalY,y,PARTICLE4_MADD(plane.m_NormalZ,z,plane.m_NegDist)));
+  return PARTICLE4_CMPLT(fDist,r);
+}
+
+// sphere or infinite cylinder (the axis component is masked out) splatted into SIMD registers
+struct ParticleSphere4_t
+{
+  inline void Set(const hkvVec3 &vCenter, float fRadius, VIS_AXIS_e eAxis, bool bInside)
+  {
+    m_CenterX = PARTICLE4_SET(vCenter.x);
+    m_CenterY = PARTICLE4_SET(vCenter.y);
+    m_CenterZ = PARTICLE4_SET(vCenter.z);
+    m_AxisMaskX = PARTICLE4_SET((eAxis==AXIS_X) ? 0.f : 1.f);
+    m_AxisMaskY = PARTICLE4_SET((eAxis==AXIS_Y) ? 0.f : 1.f);
+    m_AxisMaskZ = PARTICLE4_SET((eAxis==AXIS_Z) ? 0.f : 1.f);
+    m_Radius = PARTICLE4_SET(bInside ? (fRadius-CONSTRAINT_SIMD_TOLERANCE) : (fRadius+CONSTRAINT_SIMD_TOLERANCE));
+    m_bInside = bInside;
+  }
+
+  ParticleReal4 m_CenterX, m_CenterY, m_CenterZ;
+  ParticleReal4 m_AxisMaskX, m_AxisMaskY, m_AxisMaskZ;
+  ParticleReal4 m_Radius;
+  bool m_bInside;
+};
+
+// see VisParticleConstraintSphere_cl::HandleParticleRange. Compares squared distances, so no square root is needed
+static inline ParticleReal4 TouchSphere4(const ParticleSphere4_t &sphere, const ParticleReal4 &x, const ParticleReal4 &y, const ParticleReal4 &z, const ParticleReal4 &r)
+{
+  const ParticleReal4 dx = PARTICLE4_MUL(PARTICLE4_SUB(x,sphere.m_CenterX),sphere.m_AxisMaskX);
+  const ParticleReal4 dy = PARTICLE4_MUL(PARTICLE4_SUB(y,sphere.m_CenterY),sphere.m_AxisMaskY);
+  const ParticleReal4 dz = PARTICLE4_MUL(PARTICLE4_SUB(z,sphere.m_CenterZ),sphere.m_AxisMaskZ);
+  const ParticleReal4 fDistSqr = PARTICLE4_MADD(dx,dx,PARTICLE4_MADD(dy,dy,PARTICLE4_MUL(dz,dz)));
+  if (sphere.m_bInside)
+  {
+    // touches if |d| > radius-r
+    const ParticleReal4 fInner = PARTICLE4_MAX(PARTICLE4_SUB(sphere.m_Radius,r),PARTICLE4_SET(0.f));
+    return PARTICLE4_CMPLE(PARTICLE4_MUL(fInner,fInner),fDistSqr);
+  }
+
+  // touches if |d| < radius+r
+  const ParticleReal4 fOuter = PARTICLE4_ADD(sphere.m_Radius,r);
+  return PARTICLE4_CMPLT(fDistSqr,PARTICLE4_MUL(fOuter,fOuter));
+}
+
+// particle spheres that overlap the box (extended by the tolerance), see ClampAABox
+static inline ParticleReal4 TouchAABoxOutside4(const ParticleReal4 *pBoxMin, const ParticleReal4 *pBoxMax, const ParticleReal4 &x, const ParticleReal4 &y, const ParticleReal4 &z, const ParticleReal4 &r)
+{
+  ParticleReal4 res = PARTICLE4_AND(PARTICLE4_CMPLE(PARTICLE4_SUB(pBoxMin[0],r),x),PARTICLE4_CMPLE(x,PARTICLE4_ADD(pBoxMax[0],r)));
+  res = PARTICLE4_AND(res,PARTICLE4_AND(PARTICLE4_CMPLE(PARTICLE4_SUB(pBoxMin[1],r),y),PARTICLE4_CMPLE(y,PARTICLE4_ADD(pBoxMax[1],r))));
+  res = PARTICLE4_AND(res,PARTICLE4_AND(PARTICLE4_CMPLE(PARTICLE4_SUB(pBoxMin[2],r),z),PARTICLE4_CMPLE(z,PARTICLE4_ADD(pBoxMax[2],r))));
+  return res;
+}
+
+
 ////////////////////////////////////////////////////////////////////
 // point constraint
 ////////////////////////////////////////////////////////////////////
@@ -638,6 +831,11 @@ void VisParticleConstraintPoint_cl::HandleParticles(IVPhysicsParticleCollection_
   // Don't do anything to particles
 }
 
+void VisParticleConstraintPoint_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
+{
+  // Don't do anything to particles
+}
+
 V_IMPLEMENT_SERIAL( VisParticleConstraintPoint_cl, VisParticleConstraint_cl, 0, &g_VisionEngineModule );
 void VisParticleConstraintPoint_cl::Serialize( VArchive &ar )
 {
@@ -685,24 +883,43 @@ bool VisParticleConstraintGroundPlane_cl::DataExchangeXML(TiXmlElement *pNode, b
 }
 
 #define NEXT_PARTICLE p=(Particle_t *)(((char *)p)+iStride)
+#define PARTICLE_AT(iIndex) (Particle_t *)(((char *)pGroup->GetPhysicsParticleArray())+(iIndex)*iStride)
+
+// All constraints that support ranges implement HandleParticles by processing the full array as a single range
+#define IMPLEMENT_HANDLEPARTICLES_AS_RANGE(classname) \
+  void classname::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) \
+  { \
+    VASSERT(pGroup); \
+    HandleParticleRange(pGroup,fTimeDelta,eForceBehavior,0,pGroup->GetPhysicsParticleCount()); \
+  }
+
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintGroundPlane_cl)
 
-void VisParticleConstraintGroundPlane_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+void VisParticleConstraintGroundPlane_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
 
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
-  int i;
+  int i,j;
   const float fFramePersistance = hkvMath::pow (m_fPersistance,fTimeDelta);
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+  const float fPlaneZ = GetPosition().z;
+  const ParticleReal4 vPlaneZ = PARTICLE4_SET(fPlaneZ);
+  ParticleReal4 x,y,z,r;
+  for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
   {
-    if (HandleConstraintPlane_Min(p,2,GetPosition().z,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance))
-      pGroup->DestroyParticle(p,fTimeDelta);
+    const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+    GatherParticles4(p,iStride,iNum,x,y,z,r);
+    const int iTouchMask = PARTICLE4_MOVEMASK(TouchPlaneMin4(z,vPlaneZ,r));
+    for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
+    {
+      if (HandleConstraintPlane_Min(p,2,fPlaneZ,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance))
+        pGroup->DestroyParticle(p,fTimeDelta);
+    }
   }
 }
 
@@ -778,12 +995,13 @@ bool VisParticleConstraintPlane_cl::DataExchangeXML(TiXmlElement *pNode, bool bW
 }
 
 
-void VisParticleConstraintPlane_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintPlane_cl)
+
+void VisParticleConstraintPlane_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   const VRandom& randGen = pGroup->GetRandom();
 
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
@@ -794,13 +1012,24 @@ void VisParticleConstraintPlane_cl::HandleParticles(IVPhysicsParticleCollection_
   const float fFramePersistance = hkvMath::pow (m_fPersistance,fTimeDelta);
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
 
-  int i;
+  // both cases require the particle to touch the plane, so this is used as early-out test
+  ParticlePlane4_t plane4;
+  plane4.Set(m_Plane);
+  ParticleReal4 x,y,z,r;
+
+  int i,j;
   if (m_bInfinite)
   {
-    for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+    for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
     {
-      if (HandleConstraintPlane(p,m_Plane,vPlaneNrml,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance, m_fReflectionNoise, randGen))
-        pGroup->DestroyParticle(p,fTimeDelta);
+      const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      const int iTouchMask = PARTICLE4_MOVEMASK(TouchPlane4(plane4,x,y,z,r));
+      for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
+      {
+        if (HandleConstraintPlane(p,m_Plane,vPlaneNrml,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance, m_fReflectionNoise, randGen))
+          pGroup->DestroyParticle(p,fTimeDelta);
+      }
     }
   } else
   {
@@ -809,27 +1038,33 @@ void VisParticleConstraintPlane_cl::HandleParticles(IVPhysicsParticleCollection_
     hkvVec3 vPos = GetPosition();
     ANALYSIS_IGNORE_WARNING_ONCE(6246)
     hkvVec3 vPlaneNrml = GetObjDir_Up();
-    for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+    for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
     {
-      hkvVec3 vDiff(p->pos[0]-vPos.x, p->pos[1]-vPos.y, p->pos[2]-vPos.z);
-      float fDotX = vDiff.dot (vDirX);
-
-      float fRadius = p->size*0.5f;
-      // outside plane range?
-      if (hkvMath::Abs (fDotX)>m_fSizeX+fRadius)
-        continue;
-      float fDotY = vDiff.dot (vDirY);
-      if (hkvMath::Abs (fDotY)>m_fSizeY+fRadius)
-        continue;
-
-      // too far behind plane?
-      float fPlaneDist = vDiff.dot (vPlaneNrml);
-      if (fPlaneDist< -(fRadius+m_fThickness))
-        continue;
-
-      // otherwise default plane handling
-      if (HandleConstraintPlane(p,m_Plane,vPlaneNrml,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance, m_fReflectionNoise, randGen))
-        pGroup->DestroyParticle(p,fTimeDelta);
+      const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      const int iTouchMask = PARTICLE4_MOVEMASK(TouchPlane4(plane4,x,y,z,r));
+      for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
+      {
+        hkvVec3 vDiff(p->pos[0]-vPos.x, p->pos[1]-vPos.y, p->pos[2]-vPos.z);
+        float fDotX = vDiff.dot (vDirX);
+
+        float fRadius = p->size*0.5f;
+        // outside plane range?
+        if (hkvMath::Abs (fDotX)>m_fSizeX+fRadius)
+          continue;
+        float fDotY = vDiff.dot (vDirY);
+        if (hkvMath::Abs (fDotY)>m_fSizeY+fRadius)
+          continue;
+
+        // too far behind plane?
+        float fPlaneDist = vDiff.dot (vPlaneNrml);
+        if (fPlaneDist< -(fRadius+m_fThickness))
+          continue;
+
+        // otherwise default plane handling
+        if (HandleConstraintPlane(p,m_Plane,vPlaneNrml,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance, m_fReflectionNoise, randGen))
+          pGroup->DestroyParticle(p,fTimeDelta);
+      }
     }
   }
 }
@@ -914,12 +1149,13 @@ bool VisParticleConstraintSphere_cl::DataExchangeXML(TiXmlElement *pNode, bool b
 }
 
 
-void VisParticleConstraintSphere_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintSphere_cl)
+
+void VisParticleConstraintSphere_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
@@ -929,63 +1165,73 @@ void VisParticleConstraintSphere_cl::HandleParticles(IVPhysicsParticleCollection
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
   float fDist;
 
-  int i;
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+  ParticleSphere4_t sphere4;
+  sphere4.Set(GetPosition(),m_fRadius,m_eAxis,m_bInside);
+  ParticleReal4 x,y,z,r;
+
+  int i,j;
+  for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
   {
-    hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
-    if (m_bInside)
+    const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+    GatherParticles4(p,iStride,iNum,x,y,z,r);
+    const int iTouchMask = PARTICLE4_MOVEMASK(TouchSphere4(sphere4,x,y,z,r));
+    for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
     {
-      vDiff = GetPosition()-pos;
-      if (m_eAxis != AXIS_NONE) // for cylinders
-        vDiff[m_eAxis] = 0.f;
-      fDist = m_fRadius - vDiff.getLength();
-    } else
-    {
-      vDiff = (hkvVec3) pos-GetPosition();
-      if (m_eAxis != AXIS_NONE) // for cylinders
-        vDiff[m_eAxis] = 0.f;
-      fDist = vDiff.getLength() - m_fRadius;
-    }
-    if (fDist>=p->size*0.5f) continue;
+      hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
+      if (m_bInside)
+      {
+        vDiff = GetPosition()-pos;
+        if (m_eAxis != AXIS_NONE) // for cylinders
+          vDiff[m_eAxis] = 0.f;
+        fDist = m_fRadius - vDiff.getLength();
+      } else
+      {
+        vDiff = (hkvVec3) pos-GetPosition();
+        if (m_eAxis != AXIS_NONE) // for cylinders
+          vDiff[m_eAxis] = 0.f;
+        fDist = vDiff.getLength() - m_fRadius;
+      }
+      if (fDist>=p->size*0.5f) continue;
 
-    // remove on touch plane
-    if (eForceBehavior == CONSTRAINT_REFLECT_REMOVE)
-    {
-      pGroup->DestroyParticle(p,fTimeDelta);
-      continue;
-    }
+      // remove on touch plane
+      if (eForceBehavior == CONSTRAINT_REFLECT_REMOVE)
+      {
+        pGroup->DestroyParticle(p,fTimeDelta);
+        continue;
+      }
 
-    vPlaneNrml = vDiff;
-    vPlaneNrml.normalizeIfNotZero();
+      vPlaneNrml = vDiff;
+      vPlaneNrml.normalizeIfNotZero();
 
-    // set to fixed distance
-    pos += vPlaneNrml*(p->size*fFixedDistFactor-fDist);
-    p->pos[0] = pos.x;
-    p->pos[1] = pos.y;
-    p->pos[2] = pos.z;
+      // set to fixed distance
+      pos += vPlaneNrml*(p->size*fFixedDistFactor-fDist);
+      p->pos[0] = pos.x;
+      p->pos[1] = pos.y;
+      p->pos[2] = pos.z;
 
-    if (eForceBehavior == CONSTRAINT_REFLECT_BOUNCE)
-    {
-      hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
-      if (speed.dot (vPlaneNrml) > 0.f) continue;
-      speed = speed.getReflected(vPlaneNrml) * m_fPersistance;
-      p->velocity[0] = speed.x;
-      p->velocity[1] = speed.y;
-      p->velocity[2] = speed.z;
-    }
-    else
-    if (eForceBehavior == CONSTRAINT_REFLECT_GLIDE)
-    {
-      hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
-      float fOldLen = speed.getLength();
-      // remove normal vector component
-      float fComp = speed.dot (vPlaneNrml);
-      speed -= vPlaneNrml*fComp;
-      // maintain same speed
-      speed.setLength(fOldLen);
-      p->velocity[0] = speed.x*fFramePersistance;
-      p->velocity[1] = speed.y*fFramePersistance;
-      p->velocity[2] = speed.z*fFramePersistance;
+      if (eForceBehavior == CONSTRAINT_REFLECT_BOUNCE)
+      {
+        hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
+        if (speed.dot (vPlaneNrml) > 0.f) continue;
+        speed = speed.getReflected(vPlaneNrml) * m_fPersistance;
+        p->velocity[0] = speed.x;
+        p->velocity[1] = speed.y;
+        p->velocity[2] = speed.z;
+      }
+      else
+      if (eForceBehavior == CONSTRAINT_REFLECT_GLIDE)
+      {
+        hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
+        float fOldLen = speed.getLength();
+        // remove normal vector component
+        float fComp = speed.dot (vPlaneNrml);
+        speed -= vPlaneNrml*fComp;
+        // maintain same speed
+        speed.setLength(fOldLen);
+        p->velocity[0] = speed.x*fFramePersistance;
+        p->velocity[1] = speed.y*fFramePersistance;
+        p->velocity[2] = speed.z*fFramePersistance;
+      }
     }
   }
 }
@@ -1073,81 +1319,110 @@ bool VisParticleConstraintAABox_cl::DataExchangeXML(TiXmlElement *pNode, bool bW
 }
 
 
-void VisParticleConstraintAABox_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintAABox_cl)
+
+void VisParticleConstraintAABox_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
-  int i;
+  int i,j;
   const float fFramePersistance = hkvMath::pow (m_fPersistance,fTimeDelta);
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
+  ParticleReal4 x,y,z,r;
   if (m_bInside)
   {
-    for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+    const ParticleReal4 vMinX = PARTICLE4_SET(m_Box.m_vMin.x);
+    const ParticleReal4 vMinY = PARTICLE4_SET(m_Box.m_vMin.y);
+    const ParticleReal4 vMinZ = PARTICLE4_SET(m_Box.m_vMin.z);
+    const ParticleReal4 vMaxX = PARTICLE4_SET(m_Box.m_vMax.x);
+    const ParticleReal4 vMaxY = PARTICLE4_SET(m_Box.m_vMax.y);
+    const ParticleReal4 vMaxZ = PARTICLE4_SET(m_Box.m_vMax.z);
+    for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
     {
-      if (HandleConstraintPlane_Min(p,0,m_Box.m_vMin.x, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      if (HandleConstraintPlane_Min(p,1,m_Box.m_vMin.y, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      if (HandleConstraintPlane_Min(p,2,m_Box.m_vMin.z, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      if (HandleConstraintPlane_Max(p,0,m_Box.m_vMax.x, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      if (HandleConstraintPlane_Max(p,1,m_Box.m_vMax.y, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      if (HandleConstraintPlane_Max(p,2,m_Box.m_vMax.z, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+      const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      // particles that touch none of the six planes are not modified by the scalar code
+      ParticleReal4 touch = PARTICLE4_OR(TouchPlaneMin4(x,vMinX,r),TouchPlaneMax4(x,vMaxX,r));
+      touch = PARTICLE4_OR(touch,PARTICLE4_OR(TouchPlaneMin4(y,vMinY,r),TouchPlaneMax4(y,vMaxY,r)));
+      touch = PARTICLE4_OR(touch,PARTICLE4_OR(TouchPlaneMin4(z,vMinZ,r),TouchPlaneMax4(z,vMaxZ,r)));
+      const int iTouchMask = PARTICLE4_MOVEMASK(touch);
+      for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
+      {
+        if (HandleConstraintPlane_Min(p,0,m_Box.m_vMin.x, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        if (HandleConstraintPlane_Min(p,1,m_Box.m_vMin.y, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        if (HandleConstraintPlane_Min(p,2,m_Box.m_vMin.z, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        if (HandleConstraintPlane_Max(p,0,m_Box.m_vMax.x, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        if (HandleConstraintPlane_Max(p,1,m_Box.m_vMax.y, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        if (HandleConstraintPlane_Max(p,2,m_Box.m_vMax.z, eForceBehavior, fFixedDistFactor,m_fPersistance,fFramePersistance))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+      }
     }
   } else
   {
     hkvVec3 vPlaneNrml;
     hkvVec3 vBoxCenter = m_Box.getCenter();
     hkvVec3 vInvBoxSize(1.f/m_Box.getSizeX(),1.f/m_Box.getSizeY(),1.f/m_Box.getSizeZ());
-    for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+    ParticleReal4 vBoxMin[3], vBoxMax[3];
+    for (i=0;i<3;i++)
     {
-      hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
-      if (!ClampAABox(m_Box,vBoxCenter,vInvBoxSize, pos,vPlaneNrml,p->size*0.5f))
-        continue;
-
-      // remove on touch plane
-      if (eForceBehavior == CONSTRAINT_REFLECT_REMOVE)
-      {
-        pGroup->DestroyParticle(p,fTimeDelta);
-        continue;
-      }
-
-      p->pos[0] = pos.x;
-      p->pos[1] = pos.y;
-      p->pos[2] = pos.z;
-
-      if (eForceBehavior == CONSTRAINT_REFLECT_BOUNCE)
-      {
-        hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
-        if (speed.dot (vPlaneNrml) > 0.f) continue;
-        speed = speed.getReflected(vPlaneNrml) * m_fPersistance;
-        p->velocity[0] = speed.x;
-        p->velocity[1] = speed.y;
-        p->velocity[2] = speed.z;
-      }
-      else
-      if (eForceBehavior == CONSTRAINT_REFLECT_GLIDE)
+      vBoxMin[i] = PARTICLE4_SET(m_Box.m_vMin[i]-CONSTRAINT_SIMD_TOLERANCE);
+      vBoxMax[i] = PARTICLE4_SET(m_Box.m_vMax[i]+CONSTRAINT_SIMD_TOLERANCE);
+    }
+    for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
+    {
+      const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      const int iTouchMask = PARTICLE4_MOVEMASK(TouchAABoxOutside4(vBoxMin,vBoxMax,x,y,z,r));
+      for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
       {
-        hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
-        float fOldLen = speed.getLength();
-        // remove normal vector component
-        float fComp = speed.dot (vPlaneNrml);
-        speed -= vPlaneNrml*fComp;
-        // maintain same speed
-        speed.setLength(fOldLen);
-        p->velocity[0] = speed.x*fFramePersistance;
-        p->velocity[1] = speed.y*fFramePersistance;
-        p->velocity[2] = speed.z*fFramePersistance;
+        hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
+        if (!ClampAABox(m_Box,vBoxCenter,vInvBoxSize, pos,vPlaneNrml,p->size*0.5f))
+          continue;
+
+        // remove on touch plane
+        if (eForceBehavior == CONSTRAINT_REFLECT_REMOVE)
+        {
+          pGroup->DestroyParticle(p,fTimeDelta);
+          continue;
+        }
+
+        p->pos[0] = pos.x;
+        p->pos[1] = pos.y;
+        p->pos[2] = pos.z;
+
+        if (eForceBehavior == CONSTRAINT_REFLECT_BOUNCE)
+        {
+          hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
+          if (speed.dot (vPlaneNrml) > 0.f) continue;
+          speed = speed.getReflected(vPlaneNrml) * m_fPersistance;
+          p->velocity[0] = speed.x;
+          p->velocity[1] = speed.y;
+          p->velocity[2] = speed.z;
+        }
+        else
+        if (eForceBehavior == CONSTRAINT_REFLECT_GLIDE)
+        {
+          hkvVec3 speed(p->velocity[0],p->velocity[1],p->velocity[2]);
+          float fOldLen = speed.getLength();
+          // remove normal vector component
+          float fComp = speed.dot (vPlaneNrml);
+          speed -= vPlaneNrml*fComp;
+          // maintain same speed
+          speed.setLength(fOldLen);
+          p->velocity[0] = speed.x*fFramePersistance;
+          p->velocity[1] = speed.y*fFramePersistance;
+          p->velocity[2] = speed.z*fFramePersistance;
+        }
       }
-
     }
   }
 }
@@ -1238,17 +1513,18 @@ bool VisParticleConstraintOBox_cl::DataExchangeXML(TiXmlElement *pNode, bool bWr
 }
 
 
-void VisParticleConstraintOBox_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintOBox_cl)
+
+void VisParticleConstraintOBox_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   const VRandom& randGen = pGroup->GetRandom();
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
   
-  int i;
+  int i,j;
   const float fFramePersistance = hkvMath::pow (m_fPersistance,fTimeDelta);
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
   const hkvVec3& vCenter = GetPosition();
@@ -1268,26 +1544,41 @@ void VisParticleConstraintOBox_cl::HandleParticles(IVPhysicsParticleCollection_c
 
   if (m_bInside)
   {
-    for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+    ParticlePlane4_t planes4[6];
+    planes4[0].Set(planeXMin); planes4[1].Set(planeXMax);
+    planes4[2].Set(planeYMin); planes4[3].Set(planeYMax);
+    planes4[4].Set(planeZMin); planes4[5].Set(planeZMax);
+    ParticleReal4 x,y,z,r;
+    for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
     {
-      // x plane min
-      if (HandleConstraintPlane(p,planeXMin,normalXMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      // x plane max
-      if (HandleConstraintPlane(p,planeXMax,normalXMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      // y plane min
-      if (HandleConstraintPlane(p,planeYMin,normalYMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      // y plane max
-      if (HandleConstraintPlane(p,planeYMax,normalYMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      // z plane min
-      if (HandleConstraintPlane(p,planeZMin,normalZMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
-      // z plane max
-      if (HandleConstraintPlane(p,planeZMax,normalZMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
-        {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+      const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      // particles that touch none of the six planes are not modified by the scalar code
+      ParticleReal4 touch = TouchPlane4(planes4[0],x,y,z,r);
+      for (int iPlane=1;iPlane<6;iPlane++)
+        touch = PARTICLE4_OR(touch,TouchPlane4(planes4[iPlane],x,y,z,r));
+      const int iTouchMask = PARTICLE4_MOVEMASK(touch);
+      for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iTouchMask & (1<<j)) && p->valid)
+      {
+        // x plane min
+        if (HandleConstraintPlane(p,planeXMin,normalXMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        // x plane max
+        if (HandleConstraintPlane(p,planeXMax,normalXMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        // y plane min
+        if (HandleConstraintPlane(p,planeYMin,normalYMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        // y plane max
+        if (HandleConstraintPlane(p,planeYMax,normalYMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        // z plane min
+        if (HandleConstraintPlane(p,planeZMin,normalZMin,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+        // z plane max
+        if (HandleConstraintPlane(p,planeZMax,normalZMax,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,0.f,randGen))
+          {pGroup->DestroyParticle(p,fTimeDelta);continue;}
+      }
     }
   } else
   {
@@ -1325,7 +1616,9 @@ void VisParticleConstraintOBox_cl::OnObject3DChanged(int iO3DFlags)
 // camera box constraint
 ////////////////////////////////////////////////////////////////////
 
-void VisParticleConstraintCamBox_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintCamBox_cl)
+
+void VisParticleConstraintCamBox_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
   hkvAlignedBBox bbox;
@@ -1335,21 +1628,38 @@ void VisParticleConstraintCamBox_cl::HandleParticles(IVPhysicsParticleCollection
   const float dy = bbox.getSizeY();
   const float dz = bbox.getSizeZ();
 
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
-  int i;
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+  const ParticleReal4 vMinX = PARTICLE4_SET(bbox.m_vMin.x);
+  const ParticleReal4 vMinY = PARTICLE4_SET(bbox.m_vMin.y);
+  const ParticleReal4 vMinZ = PARTICLE4_SET(bbox.m_vMin.z);
+  const ParticleReal4 vMaxX = PARTICLE4_SET(bbox.m_vMax.x);
+  const ParticleReal4 vMaxY = PARTICLE4_SET(bbox.m_vMax.y);
+  const ParticleReal4 vMaxZ = PARTICLE4_SET(bbox.m_vMax.z);
+  ParticleReal4 x,y,z,r;
+
+  int i,j;
+  for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
   {
-    while (p->pos[0]<bbox.m_vMin.x) p->pos[0]+=dx;
-    while (p->pos[0]>bbox.m_vMax.x) p->pos[0]-=dx;
-    while (p->pos[1]<bbox.m_vMin.y) p->pos[1]+=dy;
-    while (p->pos[1]>bbox.m_vMax.y) p->pos[1]-=dy;
-    while (p->pos[2]<bbox.m_vMin.z) p->pos[2]+=dz;
-    while (p->pos[2]>bbox.m_vMax.z) p->pos[2]-=dz;
+    const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+    GatherParticles4(p,iStride,iNum,x,y,z,r);
+    // only particles outside the box have to be wrapped, these are the same comparisons as below
+    ParticleReal4 outside = PARTICLE4_OR(PARTICLE4_CMPLT(x,vMinX),PARTICLE4_CMPLT(vMaxX,x));
+    outside = PARTICLE4_OR(outside,PARTICLE4_OR(PARTICLE4_CMPLT(y,vMinY),PARTICLE4_CMPLT(vMaxY,y)));
+    outside = PARTICLE4_OR(outside,PARTICLE4_OR(PARTICLE4_CMPLT(z,vMinZ),PARTICLE4_CMPLT(vMaxZ,z)));
+    const int iOutsideMask = PARTICLE4_MOVEMASK(outside);
+    for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iOutsideMask & (1<<j)) && p->valid)
+    {
+      while (p->pos[0]<bbox.m_vMin.x) p->pos[0]+=dx;
+      while (p->pos[0]>bbox.m_vMax.x) p->pos[0]-=dx;
+      while (p->pos[1]<bbox.m_vMin.y) p->pos[1]+=dy;
+      while (p->pos[1]>bbox.m_vMax.y) p->pos[1]-=dy;
+      while (p->pos[2]<bbox.m_vMin.z) p->pos[2]+=dz;
+      while (p->pos[2]>bbox.m_vMax.z) p->pos[2]-=dz;
+    }
   }
 }
 
@@ -1421,15 +1731,16 @@ bool VisParticleAffectorFan_cl::DataExchangeXML(TiXmlElement *pNode, bool bWrite
 }
 
 
-void VisParticleAffectorFan_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleAffectorFan_cl)
+
+void VisParticleAffectorFan_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
-  int i;
+  int i,j;
   if (m_fConeAngle<1.f || m_fIntensity<1.f) return;
   
 
@@ -1448,19 +1759,47 @@ void VisParticleAffectorFan_cl::HandleParticles(IVPhysicsParticleCollection_cl *
   hkvVec3 vDir = GetDirection();
   hkvVec3 vPos = GetPosition();
 
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+  // Early-out: inside the cone, dot(diff,dir) >= cos*|diff| holds. For cone angles up to 180 degrees this is
+  // tested without square root as dot>0 && dot^2 >= cos^2*|diff|^2 (with some tolerance on the squared cosine)
+  const bool bConeTest = fCosAngle>0.f;
+  const ParticleReal4 vPosX = PARTICLE4_SET(vPos.x);
+  const ParticleReal4 vPosY = PARTICLE4_SET(vPos.y);
+  const ParticleReal4 vPosZ = PARTICLE4_SET(vPos.z);
+  const ParticleReal4 vDirX = PARTICLE4_SET(vDir.x);
+  const ParticleReal4 vDirY = PARTICLE4_SET(vDir.y);
+  const ParticleReal4 vDirZ = PARTICLE4_SET(vDir.z);
+  const ParticleReal4 vCosSqr = PARTICLE4_SET(fCosAngle*fCosAngle*0.99f);
+  const ParticleReal4 vZero = PARTICLE4_SET(0.f);
+  ParticleReal4 x,y,z,r;
+
+  for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
   {
-    hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
-    hkvVec3 vDiff = pos-vPos;
-    float fDist = vDiff.getLength();
-    if (fDist<0.1f) continue;
-    vDiff.normalizeIfNotZero();
-    float fDotProd = vDiff.dot (vDir);
-    if (fDotProd<fCosAngle) continue;
-    float fIntensity = fMult/(fDist+10.f) * fTimeDelta * (fDotProd-fCosAngle);
-    p->velocity[0] += fIntensity*vDiff.x;
-    p->velocity[1] += fIntensity*vDiff.y;
-    p->velocity[2] += fIntensity*vDiff.z;
+    const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+    int iInsideMask = 0xf;
+    if (bConeTest)
+    {
+      GatherParticles4(p,iStride,iNum,x,y,z,r);
+      const ParticleReal4 dx = PARTICLE4_SUB(x,vPosX);
+      const ParticleReal4 dy = PARTICLE4_SUB(y,vPosY);
+      const ParticleReal4 dz = PARTICLE4_SUB(z,vPosZ);
+      const ParticleReal4 fDot = PARTICLE4_MADD(dx,vDirX,PARTICLE4_MADD(dy,vDirY,PARTICLE4_MUL(dz,vDirZ)));
+      const ParticleReal4 fDistSqr = PARTICLE4_MADD(dx,dx,PARTICLE4_MADD(dy,dy,PARTICLE4_MUL(dz,dz)));
+      iInsideMask = PARTICLE4_MOVEMASK(PARTICLE4_AND(PARTICLE4_CMPLT(vZero,fDot),PARTICLE4_CMPLE(PARTICLE4_MUL(vCosSqr,fDistSqr),PARTICLE4_MUL(fDot,fDot))));
+    }
+    for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iInsideMask & (1<<j)) && p->valid)
+    {
+      hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
+      hkvVec3 vDiff = pos-vPos;
+      float fDist = vDiff.getLength();
+      if (fDist<0.1f) continue;
+      vDiff.normalizeIfNotZero();
+      float fDotProd = vDiff.dot (vDir);
+      if (fDotProd<fCosAngle) continue;
+      float fIntensity = fMult/(fDist+10.f) * fTimeDelta * (fDotProd-fCosAngle);
+      p->velocity[0] += fIntensity*vDiff.x;
+      p->velocity[1] += fIntensity*vDiff.y;
+      p->velocity[2] += fIntensity*vDiff.z;
+    }
   }
 }
 
@@ -1523,13 +1862,14 @@ static inline float BellCurve(float fIn)
 }
 
 
-void VisParticleAffectorCyclone_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleAffectorCyclone_cl)
+
+void VisParticleAffectorCyclone_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
   if (m_fIntensity<1.f || m_fRadius<=HKVMATH_LARGE_EPSILON) return;
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
@@ -1540,45 +1880,63 @@ void VisParticleAffectorCyclone_cl::HandleParticles(IVPhysicsParticleCollection_
   hkvVec3 vPos = GetPosition();
   hkvVec3 vDir = GetDirection();
 
-  int i;
+  // early-out on the axis range (same dot product as below, with some tolerance)
+  const ParticleReal4 vPosX = PARTICLE4_SET(vPos.x);
+  const ParticleReal4 vPosY = PARTICLE4_SET(vPos.y);
+  const ParticleReal4 vPosZ = PARTICLE4_SET(vPos.z);
+  const ParticleReal4 vDirX = PARTICLE4_SET(vDir.x);
+  const ParticleReal4 vDirY = PARTICLE4_SET(vDir.y);
+  const ParticleReal4 vDirZ = PARTICLE4_SET(vDir.z);
+  const ParticleReal4 vAxisMin = PARTICLE4_SET(-CONSTRAINT_SIMD_TOLERANCE);
+  const ParticleReal4 vAxisMax = PARTICLE4_SET(m_fAxisLen+CONSTRAINT_SIMD_TOLERANCE);
+  ParticleReal4 x,y,z,r;
+
+  int i,j;
 //  bool bFirst = true;
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
+  for (i=0;i<iCount;i+=PARTICLE_SIMD_WIDTH)
   {
-    if (p->size<=HKVMATH_LARGE_EPSILON) continue;
-    hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
-    hkvVec3 vDiff = pos-vPos;
+    const int iNum = hkvMath::Min(iCount-i,PARTICLE_SIMD_WIDTH);
+    GatherParticles4(p,iStride,iNum,x,y,z,r);
+    const ParticleReal4 fDot4 = PARTICLE4_MADD(PARTICLE4_SUB(x,vPosX),vDirX,PARTICLE4_MADD(PARTICLE4_SUB(y,vPosY),vDirY,PARTICLE4_MUL(PARTICLE4_SUB(z,vPosZ),vDirZ)));
+    const int iInsideMask = PARTICLE4_MOVEMASK(PARTICLE4_AND(PARTICLE4_CMPLE(vAxisMin,fDot4),PARTICLE4_CMPLE(fDot4,vAxisMax)));
+    for (j=0;j<iNum;j++,NEXT_PARTICLE) if ((iInsideMask & (1<<j)) && p->valid)
+    {
+      if (p->size<=HKVMATH_LARGE_EPSILON) continue;
+      hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
+      hkvVec3 vDiff = pos-vPos;
 
-    // outside axis?
-    float fDot = vDiff.dot (vDir);
-    if (fDot<0.f || fDot>m_fAxisLen)
-      continue;
+      // outside axis?
+      float fDot = vDiff.dot (vDir);
+      if (fDot<0.f || fDot>m_fAxisLen)
+        continue;
 
-    hkvVec3 vTangent = vDiff.cross(vDir);
+      hkvVec3 vTangent = vDiff.cross(vDir);
 
-    // distance to axis
-    float fAxisDist = vTangent.getLength();
-    float fRadDist = fAxisDist-m_fRadius;
-    float fFalloff = BellCurve(fRadDist*fInfRad); // takes maximum at radius
-    float fFalloff2 = BellCurve(fRadDist*fInfOutRad);
-    float fSign = (fAxisDist>m_fRadius) ? fFalloff2 : -1.f;
-    hkvVec3 vRadius = vTangent.cross(vDir);
-    vRadius.setLength(m_fIntensity*0.2f);
+      // distance to axis
+      float fAxisDist = vTangent.getLength();
+      float fRadDist = fAxisDist-m_fRadius;
+      float fFalloff = BellCurve(fRadDist*fInfRad); // takes maximum at radius
+      float fFalloff2 = BellCurve(fRadDist*fInfOutRad);
+      float fSign = (fAxisDist>m_fRadius) ? fFalloff2 : -1.f;
+      hkvVec3 vRadius = vTangent.cross(vDir);
+      vRadius.setLength(m_fIntensity*0.2f);
 
-    vTangent.setLength(fFalloff*m_fIntensity);
-    if (fRadDist>=p->size) // inside a particle use less force
-      vTangent += vRadius*fSign;
-    else
-      vTangent += vRadius*(fSign*fRadDist/p->size);
+      vTangent.setLength(fFalloff*m_fIntensity);
+      if (fRadDist>=p->size) // inside a particle use less force
+        vTangent += vRadius*fSign;
+      else
+        vTangent += vRadius*(fSign*fRadDist/p->size);
 
 
-    // preserve old vertical speed
-    hkvVec3 vSpeed(p->velocity[0],p->velocity[1],p->velocity[2]);
-    float fVSpeed = vSpeed.dot (vDir);
-    vTangent += vDir*fVSpeed;
+      // preserve old vertical speed
+      hkvVec3 vSpeed(p->velocity[0],p->velocity[1],p->velocity[2]);
+      float fVSpeed = vSpeed.dot (vDir);
+      vTangent += vDir*fVSpeed;
 
-    p->velocity[0] = vTangent.x;
-    p->velocity[1] = vTangent.y;
-    p->velocity[2] = vTangent.z;
+      p->velocity[0] = vTangent.x;
+      p->velocity[1] = vTangent.y;
+      p->velocity[2] = vTangent.z;
+    }
   }
 }
 
@@ -1624,13 +1982,14 @@ bool VisParticleAffectorGravityPoint_cl::DataExchangeXML(TiXmlElement *pNode, bo
   return true;
 }
 
-void VisParticleAffectorGravityPoint_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleAffectorGravityPoint_cl)
+
+void VisParticleAffectorGravityPoint_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
 {
   VASSERT(pGroup);
   if (m_fIntensity<=HKVMATH_LARGE_EPSILON) return;
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p = PARTICLE_AT(iFirst);
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
@@ -1874,15 +2233,42 @@ bool VisParticleConstraintBones_cl::DataExchangeXML(TiXmlElement *pNode, bool bW
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Application/Terrain.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainSector.hpp>
 
+// falls back to the first terrain if no terrain has been assigned (e.g. for constraints created from XML before the terrain is loaded)
+static inline VTerrain *GetConstraintTerrain(VTerrain *pTerrain)
+{
+  if (pTerrain==NULL && VTerrainManager::GlobalManager().GetResourceCount()>0)
+    pTerrain = (VTerrain *)VTerrainManager::GlobalManager().GetResourceByIndex(0);
+  return pTerrain;
+}
+
 VisParticleConstraintTerrain_cl::VisParticleConstraintTerrain_cl(VTerrain *pTerrain, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eReflectMode, float fPersistance)
     : VisParticleConstraint_cl(eReflectMode,fPersistance)
 {
-  m_pTerrain = pTerrain;
-  if (m_pTerrain==NULL && VTerrainManager::GlobalManager().GetResourceCount()>0)
-    m_pTerrain = (VTerrain *)VTerrainManager::GlobalManager().GetResourceByIndex(0);
+  m_pTerrain = GetConstraintTerrain(pTerrain);
   m_iDebugColor.SetRGBA(0,100,0,64);
 }
 
+VisParticleConstraintTerrain_cl::VisParticleConstraintTerrain_cl(TiXmlElement *pNode)
+{
+  m_pTerrain = NULL;
+  m_iDebugColor.SetRGBA(0,100,0,64);
+  DataExchangeXML(pNode,false);
+  m_pTerrain = GetConstraintTerrain(NULL);
+}
+
+
+bool VisParticleConstraintTerrain_cl::Influences(const hkvAlignedBBox &bbox)
+{
+  return GetConstraintTerrain(m_pTerrain)!=NULL;
+}
+
+
+bool VisParticleConstraintTerrain_cl::DataExchangeXML(TiXmlElement *pNode, bool bWrite)
+{
+  // the terrain itself is not referenced in XML, the first terrain in the scene is used
+  return DataExchangeXML_Base(pNode,GetShortName(),bWrite);
+}
+
 
 V_IMPLEMENT_SERIAL( VisParticleConstraintTerrain_cl, VisParticleConstraint_cl, 0, &g_VisionEngineModule );
 void VisParticleConstraintTerrain_cl::Serialize( VArchive &ar )
@@ -1901,55 +2287,180 @@ void VisParticleConstraintTerrain_cl::Serialize( VArchive &ar )
 }
 
 
-void VisParticleConstraintTerrain_cl::HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior)
+// Exact collision response of a single particle that potentially touches the terrain. fOfsX/fOfsY is the
+// particle position relative to the sector origin.
+static inline bool HandleConstraintTerrain(Particle_t *p, const VTerrainSector *pSector, const VTerrainConfig &config, float fOfsX, float fOfsY, 
+  VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eMode, float fFixedDistFactor, float fPersistance, float fFramePersistance, float fNoiseNormal, const VRandom& randGen)
 {
-  if (m_pTerrain==NULL)
+  const float fHeight = pSector->GetHeightAtRelPos(hkvVec3(fOfsX,fOfsY,0.f));
+
+  // compute normal manually (faster)
+  hkvVec3 vDirX(config.m_vSampleSpacing.x*0.5f,0.f,0.f);
+  hkvVec3 vDirY(0.f,config.m_vSampleSpacing.y*0.5f,0.f);
+  vDirX.z = pSector->GetHeightAtRelPos(hkvVec3(fOfsX+vDirX.x,fOfsY,0.f)) - fHeight;
+  vDirY.z = pSector->GetHeightAtRelPos(hkvVec3(fOfsX,fOfsY+vDirY.y,0.f)) - fHeight;
+  hkvVec3 vPlaneNrml = vDirX.cross(vDirY);
+  vPlaneNrml.normalizeIfNotZero();
+  VASSERT(vPlaneNrml.z>0);
+
+  const hkvVec3 vPos(p->pos[0],p->pos[1],fHeight+config.m_vTerrainPos.z);
+  hkvPlane plane(hkvNoInitialization);
+  plane.setFromPointAndNormal(vPos,vPlaneNrml);
+  return HandleConstraintPlane(p,plane,vPlaneNrml,eMode,fFixedDistFactor,fPersistance,fFramePersistance,fNoiseNormal,randGen);
+}
+
+// bilinear height lookup of four sample positions inside the same sector. Same math as VTerrainSector::GetHeightAtRelPos
+static inline ParticleReal4 GetTerrainHeight4(const VTerrainSector *pSector, const float *fSampleX, const float *fSampleY)
+{
+  int x[4],y[4];
+  for (int i=0;i<4;i++)
+  {
+    x[i] = (int)fSampleX[i];
+    y[i] = (int)fSampleY[i];
+  }
+  const ParticleReal4 h00 = PARTICLE4_SET4(pSector->GetHeightAt(x[0],y[0]),pSector->GetHeightAt(x[1],y[1]),pSector->GetHeightAt(x[2],y[2]),pSector->GetHeightAt(x[3],y[3]));
+  const ParticleReal4 h10 = PARTICLE4_SET4(pSector->GetHeightAt(x[0]+1,y[0]),pSector->GetHeightAt(x[1]+1,y[1]),pSector->GetHeightAt(x[2]+1,y[2]),pSector->GetHeightAt(x[3]+1,y[3]));
+  const ParticleReal4 h01 = PARTICLE4_SET4(pSector->GetHeightAt(x[0],y[0]+1),pSector->GetHeightAt(x[1],y[1]+1),pSector->GetHeightAt(x[2],y[2]+1),pSector->GetHeightAt(x[3],y[3]+1));
+  const ParticleReal4 h11 = PARTICLE4_SET4(pSector->GetHeightAt(x[0]+1,y[0]+1),pSector->GetHeightAt(x[1]+1,y[1]+1),pSector->GetHeightAt(x[2]+1,y[2]+1),pSector->GetHeightAt(x[3]+1,y[3]+1));
+  const ParticleReal4 fx = PARTICLE4_FRAC(PARTICLE4_SET4(fSampleX[0],fSampleX[1],fSampleX[2],fSampleX[3]));
+  const ParticleReal4 fy = PARTICLE4_FRAC(PARTICLE4_SET4(fSampleY[0],fSampleY[1],fSampleY[2],fSampleY[3]));
+  const ParticleReal4 h0 = PARTICLE4_MADD(PARTICLE4_SUB(h10,h00),fx,h00);
+  const ParticleReal4 h1 = PARTICLE4_MADD(PARTICLE4_SUB(h11,h01),fx,h01);
+  return PARTICLE4_MADD(PARTICLE4_SUB(h1,h0),fy,h0);
+}
+
+
+IMPLEMENT_HANDLEPARTICLES_AS_RANGE(VisParticleConstraintTerrain_cl)
+
+void VisParticleConstraintTerrain_cl::HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount)
+{
+  VTerrain *pTerrain = GetConstraintTerrain(m_pTerrain);
+  if (pTerrain==NULL)
     return;
   VASSERT(pGroup);
-  Particle_t *p = pGroup->GetPhysicsParticleArray();
-  const int iCount = pGroup->GetPhysicsParticleCount();
   const int iStride = pGroup->GetPhysicsParticleStride();
+  Particle_t *p;
 
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=m_eReflectBehavior;
   if (eForceBehavior==CONSTRAINT_REFLECT_DEFAULT) eForceBehavior=CONSTRAINT_REFLECT_NOTHING;
 
-  int i;
-  hkvPlane plane(hkvNoInitialization);
-  hkvVec3 vPlaneNrml(hkvNoInitialization), vPos(hkvNoInitialization);
   const float fFramePersistance = hkvMath::pow (m_fPersistance,fTimeDelta);
   const float fFixedDistFactor = (eForceBehavior==CONSTRAINT_REFLECT_GLIDE) ? 0.499f : 0.5f;
 
-  VTerrainSectorManager &sectors(m_pTerrain->m_SectorManager);
-  const VTerrainConfig &config(m_pTerrain->m_Config);
+  VTerrainSectorManager &sectors(pTerrain->m_SectorManager);
+  const VTerrainConfig &config(pTerrain->m_Config);
+
+  // early-out test against the terrain plane (see HandleConstraintTerrain): With the gradients gx, gy over the
+  // distances dx, dy the unnormalized normal is (-gx*dy, -gy*dx, dx*dy), so the plane distance of a particle that is h above
+  // the terrain is h*dx*dy/|n|. Particles touch if h<r or h^2*(dx*dy)^2 < r^2*|n|^2, which avoids the square root.
+  const float fDistX = config.m_vSampleSpacing.x*0.5f;
+  const float fDistY = config.m_vSampleSpacing.y*0.5f;
+  const ParticleReal4 vDistXSqr = PARTICLE4_SET(fDistX*fDistX);
+  const ParticleReal4 vDistYSqr = PARTICLE4_SET(fDistY*fDistY);
+  const ParticleReal4 vDistXYSqr = PARTICLE4_SET(fDistX*fDistX*fDistY*fDistY);
+  const ParticleReal4 vTerrainZ = PARTICLE4_SET(config.m_vTerrainPos.z);
+  const ParticleReal4 vTolerance = PARTICLE4_SET(CONSTRAINT_SIMD_TOLERANCE);
+
+  // per block scratch buffers: sector index and sector relative position of each particle, and the particles of the current sector batch
+  short iSectorX[PARTICLE_CONSTRAINT_BLOCKSIZE], iSectorY[PARTICLE_CONSTRAINT_BLOCKSIZE];
+  float fOfsX[PARTICLE_CONSTRAINT_BLOCKSIZE], fOfsY[PARTICLE_CONSTRAINT_BLOCKSIZE];
+  int iBatch[PARTICLE_CONSTRAINT_BLOCKSIZE+PARTICLE_SIMD_WIDTH];
+  float fBatchX[PARTICLE_SIMD_WIDTH], fBatchY[PARTICLE_SIMD_WIDTH];
+
+  // the sector of the last batch, which is usually the same for the next block
+  VTerrainSector *pLastSector = NULL;
+  int iLastSectorX = -1, iLastSectorY = -1;
+
+  int i,j,k;
+  for (int iBlock=0;iBlock<iCount;iBlock+=PARTICLE_CONSTRAINT_BLOCKSIZE)
+  {
+    const int iBlockCount = hkvMath::Min(iCount-iBlock,PARTICLE_CONSTRAINT_BLOCKSIZE);
+    Particle_t *pBlock = PARTICLE_AT(iFirst+iBlock);
 
-  hkvVec3 vDirX(config.m_vSampleSpacing.x*0.5f,0.f,0.f);
-  hkvVec3 vDirY(0.f,config.m_vSampleSpacing.y*0.5f,0.f);
+    // sector and relative position per particle. Invalid particles and particles outside the terrain are flagged with -1
+    p = pBlock;
+    for (i=0;i<iBlockCount;i++,NEXT_PARTICLE)
+    {
+      iSectorX[i] = -1;
+      if (!p->valid)
+        continue;
+      VLargePosition vLargePos(config,hkvVec3(p->pos[0],p->pos[1],0.f));
+      if (vLargePos.m_iSectorX<0 || vLargePos.m_iSectorY<0 || vLargePos.m_iSectorX>=config.m_iSectorCount[0] || vLargePos.m_iSectorY>=config.m_iSectorCount[1])
+        continue;
+      iSectorX[i] = vLargePos.m_iSectorX;
+      iSectorY[i] = vLargePos.m_iSectorY;
+      fOfsX[i] = vLargePos.m_vSectorOfs.x;
+      fOfsY[i] = vLargePos.m_vSectorOfs.y;
+    }
 
-  for (i=0;i<iCount;i++,NEXT_PARTICLE) if (p->valid)
-  {
-    vPos.x = p->pos[0];
-    vPos.y = p->pos[1];
-    VLargePosition vLargePos(config,(hkvVec3& )vPos);
-    if (vLargePos.m_iSectorX<0 || vLargePos.m_iSectorY<0 || vLargePos.m_iSectorX>=config.m_iSectorCount[0] || vLargePos.m_iSectorY>=config.m_iSectorCount[1])
-      continue;
-    VTerrainSector *pSector = sectors.GetSector(vLargePos.m_iSectorX,vLargePos.m_iSectorY);
-    if (!pSector->IsLoaded())
-      continue; // may not call EnsureLoaded here as this is called in a thread!
+    // batch the particles by sector. The first particle that is not handled yet opens the next batch
+    for (i=0;i<iBlockCount;i++) if (iSectorX[i]>=0)
+    {
+      const short iSX = iSectorX[i];
+      const short iSY = iSectorY[i];
+      int iBatchCount = 0;
+      for (j=i;j<iBlockCount;j++) if (iSectorX[j]==iSX && iSectorY[j]==iSY)
+      {
+        iBatch[iBatchCount++] = j;
+        iSectorX[j] = -1;
+      }
 
-    vPos.z = pSector->GetHeightAtRelPos(vLargePos.m_vSectorOfs);
-  
-    // compute normal manually (faster)
-    vDirX.z = pSector->GetHeightAtRelPos(hkvVec3(vLargePos.m_vSectorOfs.x+vDirX.x,vLargePos.m_vSectorOfs.y,0.f)) - vPos.z;
-    vDirY.z = pSector->GetHeightAtRelPos(hkvVec3(vLargePos.m_vSectorOfs.x,vLargePos.m_vSectorOfs.y+vDirY.x,0.f)) - vPos.z;
-    vPlaneNrml = vDirX.cross(vDirY);
-    vPlaneNrml.normalizeIfNotZero();
-    VASSERT(vPlaneNrml.z>0);
+      if (iSX!=iLastSectorX || iSY!=iLastSectorY)
+      {
+        pLastSector = sectors.GetSector(iSX,iSY);
+        iLastSectorX = iSX;
+        iLastSectorY = iSY;
+      }
+      if (!pLastSector->IsLoaded() || !pLastSector->IsHeightmapLoaded())
+        continue; // may not call EnsureLoaded here as this is called in a thread!
 
-    vPos.z += config.m_vTerrainPos.z;
-    plane.setFromPointAndNormal(vPos,vPlaneNrml);
+      // pad the batch to a multiple of the SIMD width by repeating the last particle
+      for (j=iBatchCount;j%PARTICLE_SIMD_WIDTH;j++)
+        iBatch[j] = iBatch[iBatchCount-1];
 
-    if (HandleConstraintPlane(p,plane,vPlaneNrml,eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance, m_fReflectionNoise, pGroup->GetRandom()))
-      pGroup->DestroyParticle(p,fTimeDelta);
+      for (j=0;j<iBatchCount;j+=PARTICLE_SIMD_WIDTH)
+      {
+        const int *pIndex = &iBatch[j];
+        const Particle_t *p0 = (const Particle_t *)(((const char *)pBlock)+pIndex[0]*iStride);
+        const Particle_t *p1 = (const Particle_t *)(((const char *)pBlock)+pIndex[1]*iStride);
+        const Particle_t *p2 = (const Particle_t *)(((const char *)pBlock)+pIndex[2]*iStride);
+        const Particle_t *p3 = (const Particle_t *)(((const char *)pBlock)+pIndex[3]*iStride);
+        const ParticleReal4 z = PARTICLE4_SET4(p0->pos[2],p1->pos[2],p2->pos[2],p3->pos[2]);
+        const ParticleReal4 r = PARTICLE4_ADD(PARTICLE4_MUL(PARTICLE4_SET4(p0->size,p1->size,p2->size,p3->size),PARTICLE4_SET(0.5f)),vTolerance);
+
+        for (k=0;k<PARTICLE_SIMD_WIDTH;k++)
+        {
+          fBatchX[k] = fOfsX[pIndex[k]] * config.m_vWorld2Sample.x;
+          fBatchY[k] = fOfsY[pIndex[k]] * config.m_vWorld2Sample.y;
+        }
+        const ParticleReal4 h = GetTerrainHeight4(pLastSector,fBatchX,fBatchY);
+        for (k=0;k<PARTICLE_SIMD_WIDTH;k++)
+          fBatchX[k] += 0.5f;
+        const ParticleReal4 gx = PARTICLE4_SUB(GetTerrainHeight4(pLastSector,fBatchX,fBatchY),h);
+        for (k=0;k<PARTICLE_SIMD_WIDTH;k++)
+        {
+          fBatchX[k] -= 0.5f;
+          fBatchY[k] += 0.5f;
+        }
+        const ParticleReal4 gy = PARTICLE4_SUB(GetTerrainHeight4(pLastSector,fBatchX,fBatchY),h);
+
+        const ParticleReal4 fAbove = PARTICLE4_SUB(z,PARTICLE4_ADD(h,vTerrainZ));
+        const ParticleReal4 fNormalSqr = PARTICLE4_MADD(PARTICLE4_MUL(gx,gx),vDistYSqr,PARTICLE4_MADD(PARTICLE4_MUL(gy,gy),vDistXSqr,vDistXYSqr));
+        const ParticleReal4 touch = PARTICLE4_OR(PARTICLE4_CMPLT(fAbove,r),
+          PARTICLE4_CMPLT(PARTICLE4_MUL(PARTICLE4_MUL(fAbove,fAbove),vDistXYSqr),PARTICLE4_MUL(PARTICLE4_MUL(r,r),fNormalSqr)));
+        const int iTouchMask = PARTICLE4_MOVEMASK(touch);
+        if (iTouchMask==0)
+          continue;
+
+        const int iNum = hkvMath::Min(iBatchCount-j,PARTICLE_SIMD_WIDTH);
+        for (k=0;k<iNum;k++) if (iTouchMask & (1<<k))
+        {
+          p = (Particle_t *)(((char *)pBlock)+pIndex[k]*iStride);
+          if (HandleConstraintTerrain(p,pLastSector,config,fOfsX[pIndex[k]],fOfsY[pIndex[k]],eForceBehavior,fFixedDistFactor,m_fPersistance,fFramePersistance,m_fReflectionNoise,pGroup->GetRandom()))
+            pGroup->DestroyParticle(p,fTimeDelta);
+        }
+      }
+    }
   }
 }
 
@@ -13,6 +13,9 @@
 
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleModule.hpp>
 
+// number of particles that the fused constraint pass processes per block (see VisParticleConstraintList_cl::HandleParticlesFused)
+#define PARTICLE_CONSTRAINT_BLOCKSIZE   256
+
 class ParticleGroupBase_cl;
 class VisParticleConstraintList_cl;
 class IVPhysicsParticleCollection_cl;
@@ -239,6 +242,41 @@ public:
 	///IVPhysicsParticleCollection_cl
 	PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior = CONSTRAINT_REFLECT_DEFAULT) {}
 
+  ///\brief
+	///Overridable to indicate that this constraint implements HandleParticleRange
+	///
+	///Constraints that return true are evaluated by the fused constraint pass (see VisParticleConstraintList_cl::HandleParticlesFused)
+	///that applies all constraints to one block of particles before it moves on to the next block. Other constraints are applied
+	///to the full array via HandleParticles. The default implementation returns false.
+	///
+	///\returns
+	///true if HandleParticleRange is implemented
+	///
+	PARTICLE_IMPEXP virtual bool SupportsParticleRange() const { return false; }
+
+  ///\brief
+	///Overridable to apply this constraint to a sub-range of the particle array
+	///
+	///Only called if SupportsParticleRange returns true. Applying the constraint to a set of ranges that covers the
+	///particle array must be equivalent to a single HandleParticles call. This function must be thread safe as well.
+	///
+	///\param pGroup
+	///Interface that provides the particle array and array stride
+	///
+	///\param fTimeDelta
+	///Time delta since last simulation
+	///
+	///\param eForceBehavior
+	///If not CONSTRAINT_REFLECT_DEFAULT then this value overrides the constrain's own mode
+	///
+	///\param iFirst
+	///Index of the first particle in the range
+	///
+	///\param iCount
+	///Number of particles in the range
+	///
+	PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) {}
+
   ///\brief
 	///Overridable to determine whether this constraint potentially affects anything in the passed bounding box.
   ///
@@ -486,7 +524,7 @@ public:
 	///Particles to simulate
 	///
 	///\param fTimeDelta
-	///Time delta forwared to constraints
+	///Time delta forwarded to constraints
 	///
 	///\param iAffectMask
 	///Filter mask to test on each constraint in the list
@@ -497,6 +535,28 @@ public:
 	///Similar to HandleParticles except that it does not remove dead constraints
 	inline void HandleParticlesNoRemove(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, unsigned int iAffectMask=0xffffffff);
 
+  ///\brief
+	///Applies the constraints of this list and of an optional second list in a single pass over the particle array
+	///
+	///The particle array is processed in blocks of PARTICLE_CONSTRAINT_BLOCKSIZE particles and all constraints that support
+	///ranges (see VisParticleConstraint_cl::SupportsParticleRange) are applied to a block while it is still in the cache.
+	///Other constraints are applied to the full array in between, so the order of the constraints is preserved.
+	///
+	///\param pGroup
+	///Particles to simulate
+	///
+	///\param fTimeDelta
+	///Time delta forwarded to constraints
+	///
+	///\param iAffectMask
+	///Filter mask to test on each constraint in both lists
+	///
+	///\param pNoRemoveList
+	///Optional list that is applied after this list. Like in HandleParticlesNoRemove, dead constraints are not removed from
+	///that list, so it can be shared between threads (e.g. the global constraint list). Dead constraints of this list are removed.
+	///
+	PARTICLE_IMPEXP void HandleParticlesFused(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, unsigned int iAffectMask=0xffffffff, const VisParticleConstraintList_cl *pNoRemoveList=NULL);
+
   ///\brief
 	///Helper function to call the DebugRender function on each constraint in the list
 	///
@@ -662,6 +722,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -824,6 +898,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -1012,6 +1100,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -1199,6 +1301,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -1525,6 +1641,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -1704,6 +1834,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -1867,6 +2011,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -2044,6 +2202,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -2220,6 +2392,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -2394,6 +2580,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -2448,7 +2648,9 @@ public:
 ///Constraint class that allows for particles bouncing off the global terrain
 ///
 ///This constraint class uses the global terrain to constraint the particles against the height values. Nice effects 
-///such as ground fog can be implemented with it, however, this effect is quite expensive from a computational side.
+///such as ground fog, rain or debris can be implemented with it. The particles are batched by terrain sector and the height
+///values are sampled four particles at a time, so only particles close to the terrain surface run the full collision response.
+///Sectors that are not loaded are ignored.
 class VisParticleConstraintTerrain_cl : public VisParticleConstraint_cl
 {
 public:
@@ -2474,11 +2676,13 @@ public:
 	///
 	PARTICLE_IMPEXP VisParticleConstraintTerrain_cl(VTerrain *pTerrain=NULL, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eReflectMode=CONSTRAINT_REFLECT_BOUNCE, float fPersistance=0.2f);
 
-
-
-  ///
-  /// @}
-  ///
+  ///\brief
+	///Constructor that de-serializes from source XML node. The first terrain in the scene is used
+	///
+	///\param pNode
+	///XML node
+	///
+  PARTICLE_IMPEXP VisParticleConstraintTerrain_cl(TiXmlElement *pNode);
 
 
   ///
@@ -2520,6 +2724,20 @@ public:
   ///VisParticleConstraint_cl::HandleParticles
   PARTICLE_IMPEXP virtual void HandleParticles(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior) HKV_OVERRIDE;
 
+  ///\brief
+	///Overridden to return true
+	///
+	///\see
+  ///VisParticleConstraint_cl::SupportsParticleRange
+  PARTICLE_IMPEXP virtual bool SupportsParticleRange() const HKV_OVERRIDE { return true; }
+
+  ///\brief
+	///Overridden function that applies the constraint to a sub-range of the particles
+	///
+	///\see
+  ///VisParticleConstraint_cl::HandleParticleRange
+  PARTICLE_IMPEXP virtual void HandleParticleRange(IVPhysicsParticleCollection_cl *pGroup, float fTimeDelta, VIS_CONSTRAINT_REFLECT_BEHAVIOR_e eForceBehavior, int iFirst, int iCount) HKV_OVERRIDE;
+
   ///\brief
 	///Overridden bounding box early out test
 	///
@@ -2531,10 +2749,7 @@ public:
 	///
 	///\see
   ///VisParticleConstraint_cl::Influences
-  PARTICLE_IMPEXP virtual bool Influences(const hkvAlignedBBox &bbox) HKV_OVERRIDE 
-  {
-    return m_pTerrain!=NULL;
-  }
+  PARTICLE_IMPEXP virtual bool Influences(const hkvAlignedBBox &bbox) HKV_OVERRIDE;
 
   ///\brief
   ///Overridden function to display the constraint (e.g. in vForge)
@@ -2562,17 +2777,13 @@ public:
 	///
 	///\returns
 	///true if successful
-  PARTICLE_IMPEXP virtual bool DataExchangeXML(TiXmlElement *pNode, bool bWrite) HKV_OVERRIDE
-  {
-    VASSERT_MSG(false, "Not implemented");
-    return false;
-  }
+  PARTICLE_IMPEXP virtual bool DataExchangeXML(TiXmlElement *pNode, bool bWrite) HKV_OVERRIDE;
 
   ///
   /// @}
   ///
 
-  VTerrain *m_pTerrain;
+  VTerrain *m_pTerrain; ///< terrain to collide with. If NULL, the first terrain in the scene is used
 };
 
 
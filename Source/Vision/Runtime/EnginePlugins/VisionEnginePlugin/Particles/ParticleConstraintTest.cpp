@@ -0,0 +1,138 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleGroupBase.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleConstraint.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// ParticleConstraintTest
+///////////////////////////////////////////////////////////////////////////////////
+
+// Simulates 50k particles for 100 steps with 8 constraints, once with VisParticleConstraintList_cl::HandleParticles
+// (every constraint loops over the whole array) and once with HandleParticlesFused (blocks of
+// PARTICLE_CONSTRAINT_BLOCKSIZE particles). Both runs start from the same state and have to end in the
+// same state, since the fused pass only changes the loop order. The time per step is printed to the test log.
+class ParticleConstraintTest : public VTestClass
+{
+public:
+  virtual void DescribeTest() HKV_OVERRIDE
+  {
+    SetTestName("Particle constraints");
+    AddSubTest("Fused pass matches one pass per constraint");
+  }
+
+  virtual VBool Init() HKV_OVERRIDE {return TRUE;}
+  virtual void InitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool RunSubTest(int iTest) HKV_OVERRIDE;
+  virtual void DeInitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool DeInit() HKV_OVERRIDE {return TRUE;}
+
+  V_DECLARE_DYNCREATE(ParticleConstraintTest);
+};
+
+V_IMPLEMENT_DYNCREATE(ParticleConstraintTest, VTestClass, &g_VisionEngineModule);
+
+
+// plain particle array that destroys particles by invalidating them
+class TestParticleArray_cl : public IVPhysicsParticleCollection_cl
+{
+public:
+  TestParticleArray_cl(int iCount) : m_Particles(iCount)
+  {
+    m_iCount = iCount;
+    memset(m_Particles.GetDataPtr(), 0, iCount*sizeof(ParticleExt_t));
+  }
+
+  virtual int GetPhysicsParticleCount() const HKV_OVERRIDE {return m_iCount;}
+  virtual int GetPhysicsParticleStride() const HKV_OVERRIDE {return sizeof(ParticleExt_t);}
+  virtual Particle_t *GetPhysicsParticleArray() const HKV_OVERRIDE {return m_Particles.GetDataPtr();}
+  virtual void DestroyParticle(Particle_t *pParticle,float fTimeDelta) HKV_OVERRIDE {pParticle->valid = 0;}
+
+  int m_iCount;
+  DynArray_cl<ParticleExt_t> m_Particles;
+};
+
+VBool ParticleConstraintTest::RunSubTest(int iTest)
+{
+  const int iParticleCount = 50000;
+  const int iSteps = 100;
+  const float fTimeDelta = 1.f/60.f;
+  VRandom randGen(5678);
+
+  // particles in a 1000 units cube around the origin
+  DynArray_cl<ParticleExt_t> initialState(iParticleCount);
+  ParticleExt_t *p = initialState.GetDataPtr();
+  memset(p, 0, iParticleCount*sizeof(ParticleExt_t));
+  for (int i=0;i<iParticleCount;i++,p++)
+  {
+    p->pos[0] = randGen.GetFloatNeg()*500.f;
+    p->pos[1] = randGen.GetFloatNeg()*500.f;
+    p->pos[2] = randGen.GetFloatNeg()*500.f;
+    p->velocity[0] = randGen.GetFloatNeg()*100.f;
+    p->velocity[1] = randGen.GetFloatNeg()*100.f;
+    p->velocity[2] = randGen.GetFloatNeg()*100.f;
+    p->size = 2.f + randGen.GetFloat()*4.f;
+    p->valid = 1;
+  }
+
+  hkvPlane slope;
+  slope.setFromPointAndNormal(hkvVec3(0.f,0.f,-200.f), hkvVec3(0.3f,0.f,1.f).getNormalized());
+
+  VisParticleConstraintList_cl constraints;
+  constraints.AddConstraint(new VisParticleConstraintGroundPlane_cl(-400.f, CONSTRAINT_REFLECT_BOUNCE));
+  constraints.AddConstraint(new VisParticleConstraintPlane_cl(slope, CONSTRAINT_REFLECT_GLIDE));
+  constraints.AddConstraint(new VisParticleConstraintSphere_cl(hkvVec3(100.f,0.f,0.f), 150.f, false, CONSTRAINT_REFLECT_BOUNCE));
+  constraints.AddConstraint(new VisParticleConstraintInfCylinder_cl(hkvVec3(-200.f,100.f,0.f), 50.f, false, AXIS_Z, CONSTRAINT_REFLECT_BOUNCE));
+  constraints.AddConstraint(new VisParticleConstraintAABox_cl(hkvAlignedBBox(hkvVec3(-480.f,-480.f,-480.f), hkvVec3(480.f,480.f,480.f)), true, CONSTRAINT_REFLECT_BOUNCE));
+  constraints.AddConstraint(new VisParticleConstraintOBox_cl(hkvAlignedBBox(hkvVec3(-60.f,-60.f,-60.f), hkvVec3(60.f,60.f,60.f)), hkvVec3(30.f,20.f,0.f), hkvVec3(200.f,-200.f,100.f), false, CONSTRAINT_REFLECT_BOUNCE));
+  constraints.AddConstraint(new VisParticleAffectorFan_cl(hkvVec3(0.f,-300.f,0.f), hkvVec3(0.f,1.f,0.f), 30.f, 50.f));
+  constraints.AddConstraint(new VisParticleAffectorGravityPoint_cl(hkvVec3(0.f,0.f,200.f), 300.f, 40.f));
+
+  TestParticleArray_cl separate(iParticleCount), fused(iParticleCount);
+  double fTimeMS[2];
+  for (int iFused=0;iFused<2;iFused++)
+  {
+    TestParticleArray_cl &particles(iFused ? fused : separate);
+    memcpy(particles.m_Particles.GetDataPtr(), initialState.GetDataPtr(), iParticleCount*sizeof(ParticleExt_t));
+
+    const uint64 iStartTime = VGLGetTimer();
+    for (int iStep=0;iStep<iSteps;iStep++)
+    {
+      if (iFused)
+        constraints.HandleParticlesFused(&particles, fTimeDelta);
+      else
+        constraints.HandleParticles(&particles, fTimeDelta);
+    }
+    fTimeMS[iFused] = (double)(VGLGetTimer()-iStartTime)*1000.0/((double)VGLGetTimerResolution()*(double)iSteps);
+  }
+
+  VTESTM(memcmp(separate.m_Particles.GetDataPtr(), fused.m_Particles.GetDataPtr(), iParticleCount*sizeof(ParticleExt_t))==0,
+    "The fused constraint pass ends in another particle state");
+  Printf("%i particles, 8 constraints: one pass per constraint %.4f ms, fused pass %.4f ms per step", iParticleCount, fTimeMS[0], fTimeMS[1]);
+
+  constraints.ReleaseAllConstraints();
+  return FALSE;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
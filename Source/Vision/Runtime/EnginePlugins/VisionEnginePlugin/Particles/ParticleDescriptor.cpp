@@ -58,6 +58,8 @@ VisParticleGroupDescriptor_cl::VisParticleGroupDescriptor_cl(VisParticleEffectFi
   , m_ModColor(255,255,255,255)
   , m_fApplySceneBrightness(0.f)
   , m_bSortParticles(false)
+  , m_bUseSoASimulation(false)
+  , m_bRadixSortParticles(true)
   , m_bRepeatLifetime(false)
   , m_bSoftParticles(false)
   , m_iVisibleBitmask(0xffffffff)
@@ -217,7 +219,9 @@ enum VParticleGroupDescriptorVersion_e
   PARTICLE_GROUP_DESCRIPTOR_VERSION_08 = 8,
   PARTICLE_GROUP_DESCRIPTOR_VERSION_09 = 9,  //binary format of render hook constants changed
   PARTICLE_GROUP_DESCRIPTOR_VERSION_10 = 10, //render hook mismatch fix
-  PARTICLE_GROUP_DESCRIPTOR_VERSION_CURRENT = PARTICLE_GROUP_DESCRIPTOR_VERSION_10
+  PARTICLE_GROUP_DESCRIPTOR_VERSION_11 = 11, //SoA simulation
+  PARTICLE_GROUP_DESCRIPTOR_VERSION_12 = 12, //radix sorting
+  PARTICLE_GROUP_DESCRIPTOR_VERSION_CURRENT = PARTICLE_GROUP_DESCRIPTOR_VERSION_12
 };
 
 V_IMPLEMENT_SERIALX( VisParticleGroupDescriptor_cl);
@@ -369,6 +373,12 @@ void VisParticleGroupDescriptor_cl::SerializeX( VArchive &ar )
     ar >> m_iCustomIntValue;
 
     ar >> m_EventList;
+
+    if (iVersion >= PARTICLE_GROUP_DESCRIPTOR_VERSION_11)
+      ar >> m_bUseSoASimulation; // vers.11
+    if (iVersion >= PARTICLE_GROUP_DESCRIPTOR_VERSION_12)
+      ar >> m_bRadixSortParticles; // vers.12
+
     Finish(true);
   }
   else
@@ -483,6 +493,8 @@ void VisParticleGroupDescriptor_cl::SerializeX( VArchive &ar )
     ar << m_iCustomIntValue;
 
     ar << m_EventList;
+    ar << m_bUseSoASimulation; // vers.11
+    ar << m_bRadixSortParticles; // vers.12
   }
 }
 
@@ -1093,6 +1105,14 @@ bool VisParticleGroupDescriptor_cl::DataExchangeXML(TiXmlElement *pRoot, bool bW
     if (pSorting)
     {
       XMLHelper::Exchange_Bool(pSorting,"enabled",m_bSortParticles,bWrite);
+      XMLHelper::Exchange_Bool(pSorting,"radix",m_bRadixSortParticles,bWrite);
+    }
+
+    // simulation mode
+    TiXmlElement *pSimulation = XMLHelper::SubNode(pParticles,"simulation",bWrite);
+    if (pSimulation)
+    {
+      XMLHelper::Exchange_Bool(pSimulation,"soa",m_bUseSoASimulation,bWrite);
     }
 
     // particle lifetime
@@ -408,6 +408,8 @@ public:
   VColorRef m_ModColor;             ///< additional modulation color
   float m_fApplySceneBrightness;    ///< if true, the scene brightness will be considered at particle group emitter position
   bool m_bSortParticles;            ///< sort particles
+  bool m_bUseSoASimulation;         ///< simulate the particles in structure-of-arrays mode (see ParticleGroupBase_cl::SetUseSoAStorage)
+  bool m_bRadixSortParticles;       ///< use the linear time radix sort rather than qsort for particle sorting (see ParticleGroupBase_cl::SetUseRadixSort)
   bool m_bRepeatLifetime;           ///< if true, it has infinite lifetime
   bool m_bSoftParticles;            ///< if enabled, a shader is applied that renders soft particles
   int m_iVisibleBitmask;            ///< per layer filtering bitmask
@@ -68,6 +68,112 @@ static int CompareParticles(const void *arg1, const void *arg2)
   return (int)pSort2->sortkey - (int)pSort1->sortkey;
 }
 
+// Sorts the index list by descending sort key (same order as CompareParticles). Since the list is kept from the
+// previous frame, it is usually sorted or nearly sorted, so an insertion sort with a limited budget of moves is
+// tried first. Otherwise a stable 2-pass radix sort (8 bits per pass) is performed, using pTemp as scratch buffer.
+static void RadixSortParticles(ParticleSort_t *pList, ParticleSort_t *pTemp, int iCount)
+{
+  if (iCount<2)
+    return;
+
+  // temporal coherence: insertion sort for nearly sorted lists
+  int iBudget = iCount*4;
+  int i;
+  for (i=1;i<iCount;i++)
+  {
+    if (pList[i].sortkey<=pList[i-1].sortkey)
+      continue;
+    ParticleSort_t entry = pList[i];
+    int j = i;
+    while (j>0 && pList[j-1].sortkey<entry.sortkey)
+    {
+      pList[j] = pList[j-1];
+      j--;
+    }
+    pList[j] = entry;
+    iBudget -= i-j;
+    if (iBudget<0)
+      break;
+  }
+  if (i>=iCount)
+    return;
+
+  // count both bytes of the key in one pass
+  int iHistogram[2][256];
+  memset(iHistogram,0,sizeof(iHistogram));
+  for (i=0;i<iCount;i++)
+  {
+    iHistogram[0][pList[i].sortkey & 255]++;
+    iHistogram[1][pList[i].sortkey >> 8]++;
+  }
+
+  ParticleSort_t *pSrc = pList;
+  ParticleSort_t *pDst = pTemp;
+  for (int iPass=0;iPass<2;iPass++)
+  {
+    int *pCount = iHistogram[iPass];
+    const int iShift = iPass*8;
+
+    // all keys share the same byte -> nothing to do in this pass
+    if (pCount[(pSrc[0].sortkey>>iShift) & 255]==iCount)
+      continue;
+
+    // descending order: the highest bucket goes first
+    int iOffset = 0;
+    for (int iBucket=255;iBucket>=0;iBucket--)
+    {
+      int iNum = pCount[iBucket];
+      pCount[iBucket] = iOffset;
+      iOffset += iNum;
+    }
+    for (i=0;i<iCount;i++)
+      pDst[pCount[(pSrc[i].sortkey>>iShift) & 255]++] = pSrc[i];
+
+    ParticleSort_t *pSwap = pSrc;
+    pSrc = pDst;
+    pDst = pSwap;
+  }
+
+  if (pSrc!=pList)
+    memcpy(pList,pSrc,iCount*sizeof(ParticleSort_t));
+}
+
+void ParticleGroupBase_cl::SortParticleIndexList(ParticleSort_t *pList, ParticleSort_t *pTemp, int iCount, bool bRadixSort)
+{
+  if (bRadixSort)
+    RadixSortParticles(pList, pTemp, iCount);
+  else
+    qsort(pList, iCount, sizeof(ParticleSort_t), CompareParticles);
+}
+
+V_IMPLEMENT_DYNCREATE( HandleParticleRangeTask_cl, VThreadedTask, &g_VisionEngineModule );
+
+void HandleParticleRangeTask_cl::Run(VManagedThread *pThread)
+{
+  VASSERT(m_pParticleGroup != NULL);
+  m_iHighWaterMark = m_iValidCount = m_iDeadCount = 0;
+
+  if (m_eMode==RANGE_BOUNDINGBOX)
+  {
+    m_BoundingBox.setInvalid();
+    m_bAnyValid = m_pParticleGroup->InflateBoundingBoxRange(m_iFirst, m_iLast, m_BoundingBox);
+    return;
+  }
+
+  ParticleExt_t *p = &m_pParticleGroup->GetParticlesExt()[m_iFirst];
+  for (int i=m_iFirst;i<m_iLast;i++,p++) if (p->valid)
+  {
+    if (!m_pParticleGroup->HandleSingleParticle(p, m_fTimeDelta, false))
+    {
+      m_DeadParticles[m_iDeadCount++] = i; // destroyed by the owner task
+      continue;
+    }
+    m_iHighWaterMark = i+1;
+    m_iValidCount++;
+  }
+}
+
+
 void HandleParticlesTask_cl::Run(VManagedThread *pThread)
 {
   // Update the seed value for this particle, this thread, this frame
@@ -78,6 +184,9 @@ void HandleParticlesTask_cl::Run(VManagedThread *pThread)
 
   int &iHighWaterMark = m_pParticleGroup->m_iHighWaterMark;
   ParticleExt_t *p;
+
+  // particles might have been invalidated since the last frame, so allow one re-sync of the free slots
+  m_pParticleGroup->m_bFreeSlotsExhausted = false;
     
   // if the scene-brightness should be used and the time-of-day component is used too, check if it needs to be updated
   if ((m_pParticleGroup->m_bApplyTimeOfDayLight) && (m_pParticleGroup->m_spDescriptor->m_fApplySceneBrightness > 0.0f) && (m_pParticleGroup->m_fLastTimeOfDayUpdate >= 0.0f))
@@ -128,12 +237,20 @@ void HandleParticlesTask_cl::Run(VManagedThread *pThread)
   iHighWaterMark = 0;
   p = m_pParticleGroup->GetParticlesExt();
   int iValidCount = 0;
-  for (i=0;i<iCount;i++,p++) if (p->valid)
+  m_pParticleGroup->UpdateSoAStorageState();
+  if (m_pParticleGroup->m_bSoAStorageActive)
   {
-    if (!m_pParticleGroup->HandleSingleParticle(p, fScaledTime))
-      continue;
-    iHighWaterMark = i+1;
-    iValidCount++;
+    m_pParticleGroup->HandleParticlesSoA(iCount, fScaledTime, iHighWaterMark, iValidCount);
+  }
+  else if (!m_pParticleGroup->HandleParticlesParallel(pThread, iCount, fScaledTime, iHighWaterMark, iValidCount))
+  {
+    for (i=0;i<iCount;i++,p++) if (p->valid)
+    {
+      if (!m_pParticleGroup->HandleSingleParticle(p, fScaledTime))
+        continue;
+      iHighWaterMark = i+1;
+      iValidCount++;
+    }
   }
 
 
@@ -178,11 +295,25 @@ void HandleParticlesTask_cl::Run(VManagedThread *pThread)
       }
     }
 
-    qsort(m_pParticleGroup->m_pIndexList, iIndexCount, sizeof(ParticleSort_t), CompareParticles);
+    if (m_pParticleGroup->m_bRadixSortParticles)
+      m_pParticleGroup->m_SortScratch.EnsureSize(iIndexCount);
+    ParticleGroupBase_cl::SortParticleIndexList(m_pParticleGroup->m_pIndexList, m_pParticleGroup->m_SortScratch.GetDataPtr(), iIndexCount, m_pParticleGroup->m_bRadixSortParticles);
   }
-  // if this particle group has a child, then its task should be handled in this thread
-  if (m_pParticleGroup->m_spOnDestroyCreateGroup) {
-    m_pParticleGroup->m_spOnDestroyCreateGroup->m_pHandlingTask->Run(pThread);
+  // if this particle group has a child, then its task is either handled in this thread or runs in parallel to the
+  // rest of this task. All particles of the child have been spawned at this point
+  HandleParticlesTask_cl *pChildTask = NULL;
+  if (m_pParticleGroup->m_spOnDestroyCreateGroup)
+  {
+    pChildTask = m_pParticleGroup->m_spOnDestroyCreateGroup->m_pHandlingTask;
+    if (VisParticleGroupManager_cl::GlobalManager().GetParallelChildGroups() && Vision::GetThreadManager()->GetThreadCount()>0)
+    {
+      Vision::GetThreadManager()->ScheduleTask(pChildTask, 5);
+    }
+    else
+    {
+      pChildTask->Run(pThread);
+      pChildTask = NULL;
+    }
   }
 
   // trail particles -> connect all (needs to be performed after all constraints etc. that might modify position)
@@ -233,6 +364,10 @@ void HandleParticlesTask_cl::Run(VManagedThread *pThread)
 
   // make sure the bounding box is up-to-date
   const hkvAlignedBBox *pBBox = m_pParticleGroup->CalcCurrentBoundingBox();
+
+  // the child group has to be finished along with this task
+  if (pChildTask!=NULL)
+    Vision::GetThreadManager()->WaitForTask(pChildTask, true);
 }
 
 
@@ -268,12 +403,7 @@ void ParticleGroupBase_cl::InitGroup(bool bSpawnParticles, int iGeneration)
   m_fLastTimeOfDayUpdate = -1.0f;
   m_bApplyTimeOfDayLight = true;
 
-  m_iCachedParticleCount = 0;
   m_iMaxAnimFrame = 0;
-  m_iMaxCachedParticleCount = PARTICLECACHESIZE_NOALLOC;
-  if (m_iCachedParticleNoAlloc!=m_piCachedParticle)
-      V_SAFE_DELETE_ARRAY(m_piCachedParticle);
-  m_piCachedParticle = m_iCachedParticleNoAlloc;
   SetLocalFactors(0.f,0.f); // not at all in local space
 
   m_fBBoxUpdateTimePos = 0.f;
@@ -281,6 +411,8 @@ void ParticleGroupBase_cl::InitGroup(bool bSpawnParticles, int iGeneration)
   m_iValidCount = 0;
   m_iConstraintAffectBitMask = 0xffffffff;
   m_bHasTransformationCurves = m_bHasEvents = false;
+  m_bUseSoAStorage = m_bSoAStorageActive = m_bSoAGatherPending = false;
+  ResetSoAGatherRange();
 
   // modify properties from descriptor
   OnDescriptorChanged();
@@ -319,26 +451,11 @@ void ParticleGroupBase_cl::InitGroup(bool bSpawnParticles, int iGeneration)
   SetParticleStride(sizeof(ParticleExt_t));
   Init( 0, iParticleCount);
   InitParticleIndexList(m_bSortParticles);
+  SetUseSoAStorage(m_spDescriptor->m_bUseSoASimulation);
 
-  // init cache and estimate how much we need
-  // there is no reason to scale it with the overall number particles, as long as we have aenough particles per frame
-  int iWantedCacheSize = (int)(fPps*0.08f); // (fPps*0.08f) is number of spawned p at low fps
-  if (iWantedCacheSize<PARTICLECACHESIZE_NOALLOC)
-    iWantedCacheSize = PARTICLECACHESIZE_NOALLOC;
-  else if (iWantedCacheSize>512)
-    iWantedCacheSize = 512;
-
-  m_iCachedParticleCount = 0;
-  if (iWantedCacheSize>m_iMaxCachedParticleCount)
-  {
-    if (m_iCachedParticleNoAlloc!=m_piCachedParticle)
-      V_SAFE_DELETE_ARRAY(m_piCachedParticle);
-    if (iWantedCacheSize>PARTICLECACHESIZE_NOALLOC)
-      m_piCachedParticle = new unsigned short[iWantedCacheSize];
-    else 
-      m_piCachedParticle = m_iCachedParticleNoAlloc;
-  }
-  m_iMaxCachedParticleCount = iWantedCacheSize;
+  // init the free slots
+  m_FreeSlots.AllocateBitfield(iParticleCount);
+  FillFreeParticleCache();
 
 
   // texture/transparency properties
@@ -393,11 +510,14 @@ ParticleGroupBase_cl::ParticleGroupBase_cl(VisParticleGroupDescriptor_cl *pDescr
   m_fTransformationCurveTime = 0.f; // need to be set before SetScaling
   m_fScaling = -1.f; // force update in SetScaling
   m_pHandlingTask = NULL;
+  m_pRangeTasks = NULL;
+  m_iRangeTaskCount = 0;
+  m_iFirstFreeSlotWord = 0;
+  m_bFreeSlotsExhausted = false;
   m_vOldPos = vSpawnPos;
   m_pParentGroup = NULL;
   m_pParentEffect = NULL;
   m_spDescriptor = pDescr;
-  m_piCachedParticle = NULL;
   SetPosition(vSpawnPos);
   SetOrientation(0.f,0.f,0.f);
   SetScaling(1.f);
@@ -415,11 +535,14 @@ ParticleGroupBase_cl::ParticleGroupBase_cl(VisParticleGroupDescriptor_cl *pDescr
   m_fTransformationCurveTime = 0.f; // need to be set before SetScaling
   m_fScaling = -1.f; // force update in SetScaling
   m_pHandlingTask = NULL;
+  m_pRangeTasks = NULL;
+  m_iRangeTaskCount = 0;
+  m_iFirstFreeSlotWord = 0;
+  m_bFreeSlotsExhausted = false;
   m_vOldPos = vSpawnPos;
   m_pParentGroup = NULL;
   m_pParentEffect = NULL;
   m_spDescriptor = pDescr;
-  m_piCachedParticle = NULL;
   m_AmbientColor.SetRGBA(0,0,0,0);
   SetPosition(vSpawnPos);
   SetOrientation(vOrientation.x,vOrientation.y,vOrientation.z);
@@ -437,12 +560,15 @@ ParticleGroupBase_cl::ParticleGroupBase_cl(VisParticleGroupDescriptor_cl *pDescr
   m_fTransformationCurveTime = 0.f; // need to be set before SetScaling
   m_fScaling = -1.f; // force update in SetScaling
   m_pHandlingTask = NULL;
+  m_pRangeTasks = NULL;
+  m_iRangeTaskCount = 0;
+  m_iFirstFreeSlotWord = 0;
+  m_bFreeSlotsExhausted = false;
   m_vOldPos = vSpawnPos;
   m_pParentGroup = NULL;
   m_pParentEffect = NULL;
   m_spDescriptor = pDescr;
   m_AmbientColor.SetRGBA(0,0,0,0);
-  m_piCachedParticle = NULL;
   SetPosition(vSpawnPos);
   SetOrientation(vOrientation.x,vOrientation.y,vOrientation.z);
   SetScaling(fScaling);
@@ -463,10 +589,13 @@ ParticleGroupBase_cl::ParticleGroupBase_cl(VisParticleGroupDescriptor_cl *pDescr
   m_fScaling = -1.f; // force update in SetScaling
   m_AmbientColor.SetRGBA(0,0,0,0);
   m_pHandlingTask = NULL;
+  m_pRangeTasks = NULL;
+  m_iRangeTaskCount = 0;
+  m_iFirstFreeSlotWord = 0;
+  m_bFreeSlotsExhausted = false;
   m_pParentEffect = NULL;
   m_pParentGroup = pParent;
   m_spDescriptor = pDescr;
-  m_piCachedParticle = NULL;
   SetScaling(pParent->GetScaling());
   SetWindSpeed(hkvVec3::ZeroVector (), false);
   m_pEmitterMeshEntity = NULL;
@@ -489,8 +618,7 @@ ParticleGroupBase_cl::~ParticleGroupBase_cl()
   EnsureUpdaterTaskFinished();
   RemoveUpdaterTaskRecursive(m_spOnDestroyCreateGroup); // make sure nothing else references this task
   V_SAFE_DELETE(m_pHandlingTask);
-  if (m_iCachedParticleNoAlloc!=m_piCachedParticle)
-    V_SAFE_DELETE_ARRAY(m_piCachedParticle);
+  V_SAFE_DELETE_ARRAY(m_pRangeTasks);
 }
 
 void ParticleGroupBase_cl::ReassignShader(bool bRecreateFX)
@@ -765,7 +893,10 @@ void ParticleGroupBase_cl::OnDescriptorChanged()
 
   // sorting (upon initilization, the index list for sorting is initialized in the InitGroup function)
   m_bSortParticles = m_spDescriptor->m_bSortParticles;
+  m_bRadixSortParticles = m_spDescriptor->m_bRadixSortParticles;
   InitParticleIndexList(m_bSortParticles);
+  if (!m_bSortParticles)
+    m_SortScratch.Reset();
 
   // render order - under certain circumstances, force a specific order constant
   #if defined(WIN32) || defined(_VR_GLES2)
@@ -904,7 +1035,6 @@ void ParticleGroupBase_cl::RespawnAllParticles(bool bUseOldCount)
     iStartupCount = iParticleCount;
   else if (iStartupCount<0) iStartupCount = 0;
 
-  m_iCachedParticleCount = 0;
   ParticleExt_t *pParticle = GetParticlesExt(); // particle array is still empty!
   ParticleExt_t *pArray = pParticle;
   memset(pParticle,0,iParticleCount*sizeof(ParticleExt_t));
@@ -935,6 +1065,9 @@ void ParticleGroupBase_cl::RespawnAllParticles(bool bUseOldCount)
   
   HandleAllConstraints(0.f);
 
+  // the startup particles have been initialized directly, so rebuild the free slots
+  FillFreeParticleCache();
+
   if (m_cUseDistortion==DISTORTION_TYPE_TRAIL)
   {
     pParticle = pArray;
@@ -988,6 +1121,7 @@ void ParticleGroupBase_cl::MoveParticles(const hkvVec3& vDelta)
   if (m_spEmitter!=NULL)
     m_spEmitter->m_vLastEmitterPos += vDelta;
   m_vOldPos += vDelta;
+  InvalidateSoAStorage();
 }
 
 void ParticleGroupBase_cl::SetLocalFactors(float fAtLifetimeStart, float fAtLifetimeEnd)
@@ -1128,33 +1262,35 @@ void ParticleGroupBase_cl::EvaluateSceneBrightness()
 }
 
 
+// returns the index of the lowest set bit of a non-zero value
+static inline int GetLowestSetBitIndex(unsigned int iValue)
+{
+  static const int iDeBruijnIndex[32] =
+  {
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8, 
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+  };
+  VASSERT(iValue!=0);
+  return iDeBruijnIndex[((iValue & (0U-iValue)) * 0x077CB531U) >> 27];
+}
+
 bool ParticleGroupBase_cl::FillFreeParticleCache()
 {
-  // reset the cache
-  m_iCachedParticleCount = 0;
-  const int iParticleCount = GetNumOfParticles();
-  int i;
-  ParticleExt_t *p = GetParticlesExt();
-  for (i=0;i<iParticleCount;i++,p++)
+  // rebuild the bitfield from the valid flags, since particles might have been invalidated directly
+  const int iParticleCount = hkvMath::Min(GetNumOfParticles(),m_FreeSlots.GetBitCount());
+  const ParticleExt_t *p = GetParticlesExt();
+  unsigned int *pWords = m_FreeSlots.GetIntArray();
+  m_FreeSlots.Clear();
+  m_iFirstFreeSlotWord = m_FreeSlots.GetIntCount();
+  for (int i=0;i<iParticleCount;i++,p++)
     if (!p->valid)
     {
-	  // Fill backwards so we get the lowest indices first in the cache
-      m_piCachedParticle[m_iMaxCachedParticleCount - ++m_iCachedParticleCount] = i;
-
-      if (m_iMaxCachedParticleCount == m_iCachedParticleCount)
-        break; // cache is full
+      pWords[i>>5] |= 1U<<(i&31);
+      m_iFirstFreeSlotWord = hkvMath::Min(m_iFirstFreeSlotWord,i>>5);
     }
-  if (!m_iCachedParticleCount)
-    return false; // no free particles at all
-  if (m_iMaxCachedParticleCount > m_iCachedParticleCount)
-  {
-    // Need to shift value down since we weren't able to fill it
-    memmove(&m_piCachedParticle[0], 
-            &m_piCachedParticle[m_iMaxCachedParticleCount - m_iCachedParticleCount], 
-            m_iCachedParticleCount*sizeof(unsigned short));
-  }
 
-  return true;
+  m_bFreeSlotsExhausted = m_iFirstFreeSlotWord>=m_FreeSlots.GetIntCount();
+  return !m_bFreeSlotsExhausted;
 }
 
 
@@ -1172,25 +1308,35 @@ ParticleExt_t* ParticleGroupBase_cl::GetFreeParticle()
     int iNext = (m_iTrailIndex+1) % GetNumOfParticles();
     ParticleExt_t *pNext = &GetParticlesExt()[iNext];
     pNext->m_fDistortionMult = (float)iNext + 0.1f; // reference itself
+    MarkSoAGatherPending(m_iTrailIndex);
     return p;
   }
-  if (m_iCachedParticleCount>0) // take particle from cache
+
+  // take the lowest free slot
+  ParticleExt_t *pParticles = GetParticlesExt();
+  unsigned int *pWords = m_FreeSlots.GetIntArray();
+  const int iWordCount = m_FreeSlots.GetIntCount();
+  for (;m_iFirstFreeSlotWord<iWordCount;m_iFirstFreeSlotWord++)
   {
-    m_iCachedParticleCount--;
-    int iIndex = m_piCachedParticle[m_iCachedParticleCount];
-    ParticleExt_t *p = &GetParticlesExt()[iIndex];
-    if (!p->valid)
+    unsigned int &iWord = pWords[m_iFirstFreeSlotWord];
+    while (iWord)
     {
-      iIndex++;
-      m_iHighWaterMark = hkvMath::Max(m_iHighWaterMark,iIndex);
-      return p;
+      int iIndex = (m_iFirstFreeSlotWord<<5) + GetLowestSetBitIndex(iWord);
+      iWord &= iWord-1; // remove from free slots
+      ParticleExt_t *p = &pParticles[iIndex];
+      if (!p->valid)
+      {
+        MarkSoAGatherPending(iIndex); // the caller initializes the particle after this call
+        iIndex++;
+        m_iHighWaterMark = hkvMath::Max(m_iHighWaterMark,iIndex);
+        return p;
+      }
+      // particle has been reused without GetFreeParticle, try the next one
     }
-    // particle has been reused although it was in cache, try the next one
-    return GetFreeParticle();
   }
 
-  // cache was empty, so fill it up again
-  if (!FillFreeParticleCache())
+  // no free slot left. Re-sync once, in case particles have been invalidated without DestroyParticle
+  if (m_bFreeSlotsExhausted || !FillFreeParticleCache())
     return NULL; // no free particle at all
 
   return GetFreeParticle();
@@ -1219,6 +1365,202 @@ void ParticleGroupBase_cl::DestroyParticle(Particle_t *pParticle,float fTimeDelt
 
 
 
+void ParticleGroupBase_cl::SetUseSoAStorage(bool bStatus)
+{
+  EnsureUpdaterTaskFinished();
+
+  m_bUseSoAStorage = bStatus;
+
+  // re-allocate in case the number of particles changed
+  m_bSoAStorageActive = m_bSoAGatherPending = false;
+  ResetSoAGatherRange();
+  m_SoAStorage.Free();
+  UpdateSoAStorageState();
+}
+
+
+void ParticleGroupBase_cl::UpdateSoAStorageState()
+{
+  // constraints operate on the particle array, so constrained groups are simulated on the particle array only. Otherwise
+  // both layouts would have to be converted into each other every frame
+  VisParticleGroupManager_cl &manager(VisParticleGroupManager_cl::GlobalManager());
+  const bool bHasConstraints = m_bHandleConstraints &&
+    (m_Constraints.GetConstraintCount()>0 || manager.GlobalConstraints().GetConstraintCount()>0);
+  const bool bActive = m_bUseSoAStorage && !bHasConstraints;
+  if (bActive==m_bSoAStorageActive)
+    return;
+
+  m_bSoAStorageActive = bActive;
+  if (!bActive)
+  {
+    m_SoAStorage.Free();
+    m_bSoAGatherPending = false;
+    ResetSoAGatherRange();
+    return;
+  }
+
+  if (m_SoAStorage.GetCapacity()!=GetNumOfParticles())
+    m_SoAStorage.Allocate(GetNumOfParticles());
+  m_bSoAGatherPending = true;
+}
+
+
+void ParticleGroupBase_cl::HandleParticlesSoA(int iCount, float fDeltaTime, int &iHighWaterMark, int &iValidCount)
+{
+  VASSERT(m_SoAStorage.GetCapacity()>=iCount);
+  ParticleExt_t *p = GetParticlesExt();
+
+  // particles have been modified outside the simulation (e.g. by constraints)
+  if (m_bSoAGatherPending)
+  {
+    m_SoAStorage.Gather(p, 0, iCount);
+    m_bSoAGatherPending = false;
+  }
+  else if (m_iSoAGatherFirst<hkvMath::Min(m_iSoAGatherEnd,iCount))
+  {
+    // slots handed out by GetFreeParticle, which may have been initialized without HandleSingleParticle
+    m_SoAStorage.Gather(p, m_iSoAGatherFirst, hkvMath::Min(m_iSoAGatherEnd,iCount)-m_iSoAGatherFirst);
+  }
+  ResetSoAGatherRange();
+
+  // vectorized integration of all particles up to the high water mark
+  ParticleSoAFrameConstants_t constants;
+  constants.m_fDeltaTime = fDeltaTime;
+  constants.m_fFriction = m_fFrameFriction;
+  constants.m_vWind = m_vFrameWind;
+  constants.m_vWindNoInertia = m_vFrameWindNoInertia;
+  constants.m_vGroupMoveDelta = m_vGroupMoveDelta;
+  constants.m_fLocalFactorStart = m_fLocalFactorStart;
+  constants.m_fLocalFactorDiff = m_fLocalFactorDiff;
+  constants.m_bMovesWithEmitter = m_bMovesWithEmitter;
+  constants.m_bRepeatLifetime = m_bRepeatLifetime;
+  constants.m_bIntegrateSize = (m_spSizeCurve==NULL);
+  m_SoAStorage.Integrate(0, iCount, constants);
+
+  const float *pLifeTime = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_LIFETIME);
+  const float *pPosX = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_POSX);
+  const float *pPosY = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_POSY);
+  const float *pPosZ = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_POSZ);
+  const float *pVelX = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_VELX);
+  const float *pVelY = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_VELY);
+  const float *pVelZ = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_VELZ);
+  const float *pSize = m_SoAStorage.GetStream(VisParticleSoAStorage_cl::STREAM_SIZE);
+
+  // scatter the results into the particle array and perform the lookups that cannot be vectorized.
+  // Dying particles are destroyed with their previous state, same as in HandleSingleParticle
+  for (int i=0;i<iCount;i++,p++) if (p->valid)
+  {
+    if (VISION_UNLIKELY(pLifeTime[i]>=1.f)) // lifetime is over (repeating lifetimes have already been wrapped around)
+    {
+      DestroyParticle(p,fDeltaTime);
+      continue;
+    }
+    p->m_fLifeTimeCounter = pLifeTime[i];
+
+    UpdateParticleColor(p);
+
+    if (VISION_LIKELY(m_spSizeCurve!=NULL))
+    {
+      p->size = m_spSizeCurve->GetValueFastInterpolated(p->m_fLifeTimeCounter) * p->m_fSizeGrowth;
+    }
+    else
+    {
+      if (pSize[i]<=0.f)
+      {
+        DestroyParticle(p,fDeltaTime);
+        continue;
+      }
+      p->size = pSize[i];
+    }
+
+    p->pos[0] = pPosX[i];
+    p->pos[1] = pPosY[i];
+    p->pos[2] = pPosZ[i];
+    p->velocity[0] = pVelX[i];
+    p->velocity[1] = pVelY[i];
+    p->velocity[2] = pVelZ[i];
+
+    UpdateParticleAttributes(p,fDeltaTime);
+
+    iHighWaterMark = i+1;
+    iValidCount++;
+  }
+}
+
+
+int ParticleGroupBase_cl::PrepareRangeTasks(int iCount, HandleParticleRangeTask_cl::RangeMode_e eMode, float fDeltaTime)
+{
+  // only split when there are at least two chunks and worker threads to run them
+  const int iChunkSize = VisParticleGroupManager_cl::GlobalManager().GetParallelSimulationChunkSize();
+  const int iThreadCount = Vision::GetThreadManager()->GetThreadCount();
+  if (iChunkSize<=0 || iThreadCount<1 || iCount<2*iChunkSize)
+    return 0;
+
+  int iTaskCount = (iCount+iChunkSize-1)/iChunkSize;
+  iTaskCount = hkvMath::Min(iTaskCount, iThreadCount+1); // the calling thread processes one chunk as well
+  iTaskCount = hkvMath::Min(iTaskCount, PARTICLE_MAX_PARALLEL_CHUNKS);
+
+  if (m_iRangeTaskCount<iTaskCount)
+  {
+    V_SAFE_DELETE_ARRAY(m_pRangeTasks);
+    m_pRangeTasks = new HandleParticleRangeTask_cl[iTaskCount];
+    m_iRangeTaskCount = iTaskCount;
+  }
+
+  // evenly distributed ranges in ascending order
+  for (int i=0;i<iTaskCount;i++)
+  {
+    HandleParticleRangeTask_cl &task(m_pRangeTasks[i]);
+    task.m_pParticleGroup = this;
+    task.m_eMode = eMode;
+    task.m_fTimeDelta = fDeltaTime;
+    task.m_iFirst = (iCount*i)/iTaskCount;
+    task.m_iLast = (iCount*(i+1))/iTaskCount;
+  }
+  return iTaskCount;
+}
+
+
+void ParticleGroupBase_cl::RunRangeTasks(VManagedThread *pThread, int iTaskCount)
+{
+  VThreadManager *pThreadManager = Vision::GetThreadManager();
+  for (int i=1;i<iTaskCount;i++)
+    pThreadManager->ScheduleTask(&m_pRangeTasks[i], 5);
+
+  // first chunk in this thread
+  m_pRangeTasks[0].Run(pThread);
+
+  for (int i=1;i<iTaskCount;i++)
+    pThreadManager->WaitForTask(&m_pRangeTasks[i], true);
+}
+
+
+bool ParticleGroupBase_cl::HandleParticlesParallel(VManagedThread *pThread, int iCount, float fDeltaTime, int &iHighWaterMark, int &iValidCount)
+{
+  const int iTaskCount = PrepareRangeTasks(iCount, HandleParticleRangeTask_cl::RANGE_SIMULATE, fDeltaTime);
+  if (iTaskCount==0)
+    return false;
+
+  RunRangeTasks(pThread, iTaskCount);
+
+  // merge in chunk order. Dead particles are destroyed in ascending index order, exactly like in the serial
+  // simulation, since destroying might spawn particles in the child group and consumes random numbers
+  ParticleExt_t *pParticles = GetParticlesExt();
+  for (int i=0;i<iTaskCount;i++)
+  {
+    HandleParticleRangeTask_cl &task(m_pRangeTasks[i]);
+    if (task.m_iHighWaterMark>0)
+      iHighWaterMark = task.m_iHighWaterMark;
+    iValidCount += task.m_iValidCount;
+
+    for (int j=0;j<task.m_iDeadCount;j++)
+      DestroyParticle(&pParticles[task.m_DeadParticles.GetDataPtr()[j]], fDeltaTime);
+  }
+
+  return true;
+}
+
+
 void ParticleGroupBase_cl::RenderParticleBoundingBoxes()
 {
   ParticleExt_t *p = GetParticlesExt();
@@ -1334,41 +1676,22 @@ void ParticleGroupBase_cl::HandleParticles(float dtime)
 void ParticleGroupBase_cl::InflateBoundingBox(bool bForceValid)
 {
   const int iCount = m_iHighWaterMark;
-  ParticleExt_t *p = GetParticlesExt();
-  int i;
   bool bAnyValid = false;
-  
-  for (i=0;i<iCount;i++,p++) if (p->valid)
-  {
-    hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
-    hkvVec3 rad(p->size,p->size,p->size);
 
-    hkvAlignedBBox transformedMeshBoundingBox = m_MeshBoundingBox;
-    transformedMeshBoundingBox.scaleFromOrigin(rad);
-    transformedMeshBoundingBox.translate(pos);
-
-    m_BoundingBox.expandToInclude(transformedMeshBoundingBox);
-
-	  rad *= 0.5f;
-
-    m_BoundingBox.expandToInclude(pos+rad);
-    m_BoundingBox.expandToInclude(pos-rad);
-
-    // make sure that this box remains valid until the next update
-    float dt = m_spDescriptor->m_fDynamicInflateInterval;
-    hkvVec3 lastPos(pos.x + p->velocity[0] * dt, pos.y + p->velocity[1] * dt, pos.z + p->velocity[2] * dt);
-    m_BoundingBox.expandToInclude(lastPos+rad);
-    m_BoundingBox.expandToInclude(lastPos-rad);
-
-    if (m_cUseDistortion)
+  // large layers: compute the bounding box of each chunk in parallel and merge
+  const int iTaskCount = PrepareRangeTasks(iCount, HandleParticleRangeTask_cl::RANGE_BOUNDINGBOX, 0.f);
+  if (iTaskCount>0)
+  {
+    RunRangeTasks(Vision::GetThreadManager()->GetExecutingThread(), iTaskCount);
+    for (int i=0;i<iTaskCount;i++) if (m_pRangeTasks[i].m_bAnyValid)
     {
-      pos.x += p->distortion[0];
-      pos.y += p->distortion[1];
-      pos.z += p->distortion[2];
-      m_BoundingBox.expandToInclude(pos+rad);
-      m_BoundingBox.expandToInclude(pos-rad);
+      m_BoundingBox.expandToInclude(m_pRangeTasks[i].m_BoundingBox);
+      bAnyValid = true;
     }
-    bAnyValid = true;
+  }
+  else
+  {
+    bAnyValid = InflateBoundingBoxRange(0, iCount, m_BoundingBox);
   }
 
   if (!bAnyValid && bForceValid)
@@ -1397,6 +1720,47 @@ void ParticleGroupBase_cl::InflateBoundingBox(bool bForceValid)
 }
 
 
+bool ParticleGroupBase_cl::InflateBoundingBoxRange(int iFirst, int iLast, hkvAlignedBBox &bbox) const
+{
+  const ParticleExt_t *p = &GetParticlesExt()[iFirst];
+  bool bAnyValid = false;
+
+  for (int i=iFirst;i<iLast;i++,p++) if (p->valid)
+  {
+    hkvVec3 pos(p->pos[0],p->pos[1],p->pos[2]);
+    hkvVec3 rad(p->size,p->size,p->size);
+
+    hkvAlignedBBox transformedMeshBoundingBox = m_MeshBoundingBox;
+    transformedMeshBoundingBox.scaleFromOrigin(rad);
+    transformedMeshBoundingBox.translate(pos);
+
+    bbox.expandToInclude(transformedMeshBoundingBox);
+
+	  rad *= 0.5f;
+
+    bbox.expandToInclude(pos+rad);
+    bbox.expandToInclude(pos-rad);
+
+    // make sure that this box remains valid until the next update
+    float dt = m_spDescriptor->m_fDynamicInflateInterval;
+    hkvVec3 lastPos(pos.x + p->velocity[0] * dt, pos.y + p->velocity[1] * dt, pos.z + p->velocity[2] * dt);
+    bbox.expandToInclude(lastPos+rad);
+    bbox.expandToInclude(lastPos-rad);
+
+    if (m_cUseDistortion)
+    {
+      pos.x += p->distortion[0];
+      pos.y += p->distortion[1];
+      pos.z += p->distortion[2];
+      bbox.expandToInclude(pos+rad);
+      bbox.expandToInclude(pos-rad);
+    }
+    bAnyValid = true;
+  }
+  return bAnyValid;
+}
+
+
 int ParticleGroupBase_cl::AddRelevantConstraints(const VisParticleConstraintList_cl *pSrcList, bool bCheckInfluence)
 {
   EnsureUpdaterTaskFinished();
@@ -1437,12 +1801,15 @@ bool ParticleGroupBase_cl::AddConstraint(VisParticleConstraint_cl *pConstraint,
 
 void ParticleGroupBase_cl::HandleAllConstraints(float dtime) 
 {
-  // local list of constraints
-  m_Constraints.HandleParticles(this,dtime,m_iConstraintAffectBitMask);
-
-  // handle global list. Note that HandleParticles causes problems in multithreaded mode. Removing dead constraints is not necessary here
+  // local list of constraints followed by the global list, applied in one pass over the particles. Note that removing dead
+  // constraints from the global list causes problems in multithreaded mode, so that list is only read (see HandleParticlesNoRemove)
   VisParticleGroupManager_cl &manager( VisParticleGroupManager_cl::GlobalManager());
-  manager.GlobalConstraints().HandleParticlesNoRemove(this,dtime,m_iConstraintAffectBitMask);
+  m_Constraints.HandleParticlesFused(this,dtime,m_iConstraintAffectBitMask,&manager.GlobalConstraints());
+
+  // constraints that have been added during this frame modified the particle array; the SoA copy is turned off for
+  // this group in the next frame (see UpdateSoAStorageState)
+  if (m_Constraints.GetConstraintCount()>0 || manager.GlobalConstraints().GetConstraintCount()>0)
+    InvalidateSoAStorage();
 }
 
 
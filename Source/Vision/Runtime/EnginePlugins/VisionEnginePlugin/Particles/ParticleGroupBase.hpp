@@ -16,8 +16,10 @@
 #include <Vision/Runtime/Engine/Renderer/Texture/VisApiBitmap.hpp>
 #include <Vision/Runtime/Engine/System/VisApiCallbacks.hpp>
 #include <Vision/Runtime/Base/Math/Random/VRandom.hpp>
+#include <Vision/Runtime/Base/Container/VBitField.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleConstraint.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleDescriptor.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleSoAStorage.hpp>
 
 // group flags
 #define PGROUPFLAGS_NONE        0x00000000
@@ -25,8 +27,13 @@
 // maximum recursion depth for particle groups that have a child group for destroyed particles
 #define MAX_ONDESTROY_GROUPDEPTH    8
 
-// minimum cache size, also used for static member size
-#define PARTICLECACHESIZE_NOALLOC   32
+// number of particles for which the free slot bitfield does not need to allocate
+#define PARTICLEFREESLOTS_NOALLOC   256
+
+// default number of particles per task when splitting the simulation of a layer (see VisParticleGroupManager_cl::SetParallelSimulationChunkSize)
+#define PARTICLE_DEFAULT_PARALLEL_CHUNKSIZE   4096
+// maximum number of tasks that the simulation of a single layer is split into
+#define PARTICLE_MAX_PARALLEL_CHUNKS          16
 
 // known trigger target constants
 #define PARTICLETRIGGER_PAUSE     "Pause"
@@ -81,6 +88,56 @@ public:
 };
 
 
+///\brief
+///Threaded task class that processes a range of particles of a single layer
+///
+///Used by HandleParticlesTask_cl to split the simulation of large layers across multiple threads.
+///Particles that die are not destroyed by this task, since destroying can spawn particles in the child layer. Instead
+///they are collected and destroyed in index order by the owner task, so the result matches the serial simulation.
+class HandleParticleRangeTask_cl : public VThreadedTask
+{
+public:
+  ///\brief
+  ///Task modes
+  enum RangeMode_e
+  {
+    RANGE_SIMULATE = 0,     ///< simulates the particles (HandleSingleParticle)
+    RANGE_BOUNDINGBOX = 1   ///< computes the bounding box of the particles
+  };
+
+  ///\brief
+  ///Constructor
+  inline HandleParticleRangeTask_cl() : VThreadedTask(), m_DeadParticles(0,-1)
+  {
+    m_pParticleGroup = NULL;
+    m_eMode = RANGE_SIMULATE;
+    m_fTimeDelta = 0.f;
+    m_iFirst = m_iLast = 0;
+    m_iHighWaterMark = m_iValidCount = m_iDeadCount = 0;
+    m_bAnyValid = false;
+  }
+
+  ///\brief
+  ///Overridden Run function that processes the range [m_iFirst, m_iLast)
+  virtual void Run(VManagedThread *pThread);
+
+  ParticleGroupBase_cl *m_pParticleGroup; ///< owner group
+  RangeMode_e m_eMode;                    ///< what to do with the particles
+  float m_fTimeDelta;                     ///< time delta used for simulation
+  int m_iFirst, m_iLast;                  ///< particle range
+
+  // results
+  int m_iHighWaterMark;                   ///< highest alive particle index + 1
+  int m_iValidCount;                      ///< number of alive particles
+  int m_iDeadCount;                       ///< number of particles in m_DeadParticles
+  DynArray_cl<int> m_DeadParticles;       ///< indices of particles that have to be destroyed (ascending)
+  hkvAlignedBBox m_BoundingBox;           ///< bounding box in RANGE_BOUNDINGBOX mode
+  bool m_bAnyValid;                       ///< whether the bounding box contains any particle
+
+  V_DECLARE_DYNCREATE_DLLEXP( HandleParticleRangeTask_cl,  PARTICLE_IMPEXP );
+};
+
+
 ///\brief
 ///Structure that represents a single particle of the extended particle system. Adds more particle specific properties
 struct ParticleExt_t : public Particle_t
@@ -335,9 +392,14 @@ public:
 
   ///\brief
   ///Returns a new particle from the layer. The result can be NULL
+  ///
+  ///Always returns the free slot with the lowest index, so alive particles stay packed at the beginning of
+  ///the particle array and the high water mark stays tight. In SoA mode, the returned slot is gathered into the
+  ///SoA streams before the next simulation step, so the caller can initialize the particle directly.
   PARTICLE_IMPEXP ParticleExt_t* GetFreeParticle();
+
   ///\brief
-  ///Cache helper function
+  ///Rebuilds the free slot bitfield from the valid flags of the particles. Returns false if there is no free particle
   PARTICLE_IMPEXP bool FillFreeParticleCache();
 
   ///\brief
@@ -346,7 +408,50 @@ public:
 
   ///\brief
   ///Simulation function of a single particle
-  inline bool HandleSingleParticle(ParticleExt_t *pParticle, float fDeltaTime);
+  ///
+  ///Returns false if the particle died. If bDestroyDeadParticles is false, a dead particle remains valid and the caller
+  ///is responsible for calling DestroyParticle.
+  inline bool HandleSingleParticle(ParticleExt_t *pParticle, float fDeltaTime, bool bDestroyDeadParticles=true);
+
+  ///\brief
+  ///Enables or disables the structure-of-arrays simulation mode for this layer
+  ///
+  ///In SoA mode, lifetime, position, velocity and size of all particles are integrated by a SIMD kernel
+  ///(see VisParticleSoAStorage_cl) instead of calling HandleSingleParticle per particle. The ParticleExt_t array
+  ///(GetParticlesExt) remains valid for rendering. By default the mode is taken from the descriptor
+  ///(VisParticleGroupDescriptor_cl::m_bUseSoASimulation).
+  ///
+  ///Constraints operate on the particle array. While the layer is affected by local or global constraints, the SoA
+  ///storage is released and the layer is simulated per particle; it is re-enabled once no constraints are left.
+  PARTICLE_IMPEXP void SetUseSoAStorage(bool bStatus);
+
+  ///\brief
+  ///Returns whether the structure-of-arrays simulation mode is enabled
+  inline bool GetUseSoAStorage() const {return m_bUseSoAStorage;}
+
+  ///\brief
+  ///Must be called after particles have been modified directly through GetParticlesExt while SoA mode is
+  ///enabled. The SoA streams are then re-initialized from the particle array before the next simulation step
+  inline void InvalidateSoAStorage() {m_bSoAGatherPending = m_bSoAStorageActive;}
+
+  ///\brief
+  ///Selects the algorithm that is used to depth sort the particles of this layer (if sorting is enabled)
+  ///
+  ///The radix sort runs in linear time on the 16 bit sort keys and takes advantage of the order of the
+  ///previous frame. If disabled, qsort is used. By default the mode is taken from the descriptor
+  ///(VisParticleGroupDescriptor_cl::m_bRadixSortParticles).
+  inline void SetUseRadixSort(bool bStatus) {EnsureUpdaterTaskFinished();m_bRadixSortParticles=bStatus;}
+
+  ///\brief
+  ///Returns whether the radix sort is used for sorting the particles of this layer
+  inline bool GetUseRadixSort() const {return m_bRadixSortParticles;}
+
+  ///\brief
+  ///Sorts a particle index list by descending sort key, either with the radix sort or with qsort
+  ///
+  ///This is the sort that is applied to the index list of every sorted layer. pTemp is the scratch buffer of
+  ///the radix sort and must hold iCount entries. It is not used by qsort and may be NULL in that case.
+  PARTICLE_IMPEXP static void SortParticleIndexList(ParticleSort_t *pList, ParticleSort_t *pTemp, int iCount, bool bRadixSort);
 
   ///\brief
   ///Respawns all particles
@@ -571,6 +676,7 @@ private:
   friend class VisParticleEmitter_cl;
   friend class VisParticleEffectFile_cl;
   friend class HandleParticlesTask_cl;
+  friend class HandleParticleRangeTask_cl;
   friend class VParticleDesaturationShaderpass;
   friend class VParticleDesaturationManager;
 
@@ -582,6 +688,16 @@ private:
   void RemoveUpdaterTaskRecursive(ParticleGroupBase_cl *pGroup);
 
   inline bool AddParticleToCache(ParticleExt_t *pParticle);
+  inline void UpdateParticleColor(ParticleExt_t *pParticle);
+  inline void UpdateParticleAttributes(ParticleExt_t *pParticle, float fDeltaTime);
+  void UpdateSoAStorageState();
+  inline void MarkSoAGatherPending(int iIndex);
+  inline void ResetSoAGatherRange() {m_iSoAGatherFirst = INT_MAX; m_iSoAGatherEnd = 0;}
+  void HandleParticlesSoA(int iCount, float fDeltaTime, int &iHighWaterMark, int &iValidCount);
+  bool HandleParticlesParallel(VManagedThread *pThread, int iCount, float fDeltaTime, int &iHighWaterMark, int &iValidCount);
+  int PrepareRangeTasks(int iCount, HandleParticleRangeTask_cl::RangeMode_e eMode, float fDeltaTime);
+  void RunRangeTasks(VManagedThread *pThread, int iTaskCount);
+  bool InflateBoundingBoxRange(int iFirst, int iLast, hkvAlignedBBox &bbox) const;
 
   ParticleGroupBase_cl *m_pParentGroup; ///< no smart pointer because of dead-lock
 
@@ -615,10 +731,10 @@ private:
   VColorRef m_InstanceColor;            ///< internal final color result
   VColorRef m_AmbientColor;             ///< color set via VisParticleEffect_cl::SetAmbientColor
 
-  // cache free particles
-  short m_iCachedParticleCount, m_iMaxCachedParticleCount;  ///< number of currently cached free particles
-  unsigned short *m_piCachedParticle;   ///< pointer to cached particles
-  unsigned short m_iCachedParticleNoAlloc[PARTICLECACHESIZE_NOALLOC];
+  // free particles
+  VTBitfield<PARTICLEFREESLOTS_NOALLOC> m_FreeSlots; ///< one bit per particle, set for free slots
+  int m_iFirstFreeSlotWord;             ///< index of the first 32 bit word in m_FreeSlots that may contain a set bit
+  bool m_bFreeSlotsExhausted;           ///< set when re-syncing m_FreeSlots did not find a free particle
 
   // group instance vars
   float m_fLifeTime;                    ///< group lifetime
@@ -685,8 +801,21 @@ private:
   bool m_bAttachedToCam; ///< Deprecated
   hkvVec3 m_vCamRelPos;  ///< Deprecated
 
+  // structure-of-arrays simulation
+  bool m_bUseSoAStorage;                         ///< SoA simulation has been requested, see SetUseSoAStorage
+  bool m_bSoAStorageActive;                      ///< m_SoAStorage is allocated and the simulation is performed on it (no constraints)
+  bool m_bSoAGatherPending;                      ///< the particle array has been modified and needs to be gathered into m_SoAStorage
+  int m_iSoAGatherFirst, m_iSoAGatherEnd;        ///< range of slots handed out by GetFreeParticle that still needs to be gathered
+  VisParticleSoAStorage_cl m_SoAStorage;         ///< SoA copy of the particle simulation state
+
+  // sorting
+  bool m_bRadixSortParticles;                    ///< sort the index list with the radix sort rather than qsort
+  DynArray_cl<ParticleSort_t> m_SortScratch;     ///< scratch buffer for the radix sort
+
   // task
   HandleParticlesTask_cl *m_pHandlingTask;       ///< pointer to simulation task
+  HandleParticleRangeTask_cl *m_pRangeTasks;     ///< tasks for splitting the simulation of large layers (see PrepareRangeTasks)
+  int m_iRangeTaskCount;                         ///< number of allocated range tasks
 
   #ifdef WIN32
     void* m_pParticleDesaturationGroup;           ///< pointer to particle desaturation group used by simulation package
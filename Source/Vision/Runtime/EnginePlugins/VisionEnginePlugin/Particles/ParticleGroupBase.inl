@@ -29,6 +29,29 @@ inline void IVPhysicsParticleCollection_cl::UpdateSeed()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////
+// VisParticleSoAStorage_cl
+///////////////////////////////////////////////////////////////////////////////////
+
+inline void VisParticleSoAStorage_cl::GatherParticle(const ParticleExt_t *pParticle, int iIndex)
+{
+  VASSERT(iIndex>=0 && iIndex<m_iCapacity);
+  float *pData = &m_pData[iIndex];
+  const int iStride = m_iStreamStride;
+  pData[STREAM_LIFETIME*iStride] = pParticle->m_fLifeTimeCounter;
+  pData[STREAM_LIFETIMEINC*iStride] = pParticle->m_fLifeTimeInc;
+  pData[STREAM_POSX*iStride] = pParticle->pos[0];
+  pData[STREAM_POSY*iStride] = pParticle->pos[1];
+  pData[STREAM_POSZ*iStride] = pParticle->pos[2];
+  pData[STREAM_VELX*iStride] = pParticle->velocity[0];
+  pData[STREAM_VELY*iStride] = pParticle->velocity[1];
+  pData[STREAM_VELZ*iStride] = pParticle->velocity[2];
+  pData[STREAM_INERTIA*iStride] = pParticle->m_fInertiaFactor;
+  pData[STREAM_SIZE*iStride] = pParticle->size;
+  pData[STREAM_SIZEGROWTH*iStride] = pParticle->m_fSizeGrowth;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////
 // particle group
 ///////////////////////////////////////////////////////////////////////////////////
@@ -134,16 +157,22 @@ inline bool ParticleGroupBase_cl::IsHalted() const
 inline bool ParticleGroupBase_cl::AddParticleToCache(ParticleExt_t *pParticle)
 {
   pParticle->valid = 0; // this will be checked again when returning free particle
-  if (m_iCachedParticleCount>=m_iMaxCachedParticleCount)
-    return false;
-
-  // cache the index
   int iIndex = (int)(pParticle-GetParticlesExt()); // no division by particle size here :-)
   VASSERT(&GetParticlesExt()[iIndex]==pParticle);
-  m_piCachedParticle[m_iCachedParticleCount++] = iIndex;
+  m_FreeSlots.SetBit(iIndex);
+  m_iFirstFreeSlotWord = hkvMath::Min(m_iFirstFreeSlotWord,iIndex>>5);
+  m_bFreeSlotsExhausted = false;
   return true;
 }
 
+inline void ParticleGroupBase_cl::MarkSoAGatherPending(int iIndex)
+{
+  if (!m_bSoAStorageActive)
+    return;
+  m_iSoAGatherFirst = hkvMath::Min(m_iSoAGatherFirst,iIndex);
+  m_iSoAGatherEnd = hkvMath::Max(m_iSoAGatherEnd,iIndex+1);
+}
+
 inline void ParticleGroupBase_cl::InitSingleParticle(ParticleExt_t *pParticle)
 {
   VASSERT(pParticle);
@@ -210,23 +239,8 @@ inline void ParticleGroupBase_cl::SetParticleAnimFrame(ParticleExt_t *pParticle,
 }
 
 
-inline bool ParticleGroupBase_cl::HandleSingleParticle(ParticleExt_t *pParticle, float fDeltaTime)
+inline void ParticleGroupBase_cl::UpdateParticleColor(ParticleExt_t *pParticle)
 {
-  // handle lifetime
-  pParticle->m_fLifeTimeCounter += fDeltaTime*pParticle->m_fLifeTimeInc;
-  if (VISION_UNLIKELY(pParticle->m_fLifeTimeCounter>=1.f)) // lifetime is over
-  {
-    if (m_bRepeatLifetime)
-      pParticle->m_fLifeTimeCounter = hkvMath::mod (pParticle->m_fLifeTimeCounter,1.f);
-    else
-    {
-      DestroyParticle(pParticle,fDeltaTime);
-      return false;
-    }
-  }
-
-
-  // assign new color
   if (VISION_LIKELY(m_pColorLookup!=NULL))
   {
     // do the color lookup at y=per particle random value, x=lifetime
@@ -255,38 +269,11 @@ inline bool ParticleGroupBase_cl::HandleSingleParticle(ParticleExt_t *pParticle,
   {
     pParticle->color = m_InstanceColor * pParticle->m_ModColor;
   }
+}
 
-  // particle size : either from size curve of lookup or just grow size
-  if (VISION_LIKELY(m_spSizeCurve!=NULL))
-  {
-    pParticle->size = m_spSizeCurve->GetValueFastInterpolated(pParticle->m_fLifeTimeCounter) * pParticle->m_fSizeGrowth;
-  } 
-  else
-  {
-    pParticle->size += pParticle->m_fSizeGrowth * fDeltaTime;
-    if (pParticle->size<=0.f)
-    {
-      DestroyParticle(pParticle,fDeltaTime);
-      return false;
-    }
-  }
-
-  pParticle->pos[0] += pParticle->velocity[0]*fDeltaTime;
-  pParticle->pos[1] += pParticle->velocity[1]*fDeltaTime;
-  pParticle->pos[2] += pParticle->velocity[2]*fDeltaTime;
-
-  if (m_bMovesWithEmitter)
-  {
-    float fWeight = m_fLocalFactorStart + m_fLocalFactorDiff * pParticle->m_fLifeTimeCounter;
-    pParticle->pos[0] += m_vGroupMoveDelta.x * fWeight;
-    pParticle->pos[1] += m_vGroupMoveDelta.y * fWeight;
-    pParticle->pos[2] += m_vGroupMoveDelta.z * fWeight;
-  }
-
-  pParticle->velocity[0] = (pParticle->velocity[0] + m_vFrameWind.x*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.x)*m_fFrameFriction;
-  pParticle->velocity[1] = (pParticle->velocity[1] + m_vFrameWind.y*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.y)*m_fFrameFriction;
-  pParticle->velocity[2] = (pParticle->velocity[2] + m_vFrameWind.z*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.z)*m_fFrameFriction;
 
+inline void ParticleGroupBase_cl::UpdateParticleAttributes(ParticleExt_t *pParticle, float fDeltaTime)
+{
   float fAnimFrame;
   // animation
   switch (m_eParticleAnimMode)
@@ -319,7 +306,7 @@ inline bool ParticleGroupBase_cl::HandleSingleParticle(ParticleExt_t *pParticle,
   }
 
   if (!m_cUseDistortion)
-    return true;
+    return;
 
   // particle distortion
   if (m_cUseDistortion==DISTORTION_TYPE_SIZEMODE)
@@ -383,6 +370,67 @@ inline bool ParticleGroupBase_cl::HandleSingleParticle(ParticleExt_t *pParticle,
     pParticle->normal[1] = vRight.y;
     pParticle->normal[2] = vRight.z;
   }
+}
+
+
+inline bool ParticleGroupBase_cl::HandleSingleParticle(ParticleExt_t *pParticle, float fDeltaTime, bool bDestroyDeadParticles)
+{
+  // handle lifetime
+  pParticle->m_fLifeTimeCounter += fDeltaTime*pParticle->m_fLifeTimeInc;
+  if (VISION_UNLIKELY(pParticle->m_fLifeTimeCounter>=1.f)) // lifetime is over
+  {
+    if (m_bRepeatLifetime)
+      pParticle->m_fLifeTimeCounter = hkvMath::mod (pParticle->m_fLifeTimeCounter,1.f);
+    else
+    {
+      if (bDestroyDeadParticles)
+        DestroyParticle(pParticle,fDeltaTime);
+      return false;
+    }
+  }
+
+
+  // assign new color
+  UpdateParticleColor(pParticle);
+
+  // particle size : either from size curve of lookup or just grow size
+  if (VISION_LIKELY(m_spSizeCurve!=NULL))
+  {
+    pParticle->size = m_spSizeCurve->GetValueFastInterpolated(pParticle->m_fLifeTimeCounter) * pParticle->m_fSizeGrowth;
+  } 
+  else
+  {
+    pParticle->size += pParticle->m_fSizeGrowth * fDeltaTime;
+    if (pParticle->size<=0.f)
+    {
+      if (bDestroyDeadParticles)
+        DestroyParticle(pParticle,fDeltaTime);
+      return false;
+    }
+  }
+
+  pParticle->pos[0] += pParticle->velocity[0]*fDeltaTime;
+  pParticle->pos[1] += pParticle->velocity[1]*fDeltaTime;
+  pParticle->pos[2] += pParticle->velocity[2]*fDeltaTime;
+
+  if (m_bMovesWithEmitter)
+  {
+    float fWeight = m_fLocalFactorStart + m_fLocalFactorDiff * pParticle->m_fLifeTimeCounter;
+    pParticle->pos[0] += m_vGroupMoveDelta.x * fWeight;
+    pParticle->pos[1] += m_vGroupMoveDelta.y * fWeight;
+    pParticle->pos[2] += m_vGroupMoveDelta.z * fWeight;
+  }
+
+  pParticle->velocity[0] = (pParticle->velocity[0] + m_vFrameWind.x*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.x)*m_fFrameFriction;
+  pParticle->velocity[1] = (pParticle->velocity[1] + m_vFrameWind.y*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.y)*m_fFrameFriction;
+  pParticle->velocity[2] = (pParticle->velocity[2] + m_vFrameWind.z*pParticle->m_fInertiaFactor + m_vFrameWindNoInertia.z)*m_fFrameFriction;
+
+  UpdateParticleAttributes(pParticle, fDeltaTime);
+
+  // keep the SoA copy in sync, e.g. for newly spawned particles
+  if (m_bSoAStorageActive)
+    m_SoAStorage.GatherParticle(pParticle, (int)(pParticle-GetParticlesExt()));
+
   return true;
 }
 
@@ -25,6 +25,8 @@ VisParticleGroupManager_cl::VisParticleGroupManager_cl(const char *szManagerName
 {
   m_fGlobalTimeScaling = 1.f;
   m_fLastToDUpdate = -1.f;
+  m_iParallelChunkSize = PARTICLE_DEFAULT_PARALLEL_CHUNKSIZE;
+  m_bParallelChildGroups = true;
 }
 
 VisParticleGroupManager_cl::~VisParticleGroupManager_cl()
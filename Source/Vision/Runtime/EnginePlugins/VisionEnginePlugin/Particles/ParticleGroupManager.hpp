@@ -246,6 +246,39 @@ public:
   /// Set a global value that scales fade distances of all effects relatively. The default value is 1.0.
   PARTICLE_IMPEXP void SetGlobalFadeDistanceScaling(float fScale);
 
+  ///\brief
+  /// Sets the number of particles per chunk when the simulation of a single layer is split across multiple threads
+  ///
+  /// Layers with at least two chunks worth of particles are simulated by several HandleParticleRangeTask_cl tasks
+  /// in parallel. The result is identical to the serial simulation. Set to 0 to disable splitting. The default is
+  /// PARTICLE_DEFAULT_PARALLEL_CHUNKSIZE.
+  inline void SetParallelSimulationChunkSize(int iParticleCount)
+  {
+    m_iParallelChunkSize = iParticleCount;
+  }
+
+  ///\brief
+  /// Returns the value that has been set via SetParallelSimulationChunkSize
+  inline int GetParallelSimulationChunkSize() const
+  {
+    return m_iParallelChunkSize;
+  }
+
+  ///\brief
+  /// If enabled (default), child layers (created on particle destruction) are simulated in their own task rather
+  /// than inside the task of the parent layer
+  inline void SetParallelChildGroups(bool bStatus)
+  {
+    m_bParallelChildGroups = bStatus;
+  }
+
+  ///\brief
+  /// Returns the value that has been set via SetParallelChildGroups
+  inline bool GetParallelChildGroups() const
+  {
+    return m_bParallelChildGroups;
+  }
+
   ///\brief
   /// Implements the resource manager's create function
   PARTICLE_IMPEXP virtual VManagedResource *CreateResource(const char *szFilename, VResourceSnapshotEntry *pExtraInfo) HKV_OVERRIDE;
@@ -278,6 +311,8 @@ private:
   VisParticleConstraintList_cl m_GlobalConstraints;
   float m_fGlobalTimeScaling;
   float m_fLastToDUpdate;
+  int m_iParallelChunkSize;
+  bool m_bParallelChildGroups;
   static float g_fGlobalFadeScaling;
 };
 
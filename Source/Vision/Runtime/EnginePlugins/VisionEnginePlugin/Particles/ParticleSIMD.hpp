@@ -0,0 +1,135 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file ParticleSIMD.hpp
+
+#ifndef PARTICLESIMD_HPP_INCLUDED
+#define PARTICLESIMD_HPP_INCLUDED
+
+// select the SIMD instruction set used by the particle kernels
+#if (defined(WIN32) && !defined(_M_ARM)) || defined(__SSE2__)
+  #include <emmintrin.h>
+  #define PARTICLE_SIMD_SSE
+#elif defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define PARTICLE_SIMD_NEON
+#endif
+
+// number of particles processed by a single SIMD instruction
+#define PARTICLE_SIMD_WIDTH       4
+
+// The PARTICLE4_ macros below are only meant to be used inside the particle kernel translation units. Comparisons
+// return a lane mask that can be combined with PARTICLE4_AND/PARTICLE4_OR and converted to a 4 bit integer
+// mask (bit n = lane n) with PARTICLE4_MOVEMASK.
+
+#if defined(PARTICLE_SIMD_SSE)
+
+  typedef __m128 ParticleReal4;
+  #define PARTICLE4_LOAD(p)         _mm_load_ps(p)
+  #define PARTICLE4_STORE(p,a)      _mm_store_ps(p,a)
+  #define PARTICLE4_SET(f)          _mm_set1_ps(f)
+  #define PARTICLE4_SET4(a,b,c,d)   _mm_setr_ps(a,b,c,d)
+  #define PARTICLE4_ADD(a,b)        _mm_add_ps(a,b)
+  #define PARTICLE4_SUB(a,b)        _mm_sub_ps(a,b)
+  #define PARTICLE4_MUL(a,b)        _mm_mul_ps(a,b)
+  #define PARTICLE4_MADD(a,b,c)     _mm_add_ps(_mm_mul_ps(a,b),c)
+  #define PARTICLE4_MAX(a,b)        _mm_max_ps(a,b)
+  // truncation is the same as floor for the positive lifetime values
+  #define PARTICLE4_FRAC(a)         _mm_sub_ps(a,_mm_cvtepi32_ps(_mm_cvttps_epi32(a)))
+  #define PARTICLE4_CMPLT(a,b)      _mm_cmplt_ps(a,b)
+  #define PARTICLE4_CMPLE(a,b)      _mm_cmple_ps(a,b)
+  #define PARTICLE4_AND(a,b)        _mm_and_ps(a,b)
+  #define PARTICLE4_OR(a,b)         _mm_or_ps(a,b)
+  #define PARTICLE4_MOVEMASK(a)     _mm_movemask_ps(a)
+
+#elif defined(PARTICLE_SIMD_NEON)
+
+  typedef float32x4_t ParticleReal4;
+
+  static inline ParticleReal4 Particle4Set4(float a, float b, float c, float d) {const float f[4] = {a,b,c,d}; return vld1q_f32(f);}
+  static inline int Particle4MoveMask(float32x4_t a)
+  {
+    const uint32x4_t m = vshrq_n_u32(vreinterpretq_u32_f32(a),31);
+    return (int)(vgetq_lane_u32(m,0) | (vgetq_lane_u32(m,1)<<1) | (vgetq_lane_u32(m,2)<<2) | (vgetq_lane_u32(m,3)<<3));
+  }
+
+  #define PARTICLE4_LOAD(p)         vld1q_f32(p)
+  #define PARTICLE4_STORE(p,a)      vst1q_f32(p,a)
+  #define PARTICLE4_SET(f)          vdupq_n_f32(f)
+  #define PARTICLE4_SET4(a,b,c,d)   Particle4Set4(a,b,c,d)
+  #define PARTICLE4_ADD(a,b)        vaddq_f32(a,b)
+  #define PARTICLE4_SUB(a,b)        vsubq_f32(a,b)
+  #define PARTICLE4_MUL(a,b)        vmulq_f32(a,b)
+  #define PARTICLE4_MADD(a,b,c)     vmlaq_f32(c,a,b)
+  #define PARTICLE4_MAX(a,b)        vmaxq_f32(a,b)
+  #define PARTICLE4_FRAC(a)         vsubq_f32(a,vcvtq_f32_s32(vcvtq_s32_f32(a)))
+  #define PARTICLE4_CMPLT(a,b)      vreinterpretq_f32_u32(vcltq_f32(a,b))
+  #define PARTICLE4_CMPLE(a,b)      vreinterpretq_f32_u32(vcleq_f32(a,b))
+  #define PARTICLE4_AND(a,b)        vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a),vreinterpretq_u32_f32(b)))
+  #define PARTICLE4_OR(a,b)         vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a),vreinterpretq_u32_f32(b)))
+  #define PARTICLE4_MOVEMASK(a)     Particle4MoveMask(a)
+
+#else
+
+  // plain C fallback that keeps the kernel code identical on all platforms. Comparison results are stored as
+  // all-bits-set/zero lanes in the integer view, just like the SIMD versions.
+  union ParticleReal4
+  {
+    float v[4];
+    unsigned int m[4];
+  };
+
+  static inline ParticleReal4 Particle4Load(const float *p) {ParticleReal4 r; r.v[0]=p[0];r.v[1]=p[1];r.v[2]=p[2];r.v[3]=p[3]; return r;}
+  static inline void Particle4Store(float *p, const ParticleReal4 &a) {p[0]=a.v[0];p[1]=a.v[1];p[2]=a.v[2];p[3]=a.v[3];}
+  static inline ParticleReal4 Particle4Set(float f) {ParticleReal4 r; r.v[0]=r.v[1]=r.v[2]=r.v[3]=f; return r;}
+  static inline ParticleReal4 Particle4Set4(float a, float b, float c, float d) {ParticleReal4 r; r.v[0]=a;r.v[1]=b;r.v[2]=c;r.v[3]=d; return r;}
+  static inline ParticleReal4 Particle4Add(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.v[i]=a.v[i]+b.v[i]; return r;}
+  static inline ParticleReal4 Particle4Sub(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.v[i]=a.v[i]-b.v[i]; return r;}
+  static inline ParticleReal4 Particle4Mul(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.v[i]=a.v[i]*b.v[i]; return r;}
+  static inline ParticleReal4 Particle4Max(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.v[i]=(a.v[i]>b.v[i]) ? a.v[i] : b.v[i]; return r;}
+  static inline ParticleReal4 Particle4Frac(const ParticleReal4 &a) {ParticleReal4 r; for (int i=0;i<4;i++) r.v[i]=a.v[i]-(float)(int)a.v[i]; return r;}
+  static inline ParticleReal4 Particle4CmpLt(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.m[i]=(a.v[i]<b.v[i]) ? 0xffffffff : 0; return r;}
+  static inline ParticleReal4 Particle4CmpLe(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.m[i]=(a.v[i]<=b.v[i]) ? 0xffffffff : 0; return r;}
+  static inline ParticleReal4 Particle4And(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.m[i]=a.m[i]&b.m[i]; return r;}
+  static inline ParticleReal4 Particle4Or(const ParticleReal4 &a, const ParticleReal4 &b) {ParticleReal4 r; for (int i=0;i<4;i++) r.m[i]=a.m[i]|b.m[i]; return r;}
+  static inline int Particle4MoveMask(const ParticleReal4 &a) {return (int)((a.m[0]>>31) | ((a.m[1]>>31)<<1) | ((a.m[2]>>31)<<2) | ((a.m[3]>>31)<<3));}
+
+  #define PARTICLE4_LOAD(p)         Particle4Load(p)
+  #define PARTICLE4_STORE(p,a)      Particle4Store(p,a)
+  #define PARTICLE4_SET(f)          Particle4Set(f)
+  #define PARTICLE4_SET4(a,b,c,d)   Particle4Set4(a,b,c,d)
+  #define PARTICLE4_ADD(a,b)        Particle4Add(a,b)
+  #define PARTICLE4_SUB(a,b)        Particle4Sub(a,b)
+  #define PARTICLE4_MUL(a,b)        Particle4Mul(a,b)
+  #define PARTICLE4_MADD(a,b,c)     Particle4Add(Particle4Mul(a,b),c)
+  #define PARTICLE4_MAX(a,b)        Particle4Max(a,b)
+  #define PARTICLE4_FRAC(a)         Particle4Frac(a)
+  #define PARTICLE4_CMPLT(a,b)      Particle4CmpLt(a,b)
+  #define PARTICLE4_CMPLE(a,b)      Particle4CmpLe(a,b)
+  #define PARTICLE4_AND(a,b)        Particle4And(a,b)
+  #define PARTICLE4_OR(a,b)         Particle4Or(a,b)
+  #define PARTICLE4_MOVEMASK(a)     Particle4MoveMask(a)
+
+#endif
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
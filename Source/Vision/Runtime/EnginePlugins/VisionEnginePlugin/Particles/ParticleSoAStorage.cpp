@@ -0,0 +1,146 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleGroupBase.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleSoAStorage.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// VisParticleSoAStorage_cl
+///////////////////////////////////////////////////////////////////////////////////
+
+VisParticleSoAStorage_cl::VisParticleSoAStorage_cl()
+{
+  m_pData = NULL;
+  m_iCapacity = 0;
+  m_iStreamStride = 0;
+}
+
+VisParticleSoAStorage_cl::~VisParticleSoAStorage_cl()
+{
+  Free();
+}
+
+void VisParticleSoAStorage_cl::Allocate(int iCapacity)
+{
+  Free();
+  if (iCapacity<=0)
+    return;
+
+  m_iCapacity = iCapacity;
+  m_iStreamStride = (iCapacity + PARTICLE_SIMD_WIDTH-1) & ~(PARTICLE_SIMD_WIDTH-1);
+  const size_t iBytes = sizeof(float) * STREAM_COUNT * m_iStreamStride;
+  m_pData = (float *)vMemAlignedAlloc(iBytes, PARTICLE_SOA_ALIGNMENT);
+  memset(m_pData, 0, iBytes); // the kernel also processes the padding
+}
+
+void VisParticleSoAStorage_cl::Free()
+{
+  V_SAFE_FREE_ALIGNED(m_pData);
+  m_iCapacity = 0;
+  m_iStreamStride = 0;
+}
+
+void VisParticleSoAStorage_cl::Gather(const ParticleExt_t *pParticles, int iFirst, int iCount)
+{
+  VASSERT(iFirst>=0 && iFirst+iCount<=m_iCapacity);
+  const ParticleExt_t *p = &pParticles[iFirst];
+  for (int i=iFirst;i<iFirst+iCount;i++,p++) if (p->valid)
+    GatherParticle(p,i);
+}
+
+void VisParticleSoAStorage_cl::Integrate(int iFirst, int iCount, const ParticleSoAFrameConstants_t &constants)
+{
+  VASSERT((iFirst % PARTICLE_SIMD_WIDTH)==0);
+  VASSERT(iFirst>=0 && iFirst+iCount<=m_iCapacity);
+
+  float *pLifeTime = GetStream(STREAM_LIFETIME);
+  float *pLifeTimeInc = GetStream(STREAM_LIFETIMEINC);
+  float *pPosX = GetStream(STREAM_POSX);
+  float *pPosY = GetStream(STREAM_POSY);
+  float *pPosZ = GetStream(STREAM_POSZ);
+  float *pVelX = GetStream(STREAM_VELX);
+  float *pVelY = GetStream(STREAM_VELY);
+  float *pVelZ = GetStream(STREAM_VELZ);
+  float *pInertia = GetStream(STREAM_INERTIA);
+  float *pSize = GetStream(STREAM_SIZE);
+  float *pSizeGrowth = GetStream(STREAM_SIZEGROWTH);
+
+  const ParticleReal4 dt = PARTICLE4_SET(constants.m_fDeltaTime);
+  const ParticleReal4 friction = PARTICLE4_SET(constants.m_fFriction);
+  const ParticleReal4 windX = PARTICLE4_SET(constants.m_vWind.x);
+  const ParticleReal4 windY = PARTICLE4_SET(constants.m_vWind.y);
+  const ParticleReal4 windZ = PARTICLE4_SET(constants.m_vWind.z);
+  const ParticleReal4 windNoInertiaX = PARTICLE4_SET(constants.m_vWindNoInertia.x);
+  const ParticleReal4 windNoInertiaY = PARTICLE4_SET(constants.m_vWindNoInertia.y);
+  const ParticleReal4 windNoInertiaZ = PARTICLE4_SET(constants.m_vWindNoInertia.z);
+  const ParticleReal4 moveX = PARTICLE4_SET(constants.m_vGroupMoveDelta.x);
+  const ParticleReal4 moveY = PARTICLE4_SET(constants.m_vGroupMoveDelta.y);
+  const ParticleReal4 moveZ = PARTICLE4_SET(constants.m_vGroupMoveDelta.z);
+  const ParticleReal4 localStart = PARTICLE4_SET(constants.m_fLocalFactorStart);
+  const ParticleReal4 localDiff = PARTICLE4_SET(constants.m_fLocalFactorDiff);
+
+  // the streams are padded, so the last block can safely be processed in full
+  const int iEnd = iFirst+iCount;
+  for (int i=iFirst;i<iEnd;i+=PARTICLE_SIMD_WIDTH)
+  {
+    // lifetime
+    ParticleReal4 life = PARTICLE4_MADD(PARTICLE4_LOAD(&pLifeTimeInc[i]), dt, PARTICLE4_LOAD(&pLifeTime[i]));
+    if (constants.m_bRepeatLifetime)
+      life = PARTICLE4_FRAC(life);
+    PARTICLE4_STORE(&pLifeTime[i], life);
+
+    // position
+    ParticleReal4 velX = PARTICLE4_LOAD(&pVelX[i]);
+    ParticleReal4 velY = PARTICLE4_LOAD(&pVelY[i]);
+    ParticleReal4 velZ = PARTICLE4_LOAD(&pVelZ[i]);
+    ParticleReal4 posX = PARTICLE4_MADD(velX, dt, PARTICLE4_LOAD(&pPosX[i]));
+    ParticleReal4 posY = PARTICLE4_MADD(velY, dt, PARTICLE4_LOAD(&pPosY[i]));
+    ParticleReal4 posZ = PARTICLE4_MADD(velZ, dt, PARTICLE4_LOAD(&pPosZ[i]));
+    if (constants.m_bMovesWithEmitter)
+    {
+      ParticleReal4 weight = PARTICLE4_MADD(localDiff, life, localStart);
+      posX = PARTICLE4_MADD(moveX, weight, posX);
+      posY = PARTICLE4_MADD(moveY, weight, posY);
+      posZ = PARTICLE4_MADD(moveZ, weight, posZ);
+    }
+    PARTICLE4_STORE(&pPosX[i], posX);
+    PARTICLE4_STORE(&pPosY[i], posY);
+    PARTICLE4_STORE(&pPosZ[i], posZ);
+
+    // velocity
+    ParticleReal4 inertia = PARTICLE4_LOAD(&pInertia[i]);
+    velX = PARTICLE4_MUL(PARTICLE4_ADD(PARTICLE4_MADD(windX, inertia, velX), windNoInertiaX), friction);
+    velY = PARTICLE4_MUL(PARTICLE4_ADD(PARTICLE4_MADD(windY, inertia, velY), windNoInertiaY), friction);
+    velZ = PARTICLE4_MUL(PARTICLE4_ADD(PARTICLE4_MADD(windZ, inertia, velZ), windNoInertiaZ), friction);
+    PARTICLE4_STORE(&pVelX[i], velX);
+    PARTICLE4_STORE(&pVelY[i], velY);
+    PARTICLE4_STORE(&pVelZ[i], velZ);
+
+    // size (the size curve lookup is performed by the owner group)
+    if (constants.m_bIntegrateSize)
+      PARTICLE4_STORE(&pSize[i], PARTICLE4_MADD(PARTICLE4_LOAD(&pSizeGrowth[i]), dt, PARTICLE4_LOAD(&pSize[i])));
+  }
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
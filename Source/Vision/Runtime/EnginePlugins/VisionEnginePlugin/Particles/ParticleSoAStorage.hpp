@@ -0,0 +1,149 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file ParticleSoAStorage.hpp
+
+#ifndef PARTICLESOASTORAGE_HPP_INCLUDED
+#define PARTICLESOASTORAGE_HPP_INCLUDED
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleModule.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleSIMD.hpp>
+
+// alignment of the SoA streams in bytes
+#define PARTICLE_SOA_ALIGNMENT    16
+
+struct ParticleExt_t;
+
+
+///\brief
+///Per-frame simulation constants that are passed to VisParticleSoAStorage_cl::Integrate
+struct ParticleSoAFrameConstants_t
+{
+  float m_fDeltaTime;             ///< scaled simulation time delta
+  float m_fFriction;              ///< friction multiplier in this frame
+  hkvVec3 m_vWind;                ///< wind/gravity delta that is scaled by the particle's inertia
+  hkvVec3 m_vWindNoInertia;       ///< wind/gravity delta that is not scaled by the inertia
+  hkvVec3 m_vGroupMoveDelta;      ///< emitter movement in this frame
+  float m_fLocalFactorStart;      ///< amount of emitter movement applied at lifetime start
+  float m_fLocalFactorDiff;       ///< difference of the emitter movement factor between lifetime start and end
+  bool m_bMovesWithEmitter;       ///< if true, m_vGroupMoveDelta is applied
+  bool m_bRepeatLifetime;         ///< if true, the lifetime counter wraps around at 1.0
+  bool m_bIntegrateSize;          ///< if true, the size grows linearly (no size curve)
+};
+
+
+///\brief
+///Structure-of-arrays copy of the simulation state of a particle group
+///
+///The integration kernel of this class updates lifetime, position, velocity and size of 
+///PARTICLE_SIMD_WIDTH particles per instruction. The ParticleExt_t array of the owner group remains
+///the authoritative storage for the renderer, the emitter and the constraints: new particles are gathered
+///into the streams via GatherParticle, and the simulated values are written back by the owner group
+///after integration.
+///
+///\see
+///  ParticleGroupBase_cl::SetUseSoAStorage
+class VisParticleSoAStorage_cl
+{
+public:
+
+  ///\brief
+  ///Indices of the individual float streams
+  enum Stream_e
+  {
+    STREAM_LIFETIME = 0,
+    STREAM_LIFETIMEINC,
+    STREAM_POSX,
+    STREAM_POSY,
+    STREAM_POSZ,
+    STREAM_VELX,
+    STREAM_VELY,
+    STREAM_VELZ,
+    STREAM_INERTIA,
+    STREAM_SIZE,
+    STREAM_SIZEGROWTH,
+
+    STREAM_COUNT
+  };
+
+  ///\brief
+  ///Constructor
+  PARTICLE_IMPEXP VisParticleSoAStorage_cl();
+
+  ///\brief
+  ///Destructor
+  PARTICLE_IMPEXP ~VisParticleSoAStorage_cl();
+
+  ///\brief
+  ///Allocates all streams for the passed number of particles. Existing data is discarded
+  PARTICLE_IMPEXP void Allocate(int iCapacity);
+
+  ///\brief
+  ///Releases all streams
+  PARTICLE_IMPEXP void Free();
+
+  ///\brief
+  ///Indicates whether the streams have been allocated
+  inline bool IsAllocated() const {return m_pData!=NULL;}
+
+  ///\brief
+  ///Returns the number of particles that fit into the streams
+  inline int GetCapacity() const {return m_iCapacity;}
+
+  ///\brief
+  ///Returns the pointer to the passed stream. The stream is aligned to PARTICLE_SOA_ALIGNMENT bytes
+  inline float *GetStream(Stream_e eStream) const
+  {
+    VASSERT(m_pData!=NULL);
+    return &m_pData[eStream*m_iStreamStride];
+  }
+
+  ///\brief
+  ///Copies the simulation state of a range of particles from the array of structures into the streams
+  PARTICLE_IMPEXP void Gather(const ParticleExt_t *pParticles, int iFirst, int iCount);
+
+  ///\brief
+  ///Copies the simulation state of a single particle into the streams
+  inline void GatherParticle(const ParticleExt_t *pParticle, int iIndex);
+
+  ///\brief
+  ///Integrates lifetime, position, velocity and (optionally) size of a range of particles
+  ///
+  ///\param iFirst
+  ///  First particle index. Must be a multiple of PARTICLE_SIMD_WIDTH
+  ///
+  ///\param iCount
+  ///  Number of particles. Particles that are not alive are integrated as well, their values are just not used.
+  ///  The last block is always processed in full, i.e. the range is extended to the next multiple of PARTICLE_SIMD_WIDTH
+  ///
+  ///\param constants
+  ///  Per-frame simulation constants
+  PARTICLE_IMPEXP void Integrate(int iFirst, int iCount, const ParticleSoAFrameConstants_t &constants);
+
+private:
+  float *m_pData;           ///< one aligned block holding all streams
+  int m_iCapacity;          ///< number of particles
+  int m_iStreamStride;      ///< distance between two streams in floats (capacity rounded up to PARTICLE_SIMD_WIDTH)
+};
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
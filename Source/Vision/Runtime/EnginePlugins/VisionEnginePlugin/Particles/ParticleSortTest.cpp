@@ -0,0 +1,121 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Particles/ParticleGroupBase.hpp>
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+
+///////////////////////////////////////////////////////////////////////////////////
+// ParticleSortTest
+///////////////////////////////////////////////////////////////////////////////////
+
+// Sorts particle index lists of 1k, 16k and 64k entries with ParticleGroupBase_cl::SortParticleIndexList,
+// once with qsort and once with the radix sort. The first subtest uses random keys (e.g. the first frame
+// of a layer), the second one the sorted list of the previous frame with slightly moved keys (a moving
+// camera), which the radix sort handles with its bounded insertion sort. Both sorts have to produce the
+// same key order. The time per sort is printed to the test log.
+class ParticleSortTest : public VTestClass
+{
+public:
+  virtual void DescribeTest() HKV_OVERRIDE
+  {
+    SetTestName("Particle depth sort");
+    AddSubTest("Random keys");
+    AddSubTest("Previous frame order with moved keys");
+  }
+
+  virtual VBool Init() HKV_OVERRIDE {return TRUE;}
+  virtual void InitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool RunSubTest(int iTest) HKV_OVERRIDE;
+  virtual void DeInitSubTest(int iTest) HKV_OVERRIDE {}
+  virtual VBool DeInit() HKV_OVERRIDE {return TRUE;}
+
+  V_DECLARE_DYNCREATE(ParticleSortTest);
+};
+
+V_IMPLEMENT_DYNCREATE(ParticleSortTest, VTestClass, &g_VisionEngineModule);
+
+
+static bool IsSortedDescending(const ParticleSort_t *pList, int iCount)
+{
+  for (int i=1;i<iCount;i++)
+    if (pList[i].sortkey>pList[i-1].sortkey)
+      return false;
+  return true;
+}
+
+static bool HaveSameKeys(const ParticleSort_t *pList, const ParticleSort_t *pOther, int iCount)
+{
+  for (int i=0;i<iCount;i++)
+    if (pList[i].sortkey!=pOther[i].sortkey)
+      return false;
+  return true;
+}
+
+VBool ParticleSortTest::RunSubTest(int iTest)
+{
+  const int iSizes[] = {1024, 16384, 65536};
+  VRandom randGen(1234);
+
+  for (int iSize=0;iSize<V_ARRAY_SIZE(iSizes);iSize++)
+  {
+    const int iCount = iSizes[iSize];
+    const int iRuns = hkvMath::Max(4*1024*1024/iCount, 4); // same number of sorted elements for all sizes
+    DynArray_cl<ParticleSort_t> input(iCount), qsorted(iCount), radixSorted(iCount), temp(iCount);
+    ParticleSort_t *pSorted[2] = {qsorted.GetDataPtr(), radixSorted.GetDataPtr()};
+
+    ParticleSort_t *pInput = input.GetDataPtr();
+    for (int i=0;i<iCount;i++)
+    {
+      pInput[i].index = (unsigned short)i;
+      pInput[i].sortkey = (unsigned short)(randGen.GetInt() & 0xffff);
+    }
+    if (iTest==1)
+    {
+      // the random list sorted, with every key moved by -2..2 units
+      ParticleGroupBase_cl::SortParticleIndexList(pInput, temp.GetDataPtr(), iCount, true);
+      for (int i=0;i<iCount;i++)
+        pInput[i].sortkey = (unsigned short)hkvMath::clamp((int)pInput[i].sortkey + (int)(randGen.GetInt()%5) - 2, 0, 65535);
+    }
+
+    double fTimeMS[2];
+    for (int iRadix=0;iRadix<2;iRadix++)
+    {
+      ParticleSort_t *pList = pSorted[iRadix];
+      const uint64 iStartTime = VGLGetTimer();
+      for (int iRun=0;iRun<iRuns;iRun++)
+      {
+        memcpy(pList, pInput, iCount*sizeof(ParticleSort_t));
+        ParticleGroupBase_cl::SortParticleIndexList(pList, temp.GetDataPtr(), iCount, iRadix==1);
+      }
+      fTimeMS[iRadix] = (double)(VGLGetTimer()-iStartTime)*1000.0/((double)VGLGetTimerResolution()*(double)iRuns);
+      VTESTM(IsSortedDescending(pList, iCount), "%s does not sort %i particles by descending key", (iRadix==1) ? "Radix sort" : "qsort", iCount);
+    }
+    VTESTM(HaveSameKeys(pSorted[0], pSorted[1], iCount), "Radix sort and qsort differ for %i particles", iCount);
+
+    Printf("%i particles: qsort %.4f ms, radix sort %.4f ms", iCount, fTimeMS[0], fTimeMS[1]);
+  }
+
+  return FALSE;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -144,7 +144,12 @@ VProjectedWallmark::VProjectedWallmark() :
   m_fInitialAlpha = (float)m_iColor.a;
   m_eTransp = VIS_TRANSP_ADDITIVE;
   m_fConeFactorX = m_fConeFactorY = 1.f;
-  m_bPrimDirty = true;
+  m_bPrimDirty = false;
+  m_iCreationIndex = manager.m_iProjectedWallmarkCounter++;
+  m_pGridCell = NULL;
+  m_iGridCellIndex = -1;
+  m_bGridUpdatePending = false;
+  InvalidatePrimitives();
   m_bFromFile = false;
   m_fDepth = 50.f;
   m_bLightmapped = false;
@@ -182,7 +187,12 @@ VProjectedWallmark::VProjectedWallmark(
   m_fLifeTime = fLifeTime + fFadeOutTime;
   m_fFadeOutTime = fFadeOutTime;
 
-  m_bPrimDirty = true;
+  m_bPrimDirty = false;
+  m_iCreationIndex = manager.m_iProjectedWallmarkCounter++;
+  m_pGridCell = NULL;
+  m_iGridCellIndex = -1;
+  m_bGridUpdatePending = false;
+  InvalidatePrimitives();
   m_bFromFile = false;
   m_vOrigin = origin;
   m_vDestPos = destpos;
@@ -220,6 +230,12 @@ void VProjectedWallmark::DisposeObject()
 {
   VisTypedEngineObject_cl::DisposeObject();
   VWallmarkManager &manager(VWallmarkManager::GlobalManager());
+  manager.RemoveFromGrid(this);
+  if (m_bGridUpdatePending)
+  {
+    m_bGridUpdatePending = false;
+    manager.m_PendingProjectedWallmarks.SafeRemove(this);
+  }
   manager.m_AllProjectedWallmarks.SafeRemove(this);
   manager.m_FadingProjectedWallmarks.SafeRemove(this);
   if (manager.m_AllProjectedWallmarks.Count()==0)
@@ -293,6 +309,19 @@ void VProjectedWallmark::PrepareForRendering()
 
 
 
+void VProjectedWallmark::InvalidatePrimitives()
+{
+  m_bPrimDirty = true;
+
+  // the manager updates the bounding box and the grid cell before rendering
+  if (!m_bGridUpdatePending)
+  {
+    m_bGridUpdatePending = true;
+    VWallmarkManager::GlobalManager().m_PendingProjectedWallmarks.Add(this);
+  }
+}
+
+
 VTextureObject* VProjectedWallmark::SetTexture(const char *szFilename)
 {
   VTextureObject *pTex = Vision::TextureManager.Load2DTexture(szFilename);
@@ -363,7 +392,7 @@ void VProjectedWallmark::SetPosition(const hkvVec3& vPos)
   float fLen = GetLength();
   m_vOrigin = vPos;
   SetLength(fLen);
-  m_bPrimDirty = true;
+  InvalidatePrimitives();
 }
 
 void VProjectedWallmark::SetOrientation(const hkvMat3 &vMat)
@@ -375,7 +404,7 @@ void VProjectedWallmark::SetOrientation(const hkvMat3 &vMat)
   m_vRight = t2; 
   m_vUpDir = t3;;
   SetLength(fLen);
-  m_bPrimDirty = true;
+  InvalidatePrimitives();
 }
 
 void VProjectedWallmark::SetConeAngles(float fAngleX, float fAngleY)
@@ -384,7 +413,7 @@ void VProjectedWallmark::SetConeAngles(float fAngleX, float fAngleY)
   m_fConeFactorX = 0.5f / hkvMath::tanDeg (fAngleX / 2.0f);
   VASSERT(fAngleY>0.f && fAngleY<180.f);
   m_fConeFactorY = 0.5f / hkvMath::tanDeg (fAngleY / 2.0f);
-  m_bPrimDirty = true;
+  InvalidatePrimitives();
 }
 
 void VProjectedWallmark::SetRadius(float fRadius)
@@ -395,13 +424,13 @@ void VProjectedWallmark::SetRadius(float fRadius)
 
   m_fConeFactorX = fConeFactor;
   m_fConeFactorY = fConeFactor;
-  m_bPrimDirty = true;
+  InvalidatePrimitives();
 }
 
 void VProjectedWallmark::SetLength(float fLen)
 {
   m_vDestPos = m_vOrigin + m_vDirection * fLen;
-  m_bPrimDirty = true;
+  InvalidatePrimitives();
 }
 
 
@@ -414,7 +443,7 @@ float VProjectedWallmark::GetLength() const
 void VProjectedWallmark::SetFadeOutRange(float fDist)
 {
   m_fDepth=fDist;
-  m_bPrimDirty=true;
+  InvalidatePrimitives();
 }
 
 void VProjectedWallmark::Serialize( VArchive &ar )
@@ -450,7 +479,7 @@ void VProjectedWallmark::Serialize( VArchive &ar )
     if (iVersion>=PROJECTOR_VERSION_7)
       ar >> fxConfig; // version 7
 
-    m_bPrimDirty=true; // recalc primitive list
+    InvalidatePrimitives(); // recalc primitive list
 
     if (m_iGeometryTypeFilter==-1)
       m_iGeometryTypeFilter = PROJECTOR_AFFECTS_DEFAULT; // entities are not default
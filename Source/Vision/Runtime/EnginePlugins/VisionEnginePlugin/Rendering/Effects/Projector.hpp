@@ -12,6 +12,7 @@
 #define VPROJECTOR_HPP_INCLUDED
 
 class VProjectedWallmark;
+class VProjectedWallmarkCell;
 typedef VProjectedWallmark VisProjectedWallmark_cl;
 
 
@@ -133,7 +134,7 @@ public:
     if (m_iGeometryTypeFilter==iMask)
       return;
     m_iGeometryTypeFilter = iMask;
-    m_bPrimDirty = true;
+    InvalidatePrimitives();
   }
 
   /// \brief
@@ -155,6 +156,10 @@ public:
   ///   Has to be called before rendering to ensure the primitives are valid. Used internally.
   EFFECTS_IMPEXP void PrepareForRendering();
 
+  /// \brief
+  ///   Marks the bounding box and the affected primitives as outdated, so they are updated before the next rendering. Used internally.
+  EFFECTS_IMPEXP void InvalidatePrimitives();
+
   /// \brief
   ///   Fills the passed plane references with the projection planes (q is normalized, a and b are
   ///   scaled according to cone angles). Used internally.
@@ -195,7 +200,7 @@ public:
   inline void SetInfluenceBitmask(unsigned int iMask)
   {
     m_InfluenceBitmask = iMask;
-    m_bPrimDirty = true;
+    InvalidatePrimitives();
   }
 
   /// \brief
@@ -418,6 +423,11 @@ protected: ///< data
   int m_iGeometryTypeFilter;        ///< bits in this member are of type 1<<VisStaticGeometryType_e
   float m_fFarClipDistance;
 
+  unsigned int m_iCreationIndex;    ///< rendering order of the wallmarks
+  VProjectedWallmarkCell *m_pGridCell; ///< grid cell of the wallmark manager that contains this wallmark
+  int m_iGridCellIndex;             ///< index inside m_pGridCell
+  bool m_bGridUpdatePending;        ///< wallmark is in the manager's list of wallmarks to update
+
   VCompiledEffectPtr m_spCustomEffect;
   VCompiledTechniquePtr m_spCustomTechnique[STATIC_GEOMETRY_TYPE_FIRSTCUSTOM]; ///< array for every engine type
 };
@@ -75,6 +75,8 @@ VParticleWallmarkGroup::VParticleWallmarkGroup(int iCount, VTextureObject *pText
   SetUseNormals(true);
   SetUseDistortion(true);
   SetParticleCenter(0.5f,0.5f); // centered
+  m_iCellKey = 0;
+  m_pNextInBucket = NULL;
 
   if (m_bApplyDeferredLighting)
   {
@@ -95,6 +97,13 @@ VParticleWallmarkGroup::VParticleWallmarkGroup(int iCount, VTextureObject *pText
 }
 
 
+VParticleWallmarkGroup::~VParticleWallmarkGroup()
+{
+  // the manager's group index must not keep a pointer to this group
+  VWallmarkManager::g_WallmarkManager.m_iGroupRevision++;
+}
+
+
 VParticleWallmark* VParticleWallmarkGroup::TryGetFreeParticle()
 {
   if (!m_bHasFreeParticles) // early out
@@ -219,6 +228,12 @@ VWallmarkManager::VWallmarkManager()
   , m_iPrimaryOpaquePassRenderOrder(VRH_PRE_OCCLUSION_TESTS)
   , m_iSecondaryOpaquePassRenderOrder(0)
   , m_iTransparentPassRenderOrder(VRH_POST_OCCLUSION_TESTS)
+  , m_iGroupRevision(0)
+  , m_iIndexedGroupRevision(0)
+  , m_ProjectedWallmarkCells(0, NULL)
+  , m_iProjectedWallmarkCellCount(0)
+  , m_VisibleProjectedWallmarks(0, NULL)
+  , m_iProjectedWallmarkCounter(0)
 {
   m_eProjectedWMPassTypes = VPT_Undefined;
   m_iGeomRefHashMask = 0;
@@ -263,6 +278,10 @@ void VWallmarkManager::OneTimeDeInit()
   m_bSimulationCallbackRegistered = m_bRenderCallbackRegistered = m_bUnloadWorldCallbackRegistered = false;
 
   Vision::Callbacks.OnReassignShaders -= this;
+
+  ClearProjectedWallmarkGrid();
+  m_ProjectedWallmarkCells.Reset();
+  m_VisibleProjectedWallmarks.Reset();
 }
 
 
@@ -280,7 +299,7 @@ void VWallmarkManager::OnZoneLoaded(VisZoneResource_cl *pZone)
   {
     VProjectedWallmark *pProjWallmark = m_AllProjectedWallmarks.GetAt(i);
     if (zoneBox.overlaps(pProjWallmark->GetBoundingBox()))
-      pProjWallmark->m_bPrimDirty = true;
+      pProjWallmark->InvalidatePrimitives();
   }
 }
 
@@ -406,6 +425,9 @@ void VWallmarkManager::OnHandleCallback(IVisCallbackDataObject_cl *pData)
     DeleteWallmarkShaders();
 
     m_AllWallmarkGroups.Clear();
+    m_WallmarkGroupIndex.Reset();
+    m_iIndexedGroupRevision = m_iGroupRevision;
+    ClearProjectedWallmarkGrid();
     m_AllProjectedWallmarks.Clear();
     m_FadingProjectedWallmarks.Clear();
     m_iGeomRefHashMask = 0;
@@ -415,31 +437,45 @@ void VWallmarkManager::OnHandleCallback(IVisCallbackDataObject_cl *pData)
 }
 
 
-VParticleWallmark* VWallmarkManager::CreateParticle(VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting, const hkvVec3& vCenter, bool bCheckBest)
+void VWallmarkManager::AddToGroupIndex(VParticleWallmarkGroup *pGroup)
 {
-  EnsureSimulationCallbackRegistered();
+  const __int64 iKey = GetGroupIndexKey(pGroup->GetTextureObject(), pGroup->GetTransparencyType(), pGroup->m_bApplyDeferredLighting, pGroup->m_iCellKey);
+  VParticleWallmarkGroup *pFirst = NULL;
+  m_WallmarkGroupIndex.Lookup(iKey, pFirst);
+  pGroup->m_pNextInBucket = pFirst;
+  m_WallmarkGroupIndex.SetAt(iKey, pGroup);
+}
+
+
+void VWallmarkManager::RebuildGroupIndex()
+{
+  // the group collection may have been modified from outside, or a group has been deleted
+  m_WallmarkGroupIndex.Reset();
+  m_iIndexedGroupRevision = m_iGroupRevision;
   const int iCount = m_AllWallmarkGroups.Count();
+  for (int i=0;i<iCount;i++) // newest groups first, same as in CreateParticle
+    AddToGroupIndex(m_AllWallmarkGroups.GetAt(i));
+}
+
+
+VParticleWallmark* VWallmarkManager::CreateParticle(VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting, const hkvVec3& vCenter)
+{
+  EnsureSimulationCallbackRegistered();
+  if (m_iIndexedGroupRevision!=m_iGroupRevision)
+    RebuildGroupIndex();
+
+  // only groups of the grid cell that contains the wallmark are used, which keeps the group bounding boxes small
+  const __int64 iCellKey = GetCellKey(vCenter);
+  const __int64 iKey = GetGroupIndexKey(pTexture, eBlending, bApplyDeferredLighting, iCellKey);
   int iNewInitCount = INITIAL_WALLMARKS_PERGROUP; // default count
-  VParticleWallmarkGroup *pBestGroup = NULL;
-  float fBestVal = FLT_MAX;
 
-  for (int i=0;i<iCount;i++)
+  VParticleWallmarkGroup *pFirst = NULL;
+  m_WallmarkGroupIndex.Lookup(iKey, pFirst);
+  for (VParticleWallmarkGroup *pGroup = pFirst; pGroup!=NULL; pGroup = pGroup->m_pNextInBucket)
   {
-    VParticleWallmarkGroup *pGroup = m_AllWallmarkGroups.GetAt(i);
-    if (pGroup->GetTextureObject()!=pTexture || pGroup->GetTransparencyType()!=eBlending || bApplyDeferredLighting!=pGroup->m_bApplyDeferredLighting)
+    if (pGroup->m_iCellKey!=iCellKey || pGroup->GetTextureObject()!=pTexture || pGroup->GetTransparencyType()!=eBlending || bApplyDeferredLighting!=pGroup->m_bApplyDeferredLighting)
       continue;
-    if (bCheckBest)
-    {
-      if (!pGroup->HasFreeParticles())
-        continue;
-      hkvVec3 vDiff = pGroup->m_BoundingBox.getCenter() - vCenter; // prefer boxes that contain the particle
-      float fThisVal = vDiff.getLengthSquared ();
-      if (fThisVal<fBestVal || pBestGroup==NULL)
-      {
-        fBestVal = fThisVal;
-        pBestGroup = pGroup;
-      }
-    } else
+    if (pGroup->HasFreeParticles())
     {
       VParticleWallmark* pParticle = pGroup->TryGetFreeParticle();
       if (pParticle)
@@ -448,16 +484,10 @@ VParticleWallmark* VWallmarkManager::CreateParticle(VTextureObject *pTexture, VI
     iNewInitCount *= 2; // previous group is correct type, but full, so next one should be larger
   }
 
-  if (pBestGroup)
-  {
-    VParticleWallmark* pParticle = pBestGroup->TryGetFreeParticle();
-    if (pParticle)
-      return pParticle;
-    return CreateParticle(pTexture,eBlending,bApplyDeferredLighting,vCenter,false); // fall back
-  }
-    
   VParticleWallmarkGroup *pNewGroup = new VParticleWallmarkGroup(hkvMath::Min(iNewInitCount,16*1024), pTexture, eBlending, bApplyDeferredLighting);
+  pNewGroup->m_iCellKey = iCellKey;
   m_AllWallmarkGroups.Add(pNewGroup);
+  AddToGroupIndex(pNewGroup);
   return pNewGroup->TryGetFreeParticle(); // must be !=NULL
 }
 
@@ -468,7 +498,7 @@ VParticleWallmark* VWallmarkManager::CreateWallmark(
     VColorRef color, float fLifetime, float fFadeOutTime, bool bApplyDeferredLighting)
 {
   VISION_PROFILE_FUNCTION(PROFILING_WALLMARK_CREATION);
-  VParticleWallmark* p = CreateParticle(pTexture,eBlending,bApplyDeferredLighting,vCenter,true);
+  VParticleWallmark* p = CreateParticle(pTexture,eBlending,bApplyDeferredLighting,vCenter);
   p->pos[0] = vCenter.x;
   p->pos[1] = vCenter.y;
   p->pos[2] = vCenter.z;
@@ -667,13 +697,46 @@ void VWallmarkManager::RenderProjectedWallmarks(VPassType_e ePassType)
   unsigned int iContextFilter = pContext->GetRenderFilterMask();
   const VisFrustum_cl *pFrustum = pVisCollector->GetBaseFrustum();
 
-  int i;
-  for (i=0;i<iWallmarkCount;i++)
+  UpdateProjectedWallmarkGrid();
+
+  // gather the wallmarks of all grid cells that overlap the frustum
+  const int iAllPlanes = (pFrustum!=NULL) ? (1<<pFrustum->GetNumPlanes())-1 : 0;
+  int iVisibleCount = 0;
+  for (int c=0;c<m_iProjectedWallmarkCellCount;c++)
   {
-    VProjectedWallmark *pProjWallmark = m_AllProjectedWallmarks.GetAt(i);
-    if ((pProjWallmark->GetVisibleBitmask() & iContextFilter)==0 || (ePassType & pProjWallmark->m_ePassType) == 0)
+    const VProjectedWallmarkCell *pCell = m_ProjectedWallmarkCells.GetDataPtr()[c];
+    if (pCell->m_iCount==0)
       continue;
-    pProjWallmark->PrepareForRendering();
+    int iPlaneFlags = iAllPlanes;
+    if (iPlaneFlags!=0 && pFrustum->ClassifyPlanes(pCell->m_Box, iPlaneFlags)==VIS_CLIPPINGRESULT_ALLCLIPPED)
+      continue;
+
+    VProjectedWallmark * const *ppWallmarks = pCell->m_Wallmarks.GetDataPtr();
+    for (int j=0;j<pCell->m_iCount;j++)
+    {
+      VProjectedWallmark *pProjWallmark = ppWallmarks[j];
+      if ((pProjWallmark->GetVisibleBitmask() & iContextFilter)==0 || (ePassType & pProjWallmark->m_ePassType) == 0)
+        continue;
+
+      // clip against its bounding box (primitive visibility might overestimate visible parts).
+      // Only the frustum planes that intersect the cell have to be tested.
+      const hkvAlignedBBox &bbox = pProjWallmark->GetBoundingBox();
+      if (pProjWallmark->m_fFarClipDistance>0.f && pProjWallmark->m_fFarClipDistance<bbox.getDistanceTo(vLODPos))
+        continue;
+      if (iPlaneFlags!=0 && !pFrustum->Overlaps(bbox, iPlaneFlags))
+        continue;
+      m_VisibleProjectedWallmarks[iVisibleCount++] = pProjWallmark;
+    }
+  }
+
+  // render in creation order (same as the order of m_AllProjectedWallmarks), so overlapping wallmarks blend as before
+  if (iVisibleCount>1)
+    qsort(m_VisibleProjectedWallmarks.GetDataPtr(), iVisibleCount, sizeof(VProjectedWallmark *), CompareCreationIndex);
+
+  for (int i=0;i<iVisibleCount;i++)
+  {
+    VProjectedWallmark *pProjWallmark = m_VisibleProjectedWallmarks.GetDataPtr()[i];
+    const hkvAlignedBBox &bbox = pProjWallmark->GetBoundingBox();
     const VisStaticGeometryInstanceCollection_cl &wmGiList = pProjWallmark->GetStaticGeometryCollection();  
 
 #ifdef HK_DEBUG
@@ -685,13 +748,6 @@ void VWallmarkManager::RenderProjectedWallmarks(VPassType_e ePassType)
     }
 #endif
 
-    // clip against its bounding box (primitive visibility might overestimate visible parts)
-    const hkvAlignedBBox &bbox = pProjWallmark->GetBoundingBox();
-    if (pProjWallmark->m_fFarClipDistance>0.f && pProjWallmark->m_fFarClipDistance<bbox.getDistanceTo(vLODPos))
-      continue;
-    if (pFrustum && !pFrustum->Overlaps(bbox))
-      continue;
-
     const int iGeomFilter = pProjWallmark->GetGeometryTypeFilterMask();
     if (iGeomFilter&PROJECTOR_AFFECTS_STATICMESHES)
     {
@@ -748,6 +804,107 @@ void VWallmarkManager::RenderProjectedWallmarks(VPassType_e ePassType)
 }
 
 
+void VWallmarkManager::UpdateProjectedWallmarkGrid()
+{
+  // update bounding boxes and primitives of modified wallmarks and move them to their new cell
+  const int iPendingCount = m_PendingProjectedWallmarks.Count();
+  for (int i=0;i<iPendingCount;i++)
+  {
+    VProjectedWallmark *pWallmark = m_PendingProjectedWallmarks.GetAt(i);
+    pWallmark->m_bGridUpdatePending = false;
+    pWallmark->PrepareForRendering();
+    RemoveFromGrid(pWallmark);
+    AddToGrid(pWallmark);
+  }
+  if (iPendingCount>0)
+    m_PendingProjectedWallmarks.Clear();
+
+  // shrink the boxes of cells that wallmarks have been removed from
+  for (int c=0;c<m_iProjectedWallmarkCellCount;c++)
+  {
+    VProjectedWallmarkCell *pCell = m_ProjectedWallmarkCells.GetDataPtr()[c];
+    if (!pCell->m_bBoxDirty)
+      continue;
+    pCell->m_bBoxDirty = false;
+    pCell->m_Box.setInvalid();
+    for (int j=0;j<pCell->m_iCount;j++)
+      pCell->m_Box.expandToInclude(pCell->m_Wallmarks.GetDataPtr()[j]->GetBoundingBox());
+  }
+}
+
+
+void VWallmarkManager::AddToGrid(VProjectedWallmark *pWallmark)
+{
+  VASSERT(pWallmark->m_pGridCell==NULL);
+  const hkvAlignedBBox &bbox = pWallmark->GetBoundingBox();
+  const __int64 iKey = GetCellKey(bbox.isValid() ? bbox.getCenter() : pWallmark->m_vDestPos);
+
+  VProjectedWallmarkCell *pCell = NULL;
+  if (!m_ProjectedWallmarkCellMap.Lookup(iKey, pCell))
+  {
+    pCell = new VProjectedWallmarkCell();
+    m_ProjectedWallmarkCellMap.SetAt(iKey, pCell);
+    m_ProjectedWallmarkCells[m_iProjectedWallmarkCellCount++] = pCell;
+  }
+
+  if (pCell->m_iCount==0)
+    pCell->m_Box = bbox;
+  else
+    pCell->m_Box.expandToInclude(bbox);
+  pWallmark->m_pGridCell = pCell;
+  pWallmark->m_iGridCellIndex = pCell->m_iCount;
+  pCell->m_Wallmarks[pCell->m_iCount++] = pWallmark;
+}
+
+
+void VWallmarkManager::RemoveFromGrid(VProjectedWallmark *pWallmark)
+{
+  VProjectedWallmarkCell *pCell = pWallmark->m_pGridCell;
+  if (pCell==NULL)
+    return;
+
+  // move the last wallmark of the cell into the free slot
+  const int iIndex = pWallmark->m_iGridCellIndex;
+  VASSERT(iIndex>=0 && iIndex<pCell->m_iCount && pCell->m_Wallmarks.GetDataPtr()[iIndex]==pWallmark);
+  VProjectedWallmark *pLast = pCell->m_Wallmarks.GetDataPtr()[--pCell->m_iCount];
+  pCell->m_Wallmarks.GetDataPtr()[iIndex] = pLast;
+  pLast->m_iGridCellIndex = iIndex;
+  pCell->m_bBoxDirty = true;
+
+  pWallmark->m_pGridCell = NULL;
+  pWallmark->m_iGridCellIndex = -1;
+}
+
+
+void VWallmarkManager::ClearProjectedWallmarkGrid()
+{
+  const int iCount = m_AllProjectedWallmarks.Count();
+  for (int i=0;i<iCount;i++)
+  {
+    VProjectedWallmark *pWallmark = m_AllProjectedWallmarks.GetAt(i);
+    pWallmark->m_pGridCell = NULL;
+    pWallmark->m_iGridCellIndex = -1;
+    pWallmark->m_bGridUpdatePending = false;
+  }
+  m_PendingProjectedWallmarks.Clear();
+
+  for (int c=0;c<m_iProjectedWallmarkCellCount;c++)
+    V_SAFE_DELETE(m_ProjectedWallmarkCells.GetDataPtr()[c]);
+  m_iProjectedWallmarkCellCount = 0;
+  m_ProjectedWallmarkCellMap.Reset();
+}
+
+
+int VWallmarkManager::CompareCreationIndex(const void *pElem1, const void *pElem2)
+{
+  const unsigned int i1 = (*(const VProjectedWallmark **)pElem1)->m_iCreationIndex;
+  const unsigned int i2 = (*(const VProjectedWallmark **)pElem2)->m_iCreationIndex;
+  if (i1<i2) return -1;
+  if (i1>i2) return 1;
+  return 0;
+}
+
+
 VProjectedWallmark *VWallmarkManager::CreateProjectedWallmark(const hkvVec3& vDestPos, const hkvVec3& vOrigin, float radius, float depth, VTextureObject* pTexture, VIS_TransparencyType drawtype, VColorRef iColor, float rotation, float fLifeTime, float fFadeOutTime)
 {
   hkvVec3 dir = vDestPos-vOrigin;
@@ -793,6 +950,7 @@ VProjectedWallmark *VWallmarkManager::CreateProjectedWallmark(const hkvVec3& vDe
 
 VRefCountedCollection<VParticleWallmarkGroup>& VWallmarkManager::ParticleGroupInstances()
 {
+  m_iGroupRevision++; // the caller may add or remove groups
   return m_AllWallmarkGroups;
 }
 
@@ -94,12 +94,17 @@ private:
 #define MAX_WALLMARK_CACHE_SIZE     64
 #define INITIAL_WALLMARKS_PERGROUP  64
 
+/// \brief
+///   Cell size of the grids the wallmark manager uses to group particle wallmarks and to cull projected wallmarks
+#define WALLMARK_GRID_CELL_SIZE     2048.f
+
 /// \brief
 ///   Internal class that holds a collection of wallmark particles.
 class VParticleWallmarkGroup : public VisParticleGroup_cl
 {
 public:
   VParticleWallmarkGroup(int iCount, VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting);
+  virtual ~VParticleWallmarkGroup();
   VParticleWallmark* TryGetFreeParticle();
 
   void TickFunction(float dtime);
@@ -122,6 +127,25 @@ protected:
   short m_iCacheIndex[MAX_WALLMARK_CACHE_SIZE];
   hkvAlignedBBox m_BoundingBox;
   VisVisibilityObjectAABoxPtr m_spVisObj;
+
+  __int64 m_iCellKey;                       ///< grid cell of the wallmarks in this group, see VWallmarkManager::GetCellKey
+  VParticleWallmarkGroup *m_pNextInBucket;  ///< next group in the same bucket of the manager's group index
+};
+
+
+/// \brief
+///   Internal class: Cell of the grid that the wallmark manager uses to cull projected wallmarks
+///
+/// Each projected wallmark is stored in the cell that contains the center of its bounding box.
+class VProjectedWallmarkCell
+{
+public:
+  VProjectedWallmarkCell() : m_Wallmarks(0, NULL), m_iCount(0), m_bBoxDirty(false) {}
+
+  hkvAlignedBBox m_Box;                         ///< contains the bounding boxes of all wallmarks in the cell
+  DynArray_cl<VProjectedWallmark *> m_Wallmarks;
+  int m_iCount;
+  bool m_bBoxDirty;                             ///< wallmarks have been removed, so m_Box might be too large
 };
 
 
@@ -280,6 +304,9 @@ public:
 
   /// \brief
   ///   Access the collection of particle groups used for particle based wallmarks. Each group instance in this collection can hold a large number of particle wallmarks.
+  ///
+  /// The manager keeps an index of the groups for creating wallmarks, which is rebuilt after each call of this function, since the
+  /// returned collection may be modified.
   EFFECTS_IMPEXP VRefCountedCollection<VParticleWallmarkGroup>& ParticleGroupInstances();
 
   /// \brief
@@ -341,10 +368,51 @@ private:
   }
 
   friend class VProjectedWallmark;
+  friend class VParticleWallmarkGroup;
   static bool IsTracePointOnPlane(const hkvVec3& vPos, const hkvVec3& vNormal, float fTraceRad, float fEpsilon, hkvVec3& vNewNormal);
-  VParticleWallmark* CreateParticle(VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting, const hkvVec3& vCenter, bool bCheckBest);
+  VParticleWallmark* CreateParticle(VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting, const hkvVec3& vCenter);
   VRefCountedCollection<VParticleWallmarkGroup> m_AllWallmarkGroups;
 
+  /// \brief
+  ///   Returns a unique key for the grid cell that contains the passed position
+  static inline __int64 GetCellKey(const hkvVec3& vPos)
+  {
+    const float fInvSize = 1.f/WALLMARK_GRID_CELL_SIZE;
+    const __int64 x = (int)hkvMath::floor(vPos.x*fInvSize) & 0x1fffff;
+    const __int64 y = (int)hkvMath::floor(vPos.y*fInvSize) & 0x1fffff;
+    const __int64 z = (int)hkvMath::floor(vPos.z*fInvSize) & 0x1fffff;
+    return (x<<42) | (y<<21) | z;
+  }
+
+  /// \brief
+  ///   Returns the key of the group index. Different groups can share the same key, so the buckets have to be compared against the group properties
+  static inline __int64 GetGroupIndexKey(VTextureObject *pTexture, VIS_TransparencyType eBlending, bool bApplyDeferredLighting, __int64 iCellKey)
+  {
+    __int64 iKey = (__int64)(size_t)pTexture;
+    iKey = iKey*31 + (__int64)eBlending*2 + (bApplyDeferredLighting ? 1:0);
+    return iKey ^ (iCellKey*2654435761u);
+  }
+
+  void AddToGroupIndex(VParticleWallmarkGroup *pGroup);
+  void RebuildGroupIndex();
+
+  VMap<__int64, VParticleWallmarkGroup *> m_WallmarkGroupIndex; ///< first group of each bucket
+  unsigned int m_iGroupRevision;        ///< incremented when m_AllWallmarkGroups is handed out for modification or a group is deleted
+  unsigned int m_iIndexedGroupRevision; ///< m_iGroupRevision at the time m_WallmarkGroupIndex has been built
+
+  void UpdateProjectedWallmarkGrid();
+  void AddToGrid(VProjectedWallmark *pWallmark);
+  void RemoveFromGrid(VProjectedWallmark *pWallmark);
+  void ClearProjectedWallmarkGrid();
+  static int CompareCreationIndex(const void *pElem1, const void *pElem2);
+
+  VMap<__int64, VProjectedWallmarkCell *> m_ProjectedWallmarkCellMap;
+  DynArray_cl<VProjectedWallmarkCell *> m_ProjectedWallmarkCells;
+  int m_iProjectedWallmarkCellCount;
+  VRefCountedCollection<VProjectedWallmark> m_PendingProjectedWallmarks; ///< wallmarks with outdated bounding box or grid cell
+  DynArray_cl<VProjectedWallmark *> m_VisibleProjectedWallmarks;
+  unsigned int m_iProjectedWallmarkCounter;
+
   static inline __int64 GetGeomHashMask(VisStaticGeometryInstance_cl *pGeom)
   {
 #if defined (WIN32)  || defined (_VISION_XENON)   || defined (_VISION_PS3)   || defined (_VISION_PSP2) 
@@ -252,9 +252,34 @@ void VScriptComponent::DeregisterCallbacks()
     Vision::Callbacks.OnVideoChanged -= this;
 }  
 
+// Handles of the frequently called script functions, see VScriptResourceManager::GetFunctionHandle
+static int g_iOnUpdateSceneBeginHandle = -1;
+static int g_iOnUpdateSceneFinishedHandle = -1;
+static int g_iOnThinkHandle = -1;
+static int g_iOnTriggerHandle = -1;
+static int g_iOnTransitionEventHandle = -1;
+static int g_iOnAnimationEventHandle = -1;
+
+static void InitFunctionHandles()
+{
+  if (g_iOnThinkHandle>=0)
+    return;
+
+  VScriptResourceManager &manager = VScriptResourceManager::GlobalManager();
+  g_iOnUpdateSceneBeginHandle = manager.GetFunctionHandle("OnUpdateSceneBegin");
+  g_iOnUpdateSceneFinishedHandle = manager.GetFunctionHandle("OnUpdateSceneFinished");
+  g_iOnTriggerHandle = manager.GetFunctionHandle("OnTrigger");
+  g_iOnTransitionEventHandle = manager.GetFunctionHandle("OnTransitionEvent");
+  g_iOnAnimationEventHandle = manager.GetFunctionHandle("OnAnimationEvent");
+  g_iOnThinkHandle = manager.GetFunctionHandle("OnThink");
+}
+
 int VScriptComponent::CheckAvailableFunctions(VScriptInstance* pInstance)
 {
   int iRes = 0;
+
+  // m_iFunctions is always set through this function, so the handles are valid whenever a function flag is set
+  InitFunctionHandles();
   
   //check which functions are present
   if (pInstance->HasFunction("OnUpdateSceneBegin"))     iRes |= VSCRIPT_FUNC_ONUPDATESCENEBEGIN;
@@ -287,7 +312,7 @@ void VScriptComponent::OnHandleCallback(IVisCallbackDataObject_cl *pData)
   if (pData->m_pSender==&Vision::Callbacks.OnUpdateSceneBegin)
   {
     if (m_iFunctions & VSCRIPT_FUNC_ONUPDATESCENEBEGIN)
-      m_spInstance->ExecuteFunctionArg("OnUpdateSceneBegin", "*");
+      m_spInstance->ExecuteFunctionHandleArg(g_iOnUpdateSceneBeginHandle, "*");
     return;
   }
 
@@ -295,7 +320,7 @@ void VScriptComponent::OnHandleCallback(IVisCallbackDataObject_cl *pData)
   {
     if ((m_iFunctions & VSCRIPT_FUNC_ONTHINK) && !Vision::GetScriptManager()->IsPaused() && m_bScriptThinkEnabled)
     {
-      m_spInstance->ExecuteFunctionArg("OnThink", "*");
+      m_spInstance->ExecuteFunctionHandleArg(g_iOnThinkHandle, "*");
     }
     return;
   }
@@ -303,7 +328,7 @@ void VScriptComponent::OnHandleCallback(IVisCallbackDataObject_cl *pData)
   if (pData->m_pSender==&Vision::Callbacks.OnUpdateSceneFinished)
   {
     if (m_iFunctions & VSCRIPT_FUNC_ONUPDATESCENEFINISHED)
-      m_spInstance->ExecuteFunctionArg("OnUpdateSceneFinished", "*");
+      m_spInstance->ExecuteFunctionHandleArg(g_iOnUpdateSceneFinishedHandle, "*");
     return;
   }
 
@@ -346,7 +371,7 @@ void VScriptComponent::MessageFunction(int iID, INT_PTR iParamA, INT_PTR iParamB
     {
       VisTriggerSourceComponent_cl *pTriggerSrc = (VisTriggerSourceComponent_cl *)iParamA;
       VisTriggerTargetComponent_cl *pTriggerTgt = (VisTriggerTargetComponent_cl *)iParamB;
-      m_spInstance->ExecuteFunctionArg("OnTrigger", "*ss",pTriggerSrc->GetComponentName(), pTriggerTgt->GetComponentName());
+      m_spInstance->ExecuteFunctionHandleArg(g_iOnTriggerHandle, "*ss",pTriggerSrc->GetComponentName(), pTriggerTgt->GetComponentName());
     }
 
     return;
@@ -357,7 +382,7 @@ void VScriptComponent::MessageFunction(int iID, INT_PTR iParamA, INT_PTR iParamB
     if (m_iFunctions&VSCRIPT_FUNC_ONTRANSITIONEVENT)
     {
       
-      m_spInstance->ExecuteFunctionArg("OnTransitionEvent", "*i", iParamA);
+      m_spInstance->ExecuteFunctionHandleArg(g_iOnTransitionEventHandle, "*i", iParamA);
     }
     return;
   }
@@ -378,11 +403,11 @@ void VScriptComponent::MessageFunction(int iID, INT_PTR iParamA, INT_PTR iParamB
       if(Vision::Animations.IsStringEvent((int)iParamA))
       {
         const char * szAnimationEventName = Vision::Animations.GetEventString((int)iParamA);
-        m_spInstance->ExecuteFunctionArg("OnAnimationEvent", "*ss", szAnimationEventName, szAnimSequence);
+        m_spInstance->ExecuteFunctionHandleArg(g_iOnAnimationEventHandle, "*ss", szAnimationEventName, szAnimSequence);
       }
       else
       {
-        m_spInstance->ExecuteFunctionArg("OnAnimationEvent", "*is", iParamA, szAnimSequence);
+        m_spInstance->ExecuteFunctionHandleArg(g_iOnAnimationEventHandle, "*is", iParamA, szAnimSequence);
       }
     }
     return;
@@ -203,7 +203,6 @@ void VScriptInstance::DiscardThread(lua_State *pThread, bool bForReuse)
   else
   {
     // clean up the list
-    lua_State* pParentState = m_spResource->m_pResourceState;
     int iOldCount = m_iCreatedThreads;
     m_iCreatedThreads = 0;
     for (int i=0;i<iOldCount;i++)
@@ -215,7 +214,8 @@ void VScriptInstance::DiscardThread(lua_State *pThread, bool bForReuse)
         //will remain inside the Lua globals
         VScriptResourceManager::DiscardThread(info.pThread);
 
-        luaL_unref(pParentState, LUA_REGISTRYINDEX, info.iRefKey);
+        // keep the thread in the resource's pool if it can be resumed again
+        m_spResource->ReleaseThread(info.pThread, info.iRefKey, info.iStateGeneration);
         info.pThread = NULL;
         continue;
       }
@@ -252,18 +252,23 @@ VScriptInstance::VLuaThreadInfo* VScriptInstance::CreateNewThread()
 
   VLuaThreadInfo &info = m_CreatedThreads[m_iCreatedThreads++];
 
-  info.pThread = lua_newthread(pParentState);
-  info.iRefKey = luaL_ref(pParentState, LUA_REGISTRYINDEX); //reference the thread from the registry for GC
+  // take a thread discarded by another instance of the same resource
+  info.pThread = m_spResource->AcquireThread(info.iRefKey);
+  if (info.pThread==NULL)
+  {
+    info.pThread = lua_newthread(pParentState);
+    info.iRefKey = luaL_ref(pParentState, LUA_REGISTRYINDEX); //reference the thread from the registry for GC
+  #ifdef PROFILING
+    VScriptResourceManager::g_iThreadsCreated++;
+  #endif
+  }
+  info.iStateGeneration = m_spResource->GetStateGeneration();
   info.eState = Running;
   info.fWaitTime = 0.f;
 
   // Associate the thread with this script instance
   // We need this so we can find out which object a native library function is called from
   VScriptResourceManager::SetScriptInstanceForState(info.pThread, this);
-  
-#ifdef PROFILING
-  VScriptResourceManager::g_iThreadsCreated++;
-#endif
 
   return &info;
 }
@@ -345,53 +350,32 @@ BOOL VScriptInstance::HasFunction(const char *szFunction)
 VScriptInstance::VLuaThreadInfo *VScriptInstance::PrepareFunctionCall(const char *szFunction)
 {
   // create new LUA thread based on resource's main state
-  VLuaThreadInfo *pInfo = CreateNewThread(); // TODO: maybe have a thread pool per resource?
+  VLuaThreadInfo *pInfo = CreateNewThread();
   if (pInfo==NULL)
     return NULL;
-  lua_State *pLuaState = pInfo->pThread;
-
-  
-  VMemoryTempBuffer<256> copyBuffer(szFunction); // operate on a copy string in the tokenizer
-  
-  VStringTokenizerInPlace Tokenizer(copyBuffer.AsChar(), '.');
-  char* pCurrent = Tokenizer.Next();
-  int i = 0;
 
-  while( pCurrent )
+  if (!VScriptResource::PushFunctionByName(pInfo->pThread, szFunction))
   {
-    if( i == 0 )
-    {
-      lua_getfield(pLuaState, LUA_GLOBALSINDEX, pCurrent);
-    }
-    else
-    {
-      lua_pushstring(pLuaState, pCurrent);
-      lua_gettable(pLuaState, -2);
-    }
-
-      
-    if (lua_isnil(pLuaState, -1))
-    {
-      //not found
-      lua_pop(pLuaState,(i+1));
-      DiscardThread(pLuaState,false);
-      return NULL;
-    }
-
-    pCurrent = Tokenizer.Next();
-    i++;
+    //not found
+    DiscardThread(pInfo->pThread,false);
+    return NULL;
   }
 
-  /*
-    lua_getfield(pLuaState, LUA_GLOBALSINDEX, szFunction);
-    if (lua_isnil(pLuaState, -1))
-    {
-      //not found
-      lua_pop(pLuaState, 1);
-      return NULL;
-    }
+  return pInfo;
+}
 
-  */
+VScriptInstance::VLuaThreadInfo *VScriptInstance::PrepareFunctionCall(int iFunctionHandle)
+{
+  VLuaThreadInfo *pInfo = CreateNewThread();
+  if (pInfo==NULL)
+    return NULL;
+
+  // looks up the function through the name string cached in the resource
+  if (!m_spResource->PushFunction(pInfo->pThread, iFunctionHandle))
+  {
+    DiscardThread(pInfo->pThread,false);
+    return NULL;
+  }
 
   return pInfo;
 }
@@ -435,8 +419,6 @@ BOOL VScriptInstance::ExecuteFunctionArgV(const char *szFunction, const char *sz
 #ifdef PROFILING
   VScriptResourceManager::g_iFunctionsCalled++;
 #endif
-  
-  int narg, nres;  // number of arguments and results
 
   //TODO: early out before creating thread?
   //if (!HasFunction(szFunction)) return FALSE;
@@ -444,7 +426,40 @@ BOOL VScriptInstance::ExecuteFunctionArgV(const char *szFunction, const char *sz
   VLuaThreadInfo *pInfo = PrepareFunctionCall(szFunction);
   if (!pInfo)
     return FALSE;
-  
+
+  return ExecutePreparedFunctionCall(pInfo, szFunction, szArgFormat, argPtr);
+}
+
+BOOL VScriptInstance::ExecuteFunctionHandleArg(int iFunctionHandle, const char *szArgFormat, ...)
+{
+  va_list argPtr;
+  va_start(argPtr, szArgFormat);
+  BOOL bResult = ExecuteFunctionHandleArgV(iFunctionHandle, szArgFormat, argPtr);
+  va_end(argPtr);
+  return bResult;
+}
+
+BOOL VScriptInstance::ExecuteFunctionHandleArgV(int iFunctionHandle, const char *szArgFormat, va_list argPtr)
+{
+  VISION_PROFILE_FUNCTION(PROFILING_SCRIPTOBJ_EXECUTEFUNCTION);
+#ifdef PROFILING
+  VScriptResourceManager::g_iFunctionsCalled++;
+#endif
+
+  if (m_spResource==NULL)
+    return FALSE;
+
+  VLuaThreadInfo *pInfo = PrepareFunctionCall(iFunctionHandle);
+  if (!pInfo)
+    return FALSE;
+
+  // the name is only used for warnings
+  return ExecutePreparedFunctionCall(pInfo, VScriptResourceManager::GlobalManager().GetFunctionHandleName(iFunctionHandle), szArgFormat, argPtr);
+}
+
+BOOL VScriptInstance::ExecutePreparedFunctionCall(VLuaThreadInfo *pInfo, const char *szFunction, const char *szArgFormat, va_list argPtr)
+{
+  int narg, nres;  // number of arguments and results
   lua_State *pLuaState = pInfo->pThread;
 
   int iNestedTable = 0;
@@ -1178,6 +1193,28 @@ bool VScriptInstance::ExecuteCollisionFunc(const char *pszFunctionName, VScriptC
   // prepare the function call (pushes function name)
   VLuaThreadInfo *pInfo = PrepareFunctionCall(pszFunctionName);
   if (!pInfo) return false;
+
+  return DoCollisionFunctionCall(pInfo, pszFunctionName, pColInfo);
+}
+
+bool VScriptInstance::ExecuteCollisionFunc(int iFunctionHandle, VScriptCollisionInfo *pColInfo)
+{
+  VISION_PROFILE_FUNCTION(PROFILING_SCRIPTOBJ_EXECUTEFUNCTION);
+#ifdef PROFILING
+  VScriptResourceManager::g_iFunctionsCalled++;
+#endif
+
+  if (m_spResource==NULL)
+    return false;
+
+  VLuaThreadInfo *pInfo = PrepareFunctionCall(iFunctionHandle);
+  if (!pInfo) return false;
+
+  return DoCollisionFunctionCall(pInfo, VScriptResourceManager::GlobalManager().GetFunctionHandleName(iFunctionHandle), pColInfo);
+}
+
+bool VScriptInstance::DoCollisionFunctionCall(VLuaThreadInfo *pInfo, const char *pszFunctionName, VScriptCollisionInfo *pColInfo)
+{
   lua_State *L = pInfo->pThread;
 
   // now start pushing the arguments on the stack
@@ -128,6 +128,18 @@ public:
   ///   Overridden function to execute a function call on this script object. See interface IVScriptInstance::ExecuteFunctionArgV for detailed description
   SCRIPT_IMPEXP virtual BOOL ExecuteFunctionArgV(const char *szFunction, const char *szArgFormat, va_list argPtr);
 
+  /// \brief
+  ///   Same as ExecuteFunctionArg, but takes a function handle returned by VScriptResourceManager::GetFunctionHandle
+  ///
+  /// The function is looked up in the globals of the script resource on every call, so functions that are assigned
+  /// at runtime are picked up. The lookup uses the name string that the resource keeps in the Lua registry, so the
+  /// name is not hashed per call. Use this for functions that are called frequently, e.g. once per frame.
+  SCRIPT_IMPEXP BOOL ExecuteFunctionHandleArg(int iFunctionHandle, const char *szArgFormat, ...);
+
+  /// \brief
+  ///   Same as ExecuteFunctionArgV, but takes a function handle returned by VScriptResourceManager::GetFunctionHandle
+  SCRIPT_IMPEXP BOOL ExecuteFunctionHandleArgV(int iFunctionHandle, const char *szArgFormat, va_list argPtr);
+
   /// \brief
   ///   Overridden function. See interface IVScriptInstance::HasFunction for detailed description
   SCRIPT_IMPEXP virtual BOOL HasFunction(const char *szFunction);
@@ -173,6 +185,10 @@ public:
   ///   VScriptCollisionInfo structure is intended to be used independent of the physics engine.
   SCRIPT_IMPEXP bool ExecuteCollisionFunc(const char *pszFunctionName, VScriptCollisionInfo *pColInfo);
 
+  /// \brief
+  ///   Same as ExecuteCollisionFunc, but takes a function handle returned by VScriptResourceManager::GetFunctionHandle
+  SCRIPT_IMPEXP bool ExecuteCollisionFunc(int iFunctionHandle, VScriptCollisionInfo *pColInfo);
+
   //serialization
   V_DECLARE_SERIAL_DLLEXP( VScriptInstance,  SCRIPT_IMPEXP )
 
@@ -213,6 +229,7 @@ protected:
   {
     lua_State *pThread;     ///< lua thread
     int iRefKey;            ///< key value under which the reference is hold
+    int iStateGeneration;   ///< VScriptResource::GetStateGeneration of the state the thread was created from
     VThreadState_e eState;  ///< internal state
     float fWaitTime;        ///< current time to wait
 
@@ -223,7 +240,10 @@ protected:
   friend class VScriptResourceManager;
 
   VLuaThreadInfo* PrepareFunctionCall(const char *szFunction);
+  VLuaThreadInfo* PrepareFunctionCall(int iFunctionHandle);
   bool DoFunctionCall(VLuaThreadInfo *pInfo, int narg);
+  BOOL ExecutePreparedFunctionCall(VLuaThreadInfo *pInfo, const char *szFunction, const char *szArgFormat, va_list argPtr);
+  bool DoCollisionFunctionCall(VLuaThreadInfo *pInfo, const char *pszFunctionName, VScriptCollisionInfo *pColInfo);
 
   void ResumeValue(int returnValue);
   void Resume(int nargs);
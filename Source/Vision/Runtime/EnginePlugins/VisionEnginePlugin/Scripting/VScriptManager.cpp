@@ -24,6 +24,9 @@ int VScriptResourceManager::g_iThreadsCreated = 0;
 int VScriptResourceManager::g_iFunctionsCalled = 0;
 int VScriptResourceManager::g_iThreadsRecycled = 0;
 int VScriptResourceManager::g_iFunctionsFailed = 0;
+int VScriptResourceManager::g_iThreadsPooled = 0;
+int VScriptResourceManager::g_iThreadsTakenFromPool = 0;
+int VScriptResourceManager::g_iThreadsDestroyed = 0;
 
 VisCallback_cl VScriptResourceManager::OnUserDataSerialize;
 
@@ -326,6 +329,7 @@ VScriptResourceManager::VScriptResourceManager()
   , m_bInitialized(false)
   , m_iGameScriptFunctions(0)
   , m_iSceneScriptFunctions(0)
+  , m_FunctionHandleNext(0, -1)
 {
 }
 
@@ -522,6 +526,36 @@ VScriptResource* VScriptResourceManager::LoadScriptFile(const char *szFilename)
 }
 
 
+// FNV-1a; Lua names are case sensitive, so the hash is as well
+static int HashFunctionName(const char *szFunction)
+{
+  unsigned int iHash = 2166136261u;
+  for (const unsigned char *p=(const unsigned char *)szFunction; *p; p++)
+    iHash = (iHash ^ *p) * 16777619u;
+  return (int)iHash;
+}
+
+int VScriptResourceManager::GetFunctionHandle(const char *szFunction)
+{
+  VASSERT(szFunction!=NULL && szFunction[0]);
+  const int iHash = HashFunctionName(szFunction);
+
+  // handles with the same hash are chained through m_FunctionHandleNext
+  int iFirst = -1;
+  if (m_FunctionHandleIndex.Lookup(iHash, iFirst))
+  {
+    for (int i=iFirst; i>=0; i=m_FunctionHandleNext.GetDataPtr()[i])
+      if (strcmp(m_FunctionHandleNames.GetString(i), szFunction)==0)
+        return i;
+  }
+
+  const int iHandle = m_FunctionHandleNames.AddString(szFunction);
+  m_FunctionHandleNext[iHandle] = iFirst;
+  m_FunctionHandleIndex.SetAt(iHash, iHandle);
+  return iHandle;
+}
+
+
 void VScriptResourceManager::OnHandleCallback(IVisCallbackDataObject_cl *pData)
 {
   VISION_PROFILE_FUNCTION(PROFILING_SCRIPTING);  //TODO: Different element for tracking callbacks?
@@ -830,6 +864,22 @@ void VScriptResourceManager::ShowDebugInfo(IVRenderInterface *pRI)
     pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
   sprintf(szLine,"Lua threads recycled \t: %i", g_iThreadsRecycled);
     pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
+
+  int iPooledThreads = 0;
+  for (int i=0;i<GetResourceCount();i++)
+  {
+    VScriptResource *pRes = (VScriptResource *)GetResourceByIndex(i);
+    if (pRes!=NULL)
+      iPooledThreads += pRes->GetPooledThreadCount();
+  }
+  sprintf(szLine,"Lua threads in resource pools \t: %i", iPooledThreads);
+    pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
+  sprintf(szLine,"...returned to pools \t: %i", g_iThreadsPooled);
+    pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
+  sprintf(szLine,"...taken from pools \t: %i", g_iThreadsTakenFromPool);
+    pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
+  sprintf(szLine,"...released \t: %i", g_iThreadsDestroyed);
+    pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
   sprintf(szLine,"Lua functions called \t: %i", g_iFunctionsCalled);
     pRI->DrawText2D(40.f,yk, szLine, V_RGBA_WHITE);yk+=10.f;
   sprintf(szLine,"...function calls failed \t: %i", g_iFunctionsFailed);
@@ -295,6 +295,25 @@ public:
   ///   Returns the collection of all script instances in the scene
   inline VScriptInstanceCollection& Instances() {return m_Instances;}
 
+  /// \brief
+  ///   Returns the handle of a script function name, for VScriptInstance::ExecuteFunctionHandleArg
+  ///
+  /// Handles are valid for all script resources and are never released, so they can be stored in static variables.
+  /// Retrieving a handle is a hash lookup. Calls through the handle look up the function in the globals of the script
+  /// resource on every call, so functions that are assigned at runtime are picked up, but they don't hash the name.
+  ///
+  /// \param szFunction
+  ///   Function name; nested tables are separated by dots, e.g. "Table.Function"
+  SCRIPT_IMPEXP int GetFunctionHandle(const char *szFunction);
+
+  /// \brief
+  ///   Returns the function name of a handle returned by GetFunctionHandle
+  inline const char* GetFunctionHandleName(int iFunctionHandle) const
+  {
+    VASSERT(iFunctionHandle>=0 && iFunctionHandle<m_FunctionHandleNames.GetLength());
+    return m_FunctionHandleNames.GetString(iFunctionHandle);
+  }
+
   /// \brief
   ///   Accesses the global instance of a LUA script manager
   SCRIPT_IMPEXP static VScriptResourceManager& GlobalManager();
@@ -386,6 +405,9 @@ public:
   // statistics:
   static int g_iThreadsCreated;
   static int g_iThreadsRecycled;
+  static int g_iThreadsPooled;
+  static int g_iThreadsTakenFromPool;
+  static int g_iThreadsDestroyed;
   static int g_iFunctionsCalled;
   static int g_iFunctionsFailed;
 
@@ -405,6 +427,10 @@ private:
 
   int m_iGameScriptFunctions;
   int m_iSceneScriptFunctions;
+
+  VStrList m_FunctionHandleNames;
+  VMap<int, int> m_FunctionHandleIndex;   ///< name hash -> last handle with that hash
+  DynArray_cl<int> m_FunctionHandleNext;  ///< next handle with the same name hash, -1 at the end of the chain
 };
 
 
@@ -55,7 +55,8 @@ void VScriptResourceSerializationProxy::Serialize( VArchive &ar )
 //-----------------------------------------------------------------------------------
 
 VScriptResource::VScriptResource(VScriptResourceManager *pManager) 
-  : VManagedResource(pManager), m_pResourceState(NULL), m_iKey(LUA_NOREF)
+  : VManagedResource(pManager), m_pResourceState(NULL), m_iKey(LUA_NOREF), m_FunctionRefs(0, LUA_NOREF), m_iFunctionRefCount(0),
+    m_iPooledThreads(0), m_iMaxPooledThreads(VSCRIPTRESOURCE_DEFAULT_THREADPOOL_SIZE), m_iStateGeneration(0), m_iPoolGeneration(0)
 {
 //  m_iScriptLen = 0;
   SetResourceFlag(VRESOURCEFLAG_ALLOWUNLOAD);
@@ -91,6 +92,8 @@ BOOL VScriptResource::Reload()
 
   // Test if file is UTF-8 and if so remove the byte order mark
   szBuffer = StripUTF8BOM(szBuffer, iScriptLen);
+
+  InvalidateFunctionHandles();
   
   lua_State *pParentState = GetScriptManager()->GetMasterState();
   VASSERT(pParentState && "Script manager not initialized");
@@ -99,6 +102,7 @@ BOOL VScriptResource::Reload()
     VASSERT(m_pResourceState == NULL);
     m_pResourceState = lua_newthread(pParentState);
     m_iKey = luaL_ref(pParentState, LUA_REGISTRYINDEX); // reference the thread from the registry for GC
+    m_iStateGeneration++; // threads created from a previous state must not be pooled anymore
 
     // Create a new locals table for this resource's state. Loaded functions will then be in this state's scope.
     // Links the new table to the original global table so scripts can find the global functions
@@ -195,6 +199,9 @@ void VScriptResource::ReloadAndReplace(char* pNewContent /*= NULL */)
 
 BOOL VScriptResource::Unload()
 {
+  InvalidateFunctionHandles();
+  DiscardPooledThreads();
+
   //clear the light user data entry for this state
   VScriptResourceManager::DiscardThread(m_pResourceState);
   m_pResourceState = NULL;
@@ -238,6 +245,148 @@ VScriptInstance* VScriptResource::CreateScriptInstance()
 
 //-----------------------------------------------------------------------------------
 
+bool VScriptResource::PushFunction(lua_State *L, int iFunctionHandle)
+{
+  VASSERT(iFunctionHandle>=0);
+
+  // The function itself is not cached, since scripts may assign a different function to the same name at any time.
+  // Instead, the interned name string is kept in the registry, so the lookup doesn't have to hash the name.
+  int iRef = (iFunctionHandle<m_iFunctionRefCount) ? m_FunctionRefs.GetDataPtr()[iFunctionHandle] : LUA_NOREF;
+  if (iRef==LUA_NOREF)
+  {
+    const char *szFunction = GetScriptManager()->GetFunctionHandleName(iFunctionHandle);
+    if (strchr(szFunction, '.')!=NULL)
+      return PushFunctionByName(L, szFunction); // nested tables, see PushFunctionByName
+
+    lua_pushstring(L, szFunction);
+    iRef = luaL_ref(L, LUA_REGISTRYINDEX); // the registry is shared by all threads
+    m_FunctionRefs[iFunctionHandle] = iRef;
+    m_iFunctionRefCount = hkvMath::Max(m_iFunctionRefCount, iFunctionHandle+1);
+  }
+
+  lua_rawgeti(L, LUA_REGISTRYINDEX, iRef);
+  lua_gettable(L, LUA_GLOBALSINDEX); // not raw, the globals of a resource fall back to the master state's globals
+  if (lua_isnil(L, -1))
+  {
+    lua_pop(L, 1);
+    return false;
+  }
+  return true;
+}
+
+/*static*/ bool VScriptResource::PushFunctionByName(lua_State *L, const char *szFunction)
+{
+  if (strchr(szFunction, '.')==NULL)
+  {
+    lua_getfield(L, LUA_GLOBALSINDEX, szFunction);
+    if (lua_isnil(L, -1))
+    {
+      lua_pop(L, 1);
+      return false;
+    }
+    return true;
+  }
+
+  VMemoryTempBuffer<256> copyBuffer(szFunction); // operate on a copy string in the tokenizer
+  VStringTokenizerInPlace Tokenizer(copyBuffer.AsChar(), '.');
+  char* pCurrent = Tokenizer.Next();
+  lua_getfield(L, LUA_GLOBALSINDEX, pCurrent);
+
+  while ((pCurrent = Tokenizer.Next()) != NULL)
+  {
+    if (lua_isnil(L, -1))
+      break;
+    lua_getfield(L, -1, pCurrent);
+    lua_remove(L, -2); // remove the parent table
+  }
+
+  if (lua_isnil(L, -1))
+  {
+    lua_pop(L, 1);
+    return false;
+  }
+  return true;
+}
+
+void VScriptResource::InvalidateFunctionHandles()
+{
+  if (m_iFunctionRefCount==0)
+    return;
+
+  lua_State *pParentState = GetScriptManager()->GetMasterState();
+  for (int i=0;i<m_iFunctionRefCount;i++)
+  {
+    int &iRef = m_FunctionRefs.GetDataPtr()[i];
+    if (iRef==LUA_NOREF)
+      continue;
+    luaL_unref(pParentState, LUA_REGISTRYINDEX, iRef);
+    iRef = LUA_NOREF;
+  }
+  m_iFunctionRefCount = 0;
+}
+
+//-----------------------------------------------------------------------------------
+
+lua_State* VScriptResource::AcquireThread(int &iRefKey)
+{
+  if (m_iPoolGeneration!=m_iStateGeneration)
+    DiscardPooledThreads();
+  if (m_iPooledThreads==0)
+    return NULL;
+
+  const VPooledThread &entry = m_ThreadPool.GetDataPtr()[--m_iPooledThreads];
+  iRefKey = entry.iRefKey;
+#ifdef PROFILING
+  VScriptResourceManager::g_iThreadsTakenFromPool++;
+#endif
+  return entry.pThread;
+}
+
+bool VScriptResource::ReleaseThread(lua_State *pThread, int iRefKey, int iStateGeneration)
+{
+  if (m_iPoolGeneration!=m_iStateGeneration)
+    DiscardPooledThreads();
+
+  // Only threads that ran to completion can be resumed again (see lua_resume). This excludes suspended threads and
+  // threads with an error status, and also a thread that is discarded while it is still executing a function.
+  // Threads created from a state that has been replaced since (e.g. by a cold reload) are never pooled.
+  lua_Debug ar;
+  if (m_pResourceState!=NULL && iStateGeneration==m_iStateGeneration && m_iPooledThreads<m_iMaxPooledThreads &&
+    lua_status(pThread)==0 && lua_getstack(pThread, 0, &ar)==0)
+  {
+    lua_settop(pThread, 0); // clear left-overs of the last function call
+    VPooledThread &entry = m_ThreadPool[m_iPooledThreads++];
+    entry.pThread = pThread;
+    entry.iRefKey = iRefKey;
+  #ifdef PROFILING
+    VScriptResourceManager::g_iThreadsPooled++;
+  #endif
+    return true;
+  }
+
+  // the thread gets garbage collected
+  luaL_unref(GetScriptManager()->GetMasterState(), LUA_REGISTRYINDEX, iRefKey);
+#ifdef PROFILING
+  VScriptResourceManager::g_iThreadsDestroyed++;
+#endif
+  return false;
+}
+
+void VScriptResource::DiscardPooledThreads()
+{
+  m_iPoolGeneration = m_iStateGeneration;
+  if (m_iPooledThreads==0)
+    return;
+
+  lua_State *pParentState = GetScriptManager()->GetMasterState();
+  for (int i=0;i<m_iPooledThreads;i++)
+    luaL_unref(pParentState, LUA_REGISTRYINDEX, m_ThreadPool.GetDataPtr()[i].iRefKey);
+  m_iPooledThreads = 0;
+  m_ThreadPool.Reset();
+}
+
+//-----------------------------------------------------------------------------------
+
 /*static*/ char* VScriptResource::StripUTF8BOM(char* szScriptIn, int& iScriptLenInOut)
 {
   const unsigned char utf8BOM[3] = { 0xef, 0xbb, 0xbf };
@@ -11,6 +11,10 @@
 #ifndef VSCRIPTRESOURCE_HPP_INCLUDED
 #define VSCRIPTRESOURCE_HPP_INCLUDED
 
+/// \brief
+///   Default number of Lua threads a script resource keeps for reuse, see VScriptResource::SetMaxPooledThreads
+#define VSCRIPTRESOURCE_DEFAULT_THREADPOOL_SIZE   32
+
 /// \brief
 ///   Vision resource class that represents the source code side of a script file. Script instances
 ///   share the same state via the resource
@@ -82,6 +86,101 @@ public:
 
   SCRIPT_IMPEXP virtual void UnloadAndReload(VUnloadReloadOptions_e eOptions) HKV_OVERRIDE;
 
+  /// \fn SCRIPT_IMPEXP bool PushFunction(lua_State *L, int iFunctionHandle)
+  ///
+  /// \brief  Pushes the function of a handle onto the stack of a thread of this resource. 
+  ///
+  /// The function is looked up in the globals of the thread on every call, so functions that are assigned to a
+  /// different value at runtime are picked up. The name is pushed from a registry reference to the interned Lua
+  /// string, so the lookup does not hash the name. Names of nested tables fall back to PushFunctionByName.
+  ///
+  /// \param [in] L  The thread to push the function onto. Must share the globals of this resource. 
+  /// \param iFunctionHandle  Handle returned by VScriptResourceManager::GetFunctionHandle. 
+  ///
+  /// \return true if the function exists. Nothing is pushed otherwise. 
+  ///
+  SCRIPT_IMPEXP bool PushFunction(lua_State *L, int iFunctionHandle);
+
+  /// \fn SCRIPT_IMPEXP static bool PushFunctionByName(lua_State *L, const char *szFunction)
+  ///
+  /// \brief  Looks up a global function by name and pushes it onto the stack. 
+  ///
+  /// \param [in] L  The Lua state. 
+  /// \param szFunction  Function name; nested tables are separated by dots, e.g. "Table.Function". 
+  ///
+  /// \return true if the function exists. Nothing is pushed otherwise. 
+  ///
+  SCRIPT_IMPEXP static bool PushFunctionByName(lua_State *L, const char *szFunction);
+
+  /// \fn SCRIPT_IMPEXP void InvalidateFunctionHandles()
+  ///
+  /// \brief  Releases the function name references cached by PushFunction. 
+  ///
+  SCRIPT_IMPEXP void InvalidateFunctionHandles();
+
+  /// \fn SCRIPT_IMPEXP lua_State* AcquireThread(int &iRefKey)
+  ///
+  /// \brief  Takes a Lua thread from the thread pool of this resource. 
+  ///
+  /// Script instances use the pool before they create a new thread, so threads survive the instances that created
+  /// them. The returned thread has an empty stack and is not associated with any script instance.
+  ///
+  /// \param [out] iRefKey  Receives the registry key that keeps the thread alive. 
+  ///
+  /// \return The thread, or NULL if the pool is empty. 
+  ///
+  SCRIPT_IMPEXP lua_State* AcquireThread(int &iRefKey);
+
+  /// \fn SCRIPT_IMPEXP bool ReleaseThread(lua_State *pThread, int iRefKey, int iStateGeneration)
+  ///
+  /// \brief  Returns a thread created from this resource's state to the pool. 
+  ///
+  /// Threads that are suspended or stopped with an error can't be resumed again and are released, just like threads
+  /// that exceed the pool size. Threads that have been created from an older resource state (see GetStateGeneration)
+  /// are released as well.
+  ///
+  /// \param [in] pThread  The thread. Must not be associated with a script instance anymore. 
+  /// \param iRefKey  The registry key of the thread. 
+  /// \param iStateGeneration  Value of GetStateGeneration when the thread was created or taken from the pool. 
+  ///
+  /// \return true if the thread has been added to the pool. 
+  ///
+  SCRIPT_IMPEXP bool ReleaseThread(lua_State *pThread, int iRefKey, int iStateGeneration);
+
+  /// \fn SCRIPT_IMPEXP void DiscardPooledThreads()
+  ///
+  /// \brief  Releases all threads in the pool. 
+  ///
+  SCRIPT_IMPEXP void DiscardPooledThreads();
+
+  /// \fn inline void SetMaxPooledThreads(int iCount)
+  ///
+  /// \brief  Sets the maximum number of threads kept in the pool (VSCRIPTRESOURCE_DEFAULT_THREADPOOL_SIZE by default). 
+  ///
+  inline void SetMaxPooledThreads(int iCount)
+  {
+    VASSERT(iCount>=0);
+    m_iMaxPooledThreads = iCount;
+  }
+
+  /// \fn inline int GetMaxPooledThreads() const
+  ///
+  /// \brief  Returns the maximum number of threads kept in the pool. 
+  ///
+  inline int GetMaxPooledThreads() const {return m_iMaxPooledThreads;}
+
+  /// \fn inline int GetPooledThreadCount() const
+  ///
+  /// \brief  Returns the number of threads currently in the pool. 
+  ///
+  inline int GetPooledThreadCount() const {return m_iPooledThreads;}
+
+  /// \fn inline int GetStateGeneration() const
+  ///
+  /// \brief  Returns a counter that changes whenever m_pResourceState is replaced by a new state. 
+  ///
+  inline int GetStateGeneration() const {return m_iStateGeneration;}
+
  // VString m_sScriptText; // we don't need the script text outside Reload()
  // int m_iScriptLen;
 
@@ -90,6 +189,20 @@ public:
 
 private:
   static char *StripUTF8BOM(char* szScriptIn, int& iScriptLenInOut);
+
+  DynArray_cl<int> m_FunctionRefs;  ///< registry reference to the name string per function handle, LUA_NOREF if not used yet
+  int m_iFunctionRefCount;          ///< number of used entries in m_FunctionRefs
+
+  struct VPooledThread
+  {
+    lua_State *pThread;
+    int iRefKey;
+  };
+  DynArray_cl<VPooledThread> m_ThreadPool;
+  int m_iPooledThreads;
+  int m_iMaxPooledThreads;
+  int m_iStateGeneration;           ///< incremented whenever a new m_pResourceState is created
+  int m_iPoolGeneration;            ///< m_iStateGeneration of the threads in m_ThreadPool
 };
 
 
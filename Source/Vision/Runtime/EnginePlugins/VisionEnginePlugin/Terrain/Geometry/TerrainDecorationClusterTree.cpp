@@ -0,0 +1,542 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationClusterTree.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationInstance.hpp>
+
+#include <Vision/Runtime/Base/System/Memory/VMemDbg.hpp>
+
+// *******************************************************************************
+// *  Packed instance data
+// *
+// *  Blocks of 4 instances are stored as pivotX[4],pivotY[4],pivotZ[4],scaling[4],
+// *  minX[4],minY[4],minZ[4],maxX[4],maxY[4],maxZ[4] so that the far clip and the
+// *  frustum test can be performed with a few SIMD instructions.
+// *******************************************************************************
+
+#define DECORATIONCLUSTER_BLOCKSIZE     4
+#define DECORATIONCLUSTER_BLOCKFLOATS   (10*DECORATIONCLUSTER_BLOCKSIZE)
+
+// Whole nodes are only rejected or accepted by the far clip distance if they are clearly outside or inside, so that
+// rounding differences never change the result compared to the per-instance test.
+#define DECORATIONCLUSTER_REJECT_TOLERANCE  1.001f
+#define DECORATIONCLUSTER_ACCEPT_TOLERANCE  0.999f
+
+#if ((defined(WIN32) && !defined(_M_ARM)) || defined(__SSE__)) && !defined(_VISION_XENON)
+  #include <xmmintrin.h>
+  #define DECORATIONCLUSTER_SSE
+#elif defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define DECORATIONCLUSTER_NEON
+#endif
+
+struct VTerrainDecorationClusterTree::TestParams_t
+{
+  const VisFrustum_cl *m_pFrustum;
+  hkvVec3 m_vLODPos;
+  hkvVec3 m_vTranslate;
+  float m_fDistanceScale;
+  float m_fUnscaledMaxDist;
+  unsigned int *m_pMask;
+  int *m_pFirstVisible;
+  int *m_pLastVisible;
+};
+
+
+// Partially sorts pOrder so that the element at iNth is the one that would be there if the array
+// was sorted by the pivot coordinate along iAxis, with all smaller ones before it.
+static void SelectNthPivot(int *pOrder, int iCount, int iNth, const hkvVec3 *pPivots, int iAxis)
+{
+  int iLeft = 0;
+  int iRight = iCount-1;
+  while (iRight > iLeft)
+  {
+    const float fPivot = pPivots[pOrder[(iLeft+iRight)/2]].data[iAxis];
+    int i = iLeft;
+    int j = iRight;
+    while (i <= j)
+    {
+      while (pPivots[pOrder[i]].data[iAxis] < fPivot) i++;
+      while (pPivots[pOrder[j]].data[iAxis] > fPivot) j--;
+      if (i <= j)
+      {
+        hkvMath::swap(pOrder[i], pOrder[j]);
+        i++;
+        j--;
+      }
+    }
+    if (iNth <= j)
+      iRight = j;
+    else if (iNth >= i)
+      iLeft = i;
+    else
+      break; // everything between j and i equals the pivot
+  }
+}
+
+
+static inline float GetInstanceScaling(const VTerrainDecorationInstance &inst)
+{
+#ifdef DECORATION_SCALE_INDEPENDENT_LOD
+  return 1.0f;
+#else
+  return inst.GetScaling();
+#endif
+}
+
+
+// Returns a 4 bit mask in which bit n is set if instance n of the block is within its far clip distance (only if
+// bTestDistance is set) and its bounding box overlaps the frustum planes in iPlaneFlags. The distance is computed
+// exactly like in VTerrainDecorationInstance::GetRenderDistanceSqr and the plane test is equivalent to
+// VisFrustum_cl::Overlaps(box, iPlaneFlags): per plane, the box corner with the smallest plane distance is selected
+// component by component, and the box is outside if that distance is not negative.
+static inline int GetPackedVisibleMask(const VisFrustum_cl *pFrustum, int iPlaneFlags, bool bTestDistance,
+  const hkvVec3 &vLODPos, const hkvVec3 &t, float fDistanceScale, float fUnscaledMaxDist, const float *pBlock)
+{
+  const unsigned int iNumPlanes = (pFrustum!=NULL) ? pFrustum->GetNumPlanes() : 0;
+
+#if defined(DECORATIONCLUSTER_SSE)
+  const __m128 tx = _mm_set1_ps(t.x);
+  const __m128 ty = _mm_set1_ps(t.y);
+  const __m128 tz = _mm_set1_ps(t.z);
+  int iMask = 0xf;
+  if (bTestDistance)
+  {
+    const __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pBlock), tx), _mm_set1_ps(vLODPos.x));
+    const __m128 dy = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pBlock + 4), ty), _mm_set1_ps(vLODPos.y));
+    const __m128 dz = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(pBlock + 8), tz), _mm_set1_ps(vLODPos.z));
+    const __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx), _mm_mul_ps(dy,dy)), _mm_mul_ps(dz,dz)));
+    const __m128 maxDist = _mm_mul_ps(_mm_set1_ps(fUnscaledMaxDist), _mm_loadu_ps(pBlock + 12));
+    iMask = _mm_movemask_ps(_mm_cmple_ps(_mm_mul_ps(dist, _mm_set1_ps(fDistanceScale)), maxDist));
+  }
+  if (iPlaneFlags == 0 || iMask == 0)
+    return iMask;
+
+  const __m128 minX = _mm_add_ps(_mm_loadu_ps(pBlock + 16), tx);
+  const __m128 minY = _mm_add_ps(_mm_loadu_ps(pBlock + 20), ty);
+  const __m128 minZ = _mm_add_ps(_mm_loadu_ps(pBlock + 24), tz);
+  const __m128 maxX = _mm_add_ps(_mm_loadu_ps(pBlock + 28), tx);
+  const __m128 maxY = _mm_add_ps(_mm_loadu_ps(pBlock + 32), ty);
+  const __m128 maxZ = _mm_add_ps(_mm_loadu_ps(pBlock + 36), tz);
+  const __m128 zero = _mm_setzero_ps();
+  for (unsigned int i=0; i<iNumPlanes && iMask!=0; i++)
+  {
+    if (!(iPlaneFlags & (1<<i)))
+      continue;
+    const hkvPlane *pPlane = pFrustum->GetPlane(i);
+    const __m128 a = _mm_set1_ps(pPlane->m_vNormal.x);
+    const __m128 b = _mm_set1_ps(pPlane->m_vNormal.y);
+    const __m128 c = _mm_set1_ps(pPlane->m_vNormal.z);
+    const __m128 d = _mm_set1_ps(pPlane->m_fNegDist);
+    __m128 r = _mm_add_ps(_mm_min_ps(_mm_mul_ps(minX,a), _mm_mul_ps(maxX,a)), _mm_min_ps(_mm_mul_ps(minY,b), _mm_mul_ps(maxY,b)));
+    r = _mm_add_ps(_mm_add_ps(r, _mm_min_ps(_mm_mul_ps(minZ,c), _mm_mul_ps(maxZ,c))), d);
+    iMask &= _mm_movemask_ps(_mm_cmplt_ps(r, zero));
+  }
+  return iMask;
+
+#elif defined(DECORATIONCLUSTER_NEON)
+  // ARMv7 NEON has no exact square root, so the distance is tested per lane
+  int iMask = 0xf;
+  if (bTestDistance)
+  {
+    for (int j=0; j<DECORATIONCLUSTER_BLOCKSIZE; j++)
+    {
+      const float dx = (pBlock[j] + t.x) - vLODPos.x;
+      const float dy = (pBlock[j+4] + t.y) - vLODPos.y;
+      const float dz = (pBlock[j+8] + t.z) - vLODPos.z;
+      if (hkvMath::sqrt(dx*dx + dy*dy + dz*dz)*fDistanceScale > fUnscaledMaxDist*pBlock[j+12])
+        iMask &= ~(1<<j);
+    }
+  }
+  if (iPlaneFlags == 0 || iMask == 0)
+    return iMask;
+
+  const float32x4_t tx = vdupq_n_f32(t.x);
+  const float32x4_t ty = vdupq_n_f32(t.y);
+  const float32x4_t tz = vdupq_n_f32(t.z);
+  const float32x4_t minX = vaddq_f32(vld1q_f32(pBlock + 16), tx);
+  const float32x4_t minY = vaddq_f32(vld1q_f32(pBlock + 20), ty);
+  const float32x4_t minZ = vaddq_f32(vld1q_f32(pBlock + 24), tz);
+  const float32x4_t maxX = vaddq_f32(vld1q_f32(pBlock + 28), tx);
+  const float32x4_t maxY = vaddq_f32(vld1q_f32(pBlock + 32), ty);
+  const float32x4_t maxZ = vaddq_f32(vld1q_f32(pBlock + 36), tz);
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  uint32x4_t inside = vdupq_n_u32(0xffffffff);
+  for (unsigned int i=0; i<iNumPlanes; i++)
+  {
+    if (!(iPlaneFlags & (1<<i)))
+      continue;
+    const hkvPlane *pPlane = pFrustum->GetPlane(i);
+    const float32x4_t a = vdupq_n_f32(pPlane->m_vNormal.x);
+    const float32x4_t b = vdupq_n_f32(pPlane->m_vNormal.y);
+    const float32x4_t c = vdupq_n_f32(pPlane->m_vNormal.z);
+    const float32x4_t d = vdupq_n_f32(pPlane->m_fNegDist);
+    float32x4_t r = vaddq_f32(vminq_f32(vmulq_f32(minX,a), vmulq_f32(maxX,a)), vminq_f32(vmulq_f32(minY,b), vmulq_f32(maxY,b)));
+    r = vaddq_f32(vaddq_f32(r, vminq_f32(vmulq_f32(minZ,c), vmulq_f32(maxZ,c))), d);
+    inside = vandq_u32(inside, vcltq_f32(r, zero));
+  }
+  const uint32x4_t m = vshrq_n_u32(inside, 31);
+  return iMask & (int)(vgetq_lane_u32(m,0) | (vgetq_lane_u32(m,1)<<1) | (vgetq_lane_u32(m,2)<<2) | (vgetq_lane_u32(m,3)<<3));
+
+#else
+  int iMask = 0xf;
+  for (int j=0; j<DECORATIONCLUSTER_BLOCKSIZE; j++)
+  {
+    if (bTestDistance)
+    {
+      const float dx = (pBlock[j] + t.x) - vLODPos.x;
+      const float dy = (pBlock[j+4] + t.y) - vLODPos.y;
+      const float dz = (pBlock[j+8] + t.z) - vLODPos.z;
+      if (hkvMath::sqrt(dx*dx + dy*dy + dz*dz)*fDistanceScale > fUnscaledMaxDist*pBlock[j+12])
+      {
+        iMask &= ~(1<<j);
+        continue;
+      }
+    }
+    for (unsigned int i=0; i<iNumPlanes; i++)
+    {
+      if (!(iPlaneFlags & (1<<i)))
+        continue;
+      const hkvPlane *pPlane = pFrustum->GetPlane(i);
+      float r = hkvMath::Min((pBlock[j+16]+t.x)*pPlane->m_vNormal.x, (pBlock[j+28]+t.x)*pPlane->m_vNormal.x)
+              + hkvMath::Min((pBlock[j+20]+t.y)*pPlane->m_vNormal.y, (pBlock[j+32]+t.y)*pPlane->m_vNormal.y)
+              + hkvMath::Min((pBlock[j+24]+t.z)*pPlane->m_vNormal.z, (pBlock[j+36]+t.z)*pPlane->m_vNormal.z)
+              + pPlane->m_fNegDist;
+      if (!(r < 0.f))
+      {
+        iMask &= ~(1<<j);
+        break;
+      }
+    }
+  }
+  return iMask;
+#endif
+}
+
+
+VTerrainDecorationClusterTree::VTerrainDecorationClusterTree() :
+  m_PackedData(0, 0.f), m_SlotInstance(0, -1), m_InstanceCluster(0, -1)
+{
+  m_pSourceInstances = NULL;
+  m_iSourceCount = 0;
+  m_iNodeCount = 0;
+  m_iSlotCount = 0;
+}
+
+VTerrainDecorationClusterTree::~VTerrainDecorationClusterTree()
+{
+}
+
+void VTerrainDecorationClusterTree::Reset()
+{
+  m_pSourceInstances = NULL;
+  m_iSourceCount = 0;
+  m_iNodeCount = 0;
+  m_iSlotCount = 0;
+  m_Nodes.Reset();
+  m_PackedData.Reset();
+  m_SlotInstance.Reset();
+  m_InstanceCluster.Reset();
+}
+
+size_t VTerrainDecorationClusterTree::GetMemSize() const
+{
+  return m_Nodes.GetMemSize() + m_PackedData.GetMemSize() + m_SlotInstance.GetMemSize() + m_InstanceCluster.GetMemSize();
+}
+
+
+bool VTerrainDecorationClusterTree::Build(const VTerrainDecorationInstance *pInstances, int iCount)
+{
+  Reset();
+
+  // all instance boxes are needed up front
+  for (int i=0; i<iCount; i++)
+  {
+    const IVTerrainDecorationModel *pModel = pInstances[i].m_spModel;
+    if (pModel!=NULL && !pModel->m_LocalBBox.isValid())
+      return false;
+  }
+
+  DynArray_cl<hkvVec3> pivots(iCount);
+  DynArray_cl<int> order(iCount);
+  int iValidCount = 0;
+  for (int i=0; i<iCount; i++)
+  {
+    pivots.GetDataPtr()[i] = pInstances[i].m_vPosition;
+    if (pInstances[i].m_spModel!=NULL)
+      order.GetDataPtr()[iValidCount++] = i;
+  }
+  m_pSourceInstances = pInstances;
+  m_iSourceCount = iCount;
+  m_InstanceCluster.EnsureSize(iCount);
+  int *pInstanceCluster = m_InstanceCluster.GetDataPtr();
+  for (int i=0; i<iCount; i++)
+    pInstanceCluster[i] = -1;
+  if (iValidCount == 0)
+    return true;
+
+  // leaves hold at least DECORATIONCLUSTER_MAX_INSTANCES/4 instances, so this is an upper bound for the node count
+  m_Nodes.EnsureSize(iValidCount/8 + 2);
+  BuildNode(order.GetDataPtr(), 0, iValidCount, pivots.GetDataPtr());
+
+  // Assign the packed slots. Children always have higher indices than their parent and leaves are created in the order of
+  // their instance ranges, so the leaves are visited in slot order and a reverse loop visits the children before their parent.
+  Node_t *pNodes = m_Nodes.GetDataPtr();
+  for (int iNode=0; iNode<m_iNodeCount; iNode++)
+  {
+    if (pNodes[iNode].m_iChild[0] < 0)
+      m_iSlotCount += (pNodes[iNode].m_iSlotCount + DECORATIONCLUSTER_BLOCKSIZE-1) & ~(DECORATIONCLUSTER_BLOCKSIZE-1);
+  }
+
+  m_PackedData.EnsureSize(m_iSlotCount/DECORATIONCLUSTER_BLOCKSIZE*DECORATIONCLUSTER_BLOCKFLOATS);
+  m_SlotInstance.EnsureSize(m_iSlotCount);
+  float *pPacked = m_PackedData.GetDataPtr();
+  int *pSlotInstance = m_SlotInstance.GetDataPtr();
+  const int *pOrder = order.GetDataPtr();
+
+  int iSlot = 0;
+  for (int iNode=0; iNode<m_iNodeCount; iNode++)
+  {
+    Node_t &node = pNodes[iNode];
+    if (node.m_iChild[0] >= 0)
+      continue;
+
+    // while building, leaves store their range in the order array
+    const int iFirst = node.m_iFirstSlot;
+    const int iNodeCount = node.m_iSlotCount;
+    node.m_iFirstSlot = iSlot;
+    node.m_iSlotCount = (iNodeCount + DECORATIONCLUSTER_BLOCKSIZE-1) & ~(DECORATIONCLUSTER_BLOCKSIZE-1);
+
+    for (int j=0; j<node.m_iSlotCount; j++, iSlot++)
+    {
+      float *pBlock = &pPacked[(iSlot/DECORATIONCLUSTER_BLOCKSIZE)*DECORATIONCLUSTER_BLOCKFLOATS];
+      const int iLane = iSlot & (DECORATIONCLUSTER_BLOCKSIZE-1);
+      if (j >= iNodeCount)
+      {
+        // unused slot at the end of a leaf; never visible
+        pSlotInstance[iSlot] = -1;
+        for (int k=0; k<10; k++)
+          pBlock[k*DECORATIONCLUSTER_BLOCKSIZE + iLane] = 0.f;
+        pBlock[12 + iLane] = -1.f;
+        continue;
+      }
+
+      const int iInstance = pOrder[iFirst + j];
+      const VTerrainDecorationInstance &inst = pInstances[iInstance];
+      hkvAlignedBBox box(hkvNoInitialization);
+      inst.GetRenderBoundingBox(box, hkvVec3::ZeroVector());
+
+      pSlotInstance[iSlot] = iInstance;
+      pInstanceCluster[iInstance] = iNode;
+      pBlock[iLane]      = inst.m_vPosition.x;
+      pBlock[iLane + 4]  = inst.m_vPosition.y;
+      pBlock[iLane + 8]  = inst.m_vPosition.z;
+      pBlock[iLane + 12] = GetInstanceScaling(inst);
+      pBlock[iLane + 16] = box.m_vMin.x;
+      pBlock[iLane + 20] = box.m_vMin.y;
+      pBlock[iLane + 24] = box.m_vMin.z;
+      pBlock[iLane + 28] = box.m_vMax.x;
+      pBlock[iLane + 32] = box.m_vMax.y;
+      pBlock[iLane + 36] = box.m_vMax.z;
+    }
+  }
+  VASSERT(iSlot == m_iSlotCount);
+
+  for (int iNode=m_iNodeCount-1; iNode>=0; iNode--)
+  {
+    Node_t &node = pNodes[iNode];
+    if (node.m_iChild[0] < 0)
+      continue;
+    int iEnd = node.m_iFirstSlot = pNodes[node.m_iChild[0]].m_iFirstSlot;
+    for (int i=0; i<4; i++)
+      iEnd = pNodes[node.m_iChild[i]].m_iFirstSlot + pNodes[node.m_iChild[i]].m_iSlotCount;
+    node.m_iSlotCount = iEnd - node.m_iFirstSlot;
+  }
+
+  return true;
+}
+
+
+int VTerrainDecorationClusterTree::BuildNode(int *pOrder, int iFirst, int iCount, const hkvVec3 *pPivots)
+{
+  VASSERT(m_iNodeCount < (int)m_Nodes.GetSize());
+  const int iNode = m_iNodeCount++;
+
+  if (iCount <= DECORATIONCLUSTER_MAX_INSTANCES)
+  {
+    Node_t &node = m_Nodes.GetDataPtr()[iNode];
+    node.m_Box.setInvalid();
+    node.m_PivotBox.setInvalid();
+    node.m_fMinScaling = FLT_MAX;
+    node.m_fMaxScaling = -FLT_MAX;
+    for (int i=0; i<iCount; i++)
+    {
+      const VTerrainDecorationInstance &inst = m_pSourceInstances[pOrder[iFirst + i]];
+      hkvAlignedBBox box(hkvNoInitialization);
+      inst.GetRenderBoundingBox(box, hkvVec3::ZeroVector());
+      node.m_Box.expandToInclude(box);
+      node.m_PivotBox.expandToInclude(inst.m_vPosition);
+      node.m_fMinScaling = hkvMath::Min(node.m_fMinScaling, GetInstanceScaling(inst));
+      node.m_fMaxScaling = hkvMath::Max(node.m_fMaxScaling, GetInstanceScaling(inst));
+    }
+    for (int i=0; i<4; i++)
+      node.m_iChild[i] = -1;
+    node.m_iFirstSlot = iFirst; // converted to the slot range once all leaves are known
+    node.m_iSlotCount = iCount;
+    return iNode;
+  }
+
+  // split into quadrants at the median x position and the median y positions of both halves, which keeps the tree balanced
+  int *pNodeOrder = pOrder + iFirst;
+  const int iHalf = iCount / 2;
+  SelectNthPivot(pNodeOrder, iCount, iHalf, pPivots, 0);
+  SelectNthPivot(pNodeOrder, iHalf, iHalf/2, pPivots, 1);
+  SelectNthPivot(pNodeOrder + iHalf, iCount - iHalf, (iCount - iHalf)/2, pPivots, 1);
+
+  int iChild[4];
+  iChild[0] = BuildNode(pOrder, iFirst, iHalf/2, pPivots);
+  iChild[1] = BuildNode(pOrder, iFirst + iHalf/2, iHalf - iHalf/2, pPivots);
+  iChild[2] = BuildNode(pOrder, iFirst + iHalf, (iCount - iHalf)/2, pPivots);
+  iChild[3] = BuildNode(pOrder, iFirst + iHalf + (iCount - iHalf)/2, iCount - iHalf - (iCount - iHalf)/2, pPivots);
+
+  Node_t &node = m_Nodes.GetDataPtr()[iNode];
+  node.m_Box.setInvalid();
+  node.m_PivotBox.setInvalid();
+  node.m_fMinScaling = FLT_MAX;
+  node.m_fMaxScaling = -FLT_MAX;
+  for (int i=0; i<4; i++)
+  {
+    const Node_t &child = m_Nodes.GetDataPtr()[iChild[i]];
+    node.m_Box.expandToInclude(child.m_Box);
+    node.m_PivotBox.expandToInclude(child.m_PivotBox);
+    node.m_fMinScaling = hkvMath::Min(node.m_fMinScaling, child.m_fMinScaling);
+    node.m_fMaxScaling = hkvMath::Max(node.m_fMaxScaling, child.m_fMaxScaling);
+    node.m_iChild[i] = iChild[i];
+  }
+  return iNode;
+}
+
+
+void VTerrainDecorationClusterTree::TestVisible(const VisFrustum_cl *pFrustum, const hkvVec3 &vLODPos, float fDistanceScale,
+  float fUnscaledMaxDist, const hkvVec3 &vTranslate, unsigned int *pMask, int &iFirstVisible, int &iLastVisible) const
+{
+  if (m_iNodeCount == 0)
+    return;
+
+  TestParams_t params;
+  params.m_pFrustum = pFrustum;
+  params.m_vLODPos = vLODPos;
+  params.m_vTranslate = vTranslate;
+  params.m_fDistanceScale = fDistanceScale;
+  params.m_fUnscaledMaxDist = fUnscaledMaxDist;
+  params.m_pMask = pMask;
+  params.m_pFirstVisible = &iFirstVisible;
+  params.m_pLastVisible = &iLastVisible;
+
+  const int iPlaneFlags = (pFrustum!=NULL) ? (1<<pFrustum->GetNumPlanes())-1 : 0;
+  TestNode(params, 0, iPlaneFlags, true);
+}
+
+
+void VTerrainDecorationClusterTree::TestNode(const TestParams_t &params, int iNode, int iPlaneFlags, bool bTestDistance) const
+{
+  const Node_t &node = m_Nodes.GetDataPtr()[iNode];
+  const hkvVec3 &t = params.m_vTranslate;
+
+  if (bTestDistance)
+  {
+    // far clip distance of the nearest and the farthest pivot position inside the node
+    const hkvVec3 vMin = node.m_PivotBox.m_vMin + t - params.m_vLODPos;
+    const hkvVec3 vMax = node.m_PivotBox.m_vMax + t - params.m_vLODPos;
+    hkvVec3 vNearest(hkvNoInitialization), vFarthest(hkvNoInitialization);
+    for (int i=0; i<3; i++)
+    {
+      vNearest.data[i] = (vMin.data[i] > 0.f) ? vMin.data[i] : ((vMax.data[i] < 0.f) ? vMax.data[i] : 0.f);
+      vFarthest.data[i] = hkvMath::Max(hkvMath::Abs(vMin.data[i]), hkvMath::Abs(vMax.data[i]));
+    }
+    if (vNearest.getLength()*params.m_fDistanceScale > params.m_fUnscaledMaxDist*node.m_fMaxScaling*DECORATIONCLUSTER_REJECT_TOLERANCE)
+      return;
+    if (vFarthest.getLength()*params.m_fDistanceScale < params.m_fUnscaledMaxDist*node.m_fMinScaling*DECORATIONCLUSTER_ACCEPT_TOLERANCE)
+      bTestDistance = false;
+  }
+
+  if (iPlaneFlags != 0)
+  {
+    hkvAlignedBBox box(node.m_Box.m_vMin + t, node.m_Box.m_vMax + t);
+    if (params.m_pFrustum->ClassifyPlanes(box, iPlaneFlags) == VIS_CLIPPINGRESULT_ALLCLIPPED)
+      return;
+  }
+
+  if (iPlaneFlags == 0 && !bTestDistance)
+  {
+    // all instances of the node are visible
+    const int *pSlotInstance = m_SlotInstance.GetDataPtr() + node.m_iFirstSlot;
+    for (int i=0; i<node.m_iSlotCount; i++)
+    {
+      const int iInstance = pSlotInstance[i];
+      if (iInstance < 0)
+        continue;
+      params.m_pMask[iInstance / 32] |= (1 << (iInstance & 31));
+      *params.m_pFirstVisible = hkvMath::Min(*params.m_pFirstVisible, iInstance);
+      *params.m_pLastVisible = hkvMath::Max(*params.m_pLastVisible, iInstance);
+    }
+    return;
+  }
+
+  if (node.m_iChild[0] < 0)
+  {
+    TestLeaf(params, node, iPlaneFlags, bTestDistance);
+    return;
+  }
+
+  for (int i=0; i<4; i++)
+    TestNode(params, node.m_iChild[i], iPlaneFlags, bTestDistance);
+}
+
+
+void VTerrainDecorationClusterTree::TestLeaf(const TestParams_t &params, const Node_t &node, int iPlaneFlags, bool bTestDistance) const
+{
+  const int iFirstBlock = node.m_iFirstSlot / DECORATIONCLUSTER_BLOCKSIZE;
+  const int iBlockCount = node.m_iSlotCount / DECORATIONCLUSTER_BLOCKSIZE;
+  const float *pBlock = m_PackedData.GetDataPtr() + iFirstBlock*DECORATIONCLUSTER_BLOCKFLOATS;
+  const int *pSlotInstance = m_SlotInstance.GetDataPtr() + node.m_iFirstSlot;
+
+  for (int b=0; b<iBlockCount; b++, pBlock+=DECORATIONCLUSTER_BLOCKFLOATS, pSlotInstance+=DECORATIONCLUSTER_BLOCKSIZE)
+  {
+    const int iMask = GetPackedVisibleMask(params.m_pFrustum, iPlaneFlags, bTestDistance, params.m_vLODPos, params.m_vTranslate,
+      params.m_fDistanceScale, params.m_fUnscaledMaxDist, pBlock);
+    if (iMask == 0)
+      continue;
+
+    for (int j=0; j<DECORATIONCLUSTER_BLOCKSIZE; j++)
+    {
+      const int iInstance = pSlotInstance[j];
+      if ((iMask & (1<<j)) == 0 || iInstance < 0)
+        continue;
+      params.m_pMask[iInstance / 32] |= (1 << (iInstance & 31));
+      *params.m_pFirstVisible = hkvMath::Min(*params.m_pFirstVisible, iInstance);
+      *params.m_pLastVisible = hkvMath::Max(*params.m_pLastVisible, iInstance);
+    }
+  }
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
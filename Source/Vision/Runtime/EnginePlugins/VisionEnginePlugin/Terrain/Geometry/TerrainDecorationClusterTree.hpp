@@ -0,0 +1,142 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file TerrainDecorationClusterTree.hpp
+
+#ifndef TERRAINDECORATIONCLUSTERTREE_HPP_INCLUDED
+#define TERRAINDECORATIONCLUSTERTREE_HPP_INCLUDED
+
+class VTerrainDecorationInstance;
+
+/// \brief
+///   Number of instances up to which a node of a VTerrainDecorationClusterTree is not split any further
+#define DECORATIONCLUSTER_MAX_INSTANCES   64
+
+
+/// \brief
+///   Quadtree of instance clusters, used by VTerrainDecorationGroup to cull its instances
+///
+/// The instances of a group are recursively split into four quadrants (at the median x and y position of the
+/// instance pivots) until a node holds at most DECORATIONCLUSTER_MAX_INSTANCES instances. Each node stores the bounding
+/// box of its instances, the bounding box of their pivots and the range of their instance scaling, so a whole node can
+/// be rejected or accepted by a single frustum and far clip test.
+///
+/// The instances of the leaves are stored in a packed structure-of-arrays layout in blocks of 4 (pivot, scaling and
+/// bounding box), so the remaining per-instance tests handle 4 instances at a time with SSE or NEON. The tests produce
+/// the same results as testing each instance with GetRenderDistanceSqr and VisFrustum_cl::Overlaps.
+///
+/// The tree references instances by their index in the group's instance array; the array itself is not reordered.
+/// All boxes are stored relative to the group position at export time. The offset of a repositioned group is passed to
+/// the query functions.
+class VTerrainDecorationClusterTree
+{
+public:
+  TERRAIN_IMPEXP VTerrainDecorationClusterTree();
+  TERRAIN_IMPEXP ~VTerrainDecorationClusterTree();
+
+  /// \brief
+  ///   Builds the tree. Instances without a model are left out and never returned as visible.
+  ///
+  /// \return
+  ///   false if a model of the instances does not have a valid bounding box yet. The tree is empty in that case.
+  TERRAIN_IMPEXP bool Build(const VTerrainDecorationInstance *pInstances, int iCount);
+
+  /// \brief
+  ///   Releases all data
+  TERRAIN_IMPEXP void Reset();
+
+  /// \brief
+  ///   Indicates whether the tree has been built for the passed instance array
+  inline bool IsBuiltFor(const VTerrainDecorationInstance *pInstances, int iCount) const
+  {
+    return m_pSourceInstances!=NULL && m_pSourceInstances==pInstances && m_iSourceCount==iCount;
+  }
+
+  /// \brief
+  ///   Sets the bits of all visible instances in a bitmask (bit i%32 of pMask[i/32] refers to instance i)
+  ///
+  /// An instance is visible if fDistance*fDistanceScale does not exceed fUnscaledMaxDist times its scaling, where
+  /// fDistance is the distance of its pivot to vLODPos, and if its bounding box overlaps the frustum. pFrustum can be NULL.
+  ///
+  /// \param iFirstVisible
+  ///   In/Out: Smallest visible instance index
+  ///
+  /// \param iLastVisible
+  ///   In/Out: Largest visible instance index
+  TERRAIN_IMPEXP void TestVisible(const VisFrustum_cl *pFrustum, const hkvVec3 &vLODPos, float fDistanceScale, float fUnscaledMaxDist,
+    const hkvVec3 &vTranslate, unsigned int *pMask, int &iFirstVisible, int &iLastVisible) const;
+
+  /// \brief
+  ///   Returns the number of nodes
+  inline int GetNodeCount() const {return m_iNodeCount;}
+
+  /// \brief
+  ///   Returns the leaf node an instance is stored in, or -1 for instances that have been left out
+  inline int GetInstanceCluster(int iInstance) const
+  {
+    VASSERT(iInstance>=0 && iInstance<m_iSourceCount);
+    return m_InstanceCluster.GetDataPtr()[iInstance];
+  }
+
+  /// \brief
+  ///   Returns the bounding box of a node (not including the offset passed to the query functions)
+  inline const hkvAlignedBBox& GetClusterBoundingBox(int iNode) const
+  {
+    VASSERT(iNode>=0 && iNode<m_iNodeCount);
+    return m_Nodes.GetDataPtr()[iNode].m_Box;
+  }
+
+  /// \brief
+  ///   Returns the memory allocated for the tree
+  TERRAIN_IMPEXP size_t GetMemSize() const;
+
+protected:
+  /// \brief
+  ///   Tree node. Leaves have m_iChild[0]==-1. Each node references the packed slots m_iFirstSlot..m_iFirstSlot+m_iSlotCount-1,
+  ///   which include the slots of all its children. Slot ranges of leaves start at a block boundary.
+  struct Node_t
+  {
+    hkvAlignedBBox m_Box;       ///< union of the instance bounding boxes
+    hkvAlignedBBox m_PivotBox;  ///< union of the instance pivots
+    float m_fMinScaling, m_fMaxScaling;
+    int m_iChild[4];
+    int m_iFirstSlot, m_iSlotCount;
+  };
+
+  struct TestParams_t;
+
+  int BuildNode(int *pOrder, int iFirst, int iCount, const hkvVec3 *pPivots);
+  void TestNode(const TestParams_t &params, int iNode, int iPlaneFlags, bool bTestDistance) const;
+  void TestLeaf(const TestParams_t &params, const Node_t &node, int iPlaneFlags, bool bTestDistance) const;
+
+  const VTerrainDecorationInstance *m_pSourceInstances;
+  int m_iSourceCount;
+  int m_iNodeCount;
+  int m_iSlotCount;
+  DynArray_cl<Node_t> m_Nodes;
+  DynArray_cl<float> m_PackedData;    ///< per block of 4 slots: pivot x,y,z, scaling, box min x,y,z, box max x,y,z (4 floats each)
+  DynArray_cl<int> m_SlotInstance;    ///< instance index per packed slot, -1 for unused slots
+  DynArray_cl<int> m_InstanceCluster; ///< leaf node per instance, -1 for instances that have been left out
+};
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
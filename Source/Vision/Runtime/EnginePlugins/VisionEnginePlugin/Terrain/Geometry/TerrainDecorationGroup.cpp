@@ -20,6 +20,8 @@
 
 
 DynArray_cl<VTerrainDecorationInstance *> VTerrainDecorationGroup::g_VisibleInstances(0,NULL); // only needed while rendering
+DynArray_cl<char> VTerrainDecorationGroup::g_ClusterShadowState(0,0); // only needed while rendering
+bool VTerrainDecorationGroup::g_bUseClusteredCulling = true;
 hkvVec3 VTerrainDecorationGroup::g_vGlobalRenderOffset; // for repositioning
 
 
@@ -38,6 +40,7 @@ VTerrainDecorationGroup::VTerrainDecorationGroup(bool bRegister)
   m_fMax3DDistance = m_fUnscaledMaxDist = -1;
   m_pDecoOfTerrain = NULL;
   m_bUseCollisions = m_bCastLightmapShadows = true;
+  m_bClusterTreeDirty = true;
 }
 
 
@@ -65,6 +68,8 @@ void VTerrainDecorationGroup::DisposeObject()
   VisVisibilityObjectAABox_cl::DisposeObject();
   FreeAllVisStates();
   m_Instances.Free();
+  m_ClusterTree.Reset();
+  m_bClusterTreeDirty = true;
 
   bool bOldRegistered = m_bIsRegistered;
   m_bIsRegistered = false;
@@ -128,6 +133,22 @@ VTerrainDecorationGroup::VCollectorVisibleState* VTerrainDecorationGroup::Create
 }
 
 
+bool VTerrainDecorationGroup::EnsureClusterTree()
+{
+  // several collectors may test this group at the same time, so the flag is only read inside the lock
+  m_VisibilityMutex.Lock();
+  if (m_bClusterTreeDirty || !m_ClusterTree.IsBuiltFor(m_Instances.m_pInstances, m_Instances.m_iCount))
+  {
+    // fails while the model is not loaded yet; try again next time
+    if (m_ClusterTree.Build(m_Instances.m_pInstances, m_Instances.m_iCount))
+      m_bClusterTreeDirty = false;
+  }
+  const bool bResult = !m_bClusterTreeDirty;
+  m_VisibilityMutex.Unlock();
+  return bResult;
+}
+
+
 BOOL VTerrainDecorationGroup::OnTestVisible(IVisVisibilityCollector_cl *pCollector, const VisFrustum_cl *pFrustum)
 {
   // VISION_PROFILE_FUNCTION(VSpeedTreeManager::PROFILING_VISIBILITY);
@@ -172,6 +193,15 @@ BOOL VTerrainDecorationGroup::OnTestVisible(IVisVisibilityCollector_cl *pCollect
     return TRUE;
 
   const hkvVec3 vTranslate = GetPosition() - m_vPositionBackup;
+
+  // reject and accept whole instance clusters; the remaining instances are tested 4 at a time
+  if (g_bUseClusteredCulling && EnsureClusterTree())
+  {
+    m_ClusterTree.TestVisible(pFrustum, vLODPos, fDistanceScale, m_fUnscaledMaxDist, vTranslate, pMask,
+      pState->m_iFirstRelevantBit, pState->m_iLastRelevantBit);
+    return TRUE;
+  }
+
   VTerrainDecorationInstance *pInst = m_Instances.m_pInstances;
   
   for (int i = 0; i < m_Instances.m_iCount; i++, pInst++)
@@ -219,6 +249,16 @@ void VTerrainDecorationGroup::RenderVisibleInstancesToShadowMap(IVisVisibilityCo
   int iInstCount = 0;
   const unsigned int* pMask = &pState->m_iFirstMask;
 
+  // the cluster boxes are tested on demand: 0 = not tested yet, 1 = may cast a shadow into the view frustum, 2 = rejected
+  const bool bUseClusters = g_bUseClusteredCulling && !m_bClusterTreeDirty && m_ClusterTree.IsBuiltFor(m_Instances.m_pInstances, m_Instances.m_iCount);
+  char *pClusterState = NULL;
+  if (bUseClusters && m_ClusterTree.GetNodeCount() > 0)
+  {
+    g_ClusterShadowState.EnsureSize(m_ClusterTree.GetNodeCount());
+    pClusterState = g_ClusterShadowState.GetDataPtr();
+    memset(pClusterState, 0, m_ClusterTree.GetNodeCount());
+  }
+
   // loop through all relevant integers
   const int iFirstRelevantInt = pState->m_iFirstRelevantBit / 32;
   const int iLastRelevantInt = pState->m_iLastRelevantBit / 32;
@@ -240,6 +280,20 @@ void VTerrainDecorationGroup::RenderVisibleInstancesToShadowMap(IVisVisibilityCo
       if ((iMask32 & (1 << (b & 31))) == 0)
         continue;
 
+      const int iCluster = (pClusterState != NULL) ? m_ClusterTree.GetInstanceCluster(b) : -1;
+      if (iCluster >= 0)
+      {
+        if (pClusterState[iCluster] == 0)
+        {
+          const hkvAlignedBBox &clusterBox = m_ClusterTree.GetClusterBoundingBox(iCluster);
+          const hkvAlignedBBox absClusterBox(clusterBox.m_vMin + vTranslate, clusterBox.m_vMax + vTranslate);
+          pClusterState[iCluster] = Vision::RenderLoopHelper.CompareLightFrustumDistances(absClusterBox,
+            pShadowMapGenerator->GetMainFrustum(), pfLightFrustumDistances) ? 1 : 2;
+        }
+        if (pClusterState[iCluster] == 2)
+          continue;
+      }
+
       hkvAlignedBBox instanceBox(hkvNoInitialization);
       m_Instances.m_pInstances[b].GetRenderBoundingBox(instanceBox, vTranslate);
       if (!Vision::RenderLoopHelper.CompareLightFrustumDistances(instanceBox, 
@@ -330,6 +384,8 @@ VTerrainDecorationInstanceCollection& VTerrainDecorationGroup::BeginUpdateInstan
     pPM->OnDecorationRemoved(m_Instances);
 
   FreeAllVisStates();
+  m_ClusterTree.Reset();
+  m_bClusterTreeDirty = true;
   return m_Instances;
 }
 
@@ -364,6 +420,7 @@ void VTerrainDecorationGroup::EndUpdateInstances()
   SetWorldSpaceBoundingBox(bbox);
   m_bIsWorldSpaceBBox = false; // make it movable for re-positioning
   ReComputeVisibility();
+  m_bClusterTreeDirty = true;
   if (Vision::Editor.IsInEditor())
     BackupPosition();
   CalcMax3DDistance();
@@ -461,6 +518,8 @@ void VTerrainDecorationGroup::Serialize( VArchive &ar )
     if (m_fMax3DDistance<0.f) // not serialized? Then test now
       CalcMax3DDistance();
     m_bIsWorldSpaceBBox = false; // make it movable for re-positioning
+    m_ClusterTree.Reset();
+    m_bClusterTreeDirty = true; // built on the first visibility test, when the model has been loaded
   }
   else
   {
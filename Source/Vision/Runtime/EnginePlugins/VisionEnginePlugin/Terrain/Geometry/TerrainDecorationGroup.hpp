@@ -14,6 +14,7 @@
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/TerrainModule.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationModel.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationInstance.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationClusterTree.hpp>
 
 #define DEFAULT_NUM_VISIBILITY_COLLECTORS   16
 
@@ -98,6 +99,22 @@ public:
   ///Internal function to render a batch of instances associated with the passed collector into a shadow map (performs additional visibility/relevance tests)
   TERRAIN_IMPEXP void RenderVisibleInstancesToShadowMap(IVisVisibilityCollector_cl *pCollector, VShadowMapGenerator *pShadowMapGenerator, float *pfLightFrustumDistances);
 
+  /// \brief
+  ///   Globally enables or disables culling the instances of all groups by instance clusters (see VTerrainDecorationClusterTree). Enabled by default.
+  ///
+  /// If disabled, each instance is tested separately. Both ways return the same visible instances; this is mainly useful for profiling.
+  static inline void SetUseClusteredCulling(bool bStatus)
+  {
+    g_bUseClusteredCulling = bStatus;
+  }
+
+  /// \brief
+  ///   Returns the state previously set with SetUseClusteredCulling
+  static inline bool GetUseClusteredCulling()
+  {
+    return g_bUseClusteredCulling;
+  }
+
 
   ///
   /// @}
@@ -273,14 +290,19 @@ protected:
   VCollectorVisibleState* FindVisStateForCollector(IVisVisibilityCollector_cl* pColl);
   VCollectorVisibleState* CreateVisStateForCollector(IVisVisibilityCollector_cl* pColl);
   void CalcMax3DDistance();
+  bool EnsureClusterTree();
 
   VMutex m_VisibilityMutex;
   int m_iVisStateCount;
   VMemoryTempBuffer<DEFAULT_NUM_VISIBILITY_COLLECTORS * sizeof(VCollectorVisibleState*)> m_VisStates;
   bool m_bUseLightgrid, m_bIsRegistered;
   hkvVec3 m_vPositionBackup; // position at export time (for repositioning)
+  VTerrainDecorationClusterTree m_ClusterTree; ///< built on the first visibility test after the instances changed
+  bool m_bClusterTreeDirty;
   static hkvVec3 g_vGlobalRenderOffset; // for repositioning
   static DynArray_cl<VTerrainDecorationInstance *>g_VisibleInstances; ///< only needed while rendering
+  static DynArray_cl<char>g_ClusterShadowState; ///< only needed while rendering
+  static bool g_bUseClusteredCulling;
 };
 
 
@@ -0,0 +1,335 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/VisionEnginePluginPCH.h>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Application/TerrainConfig.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainQuantizedHeightmap.hpp>
+
+
+VTerrainQuantizedHeightmap::VTerrainQuantizedHeightmap()
+{
+  m_iSamples[0] = m_iSamples[1] = 0;
+  m_iStrideX = m_iRows = 0;
+  m_fBase = m_fScale = 0.f;
+  m_fMinHeight = m_fMaxHeight = 0.f;
+  m_pValues = NULL;
+  m_pEdges = NULL;
+}
+
+VTerrainQuantizedHeightmap::~VTerrainQuantizedHeightmap()
+{
+  Reset();
+}
+
+void VTerrainQuantizedHeightmap::Reset()
+{
+  V_SAFE_DELETE_ARRAY(m_pValues);
+  V_SAFE_DELETE_ARRAY(m_pEdges);
+  m_iSamples[0] = m_iSamples[1] = 0;
+  m_iStrideX = m_iRows = 0;
+}
+
+void VTerrainQuantizedHeightmap::Allocate(int iSamplesX, int iSamplesY)
+{
+  VASSERT(iSamplesX>0 && iSamplesY>0);
+  Reset();
+  m_iSamples[0] = iSamplesX;
+  m_iSamples[1] = iSamplesY;
+  m_iStrideX = iSamplesX+2;
+  m_iRows = iSamplesY+2;
+  m_pValues = new unsigned short[GetSampleCount()];
+  m_pEdges = new float[GetEdgeCount()];
+}
+
+
+void VTerrainQuantizedHeightmap::Quantize(const float *pHeight, int iSamplesX, int iSamplesY)
+{
+  VASSERT(pHeight);
+  Allocate(iSamplesX, iSamplesY);
+  const int iCount = GetSampleCount();
+
+  float fMin = pHeight[0];
+  float fMax = pHeight[0];
+  for (int i=1;i<iCount;i++)
+  {
+    fMin = hkvMath::Min(fMin,pHeight[i]);
+    fMax = hkvMath::Max(fMax,pHeight[i]);
+  }
+
+  m_fBase = fMin;
+  m_fScale = (fMax-fMin)/65535.f;
+  const float fInvScale = (m_fScale>0.f) ? (1.f/m_fScale) : 0.f;
+  for (int i=0;i<iCount;i++)
+  {
+    int iValue = (int)((pHeight[i]-m_fBase)*fInvScale + 0.5f);
+    m_pValues[i] = (unsigned short)hkvMath::clamp(iValue,0,65535);
+  }
+
+  // keep the shared sector edges exact
+  float *pEdge = m_pEdges;
+  memcpy(pEdge, pHeight, m_iStrideX*sizeof(float));
+  pEdge += m_iStrideX;
+  memcpy(pEdge, &pHeight[m_iSamples[1]*m_iStrideX], m_iStrideX*sizeof(float));
+  pEdge += m_iStrideX;
+  for (int y=0;y<m_iRows;y++)
+    pEdge[y] = pHeight[y*m_iStrideX];
+  pEdge += m_iRows;
+  for (int y=0;y<m_iRows;y++)
+    pEdge[y] = pHeight[y*m_iStrideX+m_iSamples[0]];
+
+  ComputeHeightRange();
+}
+
+
+void VTerrainQuantizedHeightmap::ComputeHeightRange()
+{
+  // the range is computed from the quantized values, so it encloses exactly what GetHeightAt returns.
+  // Note that the extra border must not be considered
+  m_fMinHeight = m_fMaxHeight = GetHeightAt(0,0);
+  for (int y=0;y<=m_iSamples[1];y++)
+    for (int x=0;x<=m_iSamples[0];x++)
+    {
+      const float h = GetHeightAt(x,y);
+      m_fMinHeight = hkvMath::Min(m_fMinHeight,h);
+      m_fMaxHeight = hkvMath::Max(m_fMaxHeight,h);
+    }
+}
+
+
+// Each value is predicted from its neighbors (left + up - upper left, i.e. a locally planar terrain). The
+// difference to the prediction is zigzag encoded and written with 7 bits per byte, the highest bit marks
+// that another byte follows. Returns the number of bytes written; pDest must hold 3 bytes per sample.
+int VTerrainQuantizedHeightmap::EncodeDeltas(unsigned char *pDest) const
+{
+  unsigned char *p = pDest;
+  for (int y=0;y<m_iRows;y++)
+  {
+    const unsigned short *pRow = &m_pValues[y*m_iStrideX];
+    const unsigned short *pPrevRow = pRow-m_iStrideX;
+    for (int x=0;x<m_iStrideX;x++)
+    {
+      int iPrediction;
+      if (y==0)
+        iPrediction = (x==0) ? 0 : pRow[x-1];
+      else if (x==0)
+        iPrediction = pPrevRow[0];
+      else
+        iPrediction = hkvMath::clamp((int)pRow[x-1] + (int)pPrevRow[x] - (int)pPrevRow[x-1], 0, 65535);
+
+      const int iDelta = (int)pRow[x] - iPrediction;
+      unsigned int iCode = ((unsigned int)iDelta<<1) ^ (unsigned int)(iDelta>>31);
+      while (iCode>=0x80)
+      {
+        *p++ = (unsigned char)(iCode|0x80);
+        iCode >>= 7;
+      }
+      *p++ = (unsigned char)iCode;
+    }
+  }
+  return (int)(p-pDest);
+}
+
+bool VTerrainQuantizedHeightmap::DecodeDeltas(const unsigned char *pSrc, int iSize)
+{
+  const unsigned char *p = pSrc;
+  const unsigned char *pEnd = pSrc+iSize;
+  for (int y=0;y<m_iRows;y++)
+  {
+    unsigned short *pRow = &m_pValues[y*m_iStrideX];
+    const unsigned short *pPrevRow = pRow-m_iStrideX;
+    for (int x=0;x<m_iStrideX;x++)
+    {
+      unsigned int iCode = 0;
+      int iShift = 0;
+      for (;;)
+      {
+        if (p>=pEnd || iShift>14)
+          return false;
+        const unsigned int iByte = *p++;
+        iCode |= (iByte&0x7f) << iShift;
+        iShift += 7;
+        if ((iByte&0x80)==0)
+          break;
+      }
+
+      int iPrediction;
+      if (y==0)
+        iPrediction = (x==0) ? 0 : pRow[x-1];
+      else if (x==0)
+        iPrediction = pPrevRow[0];
+      else
+        iPrediction = hkvMath::clamp((int)pRow[x-1] + (int)pPrevRow[x] - (int)pPrevRow[x-1], 0, 65535);
+
+      const int iDelta = (int)(iCode>>1) ^ -(int)(iCode&1);
+      const int iValue = iPrediction + iDelta;
+      if (iValue<0 || iValue>65535)
+        return false;
+      pRow[x] = (unsigned short)iValue;
+    }
+  }
+  return p==pEnd;
+}
+
+
+bool VTerrainQuantizedHeightmap::WriteToStream(IVFileOutStream *pOut, bool bDeltaCompression) const
+{
+  VASSERT(pOut && IsValid());
+  const int iCount = GetSampleCount();
+
+  VMemoryTempBuffer<64*1024> payload;
+  int iPayloadSize = 0;
+  int iFlags = 0;
+  if (bDeltaCompression)
+  {
+    payload.EnsureCapacity(iCount*3);
+    iPayloadSize = EncodeDeltas((unsigned char *)payload.GetBuffer());
+    if (iPayloadSize < iCount*(int)sizeof(unsigned short))
+      iFlags |= QUANTIZEDHEIGHTMAP_FLAG_DELTACOMPRESSED;
+  }
+
+  int iVersion = QUANTIZEDHEIGHTMAP_CURRENT_VERSION;
+  int iHeader[3] = {m_iSamples[0],m_iSamples[1],iFlags};
+  float fRange[4] = {m_fBase,m_fScale,m_fMinHeight,m_fMaxHeight};
+  pOut->Write(&iVersion,sizeof(iVersion),"i");
+  pOut->Write(iHeader,sizeof(iHeader),"3i");
+  pOut->Write(fRange,sizeof(fRange),"4f");
+  pOut->Write(m_pEdges,GetEdgeCount()*sizeof(float),"f",GetEdgeCount());
+
+  if (iFlags & QUANTIZEDHEIGHTMAP_FLAG_DELTACOMPRESSED)
+  {
+    pOut->Write(&iPayloadSize,sizeof(iPayloadSize),"i");
+    return pOut->Write(payload.GetBuffer(),iPayloadSize) == (size_t)iPayloadSize;
+  }
+  return pOut->Write(m_pValues,iCount*sizeof(unsigned short),"s",iCount) == iCount*sizeof(unsigned short);
+}
+
+
+bool VTerrainQuantizedHeightmap::ReadFromStream(IVFileInStream *pIn, int iSamplesX, int iSamplesY)
+{
+  VASSERT(pIn);
+  Reset();
+
+  int iVersion = -1;
+  int iHeader[3];
+  float fRange[4];
+  if (pIn->Read(&iVersion,sizeof(iVersion),"i")!=sizeof(iVersion) || iVersion<0 || iVersion>QUANTIZEDHEIGHTMAP_CURRENT_VERSION)
+    return false;
+  if (pIn->Read(iHeader,sizeof(iHeader),"3i")!=sizeof(iHeader))
+    return false;
+  if (iHeader[0]!=iSamplesX || iHeader[1]!=iSamplesY)
+    return false; // written with a different terrain configuration
+  if (pIn->Read(fRange,sizeof(fRange),"4f")!=sizeof(fRange))
+    return false;
+
+  Allocate(iSamplesX, iSamplesY);
+  m_fBase = fRange[0];
+  m_fScale = fRange[1];
+  m_fMinHeight = fRange[2];
+  m_fMaxHeight = fRange[3];
+
+  const int iCount = GetSampleCount();
+  bool bResult = pIn->Read(m_pEdges,GetEdgeCount()*sizeof(float),"f",GetEdgeCount()) == GetEdgeCount()*sizeof(float);
+
+  if (bResult && (iHeader[2] & QUANTIZEDHEIGHTMAP_FLAG_DELTACOMPRESSED))
+  {
+    int iPayloadSize = 0;
+    bResult = pIn->Read(&iPayloadSize,sizeof(iPayloadSize),"i")==sizeof(iPayloadSize) && iPayloadSize>0 && iPayloadSize<=iCount*3;
+    if (bResult)
+    {
+      VMemoryTempBuffer<64*1024> payload(iPayloadSize);
+      bResult = pIn->Read(payload.GetBuffer(),iPayloadSize)==(size_t)iPayloadSize
+        && DecodeDeltas((const unsigned char *)payload.GetBuffer(),iPayloadSize);
+    }
+  }
+  else if (bResult)
+  {
+    bResult = pIn->Read(m_pValues,iCount*sizeof(unsigned short),"s",iCount) == iCount*sizeof(unsigned short);
+  }
+
+  if (!bResult)
+    Reset();
+  return bResult;
+}
+
+
+void VTerrainQuantizedHeightmap::Decode(float *pDest) const
+{
+  VASSERT(pDest && IsValid());
+  const int iCount = GetSampleCount();
+  for (int i=0;i<iCount;i++)
+    pDest[i] = m_fBase + (float)m_pValues[i]*m_fScale;
+
+  const float *pEdge = m_pEdges;
+  memcpy(pDest, pEdge, m_iStrideX*sizeof(float));
+  pEdge += m_iStrideX;
+  memcpy(&pDest[m_iSamples[1]*m_iStrideX], pEdge, m_iStrideX*sizeof(float));
+  pEdge += m_iStrideX;
+  for (int y=0;y<m_iRows;y++)
+    pDest[y*m_iStrideX] = pEdge[y];
+  pEdge += m_iRows;
+  for (int y=0;y<m_iRows;y++)
+    pDest[y*m_iStrideX+m_iSamples[0]] = pEdge[y];
+}
+
+
+
+V_IMPLEMENT_DYNCREATE( VTerrainHeightmapLoadingTask, VThreadedTask, &g_VisionEngineModule );
+
+VTerrainHeightmapLoadingTask::VTerrainHeightmapLoadingTask(IVFileInStream *pIn, const VTerrainConfig &config, bool bDecode) : VThreadedTask()
+{
+  VASSERT(pIn != NULL);
+  m_pIn = pIn;
+  m_iSamples[0] = config.m_iHeightSamplesPerSector[0];
+  m_iSamples[1] = config.m_iHeightSamplesPerSector[1];
+  m_bDecode = bDecode;
+  m_pHeightmap = NULL;
+  m_pDecodedHeight = NULL;
+}
+
+VTerrainHeightmapLoadingTask::~VTerrainHeightmapLoadingTask()
+{
+  if (m_pIn)
+    m_pIn->Close();
+  V_SAFE_DELETE(m_pHeightmap);
+  V_SAFE_DELETE_ARRAY(m_pDecodedHeight);
+}
+
+void VTerrainHeightmapLoadingTask::Run(VManagedThread *pThread)
+{
+  VTerrainQuantizedHeightmap *pHeightmap = new VTerrainQuantizedHeightmap();
+  bool bResult = pHeightmap->ReadFromStream(m_pIn, m_iSamples[0], m_iSamples[1]);
+  m_pIn->Close();
+  m_pIn = NULL;
+  if (!bResult)
+  {
+    V_SAFE_DELETE(pHeightmap);
+    return;
+  }
+
+  if (m_bDecode)
+  {
+    m_pDecodedHeight = new float[pHeightmap->GetSampleCount()];
+    pHeightmap->Decode(m_pDecodedHeight);
+  }
+  m_pHeightmap = pHeightmap;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -0,0 +1,160 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file TerrainQuantizedHeightmap.hpp
+
+#ifndef TERRAINQUANTIZEDHEIGHTMAP_HPP_INCLUDED
+#define TERRAINQUANTIZEDHEIGHTMAP_HPP_INCLUDED
+
+#define QUANTIZEDHEIGHTMAP_VERSION_0        0
+#define QUANTIZEDHEIGHTMAP_CURRENT_VERSION  QUANTIZEDHEIGHTMAP_VERSION_0
+
+#define QUANTIZEDHEIGHTMAP_FLAG_DELTACOMPRESSED   0x00000001  ///< the 16 bit values are delta compressed
+
+
+/// \brief
+///   Heightmap of a terrain sector with 16 bit height values, as stored in the .hmq sector cache files
+///
+/// The heights are quantized to 16 bit between the lowest and the highest sample of the sector. The samples on the
+/// sector edges (first and last row and column of the sector mesh) are additionally kept as floats, so adjacent sectors
+/// share exactly the same edge heights and no cracks appear between sectors with different quantization ranges.
+///
+/// The file stores the height range of the sector, so the bounding box of a sector is known without scanning the heights.
+/// On disk, the 16 bit values can be delta compressed: each value is predicted from its left, upper and upper left neighbor
+/// and the difference is stored with 1 to 3 bytes, which is 1 byte for most samples of a smooth terrain.
+///
+/// Reading and decoding does not access any engine state, so it can happen on a worker thread (see VTerrainHeightmapLoadingTask).
+class VTerrainQuantizedHeightmap
+{
+public:
+  TERRAIN_IMPEXP VTerrainQuantizedHeightmap();
+  TERRAIN_IMPEXP ~VTerrainQuantizedHeightmap();
+
+  /// \brief
+  ///   Releases all data
+  TERRAIN_IMPEXP void Reset();
+
+  /// \brief
+  ///   Quantizes the float heightmap of a sector
+  ///
+  /// \param pHeight
+  ///   (iSamplesX+2)*(iSamplesY+2) height values, in the layout of VTerrainSector::m_pHeight
+  ///
+  /// \param iSamplesX
+  ///   Height samples per sector in x-direction (VTerrainConfig::m_iHeightSamplesPerSector)
+  ///
+  /// \param iSamplesY
+  ///   Height samples per sector in y-direction
+  TERRAIN_IMPEXP void Quantize(const float *pHeight, int iSamplesX, int iSamplesY);
+
+  /// \brief
+  ///   Writes the heightmap to a stream. Delta compression is only used if it actually makes the data smaller
+  TERRAIN_IMPEXP bool WriteToStream(IVFileOutStream *pOut, bool bDeltaCompression=true) const;
+
+  /// \brief
+  ///   Reads the heightmap from a stream. Fails if the file does not match the passed sector dimensions
+  TERRAIN_IMPEXP bool ReadFromStream(IVFileInStream *pIn, int iSamplesX, int iSamplesY);
+
+  /// \brief
+  ///   Writes all (iSamplesX+2)*(iSamplesY+2) heights as floats, in the layout of VTerrainSector::m_pHeight
+  TERRAIN_IMPEXP void Decode(float *pDest) const;
+
+  /// \brief
+  ///   Indicates whether the heightmap holds any data
+  inline bool IsValid() const {return m_pValues!=NULL;}
+
+  /// \brief
+  ///   Returns the height at a sector-relative sample position, including the overlapping border
+  inline float GetHeightAt(int x, int y) const
+  {
+    VASSERT(x>=0 && x<m_iStrideX && y>=0 && y<m_iRows);
+    if (y==0 || y==m_iSamples[1])
+      return m_pEdges[(y==0 ? 0 : m_iStrideX) + x];
+    if (x==0 || x==m_iSamples[0])
+      return m_pEdges[2*m_iStrideX + (x==0 ? 0 : m_iRows) + y];
+    return m_fBase + (float)m_pValues[y*m_iStrideX+x]*m_fScale;
+  }
+
+  /// \brief
+  ///   Returns the minimum height of the sector, without the overlapping border
+  inline float GetMinHeight() const {return m_fMinHeight;}
+
+  /// \brief
+  ///   Returns the maximum height of the sector, without the overlapping border
+  inline float GetMaxHeight() const {return m_fMaxHeight;}
+
+  /// \brief
+  ///   Returns the number of heights, including the overlapping border
+  inline int GetSampleCount() const {return m_iStrideX*m_iRows;}
+
+  /// \brief
+  ///   Returns the memory allocated for the heightmap
+  inline size_t GetMemSize() const
+  {
+    if (!IsValid())
+      return 0;
+    return GetSampleCount()*sizeof(unsigned short) + GetEdgeCount()*sizeof(float);
+  }
+
+protected:
+  inline int GetEdgeCount() const {return 2*m_iStrideX + 2*m_iRows;}
+  void Allocate(int iSamplesX, int iSamplesY);
+  void ComputeHeightRange();
+  int EncodeDeltas(unsigned char *pDest) const;
+  bool DecodeDeltas(const unsigned char *pSrc, int iSize);
+
+  int m_iSamples[2];          ///< height samples per sector (without the overlapping border)
+  int m_iStrideX, m_iRows;    ///< m_iSamples+2
+  float m_fBase, m_fScale;    ///< height = m_fBase + value*m_fScale
+  float m_fMinHeight, m_fMaxHeight;
+  unsigned short *m_pValues;  ///< m_iStrideX*m_iRows quantized heights
+  float *m_pEdges;            ///< exact heights of row 0, row m_iSamples[1], column 0 and column m_iSamples[0]
+};
+
+
+/// \brief
+///   Internal task that reads a quantized sector heightmap on a worker thread, see VTerrainSector::PreCacheHeightmap
+class VTerrainHeightmapLoadingTask : public VThreadedTask
+{
+public:
+  /// \brief
+  ///   Constructor. The task takes ownership of the passed stream. If bDecode is true, the task also converts the
+  ///   heights to floats
+  VTerrainHeightmapLoadingTask(IVFileInStream *pIn, const VTerrainConfig &config, bool bDecode);
+  virtual ~VTerrainHeightmapLoadingTask();
+
+  virtual void Run(VManagedThread *pThread);
+
+  IVFileInStream *m_pIn;
+  int m_iSamples[2];
+  bool m_bDecode;
+  VTerrainQuantizedHeightmap *m_pHeightmap; ///< result, NULL if the file could not be read
+  float *m_pDecodedHeight;                  ///< float heights if m_bDecode is set; allocated with new[]
+
+public:
+  //type management
+  inline VTerrainHeightmapLoadingTask() {m_pIn=NULL;m_pHeightmap=NULL;m_pDecodedHeight=NULL;m_bDecode=false;}
+  V_DECLARE_DYNCREATE_DLLEXP( VTerrainHeightmapLoadingTask,  TERRAIN_IMPEXP );
+};
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
@@ -29,6 +29,7 @@ VTerrainSector::VTerrainSector(VTerrainSectorManager *pManager, const VTerrainCo
   SetResourceFlag(VRESOURCEFLAG_ALLOWUNLOAD); // no auto delete, currently messes with visibility when destroying terrain
 
   m_pSnapshot = NULL;
+  m_pHeightmapTask = NULL;
   m_PhysicsUserData = NULL;
   m_vSectorOrigin = config.GetSectorOrigin(iIndexX,iIndexY);
   m_piReferencedDecoration = NULL;
@@ -43,6 +44,7 @@ VTerrainSector::VTerrainSector(VTerrainSectorManager *pManager, const VTerrainCo
   m_fMaxHeightValue = 0.f;
   m_fMaxTileHandlingDistance = 0.f;
   m_pHeight = NULL;
+  m_pQuantizedHeight = NULL;
   m_pTile = NULL;
   m_bPrepared = m_bSectorFileLoaded = m_bHasAdditionalDecoration = m_bFailedLoadingReplacementMesh = false;
   m_pMeshPage = NULL;
@@ -68,6 +70,8 @@ VTerrainSector::~VTerrainSector()
     VASSERT(!IsLoaded());
   V_SAFE_DELETE_ARRAY(m_piReferencedDecoration);
   V_SAFE_DELETE_ARRAY(m_pHeight);
+  V_SAFE_DELETE(m_pQuantizedHeight);
+  DiscardHeightmapLoadingTask();
 }
 
 #define ADDREMOVENEIGHBOR(iIX,iIY) \
@@ -171,6 +175,9 @@ bool VTerrainSector::SaveHeightmap()
   pOut->Close();
   m_Config.RCSPerformAction(szFilename, RCS_ADD);
 
+  // compact version for the runtime
+  bResult &= SaveQuantizedHeightmap();
+
   if (!m_Config.m_bUseTempFolder)
   {
     IVisPhysicsModule_cl *pModule = Vision::GetApplication()->GetPhysicsModule();
@@ -182,50 +189,144 @@ bool VTerrainSector::SaveHeightmap()
 }
 
 
+bool VTerrainSector::SaveQuantizedHeightmap()
+{
+  if (!m_pHeight)
+    return false;
+
+  char szFilename[FS_MAX_PATH];
+  if (!m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY,"hmq",true))
+    return false;
+
+  m_Config.RCSPerformAction(szFilename, RCS_EDIT); //make sure we can write to it
+
+  IVFileOutStream *pOut = GetParentManager()->CreateFileOutStream(szFilename,this);
+  if (!pOut)
+    return false;
+
+  VTerrainQuantizedHeightmap heightmap;
+  heightmap.Quantize(m_pHeight,m_Config.m_iHeightSamplesPerSector[0],m_Config.m_iHeightSamplesPerSector[1]);
+  bool bResult = heightmap.WriteToStream(pOut);
+  pOut->Close();
+  m_Config.RCSPerformAction(szFilename, RCS_ADD);
+
+  return bResult;
+}
+
+
 void VTerrainSector::LoadHeightmap()
 {
-  if (m_pHeight==NULL)
-    AllocateHeightMap();
   const int iSampleCount = GetHeightmapSampleCount();
-  VASSERT(iSampleCount>0 && m_pHeight);
+  VASSERT(iSampleCount>0);
 
-  bool bLoaded = false;
-  char szFilename[FS_MAX_PATH];
-  if (m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY,"hmap",false))
+  bool bCompact = m_pHeight==NULL && GetSectorManager()->GetUseCompactHeightmaps();
+  bool bDecoded = false;
+  VTerrainQuantizedHeightmap *pQuantized = NULL;
+
+  if (m_pHeightmapTask!=NULL)
   {
-    IVFileInStream *pIn = GetParentManager()->CreateFileInStream(szFilename,this);
-    if (pIn)
+    // take the result of the background read started in PreCacheHeightmap
+    Vision::GetThreadManager()->WaitForTask(m_pHeightmapTask, true);
+    pQuantized = m_pHeightmapTask->m_pHeightmap;
+    m_pHeightmapTask->m_pHeightmap = NULL;
+    if (pQuantized!=NULL && !bCompact && m_pHeight==NULL && m_pHeightmapTask->m_pDecodedHeight!=NULL)
     {
-      int iVersion=0;
-      int iFileSampleCount = 0;
-
-      pIn->Read(&iVersion,sizeof(iVersion),"i");
-      pIn->Read(&iFileSampleCount,sizeof(iFileSampleCount),"i");
-      if (iFileSampleCount==iSampleCount)
+      m_pHeight = m_pHeightmapTask->m_pDecodedHeight;
+      m_pHeightmapTask->m_pDecodedHeight = NULL;
+      bDecoded = true;
+    }
+    V_SAFE_DELETE(m_pHeightmapTask);
+  }
+  else if (m_pQuantizedHeight!=NULL && m_pHeight==NULL)
+  {
+    // float values have been requested (GetHeightmapValues), so convert the compact heights. Other threads
+    // may be reading heights through GetHeightAt meanwhile (e.g. particle terrain constraints), so the floats
+    // are decoded into a new buffer and published once they are complete. The compact heights are kept until
+    // the sector is unloaded, since a reader may still be inside m_pQuantizedHeight->GetHeightAt.
+    float *pDecoded = new float[iSampleCount];
+    m_pQuantizedHeight->Decode(pDecoded);
+    if (VAtomic::CompareExchangePointer((void * volatile *)&m_pHeight, pDecoded, NULL)!=NULL)
+      delete[] pDecoded; // another thread has published its heights first
+    return;
+  }
+  else if (!Vision::Editor.IsInEditor())
+  {
+    // outside the editor, the quantized heightmap is preferred. The editor always works on the lossless float values
+    char szFilename[FS_MAX_PATH];
+    if (m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY,"hmq",false))
+    {
+      IVFileInStream *pIn = GetParentManager()->CreateFileInStream(szFilename,this);
+      if (pIn)
       {
-        // load block of height values
-        bLoaded = pIn->Read(m_pHeight,iSampleCount*sizeof(float),"f",iSampleCount) == iSampleCount*sizeof(float);
+        pQuantized = new VTerrainQuantizedHeightmap();
+        if (!pQuantized->ReadFromStream(pIn,m_Config.m_iHeightSamplesPerSector[0],m_Config.m_iHeightSamplesPerSector[1]))
+          V_SAFE_DELETE(pQuantized);
+        pIn->Close();
       }
-      pIn->Close();
     }
   }
 
-  // procedurally generate a heightmap
-  if (!bLoaded)
+  if (pQuantized!=NULL)
   {
-    memset(m_pHeight,0,iSampleCount*sizeof(float));
+    // min/max are stored in the file, so no need to scan the heights
+    m_fMinHeightValue = pQuantized->GetMinHeight();
+    m_fMaxHeightValue = pQuantized->GetMaxHeight();
+    if (bCompact)
+    {
+      m_pQuantizedHeight = pQuantized;
+      pQuantized = NULL;
+    }
+    else if (!bDecoded)
+    {
+      AllocateHeightMap();
+      pQuantized->Decode(m_pHeight);
+    }
+    V_SAFE_DELETE(pQuantized);
   }
+  else
+  {
+    if (m_pHeight==NULL)
+      AllocateHeightMap();
+    VASSERT(m_pHeight);
 
+    bool bLoaded = false;
+    char szFilename[FS_MAX_PATH];
+    if (m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY,"hmap",false))
+    {
+      IVFileInStream *pIn = GetParentManager()->CreateFileInStream(szFilename,this);
+      if (pIn)
+      {
+        int iVersion=0;
+        int iFileSampleCount = 0;
 
-  // recalc min/max. Note that the extra border must not be considered
-  m_fMaxHeightValue = m_fMinHeightValue = m_pHeight[0];
-  for (int y=0;y<=m_Config.m_iHeightSamplesPerSector[1];y++)
-  {
-    float *pHeight = &m_pHeight[y*m_iSampleStrideX];
-    for (int x=0;x<=m_Config.m_iHeightSamplesPerSector[0];x++)
+        pIn->Read(&iVersion,sizeof(iVersion),"i");
+        pIn->Read(&iFileSampleCount,sizeof(iFileSampleCount),"i");
+        if (iFileSampleCount==iSampleCount)
+        {
+          // load block of height values
+          bLoaded = pIn->Read(m_pHeight,iSampleCount*sizeof(float),"f",iSampleCount) == iSampleCount*sizeof(float);
+        }
+        pIn->Close();
+      }
+    }
+
+    // procedurally generate a heightmap
+    if (!bLoaded)
+    {
+      memset(m_pHeight,0,iSampleCount*sizeof(float));
+    }
+
+
+    // recalc min/max. Note that the extra border must not be considered
+    m_fMaxHeightValue = m_fMinHeightValue = m_pHeight[0];
+    for (int y=0;y<=m_Config.m_iHeightSamplesPerSector[1];y++)
     {
-      m_fMaxHeightValue = hkvMath::Max(m_fMaxHeightValue, pHeight[x]);
-      m_fMinHeightValue = hkvMath::Min(m_fMinHeightValue, pHeight[x]);
+      float *pHeight = &m_pHeight[y*m_iSampleStrideX];
+      for (int x=0;x<=m_Config.m_iHeightSamplesPerSector[0];x++)
+      {
+        m_fMaxHeightValue = hkvMath::Max(m_fMaxHeightValue, pHeight[x]);
+        m_fMinHeightValue = hkvMath::Min(m_fMinHeightValue, pHeight[x]);
+      }
     }
   }
 
@@ -236,6 +337,39 @@ void VTerrainSector::LoadHeightmap()
 }
 
 
+bool VTerrainSector::PreCacheHeightmap()
+{
+  if (m_pHeightmapTask!=NULL)
+    return m_pHeightmapTask->GetState()!=TASKSTATE_FINISHED;
+  if (IsHeightmapLoaded() || Vision::Editor.IsInEditor())
+    return false;
+
+  char szFilename[FS_MAX_PATH];
+  if (!m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY,"hmq",false))
+    return false;
+
+  // the file is part of the sector snapshot, so at this point opening it does not touch the disk
+  IVFileInStream *pIn = GetParentManager()->CreateFileInStream(szFilename,NULL);
+  if (!pIn)
+    return false;
+
+  m_pHeightmapTask = new VTerrainHeightmapLoadingTask(pIn, m_Config, !GetSectorManager()->GetUseCompactHeightmaps());
+  Vision::GetThreadManager()->ScheduleTask(m_pHeightmapTask);
+  return true;
+}
+
+
+void VTerrainSector::DiscardHeightmapLoadingTask()
+{
+  if (m_pHeightmapTask==NULL)
+    return;
+
+  // a scheduled task can't be cancelled
+  Vision::GetThreadManager()->WaitForTask(m_pHeightmapTask, true);
+  V_SAFE_DELETE(m_pHeightmapTask);
+}
+
+
 float VTerrainSector::ComputeMaxErrorForLOD(int iLod,int x1,int y1,int x2,int y2)
 {
   EnsureLoaded();
@@ -784,7 +918,7 @@ bool VTerrainSector::DeleteSectorData(bool bUseTemp)
 
   const char *szDataDir = GetSectorManager()->GetFileManager()->GetDataDirectory();
 
-  const char *relevantExt[] = {"mesh","hmap",NULL};
+  const char *relevantExt[] = {"mesh","hmap","hmq",NULL};
   for (int i = 0; relevantExt[i] != NULL; i++)
   {
     char szFilename[FS_MAX_PATH];
@@ -904,7 +1038,9 @@ BOOL VTerrainSector::Reload()
 
   SetSurface(&m_pMeshPage[0].GetSurfaceSafe());
 
-  LoadHeightmap();
+  // compact heights may already have been loaded for a height lookup; loading them again would convert them to floats
+  if (m_pQuantizedHeight==NULL)
+    LoadHeightmap();
 
   bool bNeedsNormalmap = Vision::Editor.IsInEditor(); // always use in editor
 
@@ -1165,6 +1301,7 @@ void VTerrainSector::OnDestroying()
 {
   m_spCollisionMeshes = NULL;
   V_SAFE_DELETE(m_pSnapshot);
+  DiscardHeightmapLoadingTask();
 }
 
 
@@ -1173,7 +1310,9 @@ BOOL VTerrainSector::Unload()
   VISION_PROFILE_FUNCTION(VTerrainSectorManager::PROFILING_UNLOAD);
   V_SAFE_DELETE(m_pSnapshot)
     m_spMaterialIDMap = NULL;
+  DiscardHeightmapLoadingTask();
   V_SAFE_DELETE_ARRAY(m_pHeight);
+  V_SAFE_DELETE(m_pQuantizedHeight);
   V_SAFE_DELETE_ARRAY(m_pTile);
   V_SAFE_DELETE_ARRAY(m_pMeshPage);
   VTerrainSectorDecorationVisibilityMask::DeleteRecursive(m_pFirstDecoVisInfo);
@@ -1251,9 +1390,14 @@ void VTerrainSector::GetDependencies(VResourceSnapshot &snapshot)
 
   // add files
   char szFilename[FS_MAX_PATH];
-  const char *relevantExt[] = {"mesh","hmap",NULL};
+  const char *relevantExt[] = {"mesh","hmq","hmap",NULL};
+  bool bHasQuantizedHeightmap = false;
 
   for (int i=0;relevantExt[i];i++)
+  {
+    // the runtime only loads the float heightmap if there is no quantized version
+    if (bHasQuantizedHeightmap && !strcmp(relevantExt[i],"hmap"))
+      continue;
     if (m_Config.GetSectorCacheFilename(szFilename,m_iIndexX,m_iIndexY, relevantExt[i],true))
     {
       IVFileInStream *pIn = GetParentManager()->CreateFileInStream(szFilename,this);
@@ -1261,8 +1405,11 @@ void VTerrainSector::GetDependencies(VResourceSnapshot &snapshot)
       {
         snapshot.AddFileDependency(this, szFilename, pIn->GetSize());
         pIn->Close();
+        if (!strcmp(relevantExt[i],"hmq"))
+          bHasQuantizedHeightmap = true;
       }
     }
+  }
 
     // attached textures
     if (m_spMesh)
@@ -1322,6 +1469,9 @@ void VTerrainSector::PreCache()
 
     if (m_pSnapshot->IsFinished())
     {
+      // all files are cached now. Read and decode the heightmap on a worker thread before loading the sector
+      if (PreCacheHeightmap())
+        return;
       EnsureLoaded();
       return;
     }
@@ -1348,6 +1498,10 @@ void VTerrainSector::SetSectorBoundingBox(const hkvAlignedBBox &box, bool bInfla
   VisStaticGeometryInstance_cl::SetBoundingBox(box);
   VASSERT(box.isValid());
 
+  // let the visibility collectors re-pack the geometry boxes of the zones this sector is assigned to
+  for (int i=0;i<GetVisibilityZoneAssignmentCount();i++)
+    GetVisibilityZone(i)->OnStaticGeometryBoundsChanged();
+
   // set a larger bounding box on the visibility zone so camera assignment is correct
   if (m_spSectorZone)
   {
@@ -1451,7 +1605,7 @@ bool VTerrainSector::IsAllHoles() const
 float VTerrainSector::GetHeightAtRelPos(const hkvVec3& vPos) const
 {
   VISION_PROFILE_FUNCTION(VTerrainSectorManager::PROFILING_HEIGHTLOOKUP);
-  ((VTerrainSector *)this)->GetHeightmapValues();
+  ((VTerrainSector *)this)->EnsureHeightmapLoaded();
   float fPosX = vPos.x * m_Config.m_vWorld2Sample.x;
   float fPosY = vPos.y * m_Config.m_vWorld2Sample.y;
   int x = (int)fPosX;
@@ -1580,6 +1734,8 @@ void VTerrainSector::AccumulateMemoryFootprint(size_t &iUniqueSys, size_t &iUniq
 
   if (m_pHeight)
     iUniqueSys += m_iSampleStrideX*(m_Config.m_iHeightSamplesPerSector[1]+2)*sizeof(float);
+  if (m_pQuantizedHeight)
+    iUniqueSys += m_pQuantizedHeight->GetMemSize();
 
   // tiles
   if (m_pTile)
@@ -1881,8 +2037,8 @@ void VTerrainSector::UpdateMesh(bool bForceAllPages)
   if (!bFastUpdate)
     bForceAllPages = true;
 
-  GetHeightmapValues();
-  VASSERT(m_spMesh && m_pHeight);
+  EnsureHeightmapLoaded();
+  VASSERT(m_spMesh && IsHeightmapLoaded());
 
   const VTerrainConfig &config = m_Config;
   const int iMeshSamplesX = m_Config.m_iHeightSamplesPerSector[0]/config.m_iSectorMeshesPerSector[0];
@@ -1916,8 +2072,8 @@ void VTerrainSector::UpdateMesh(bool bForceAllPages)
     pVert = (TerrainVertex_t *)tempVertices.GetBuffer();
   }
 
-  m_fMinHeightValue = m_pHeight[0];
-  m_fMaxHeightValue = m_pHeight[0];
+  m_fMinHeightValue = GetHeightAt(0,0);
+  m_fMaxHeightValue = m_fMinHeightValue;
   const float fHOfs = m_Config.m_vTerrainPos.z;
 
   int iFirstVertex = 0;
@@ -1935,13 +2091,15 @@ void VTerrainSector::UpdateMesh(bool bForceAllPages)
       pPage->m_AbsBoundingBox.m_vMax.z = -10000000.f;
       for (y=0;y<=iMeshSamplesY;y++)
       {
-        float *pHVal = &m_pHeight[m_iSampleStrideX*(y+iPageY*iMeshSamplesY) + iPageX*iMeshSamplesX];
-        for (x=0;x<=iMeshSamplesX;x++, pVert++, pHVal++)
+        const int iSampleX = iPageX*iMeshSamplesX;
+        const int iSampleY = y+iPageY*iMeshSamplesY;
+        for (x=0;x<=iMeshSamplesX;x++, pVert++)
         {
-          float h = *pHVal + fHOfs;
+          const float fHVal = GetHeightAt(iSampleX+x,iSampleY);
+          float h = fHVal + fHOfs;
           pVert->fHeight = h;
-          m_fMinHeightValue = hkvMath::Min(m_fMinHeightValue,*pHVal); // use h here?
-          m_fMaxHeightValue = hkvMath::Max(m_fMaxHeightValue,*pHVal);
+          m_fMinHeightValue = hkvMath::Min(m_fMinHeightValue,fHVal); // use h here?
+          m_fMaxHeightValue = hkvMath::Max(m_fMaxHeightValue,fHVal);
           pPage->m_AbsBoundingBox.m_vMin.z = hkvMath::Min(pPage->m_AbsBoundingBox.m_vMin.z,h);
           pPage->m_AbsBoundingBox.m_vMax.z = hkvMath::Max(pPage->m_AbsBoundingBox.m_vMax.z,h);
         }
@@ -1983,7 +2141,7 @@ VSimpleCollisionMesh* VTerrainSector::GetCollisionMesh(int iTileX, int iTileY)
     pMesh->AllocateVertices((iCountX+1)*(iCountY+1));
     pMesh->AllocateIndices(iCountX*iCountY*6);
     pMesh->SetPrimitiveCount(iCountX*iCountY*2);
-    const float *pHeight = GetHeightmapValues();
+    EnsureHeightmapLoaded();
     hkvVec3 vPos;
     int iIndex = 0;
     const int y1 = iCountY*iTileY;
@@ -2001,12 +2159,11 @@ VSimpleCollisionMesh* VTerrainSector::GetCollisionMesh(int iTileX, int iTileY)
     // create vertices
     for (y=y1;y<=y2;y++)
     {
-      const float *pHVal = &pHeight[m_iSampleStrideX*(y*iDetail) + x1*iDetail];
       vPos.x = (float)x1*fStepX;
       vPos.y = (float)y*fStepY;
-      for (x=x1;x<=x2;x++,iIndex++,pHVal+=iDetail,vPos.x+=fStepX)
+      for (x=x1;x<=x2;x++,iIndex++,vPos.x+=fStepX)
       {
-        vPos.z = *pHVal;
+        vPos.z = GetHeightAt(x*iDetail,y*iDetail);
         pMesh->SetVertex(iIndex,vPos+vPosOfs);
       }
     }
@@ -19,6 +19,7 @@
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainSectorManager.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainDecorationInstance.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainSectorMesh.hpp>
+#include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Geometry/TerrainQuantizedHeightmap.hpp>
 #include <Vision/Runtime/EnginePlugins/VisionEnginePlugin/Terrain/Editing/LuminanceChannel.hpp>
 
 
@@ -112,8 +113,21 @@ public:
 
   /// \brief
   ///   Returns a raw array of heightmap values. Ensures that the heightmap is loaded for this sector
+  ///
+  /// If the sector only keeps compact 16 bit heights in memory (see VTerrainSectorManager::SetUseCompactHeightmaps), they are
+  /// converted to floats, which doubles the memory used by the heightmap. Use EnsureHeightmapLoaded and GetHeightAt for
+  /// read-only access.
   inline float *GetHeightmapValues() {if (!m_pHeight) LoadHeightmap(); return m_pHeight;}
 
+  /// \brief
+  ///   Indicates whether the heightmap values are in memory, i.e. whether GetHeightAt can be used without loading
+  inline bool IsHeightmapLoaded() const {return m_pHeight!=NULL || m_pQuantizedHeight!=NULL;}
+
+  /// \brief
+  ///   Ensures that the heightmap is in memory so that GetHeightAt can be used. Unlike GetHeightmapValues, this function
+  ///   keeps compact 16 bit heights
+  inline void EnsureHeightmapLoaded() {if (!IsHeightmapLoaded()) LoadHeightmap();}
+
   /// \brief
   ///   Returns the non-interpolated height value at specified sector-relative sample position. Ensures that the heightmap is loaded
   inline float *GetHeightmapValuesAt(int x, int y) 
@@ -128,10 +142,12 @@ public:
   ///   Same as GetHeightmapValuesAt but assumes that the sector is loaded (must be tested outside)
   inline float GetHeightAt(int x, int y) const
   {
-    VASSERT(m_pHeight != NULL); ///< make sure GetHeightmapValues() has been called
+    VASSERT(IsHeightmapLoaded()); ///< make sure EnsureHeightmapLoaded() has been called
     VASSERT(x>=0 && x<=m_Config.m_iHeightSamplesPerSector[0]+1); ///< also allow overlapping part
     VASSERT(y>=0 && y<=m_Config.m_iHeightSamplesPerSector[1]+1);
-    return m_pHeight[y*m_iSampleStrideX+x];
+    if (m_pHeight)
+      return m_pHeight[y*m_iSampleStrideX+x];
+    return m_pQuantizedHeight->GetHeightAt(x,y);
   }
   /// \brief
   ///   Returns interpolated height value at sample position that is a world position made relative to the sector's origin
@@ -277,6 +293,16 @@ public:
   TERRAIN_IMPEXP float* AllocateHeightMap();
   TERRAIN_IMPEXP void LoadHeightmap();
   TERRAIN_IMPEXP bool SaveHeightmap();
+  TERRAIN_IMPEXP bool SaveQuantizedHeightmap();
+
+  /// \brief
+  ///   Starts reading the quantized heightmap (.hmq) on a worker thread, so that LoadHeightmap does not have to read and
+  ///   decode it on the main thread. Called by PreCache when all files of the sector are cached.
+  ///
+  /// \returns
+  ///   true while the heightmap is being read, false when it is ready or there is nothing to read in the background
+  TERRAIN_IMPEXP bool PreCacheHeightmap();
+  void DiscardHeightmapLoadingTask();
   TERRAIN_IMPEXP bool LoadSectorInformation();
   TERRAIN_IMPEXP bool SaveSectorInformation();
   void DisposePerSectorObjects();
@@ -377,6 +403,7 @@ public:
   int m_iIndexX, m_iIndexY;         ///< sector index in the global terrain
   int m_iSampleStrideX;             ///< 2 additional overlapping height values (m_Config.m_iHeightSamplesPerSector+2)
   float *m_pHeight;                 ///< (m_iSampleCount[0]+2)*(m_iSampleCount[1]+2)
+  VTerrainQuantizedHeightmap *m_pQuantizedHeight; ///< compact 16 bit heights, used while m_pHeight is NULL, see VTerrainSectorManager::SetUseCompactHeightmaps. Kept until Unload once converted to floats
   float m_fMinHeightValue;          ///< the minimum value in m_pHeight array
   float m_fMaxHeightValue;          ///< the maximum value in m_pHeight array
   float m_fMaxTileHandlingDistance; ///< maximum of m_fMaxDecorationFarClip over all tiles
@@ -393,6 +420,7 @@ public:
 
   // precaching:
   VSectorResourceSnapshot *m_pSnapshot;
+  VTerrainHeightmapLoadingTask *m_pHeightmapTask;
 
   // decoration
   VTerrainDecorationInstanceCollection m_Decoration;    ///< the decoration instances itself
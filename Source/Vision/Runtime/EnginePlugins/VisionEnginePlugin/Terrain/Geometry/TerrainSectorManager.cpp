@@ -129,6 +129,7 @@ VTerrainSectorManager::VTerrainSectorManager(VTerrainConfig &config)
 
   m_bTerrainMeshExport = false;
   m_bExportRendering = false;
+  m_bCompactHeightmaps = !Vision::Editor.IsInEditor(); // the editor modifies the float heights
 }
 
 VTerrainSectorManager::~VTerrainSectorManager()
@@ -504,7 +505,7 @@ float VTerrainSectorManager::GetHeightAtSamplePos(int iSampleX, int iSampleY) co
 //  if (iSectorX<0 || iSectorY<0 || iSectorX>=m_Config.m_iSectorCount[0] || iSectorY>=m_Config.m_iSectorCount[1])
 //    return 0.f;
   VTerrainSector *pSector = GetSector(iSectorX,iSectorY);
-  pSector->GetHeightmapValues();
+  pSector->EnsureHeightmapLoaded();
   return pSector->GetHeightAt(m_Config.GetSectorSampleOfsX(iSampleX),m_Config.GetSectorSampleOfsY(iSampleY));
 }
 
@@ -375,10 +375,22 @@ public:
   ///   Get whether the export rendering mode is enabled or not
   inline bool GetUseExportRendering() { return m_bExportRendering; }
 
+  /// \brief
+  ///   Enables or disables compact heightmaps. If enabled, sectors that are loaded from quantized heightmap files (.hmq)
+  ///   keep 16 bit heights in memory instead of floats, which halves the memory of resident heightmaps.
+  ///
+  /// Enabled by default outside vForge. Only affects sectors that are loaded afterwards.
+  inline void SetUseCompactHeightmaps(bool bFlag) { m_bCompactHeightmaps = bFlag; }
+
+  /// \brief
+  ///   Returns whether compact heightmaps are enabled, see SetUseCompactHeightmaps
+  inline bool GetUseCompactHeightmaps() const { return m_bCompactHeightmaps; }
+
 private:
   bool m_bTerrainMeshExport;
   bool m_bExportRendering; ///< If enabled, pure terrain rendering is done without any holes, overlays, or preview light.
                            ///  This mode also forces the non baked version of the terrain to be rendered.
+  bool m_bCompactHeightmaps;
 
 public:
   // profiling
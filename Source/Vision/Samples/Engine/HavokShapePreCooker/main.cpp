@@ -0,0 +1,152 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+// ***********************************************************************************************
+// HavokShapePreCooker : Batch cooking of the Havok static mesh shapes of whole scenes
+// Copyright (C) Havok.com Inc. All rights reserved.
+// ***********************************************************************************************
+// Loads a list of scenes in headless mode (null renderer, no window, no GPU required) with HKT
+// shape caching enforced. All static mesh shapes that are missing in the cache or whose content
+// hash does not match the current geometry and cooking parameters are cooked and written as .hkt
+// files next to the meshes, so the game never has to cook them at runtime.
+//
+// Terrain sector shapes are not pre-cooked by this tool.
+//
+// Command line (Windows):
+//   HavokShapePreCooker.exe [-data <data dir>] [-scenes <scene1;scene2;...>]
+// ***********************************************************************************************
+#include <Vision/Samples/Engine/HavokShapePreCooker/HavokShapePreCookerPCH.h>
+
+struct PreCookerConfig_t
+{
+  PreCookerConfig_t()
+  {
+    sDataDir = "Maps\\ViewerMap";
+    sScenes = "ViewerMap";
+  }
+
+#if defined(WIN32) && !defined(_VISION_WINRT)
+  void ParseParams()
+  {
+    int argc;
+    LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    for (int i=1;i<argc-1;i++)
+    {
+      LPWSTR pArg = argv[i];
+      if (pArg[0]!='-' && pArg[0]!='/')
+        continue;
+      pArg++;
+      LPWSTR pValue = argv[++i]; // all options take one value
+
+      if (!_wcsicmp(pArg,L"data")) sDataDir = VString(pValue);
+      else if (!_wcsicmp(pArg,L"scenes")) sScenes = VString(pValue);
+      else
+        i--; // unknown option without value
+    }
+
+    LocalFree(argv);
+  }
+#else
+  void ParseParams() {}
+#endif
+
+  VString sDataDir;
+  VString sScenes;  ///< semicolon separated list of scenes
+};
+
+static PreCookerConfig_t g_Config;
+static VStrList g_Scenes;
+static int g_iCurrentScene = -1;
+static bool g_bSceneLoaded = false;
+
+VisSampleAppPtr spApp;
+
+static bool LoadNextScene()
+{
+  while (++g_iCurrentScene<g_Scenes.GetLength())
+  {
+    const char *szScene = g_Scenes[g_iCurrentScene];
+    Vision::Error.SystemMessage("HavokShapePreCooker: Cooking shapes of %s", szScene);
+    g_bSceneLoaded = false;
+    if (spApp->LoadScene(szScene))
+      return true;
+    Vision::Error.Warning("HavokShapePreCooker: Failed to load %s", szScene);
+  }
+  return false;
+}
+
+VISION_INIT
+{
+  VISION_SET_DIRECTORIES(false);
+  g_Config.ParseParams();
+  VStringTokenizer tokens(g_Config.sScenes, ";");
+  for (int i=0;i<tokens.GetLength();i++)
+    g_Scenes.AddString((const char *)tokens[i]);
+
+  spApp = new VisSampleApp();
+  spApp->LoadVisionEnginePlugin();
+  VISION_PLUGIN_ENSURE_LOADED(vHavok);
+
+  // no window, no splash screen, no vsync and no prompts
+  const uint64 iSampleFlags = VSampleFlags::VSAMPLE_HEADLESS | VSampleFlags::VSAMPLE_DISABLEDEFAULTKEYS;
+  if (!spApp->InitSample(g_Config.sDataDir, NULL, iSampleFlags))
+    return false;
+
+  // write every shape that had to be cooked to a .hkt file, and recook outdated .hkt files. Cooking has to
+  // happen synchronously here, otherwise the placeholder shapes would be saved instead.
+  vHavokPhysicsModule *pModule = vHavokPhysicsModule::GetInstance();
+  VASSERT(pModule!=NULL);
+  pModule->ForceHktShapeCaching(true);
+  vHavokCachedShape::EnableHktUpToDateChecking(true);
+  vHavokShapeFactory::EnableBackgroundCooking(false);
+
+  return LoadNextScene();
+}
+
+VISION_SAMPLEAPP_AFTER_LOADING
+{
+  g_bSceneLoaded = true;
+}
+
+VISION_SAMPLEAPP_RUN
+{
+  if (!spApp->Run())
+    return false;
+  if (!g_bSceneLoaded)
+    return true;
+
+  // all shapes of a scene are created while it is loaded
+  Vision::Error.SystemMessage("HavokShapePreCooker: Finished %s", g_Scenes[g_iCurrentScene]);
+  spApp->ClearScene();
+  return LoadNextScene();
+}
+
+VISION_DEINIT
+{
+  spApp->DeInitSample();
+  spApp = NULL;
+  return true;
+}
+
+VISION_MAIN_DEFAULT
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ *
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ *
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ *
+ */
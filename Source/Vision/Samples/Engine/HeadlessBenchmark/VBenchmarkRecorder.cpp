@@ -0,0 +1,195 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+#include <Vision/Samples/Engine/HeadlessBenchmark/HeadlessBenchmarkPCH.h>
+#include <Vision/Samples/Engine/HeadlessBenchmark/VBenchmarkRecorder.hpp>
+
+VBenchmarkRecorder::VBenchmarkRecorder() : m_FrameTimes(0, 0.f), m_Elements(0), m_ElementIndex(MAX_PROFILING_ID_COUNT, -1)
+{
+  m_iFrameCount = 0;
+  m_iElementCount = 0;
+}
+
+VBenchmarkRecorder::~VBenchmarkRecorder()
+{
+}
+
+void VBenchmarkRecorder::Reset()
+{
+  m_iFrameCount = 0;
+  m_iElementCount = 0;
+  m_ElementIndex.Init(-1);
+}
+
+void VBenchmarkRecorder::RecordFrame(float fFrameTimeMS)
+{
+  m_FrameTimes[m_iFrameCount++] = fFrameTimeMS;
+
+  // the children of the root node are the profiling pages (groups), the elements are below them
+  const VProfilingNode *pRoot = Vision::Profiling.GetProfilingRootNode();
+  if (pRoot==NULL)
+    return;
+  const VProfilingNodeCollection &groups = pRoot->Children();
+  const int iGroupCount = groups.Count();
+  for (int i=0;i<iGroupCount;i++)
+    RecordNode(groups.GetAt(i), groups.GetAt(i)->GetName());
+}
+
+void VBenchmarkRecorder::RecordNode(const VProfilingNode *pNode, const char *szGroup)
+{
+  const int iID = pNode->GetID();
+  if (pNode->HasValidID() && iID<MAX_PROFILING_ID_COUNT)
+  {
+    int iIndex = m_ElementIndex.GetDataPtr()[iID];
+    if (iIndex<0)
+    {
+      iIndex = m_iElementCount++;
+      m_ElementIndex.GetDataPtr()[iID] = iIndex;
+      ElementStats_t &newStats(m_Elements[iIndex]);
+      vstrncpy(newStats.m_szName, pNode->GetName(), sizeof(newStats.m_szName));
+      vstrncpy(newStats.m_szGroup, szGroup, sizeof(newStats.m_szGroup));
+      newStats.m_iID = iID;
+      newStats.m_fTotalMS = 0.0;
+      newStats.m_fMaxMS = 0.f;
+      newStats.m_iTotalCalls = 0;
+    }
+
+    ElementStats_t &stats(m_Elements.GetDataPtr()[iIndex]);
+    const float fTimeMS = pNode->GetTimeInMS();
+    stats.m_fTotalMS += fTimeMS;
+    stats.m_fMaxMS = hkvMath::Max(stats.m_fMaxMS, fTimeMS);
+    stats.m_iTotalCalls += pNode->GetCallCount();
+  }
+
+  const VProfilingNodeCollection &children = pNode->Children();
+  const int iChildCount = children.Count();
+  for (int i=0;i<iChildCount;i++)
+    RecordNode(children.GetAt(i), szGroup);
+}
+
+
+static int CompareFloat(const void *pElem1, const void *pElem2)
+{
+  const float f1 = *(const float *)pElem1;
+  const float f2 = *(const float *)pElem2;
+  if (f1<f2) return -1;
+  if (f1>f2) return 1;
+  return 0;
+}
+
+static void WriteLine(IVFileOutStream *pOut, const char *szFormat, ...)
+{
+  char szBuffer[1024];
+  va_list args;
+  va_start(args, szFormat);
+  const int iLen = vsnprintf(szBuffer, sizeof(szBuffer)-1, szFormat, args);
+  va_end(args);
+  szBuffer[sizeof(szBuffer)-1] = 0;
+  if (iLen>0)
+    pOut->Write(szBuffer, hkvMath::Min(iLen, (int)sizeof(szBuffer)-1));
+  pOut->Write("\n", 1);
+}
+
+// escapes quotes, backslashes and control characters for a JSON string
+static const char* EscapeJSON(const char *szIn, char *szOut, int iOutSize)
+{
+  int j = 0;
+  for (const char *p=szIn; *p && j<iOutSize-7; p++)
+  {
+    const unsigned char c = (unsigned char)*p;
+    if (c=='"' || c=='\\')
+    {
+      szOut[j++] = '\\';
+      szOut[j++] = (char)c;
+    }
+    else if (c<0x20)
+      j += sprintf(&szOut[j], "\\u%04x", (int)c);
+    else
+      szOut[j++] = (char)c;
+  }
+  szOut[j] = 0;
+  return szOut;
+}
+
+bool VBenchmarkRecorder::WriteJSON(const char *szFilename, const char *szScene, int iWarmupFrames, int iSimulationFPS) const
+{
+  IVFileOutStream *pOut = Vision::File.Create(szFilename);
+  if (pOut==NULL)
+    return false;
+
+  // frame time statistics
+  const int iFrames = m_iFrameCount;
+  float fMean = 0.f, fMin = 0.f, fMedian = 0.f, fP95 = 0.f, fMax = 0.f;
+  if (iFrames>0)
+  {
+    DynArray_cl<float> sorted(iFrames, 0.f);
+    memcpy(sorted.GetDataPtr(), m_FrameTimes.GetDataPtr(), iFrames*sizeof(float));
+    qsort(sorted.GetDataPtr(), iFrames, sizeof(float), CompareFloat);
+    double fSum = 0.0;
+    for (int i=0;i<iFrames;i++)
+      fSum += sorted.GetDataPtr()[i];
+    fMean = (float)(fSum/(double)iFrames);
+    fMin = sorted.GetDataPtr()[0];
+    fMedian = sorted.GetDataPtr()[iFrames/2];
+    fP95 = sorted.GetDataPtr()[hkvMath::Min((iFrames*95)/100, iFrames-1)];
+    fMax = sorted.GetDataPtr()[iFrames-1];
+  }
+
+  char szEscaped[512];
+  WriteLine(pOut, "{");
+  WriteLine(pOut, "  \"scene\": \"%s\",", EscapeJSON(szScene ? szScene : "", szEscaped, sizeof(szEscaped)));
+#ifdef PROFILING
+  WriteLine(pOut, "  \"profiling\": true,");
+#else
+  WriteLine(pOut, "  \"profiling\": false,");
+#endif
+  WriteLine(pOut, "  \"warmupFrames\": %i,", iWarmupFrames);
+  WriteLine(pOut, "  \"frames\": %i,", iFrames);
+  WriteLine(pOut, "  \"simulationFPS\": %i,", iSimulationFPS);
+  WriteLine(pOut, "  \"frameTimeMS\": {\"mean\": %.4f, \"min\": %.4f, \"median\": %.4f, \"p95\": %.4f, \"max\": %.4f},",
+    fMean, fMin, fMedian, fP95, fMax);
+
+  // per element statistics, averaged over all recorded frames
+  WriteLine(pOut, "  \"elements\": [");
+  const float fInvFrames = (iFrames>0) ? 1.f/(float)iFrames : 0.f;
+  int iLastElement = -1;
+  for (int i=0;i<m_iElementCount;i++)
+    if (m_Elements.GetDataPtr()[i].m_iTotalCalls>0 || m_Elements.GetDataPtr()[i].m_fTotalMS>0.0) // leave out elements that never executed
+      iLastElement = i;
+  for (int i=0;i<=iLastElement;i++)
+  {
+    const ElementStats_t &stats(m_Elements.GetDataPtr()[i]);
+    if (stats.m_iTotalCalls==0 && stats.m_fTotalMS<=0.0)
+      continue;
+    char szGroup[256];
+    WriteLine(pOut, "    {\"id\": %i, \"group\": \"%s\", \"name\": \"%s\", \"meanMS\": %.4f, \"maxMS\": %.4f, \"totalMS\": %.4f, \"callsPerFrame\": %.2f}%s",
+      stats.m_iID, EscapeJSON(stats.m_szGroup, szGroup, sizeof(szGroup)), EscapeJSON(stats.m_szName, szEscaped, sizeof(szEscaped)),
+      (float)stats.m_fTotalMS*fInvFrames, stats.m_fMaxMS, (float)stats.m_fTotalMS, (float)stats.m_iTotalCalls*fInvFrames,
+      (i<iLastElement) ? "," : "");
+  }
+  WriteLine(pOut, "  ]");
+  WriteLine(pOut, "}");
+
+  pOut->Close();
+  return true;
+}
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
@@ -0,0 +1,89 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+/// \file VBenchmarkRecorder.hpp
+
+#ifndef VBENCHMARKRECORDER_HPP_INCLUDED
+#define VBENCHMARKRECORDER_HPP_INCLUDED
+
+/// \brief
+///   Collects frame times and the per-frame results of the engine's profiling tree and writes them as JSON
+///
+/// RecordFrame is called once per benchmarked frame. It walks the tree of Vision::Profiling (the same elements that
+/// VISION_PROFILE_FUNCTION and VISION_START_PROFILING measure, e.g. visibility, particles, animation, physics and scripting)
+/// and accumulates the time and the call count of every element that has a valid profiling ID.
+class VBenchmarkRecorder
+{
+public:
+  VBenchmarkRecorder();
+  ~VBenchmarkRecorder();
+
+  /// \brief
+  ///   Discards all recorded frames
+  void Reset();
+
+  /// \brief
+  ///   Records one frame. fFrameTimeMS is the wall clock time of the frame, measured by the caller
+  void RecordFrame(float fFrameTimeMS);
+
+  /// \brief
+  ///   Returns the number of recorded frames
+  inline int GetFrameCount() const {return m_iFrameCount;}
+
+  /// \brief
+  ///   Writes the results to a JSON file. Returns false if the file could not be created
+  ///
+  /// \param szFilename
+  ///   Target file, opened via Vision::File.Create
+  ///
+  /// \param szScene
+  ///   Scene name that is written to the report
+  ///
+  /// \param iWarmupFrames
+  ///   Number of frames that ran before recording started; only written to the report
+  ///
+  /// \param iSimulationFPS
+  ///   Forced simulation frame rate (0 for real time); only written to the report
+  bool WriteJSON(const char *szFilename, const char *szScene, int iWarmupFrames, int iSimulationFPS) const;
+
+protected:
+  struct ElementStats_t
+  {
+    char m_szName[128];
+    char m_szGroup[64];       ///< name of the top level node the element belongs to
+    int m_iID;
+    double m_fTotalMS;
+    float m_fMaxMS;
+    unsigned int m_iTotalCalls;
+  };
+
+  void RecordNode(const VProfilingNode *pNode, const char *szGroup);
+
+  int m_iFrameCount;
+  DynArray_cl<float> m_FrameTimes;
+  int m_iElementCount;
+  DynArray_cl<ElementStats_t> m_Elements;
+  DynArray_cl<int> m_ElementIndex;  ///< index into m_Elements per profiling ID, -1 for unused IDs
+};
+
+#endif
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */
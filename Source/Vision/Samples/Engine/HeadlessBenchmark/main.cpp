@@ -0,0 +1,181 @@
+/*
+ *
+ * Confidential Information of Telekinesys Research Limited (t/a Havok). Not for disclosure or distribution without Havok's
+ * prior written consent. This software contains code, techniques and know-how which is confidential and proprietary to Havok.
+ * Product and Trade Secret source code contains trade secrets of Havok. Havok Software (C) Copyright 1999-2013 Telekinesys Research Limited t/a Havok. All Rights Reserved. Use of this software is subject to the terms of an end user license agreement.
+ *
+ */
+
+// ***********************************************************************************************
+// HeadlessBenchmark : CPU benchmark of the engine subsystems
+// Copyright (C) Havok.com Inc. All rights reserved.
+// ***********************************************************************************************
+// Loads a scene in headless mode (null renderer, no window, no GPU required), runs a fixed number
+// of frames with a fixed simulation time step and writes the per-frame times of all profiling
+// elements (visibility, particles, animation, physics, scripting, ...) to a JSON file.
+//
+// With -test, no scene is loaded. Instead all test classes of the loaded modules (classes derived from
+// VTestClass, e.g. the particle, animation and GUI tests of the engine plugin) run once, and their results
+// are written to a JUnit compatible XML report.
+//
+// Command line (Windows):
+//   HeadlessBenchmark.exe [-data <sample data dir>] [-scene <scene>] [-frames <n>] [-warmup <n>]
+//                         [-fps <simulation frame rate>] [-out <report.json>] [-test <report.xml>]
+// ***********************************************************************************************
+#include <Vision/Samples/Engine/HeadlessBenchmark/HeadlessBenchmarkPCH.h>
+#include <Vision/Samples/Engine/HeadlessBenchmark/VBenchmarkRecorder.hpp>
+
+struct BenchmarkConfig_t
+{
+  BenchmarkConfig_t()
+  {
+    sDataDir = "Maps\\ViewerMap";
+    sScene = "ViewerMap";
+    sOutFile = "HeadlessBenchmark.json";
+    iFrames = 1000;
+    iWarmupFrames = 100;
+    iSimulationFPS = 60;
+  }
+
+#if defined(WIN32) && !defined(_VISION_WINRT)
+  void ParseParams()
+  {
+    int argc;
+    LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+
+    for (int i=1;i<argc-1;i++)
+    {
+      LPWSTR pArg = argv[i];
+      if (pArg[0]!='-' && pArg[0]!='/')
+        continue;
+      pArg++;
+      LPWSTR pValue = argv[++i]; // all options take one value
+
+      if (!_wcsicmp(pArg,L"data")) sDataDir = VString(pValue);
+      else if (!_wcsicmp(pArg,L"scene")) sScene = VString(pValue);
+      else if (!_wcsicmp(pArg,L"out")) sOutFile = VString(pValue);
+      else if (!_wcsicmp(pArg,L"frames")) iFrames = hkvMath::Max(_wtoi(pValue), 1);
+      else if (!_wcsicmp(pArg,L"warmup")) iWarmupFrames = hkvMath::Max(_wtoi(pValue), 0);
+      else if (!_wcsicmp(pArg,L"fps")) iSimulationFPS = hkvMath::Max(_wtoi(pValue), 0);
+      else if (!_wcsicmp(pArg,L"test")) sTestReport = VString(pValue);
+      else
+        i--; // unknown option without value
+    }
+
+    LocalFree(argv);
+  }
+#else
+  void ParseParams() {}
+#endif
+
+  VString sDataDir;
+  VString sScene;
+  VString sOutFile;
+  int iFrames;
+  int iWarmupFrames;
+  int iSimulationFPS; ///< 0 uses the real frame time
+  VString sTestReport; ///< XML report of the test classes, which run instead of the scene if set
+};
+
+static BenchmarkConfig_t g_Config;
+static VBenchmarkRecorder g_Recorder;
+static int g_iFrame = 0;
+
+VisSampleAppPtr spApp;
+
+VISION_INIT
+{
+  VISION_SET_DIRECTORIES(false);
+  g_Config.ParseParams();
+
+  spApp = new VisSampleApp();
+  spApp->LoadVisionEnginePlugin();
+  VISION_PLUGIN_ENSURE_LOADED(vHavok);
+
+  // no window, no splash screen, no vsync and no prompts
+  const uint64 iSampleFlags = VSampleFlags::VSAMPLE_HEADLESS | VSampleFlags::VSAMPLE_DISABLEDEFAULTKEYS;
+  const char *szScene = g_Config.sTestReport.IsEmpty() ? g_Config.sScene.AsChar() : NULL;
+  if (!spApp->InitSample(g_Config.sDataDir, szScene, iSampleFlags))
+    return false;
+
+  return true;
+}
+
+VISION_SAMPLEAPP_AFTER_LOADING
+{
+  // a fixed time step makes the simulated work independent of the speed of the machine
+  Vision::GetTimer()->ForceFrameRate(g_Config.iSimulationFPS);
+  Vision::Profiling.ResetProfilingMaxValues();
+  g_Recorder.Reset();
+  g_iFrame = 0;
+}
+
+// runs all registered test classes once instead of the scene frames
+static void RunTests()
+{
+  char szTestDir[FS_MAX_PATH];
+  VFileHelper::GetFileDir(g_Config.sTestReport, szTestDir);
+  if (!szTestDir[0])
+    strcpy(szTestDir, ".");
+
+  VTestUnit tests(szTestDir, szTestDir);
+  tests.SetOutput(AOUT_STDOUT);
+  tests.SetXMLOutput(TRUE, VFileHelper::GetFilename(g_Config.sTestReport));
+  const int iTestCount = tests.RegisterTestsFromModule(*Vision::GetTypeManager(), V_RUNTIME_CLASS(VTestClass));
+  const int iFailedCount = tests.RunAll();
+  tests.FinishOutputDocuments();
+
+  if (iFailedCount>0)
+    Vision::Error.Warning("HeadlessBenchmark: %i of %i tests failed, see %s", iFailedCount, iTestCount, g_Config.sTestReport.AsChar());
+  else
+    Vision::Error.SystemMessage("HeadlessBenchmark: %i tests passed, results written to %s", iTestCount, g_Config.sTestReport.AsChar());
+}
+
+VISION_SAMPLEAPP_RUN
+{
+  const uint64 iStartTime = VGLGetTimer();
+  if (!spApp->Run())
+    return false;
+  if (!g_Config.sTestReport.IsEmpty())
+  {
+    RunTests();
+    return false;
+  }
+  const float fFrameTimeMS = (float)((double)(VGLGetTimer()-iStartTime)*1000.0/(double)VGLGetTimerResolution());
+
+  if (++g_iFrame<=g_Config.iWarmupFrames)
+    return true;
+  g_Recorder.RecordFrame(fFrameTimeMS);
+  if (g_Recorder.GetFrameCount()<g_Config.iFrames)
+    return true;
+
+  if (g_Recorder.WriteJSON(g_Config.sOutFile, g_Config.sScene, g_Config.iWarmupFrames, g_Config.iSimulationFPS))
+    Vision::Error.SystemMessage("HeadlessBenchmark: Results written to %s", g_Config.sOutFile.AsChar());
+  else
+    Vision::Error.Warning("HeadlessBenchmark: Failed to write %s", g_Config.sOutFile.AsChar());
+  return false;
+}
+
+VISION_DEINIT
+{
+  spApp->DeInitSample();
+  spApp = NULL;
+  return true;
+}
+
+VISION_MAIN_DEFAULT
+
+/*
+ * Havok SDK - Base file, BUILD(#20131019)
+ * 
+ * Confidential Information of Havok.  (C) Copyright 1999-2013
+ * Telekinesys Research Limited t/a Havok. All Rights Reserved. The Havok
+ * Logo, and the Havok buzzsaw logo are trademarks of Havok.  Title, ownership
+ * rights, and intellectual property rights in the Havok software remain in
+ * Havok and/or its suppliers.
+ * 
+ * Use of this software for evaluation purposes is subject to and indicates
+ * acceptance of the End User licence Agreement for this product. A copy of
+ * the license is included with this software and is also available from salesteam@havok.com.
+ * 
+ */